@@ -0,0 +1,101 @@
+/*
+ * Asynchronous flash controller for the simulator, backend of
+ * bslib::flash::Job_Queue.
+ *
+ * A thread plays the flash controller: it waits the erase or program time
+ * of the operation, applies it to a NorFlash and calls the operation done
+ * callback, like the end of operation interrupt on the board does.
+ */
+#pragma once
+
+#include <sim_nor_flash.hpp>
+#include <bslib-Flash_Job_Queue.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace BSP::sim {
+
+class AsyncFlashBackend : public bslib::flash::Flash_Backend_Interface
+{
+public:
+	struct Statistics
+	{
+		std::size_t               operations = 0;
+		std::size_t               failed     = 0;
+		// time the controller was busy, like the BSY flag
+		std::chrono::microseconds busy_time{};
+	};
+
+protected:
+	struct Operation
+	{
+		bslib::flash::job_type_t type;
+		std::size_t              address;
+		std::vector<std::byte>   word;
+		// the operation can not start before this point in time
+		std::chrono::steady_clock::time_point requested{};
+	};
+
+	NorFlash &                  flash;
+	const std::size_t           flash_word_size;
+	const std::size_t           sector_size;
+	const std::chrono::microseconds erase_time;
+	const std::chrono::microseconds program_time;
+
+	std::mutex                  mutex;
+	std::condition_variable     cond;
+	std::optional<Operation>    pending;
+	bool                        busy = false;
+	bool                        stop = false;
+	Statistics                  statistics;
+
+	// end of the last operation, the next one can start earliest then,
+	// only used by the thread of the controller
+	std::chrono::steady_clock::time_point last_end{};
+
+	wlib::Callback<void(bool)> *operation_done = nullptr;
+
+	std::thread                 thread;
+
+public:
+	/**
+	 * flash should have Timing::None, the latency is emulated here.
+	 * The operation times default to the ones of the flash configuration.
+	 */
+	explicit AsyncFlashBackend( NorFlash & flash_,
+								std::optional<std::chrono::microseconds> erase_time_ = {},
+								std::optional<std::chrono::microseconds> program_time_ = {} );
+
+	~AsyncFlashBackend();
+
+	AsyncFlashBackend( const AsyncFlashBackend & ) = delete;
+	AsyncFlashBackend & operator=( const AsyncFlashBackend & ) = delete;
+
+	std::size_t get_sector_size() const noexcept override {
+		return sector_size;
+	}
+
+	std::size_t get_flash_word_size() const noexcept override {
+		return flash_word_size;
+	}
+
+	void set_operation_done_callback( wlib::Callback<void(bool)> *callback ) noexcept override;
+
+	/**
+	 * addresses are relative to the start of the NorFlash
+	 */
+	bool start_erase( std::size_t address ) noexcept override;
+	bool start_program( std::size_t address, std::span<const std::byte> word ) noexcept override;
+
+	Statistics get_statistics();
+
+protected:
+	bool start( Operation && operation );
+	void run();
+};
+
+} // namespace BSP::sim
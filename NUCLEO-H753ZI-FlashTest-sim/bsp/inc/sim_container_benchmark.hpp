@@ -0,0 +1,16 @@
+/*
+ * Throughput and latency benchmarks of the bslib containers
+ * and publishers on the PC.
+ */
+#pragma once
+
+#include <wlib.hpp>
+
+namespace BSP::sim {
+
+/**
+ * runs all container benchmarks and prints the results
+ */
+void container_benchmark( wlib::StringSink_Interface & sink );
+
+} // namespace BSP::sim
@@ -0,0 +1,17 @@
+/*
+ * Stress tests of the lock free bslib containers and publishers
+ * with real threads on the PC.
+ */
+#pragma once
+
+#include <wlib.hpp>
+
+namespace BSP::sim {
+
+/**
+ * runs all stress tests, prints the result of each one,
+ * returns false if one of them failed
+ */
+bool container_stress( wlib::StringSink_Interface & sink );
+
+} // namespace BSP::sim
@@ -0,0 +1,25 @@
+/*
+ * Throughput benchmark of the JBODGenericFlashDriver on two
+ * simulated flash banks, concatenated and striped, of the
+ * asynchronous flash job queue and of the PageCacheRawDriver.
+ */
+#pragma once
+
+#include <wlib.hpp>
+
+namespace BSP::sim {
+
+/**
+ * writes both banks completely, once concatenated from one task,
+ * once striped with one task per bank, and prints the throughput.
+ * Then erases and programs one bank blocking and via the job queue and
+ * prints how long the task was blocked and the cpu time used meanwhile,
+ * and checks that the queue survives a refused step, a failed operation
+ * and a full queue.
+ * At last appends log records through GenericFlashDriver, directly and
+ * through a PageCacheRawDriver, and prints the erases and programmed flash words,
+ * and checks that the PageCacheRawDriver keeps a page it could not write back.
+ */
+void flash_benchmark( wlib::StringSink_Interface & sink );
+
+} // namespace BSP::sim
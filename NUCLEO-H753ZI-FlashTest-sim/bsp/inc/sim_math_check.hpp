@@ -0,0 +1,19 @@
+/*
+ * Accuracy checks of the optimized ex-math kernels, the CRC engines
+ * and SHA-256 against straightforward reference implementations or
+ * known answers on the PC, and their time and stack compared to
+ * these implementations.
+ */
+#pragma once
+
+#include <wlib.hpp>
+
+namespace BSP::sim {
+
+/**
+ * runs all checks, prints the result of each one,
+ * returns false if one of them failed
+ */
+bool math_check( wlib::StringSink_Interface & sink );
+
+} // namespace BSP::sim
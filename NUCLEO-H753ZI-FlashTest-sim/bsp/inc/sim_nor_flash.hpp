@@ -0,0 +1,140 @@
+/*
+ * NOR flash model for the simulator.
+ *
+ * Behaves like one bank of the STM32H7 internal flash:
+ *  - erased state is 0xFF, erasing is only possible per sector
+ *  - programming is done per flash word (256 bit) and can only clear bits
+ *  - a flash word can be programmed once after an erase, a second program
+ *    is refused and counted as violation (the H7 reports an error too)
+ *  - erase and program operations take their time, either just accounted,
+ *    or really slept, so tasks see the flash busy like on the board.
+ *
+ * Every sector counts its erases and programmed flash words, so the wear and the
+ * time a filesystem or storage strategy spends on flash can be measured on a PC.
+ */
+#pragma once
+
+#include <RawDriverInterface.h>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace BSP::sim {
+
+class NorFlash : public stm32_internal_flash::RawDriverInterface
+{
+public:
+	enum class Timing
+	{
+		None,    // no time is accounted
+		Account, // busy time is summed up, operations return immediately
+		Sleep    // the calling task sleeps for the duration of the operation
+	};
+
+	struct Configuration
+	{
+		std::size_t               size              = 2 * 128 * 1024;
+		std::size_t               sector_size       = 128 * 1024;
+		std::size_t               flash_word_size   = 32;
+		// typical STM32H7 values, 3.3V, x64 parallelism
+		std::chrono::microseconds sector_erase_time = std::chrono::microseconds( 1'000'000 );
+		std::chrono::microseconds word_program_time = std::chrono::microseconds( 16 );
+		bool                      strict_program_once = true;
+		Timing                    timing            = Timing::Account;
+		// if set, the content is loaded from and written through to this file
+		std::string               file_name{};
+	};
+
+	struct SectorStatistics
+	{
+		std::size_t erases             = 0;
+		std::size_t programmed_words   = 0;
+		std::size_t program_violations = 0;
+	};
+
+	struct Report
+	{
+		std::vector<SectorStatistics> sectors{};
+		std::size_t                   erases             = 0;
+		std::size_t                   programmed_words   = 0;
+		std::size_t                   program_violations = 0;
+		std::size_t                   bytes_read         = 0;
+		std::size_t                   bytes_written      = 0;
+		std::chrono::microseconds     busy_time{};
+
+		std::size_t get_max_erases() const;
+		std::size_t get_min_erases() const;
+	};
+
+protected:
+	const Configuration    conf;
+	mutable std::mutex     mutex;
+	std::vector<std::byte> data;
+	std::vector<bool>      programmed;
+	Report                 report;
+	std::fstream           file;
+
+public:
+	explicit NorFlash( const Configuration & conf_ );
+
+	NorFlash( const NorFlash & ) = delete;
+	NorFlash & operator=( const NorFlash & ) = delete;
+
+	std::size_t get_size() override {
+		return conf.size;
+	}
+
+	/**
+	 * the erase unit, a sector
+	 */
+	std::size_t get_page_size() override {
+		return conf.sector_size;
+	}
+
+	std::size_t get_write_size() override {
+		return conf.flash_word_size;
+	}
+
+	/**
+	 * erases all sectors of [address, address + size), both have to be sector aligned
+	 */
+	bool erase_page( std::size_t address, std::size_t size ) override;
+
+	/**
+	 * programs whole flash words, address and buffer size have to be flash word aligned.
+	 * Returns the number of bytes programmed until the first failing word.
+	 */
+	std::size_t write_page( std::size_t address, const std::span<const std::byte> & buffer ) override;
+
+	std::size_t read_page( std::size_t address, std::span<std::byte> & buffer ) override;
+
+	/**
+	 * the flash is memory mapped, like the internal flash of the H7
+	 */
+	const std::byte* map_read( std::size_t address, std::size_t size ) override;
+
+	/**
+	 * the flash remembers, which words have been programmed since their erase
+	 */
+	bool is_word_programmed( std::size_t address ) const override;
+
+	Report get_report() const;
+	void reset_report();
+
+	const Configuration & get_configuration() const {
+		return conf;
+	}
+
+protected:
+	void busy( std::chrono::microseconds duration );
+	void write_through( std::size_t address, std::size_t size );
+};
+
+std::ostream & operator<<( std::ostream & out, const NorFlash::Report & report );
+
+} // namespace BSP::sim
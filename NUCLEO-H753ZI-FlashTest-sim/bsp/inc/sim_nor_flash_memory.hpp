@@ -0,0 +1,49 @@
+/*
+ * wlib::memory::Flash_Memory_Interface on top of the NOR flash model,
+ * so the flash storage strategies of wlib can run on the simulator.
+ */
+#pragma once
+
+#include <sim_nor_flash.hpp>
+#include <wlib-memory.hpp>
+
+namespace BSP::sim {
+
+/**
+ * Addresses are relative to the start of the NorFlash.
+ * A failing erase or program throws std::runtime_error, the interface
+ * has no other way to report it.
+ */
+class NorFlashMemory : public wlib::memory::Flash_Memory_Interface
+{
+	NorFlash & flash;
+
+public:
+	explicit NorFlashMemory( NorFlash & flash_ )
+	: flash( flash_ )
+	{}
+
+	std::size_t get_size() const override {
+		return flash.get_configuration().size;
+	}
+
+	std::size_t get_sector_size() const override {
+		return flash.get_configuration().sector_size;
+	}
+
+	std::size_t get_program_size() const override {
+		return flash.get_configuration().flash_word_size;
+	}
+
+	void erase( std::size_t add, std::size_t size ) override;
+	void write( std::size_t add, std::span<const std::byte> data ) override;
+	void read( std::size_t add, std::span<std::byte> data ) override;
+
+	/**
+	 * NorFlash programs immediately
+	 */
+	void flush() override {
+	}
+};
+
+} // namespace BSP::sim
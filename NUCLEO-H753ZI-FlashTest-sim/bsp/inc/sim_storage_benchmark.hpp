@@ -0,0 +1,25 @@
+/*
+ * Flash wear of the wlib storage strategies on the simulated flash.
+ */
+#pragma once
+
+#include <wlib.hpp>
+
+namespace BSP::sim {
+
+/**
+ * saves the same sequence of settings once with mirrow_storage_t and
+ * once with log_storage_t, prints the erases, programmed flash words and the
+ * flash busy time of both, and checks, that log_storage_t finds the last
+ * value again after a restart, also after power losses and failed writes
+ * torn within a record, and rejects an invalid configuration.
+ * Then appends small entries through Write_Coalescing_Memory and prints
+ * the coalesced bytes and the saved program operations, and times the
+ * serialization of a record with MemoryBlob and AppendWriter against
+ * the byte loops MemoryBlob used before, and checks that a record of
+ * wlib::blob::schema survives the round trip in both byte orders.
+ * Returns false if a check failed.
+ */
+bool storage_benchmark( wlib::StringSink_Interface & sink );
+
+} // namespace BSP::sim
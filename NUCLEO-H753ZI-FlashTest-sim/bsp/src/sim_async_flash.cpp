@@ -0,0 +1,144 @@
+/*
+ * Asynchronous flash controller for the simulator.
+ */
+#include <sim_async_flash.hpp>
+#include <algorithm>
+
+namespace BSP::sim {
+
+AsyncFlashBackend::AsyncFlashBackend( NorFlash & flash_,
+									  std::optional<std::chrono::microseconds> erase_time_,
+									  std::optional<std::chrono::microseconds> program_time_ )
+: flash( flash_ ),
+  flash_word_size( flash_.get_configuration().flash_word_size ),
+  sector_size( flash_.get_configuration().sector_size ),
+  erase_time( erase_time_.value_or( flash_.get_configuration().sector_erase_time ) ),
+  program_time( program_time_.value_or( flash_.get_configuration().word_program_time ) ),
+  thread( [this]() { run(); } )
+{
+}
+
+AsyncFlashBackend::~AsyncFlashBackend()
+{
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+		stop = true;
+	}
+
+	cond.notify_all();
+	thread.join();
+}
+
+void AsyncFlashBackend::set_operation_done_callback( wlib::Callback<void(bool)> *callback ) noexcept
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	operation_done = callback;
+}
+
+bool AsyncFlashBackend::start_erase( std::size_t address ) noexcept
+{
+	if( address % sector_size != 0 || address + sector_size > flash.get_size() ) {
+		return false;
+	}
+
+	return start( Operation{ bslib::flash::job_type_t::erase, address, {} } );
+}
+
+bool AsyncFlashBackend::start_program( std::size_t address, std::span<const std::byte> word ) noexcept
+{
+	if( word.size() != flash_word_size || address % flash_word_size != 0 || address + flash_word_size > flash.get_size() ) {
+		return false;
+	}
+
+	// the controller has its own write buffer, the caller may reuse the word
+	return start( Operation{ bslib::flash::job_type_t::program, address, std::vector<std::byte>( word.begin(), word.end() ) } );
+}
+
+bool AsyncFlashBackend::start( Operation && operation )
+{
+	// started from the operation done callback, that is at the end of the last operation,
+	// even if the thread of the controller woke up a little too late
+	if( std::this_thread::get_id() == thread.get_id() ) {
+		operation.requested = last_end;
+	} else {
+		operation.requested = std::chrono::steady_clock::now();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock( mutex );
+
+		// one operation at once, like the BSY flag
+		if( busy ) {
+			return false;
+		}
+
+		busy = true;
+		pending = std::move( operation );
+	}
+
+	cond.notify_one();
+	return true;
+}
+
+AsyncFlashBackend::Statistics AsyncFlashBackend::get_statistics()
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	return statistics;
+}
+
+void AsyncFlashBackend::run()
+{
+	while( true ) {
+		Operation operation;
+
+		{
+			std::unique_lock<std::mutex> lock( mutex );
+			cond.wait( lock, [this]() { return stop || pending.has_value(); } );
+
+			if( stop ) {
+				return;
+			}
+
+			operation = std::move( *pending );
+			pending.reset();
+		}
+
+		const std::chrono::microseconds duration = operation.type == bslib::flash::job_type_t::erase ? erase_time : program_time;
+
+		// the operations of a busy controller follow each other without a gap, so a row
+		// of short programs takes its sum, even if the sleep of the PC is not that exact
+		const auto start_time = std::max( operation.requested, last_end );
+		last_end = start_time + duration;
+		std::this_thread::sleep_until( last_end );
+
+		bool success = false;
+
+		if( operation.type == bslib::flash::job_type_t::erase ) {
+			success = flash.erase_page( operation.address, sector_size );
+		} else {
+			success = flash.write_page( operation.address, operation.word ) == flash_word_size;
+		}
+
+		wlib::Callback<void(bool)> *callback = nullptr;
+
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			statistics.operations++;
+			statistics.busy_time += duration;
+
+			if( !success ) {
+				statistics.failed++;
+			}
+
+			busy = false;
+			callback = operation_done;
+		}
+
+		// the "interrupt", the callback may start the next operation
+		if( callback ) {
+			(*callback)( success );
+		}
+	}
+}
+
+} // namespace BSP::sim
@@ -178,9 +178,28 @@ static bool read_available_data_from_stdin( std::list<int> & msg )
 #endif
 
 
-std::optional<char> BSP::usb_uart_get_char()
+static std::list<int> & get_input_data()
 {
 	static std::list<int> data;
+	return data;
+}
+
+std::optional<char> BSP::usb_uart_get_char()
+{
+	char c;
+	if( usb_uart_read_available( std::span<char>( &c, 1 ) ).empty() ) {
+		return {};
+	}
+	return c;
+}
+
+std::span<char const> BSP::usb_uart_read_available(std::span<char> buffer)
+{
+	std::list<int> & data = get_input_data();
+
+	if( buffer.empty() ) {
+		return {};
+	}
 
 	for( ; os::this_thread::keep_running() ; os::this_thread::sleep_for(std::chrono::milliseconds(10) ) ) {
 
@@ -190,12 +209,15 @@ std::optional<char> BSP::usb_uart_get_char()
 			continue;
 		}
 
-		int c = data.front();
-		data.pop_front();
+		std::size_t len = 0;
+		while( len < buffer.size() && !data.empty() ) {
+			buffer[len++] = static_cast<char>(data.front());
+			data.pop_front();
+		}
 
-		// CPPDEBUG( Tools::format( "c: '%c' %d", (char)c, c ) );
+		// CPPDEBUG( Tools::format( "read %d chars", (int)len ) );
 
-		return static_cast<char>(c);
+		return buffer.first(len);
 	}
 
 	return {};
@@ -0,0 +1,614 @@
+/*
+ * Throughput and latency benchmarks of the bslib containers
+ * and publishers on the PC.
+ *
+ * The numbers depend on the PC and its number of cores, they
+ * are only comparable between the variants of one run.
+ */
+#include <sim_container_benchmark.hpp>
+#include <bslib-SPSC.hpp>
+#include <bslib-SPSC_aligned.hpp>
+#include <bslib-MPSC.hpp>
+#include <bslib-MPMC.hpp>
+#include <bslib-Broadcast_Ring.hpp>
+#include <bslib-LF_publisher.hpp>
+#include <bslib-Deferred_publisher.hpp>
+#include <static_format.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <vector>
+
+using namespace Tools;
+
+namespace {
+
+constexpr std::size_t NUMBER_OF_ELEMENTS = 2'000'000;
+constexpr std::size_t QUEUE_SIZE = 1023;
+constexpr std::size_t BLOCK_SIZE = 64;
+
+struct Result
+{
+	bool                      success = false;
+	std::chrono::milliseconds duration{};
+	// broadcast ring only, entries the readers missed, because they were overwritten
+	std::size_t               lost = 0;
+};
+
+void print( wlib::StringSink_Interface & sink, const char *name, const Result & result )
+{
+	if( !result.success ) {
+		sink( static_format<100>( "%s: failed\n", name ).c_str() );
+		return;
+	}
+
+	const long long ms = std::max<long long>( result.duration.count(), 1 );
+
+	sink( static_format<150>( "%s: %d elements in %dms %dk elements/s%s\n",
+			name, NUMBER_OF_ELEMENTS, ms, NUMBER_OF_ELEMENTS / ms,
+			result.lost ? static_format<50>( ", lost by readers: %d", result.lost ).c_str() : "" ).c_str() );
+}
+
+/**
+ * one producer and one consumer thread, element by element,
+ * the consumer checks the order
+ */
+template<class Queue>
+Result measure_spsc()
+{
+	static Queue queue;
+	bool in_order = true;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread consumer( [&]() {
+		for( uint32_t expected = 0; expected < NUMBER_OF_ELEMENTS; ) {
+			if( auto value = queue.pop_front(); value ) {
+				in_order = in_order && *value == expected;
+				expected++;
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	for( uint32_t i = 0; i < NUMBER_OF_ELEMENTS; ) {
+		if( queue.push_back( i ) ) {
+			i++;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	consumer.join();
+
+	return { in_order, std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ) };
+}
+
+/**
+ * like measure_spsc(), but BLOCK_SIZE elements at once via the span interface
+ */
+template<class Queue>
+Result measure_spsc_bulk()
+{
+	static Queue queue;
+	bool in_order = true;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread consumer( [&]() {
+		uint32_t block[BLOCK_SIZE];
+
+		for( uint32_t expected = 0; expected < NUMBER_OF_ELEMENTS; ) {
+			const std::size_t len = queue.pop_front( std::span<uint32_t>( block ) );
+
+			if( len == 0 ) {
+				std::this_thread::yield();
+			}
+
+			for( std::size_t i = 0; i < len; i++, expected++ ) {
+				in_order = in_order && block[i] == expected;
+			}
+		}
+	});
+
+	uint32_t block[BLOCK_SIZE];
+
+	for( uint32_t i = 0; i < NUMBER_OF_ELEMENTS; ) {
+		const std::size_t count = std::min<std::size_t>( BLOCK_SIZE, NUMBER_OF_ELEMENTS - i );
+
+		for( std::size_t k = 0; k < count; k++ ) {
+			block[k] = i + k;
+		}
+
+		const std::size_t len = queue.push_back( std::span<const uint32_t>( block, count ) );
+
+		if( len == 0 ) {
+			std::this_thread::yield();
+		}
+
+		i += len;
+	}
+
+	consumer.join();
+
+	return { in_order, std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ) };
+}
+
+/**
+ * like measure_spsc_bulk(), but without copies: the producer fills the
+ * queue in place via reserve_span()/commit(), the consumer reads it in
+ * place via peak_span()/drop(), like the serial command parser does
+ */
+template<class Queue>
+Result measure_spsc_span()
+{
+	static Queue queue;
+	bool in_order = true;
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::thread consumer( [&]() {
+		for( uint32_t expected = 0; expected < NUMBER_OF_ELEMENTS; ) {
+			const std::span<uint32_t> values = queue.peak_span();
+
+			if( values.empty() ) {
+				std::this_thread::yield();
+			}
+
+			for( const uint32_t value : values ) {
+				in_order = in_order && value == expected++;
+			}
+
+			queue.drop( values.size() );
+		}
+	});
+
+	for( uint32_t i = 0; i < NUMBER_OF_ELEMENTS; ) {
+		const std::span<uint32_t> free = queue.reserve_span( std::min<std::size_t>( BLOCK_SIZE, NUMBER_OF_ELEMENTS - i ) );
+
+		if( free.empty() ) {
+			std::this_thread::yield();
+		}
+
+		for( std::size_t k = 0; k < free.size(); k++ ) {
+			free[k] = i + k;
+		}
+
+		queue.commit( free.size() );
+		i += free.size();
+	}
+
+	consumer.join();
+
+	return { in_order, std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ) };
+}
+
+struct QueueLatencyResult
+{
+	bool                     success = false;
+	std::chrono::nanoseconds p50{};
+	std::chrono::nanoseconds p99{};
+	std::chrono::nanoseconds p999{};
+	std::chrono::nanoseconds max{};
+};
+
+/**
+ * the producer pushes the time stamp of each element every few microseconds,
+ * the consumer polls and measures how long each one took from push_back()
+ * to pop_front(), reported as percentiles
+ */
+template<class Queue>
+QueueLatencyResult measure_spsc_latency()
+{
+	constexpr std::size_t NUMBER_OF_SAMPLES = 100'000;
+	constexpr auto PERIOD = std::chrono::microseconds( 2 );
+
+	static Queue queue;
+	std::vector<std::chrono::nanoseconds> latencies;
+	latencies.reserve( NUMBER_OF_SAMPLES );
+
+	std::thread consumer( [&]() {
+		while( latencies.size() < NUMBER_OF_SAMPLES ) {
+			if( auto value = queue.pop_front(); value ) {
+				const auto now = std::chrono::steady_clock::now().time_since_epoch();
+				latencies.push_back( now - std::chrono::nanoseconds( *value ) );
+			} else {
+				std::this_thread::yield();
+			}
+		}
+	});
+
+	auto next = std::chrono::steady_clock::now();
+
+	for( std::size_t i = 0; i < NUMBER_OF_SAMPLES; ) {
+		// no sleep, it would take much longer than the period
+		while( std::chrono::steady_clock::now() < next ) {
+			std::this_thread::yield();
+		}
+
+		next += PERIOD;
+
+		const std::chrono::nanoseconds stamp = std::chrono::steady_clock::now().time_since_epoch();
+
+		if( queue.push_back( static_cast<uint64_t>( stamp.count() ) ) ) {
+			i++;
+		}
+	}
+
+	consumer.join();
+
+	std::sort( latencies.begin(), latencies.end() );
+
+	auto percentile = [&]( double p ) {
+		return latencies[std::min( latencies.size() - 1, static_cast<std::size_t>( p * latencies.size() ) )];
+	};
+
+	return { true, percentile( 0.5 ), percentile( 0.99 ), percentile( 0.999 ), latencies.back() };
+}
+
+void print( wlib::StringSink_Interface & sink, const char *name, const QueueLatencyResult & result )
+{
+	if( !result.success ) {
+		sink( static_format<100>( "%s: failed\n", name ).c_str() );
+		return;
+	}
+
+	sink( static_format<200>( "%s: latency p50 %dns p99 %dns p99.9 %dns max %dns\n",
+			name, static_cast<long long>( result.p50.count() ), static_cast<long long>( result.p99.count() ),
+			static_cast<long long>( result.p999.count() ), static_cast<long long>( result.max.count() ) ).c_str() );
+}
+
+/**
+ * number_of_producers threads push NUMBER_OF_ELEMENTS together, one consumer
+ * pops them single or via peak_span()/drop() like the UART DMA does. The
+ * values of each producer have to arrive in order.
+ */
+Result measure_mpsc( std::size_t number_of_producers, bool span )
+{
+	using queue_t = bslib::container::mpsc_queue_ex_mem<uint32_t>;
+
+	static queue_t::mem_payload_t    mem[QUEUE_SIZE + 1];
+	static queue_t::mem_slot_state_t slot_state[QUEUE_SIZE + 1];
+	queue_t queue( mem, slot_state );
+
+	std::vector<std::thread> producers;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for( std::size_t t = 0; t < number_of_producers; t++ ) {
+		producers.emplace_back( [&, t]() {
+			for( uint32_t i = t; i < NUMBER_OF_ELEMENTS; ) {
+				if( queue.push_back( i ) ) {
+					i += number_of_producers;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<std::optional<uint32_t>> last( number_of_producers );
+	bool in_order = true;
+	std::size_t received = 0;
+
+	auto check = [&]( uint32_t value ) {
+		std::optional<uint32_t> & last_of_producer = last[value % number_of_producers];
+
+		in_order = in_order && ( !last_of_producer || *last_of_producer + number_of_producers == value );
+		last_of_producer = value;
+		received++;
+	};
+
+	while( received < NUMBER_OF_ELEMENTS ) {
+		if( span ) {
+			std::span<uint32_t> values = queue.peak_span();
+
+			for( uint32_t value : values ) {
+				check( value );
+			}
+
+			queue.drop( values.size() );
+
+			if( values.empty() ) {
+				std::this_thread::yield();
+			}
+		} else if( auto value = queue.pop_front(); value ) {
+			check( *value );
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	for( std::thread & producer : producers ) {
+		producer.join();
+	}
+
+	return { in_order, std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ) };
+}
+
+/**
+ * producers and consumers threads share NUMBER_OF_ELEMENTS,
+ * the sum of all popped values has to match the pushed ones
+ */
+Result measure_mpmc( std::size_t number_of_threads )
+{
+	static bslib::container::MPMC<uint32_t, 1024> queue;
+
+	std::atomic<uint64_t> sum_popped = 0;
+	std::atomic<std::size_t> popped = 0;
+	std::vector<std::thread> threads;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for( std::size_t t = 0; t < number_of_threads; t++ ) {
+		threads.emplace_back( [&]() {
+			uint64_t sum = 0;
+
+			while( popped.load( std::memory_order_relaxed ) < NUMBER_OF_ELEMENTS ) {
+				if( auto value = queue.pop_front(); value ) {
+					sum += *value;
+					popped++;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+
+			sum_popped += sum;
+		});
+
+		threads.emplace_back( [&, t]() {
+			for( uint32_t i = t; i < NUMBER_OF_ELEMENTS; ) {
+				if( queue.push_back( i ) ) {
+					i += number_of_threads;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	for( std::thread & thread : threads ) {
+		thread.join();
+	}
+
+	const uint64_t sum_pushed = uint64_t( NUMBER_OF_ELEMENTS ) * ( NUMBER_OF_ELEMENTS - 1 ) / 2;
+
+	return { sum_popped == sum_pushed && popped == NUMBER_OF_ELEMENTS,
+			 std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ) };
+}
+
+/**
+ * one writer, number_of_readers readers. The writer never waits, so slow
+ * readers lose entries, but the ones they get have to be increasing.
+ */
+Result measure_broadcast( std::size_t number_of_readers )
+{
+	using ring_t = bslib::container::Broadcast_Ring<uint32_t, 1024>;
+	static ring_t ring;
+
+	std::atomic<bool> done = false;
+	std::atomic<std::size_t> lost = 0;
+	std::atomic<bool> in_order = true;
+	std::vector<std::unique_ptr<ring_t::Reader>> readers;
+	std::vector<std::thread> threads;
+
+	for( std::size_t r = 0; r < number_of_readers; r++ ) {
+		readers.push_back( std::make_unique<ring_t::Reader>( ring ) );
+	}
+
+	const uint32_t first = ring.get_number_of_written_entries();
+	auto start = std::chrono::steady_clock::now();
+
+	for( std::unique_ptr<ring_t::Reader> & reader : readers ) {
+		threads.emplace_back( [&, reader = reader.get()]() {
+			std::optional<uint32_t> last;
+
+			while( true ) {
+				const bool writer_done = done;
+
+				if( auto value = reader->try_read(); value ) {
+					if( last && *value <= *last ) {
+						in_order = false;
+					}
+
+					last = value;
+				} else if( writer_done ) {
+					break;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+
+			lost += reader->get_number_of_lost_entries();
+		});
+	}
+
+	for( uint32_t i = 0; i < NUMBER_OF_ELEMENTS; i++ ) {
+		ring.push_back( first + i );
+	}
+
+	done = true;
+
+	for( std::thread & thread : threads ) {
+		thread.join();
+	}
+
+	Result result{ in_order, std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start ) };
+	result.lost = lost;
+
+	return result;
+}
+
+struct Sample
+{
+	std::chrono::steady_clock::time_point published;
+	// not counted, only to let the publisher notice its subscribers
+	bool                                  warm_up;
+};
+
+/**
+ * subscriber, that needs some time for each value, like one that logs
+ */
+class BusySubscriber : public wlib::publisher::Publisher_Interface<Sample>::Subscription_Interface
+{
+	const std::chrono::microseconds work;
+
+public:
+	std::atomic<std::size_t> received = 0;
+	std::chrono::nanoseconds latency_sum{};
+	std::chrono::nanoseconds latency_max{};
+
+	explicit BusySubscriber( std::chrono::microseconds work_ )
+	: work( work_ )
+	{}
+
+private:
+	void notify( const Sample & sample ) override {
+		if( sample.warm_up ) {
+			return;
+		}
+
+		const auto now = std::chrono::steady_clock::now();
+		const std::chrono::nanoseconds latency = now - sample.published;
+
+		latency_sum += latency;
+		latency_max = std::max( latency_max, latency );
+
+		while( std::chrono::steady_clock::now() - now < work ) {
+			// busy
+		}
+
+		received++;
+	}
+};
+
+struct LatencyResult
+{
+	bool                     success = false;
+	std::chrono::nanoseconds notify_avg{};
+	std::chrono::nanoseconds notify_max{};
+	std::chrono::nanoseconds delivery_avg{};
+	std::chrono::nanoseconds delivery_max{};
+};
+
+/**
+ * calls notify() periodically like a DMA ISR and measures how long the "ISR"
+ * is blocked by it, and how long the values take to reach the subscribers
+ */
+LatencyResult measure_notify_latency( wlib::publisher::Publisher_Interface<Sample> & pub,
+									  std::function<void(const Sample&)> notify )
+{
+	constexpr std::size_t NUMBER_OF_SUBSCRIBERS = 4;
+	constexpr std::size_t NUMBER_OF_SAMPLES = 1000;
+	constexpr auto PERIOD = std::chrono::microseconds( 500 );
+	constexpr auto WORK_PER_SUBSCRIBER = std::chrono::microseconds( 20 );
+
+	std::vector<std::unique_ptr<BusySubscriber>> subscribers;
+
+	for( std::size_t i = 0; i < NUMBER_OF_SUBSCRIBERS; i++ ) {
+		subscribers.push_back( std::make_unique<BusySubscriber>( WORK_PER_SUBSCRIBER ) );
+		subscribers.back()->subscribe( pub );
+	}
+
+	// the deferred publisher delivers to a new subscriber only values published after its dispatcher noticed it
+	notify( Sample{ std::chrono::steady_clock::now(), true } );
+	std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+
+	LatencyResult result;
+	std::chrono::nanoseconds notify_sum{};
+	auto next = std::chrono::steady_clock::now();
+
+	for( std::size_t i = 0; i < NUMBER_OF_SAMPLES; i++ ) {
+		next += PERIOD;
+		std::this_thread::sleep_until( next );
+
+		const auto start = std::chrono::steady_clock::now();
+		notify( Sample{ start, false } );
+		const std::chrono::nanoseconds duration = std::chrono::steady_clock::now() - start;
+
+		notify_sum += duration;
+		result.notify_max = std::max( result.notify_max, duration );
+	}
+
+	// the deferred publisher needs some time to deliver the last values
+	const auto timeout = std::chrono::steady_clock::now() + std::chrono::seconds( 5 );
+	result.success = true;
+
+	for( std::unique_ptr<BusySubscriber> & subscriber : subscribers ) {
+		while( subscriber->received < NUMBER_OF_SAMPLES && std::chrono::steady_clock::now() < timeout ) {
+			std::this_thread::sleep_for( std::chrono::milliseconds( 1 ) );
+		}
+
+		subscriber->unsubscribe();
+
+		result.success = result.success && subscriber->received == NUMBER_OF_SAMPLES;
+		result.delivery_avg += subscriber->latency_sum / ( NUMBER_OF_SAMPLES * NUMBER_OF_SUBSCRIBERS );
+		result.delivery_max = std::max( result.delivery_max, subscriber->latency_max );
+	}
+
+	result.notify_avg = notify_sum / NUMBER_OF_SAMPLES;
+
+	return result;
+}
+
+void print( wlib::StringSink_Interface & sink, const char *name, const LatencyResult & result )
+{
+	if( !result.success ) {
+		sink( static_format<100>( "%s: failed\n", name ).c_str() );
+		return;
+	}
+
+	auto us = []( std::chrono::nanoseconds ns ) {
+		return static_cast<long long>( std::chrono::duration_cast<std::chrono::microseconds>( ns ).count() );
+	};
+
+	sink( static_format<200>( "%s: notify avg %dus max %dus, delivery avg %dus max %dus\n",
+			name, us( result.notify_avg ), us( result.notify_max ),
+			us( result.delivery_avg ), us( result.delivery_max ) ).c_str() );
+}
+
+} // namespace
+
+void BSP::sim::container_benchmark( wlib::StringSink_Interface & sink )
+{
+	using spsc_t         = bslib::container::SPSC<uint32_t, QUEUE_SIZE>;
+	using spsc_aligned_t = bslib::container::SPSC_aligned<uint32_t, QUEUE_SIZE>;
+
+	print( sink, "SPSC single", measure_spsc<spsc_t>() );
+	print( sink, "SPSC_aligned single", measure_spsc<spsc_aligned_t>() );
+	print( sink, "SPSC bulk", measure_spsc_bulk<spsc_t>() );
+	print( sink, "SPSC_aligned bulk", measure_spsc_bulk<spsc_aligned_t>() );
+	print( sink, "SPSC span", measure_spsc_span<spsc_t>() );
+	print( sink, "SPSC_aligned span", measure_spsc_span<spsc_aligned_t>() );
+	print( sink, "SPSC", measure_spsc_latency<bslib::container::SPSC<uint64_t, QUEUE_SIZE>>() );
+	print( sink, "SPSC_aligned", measure_spsc_latency<bslib::container::SPSC_aligned<uint64_t, QUEUE_SIZE>>() );
+
+	for( std::size_t producers : { 1, 2, 4, 8 } ) {
+		print( sink, static_format<50>( "MPSC %d producers single", producers ).c_str(), measure_mpsc( producers, false ) );
+		print( sink, static_format<50>( "MPSC %d producers span", producers ).c_str(), measure_mpsc( producers, true ) );
+	}
+
+	for( std::size_t threads : { 1, 2, 4, 8 } ) {
+		print( sink, static_format<50>( "MPMC %d producers %d consumers", threads, threads ).c_str(), measure_mpmc( threads ) );
+	}
+
+	for( std::size_t readers : { 1, 2, 4 } ) {
+		print( sink, static_format<50>( "Broadcast_Ring %d readers", readers ).c_str(), measure_broadcast( readers ) );
+	}
+
+	// the dispatcher task of the deferred publisher is stopped with the simulator
+	static bslib::publisher::LF_Publisher<Sample, 4> lf_publisher;
+	static bslib::publisher::Deferred_LF_Publisher<Sample, 4, 16> deferred_publisher{ "bench_pub" };
+
+	print( sink, "LF_Publisher 4 subscribers",
+			measure_notify_latency( lf_publisher, []( const Sample & sample ) { lf_publisher.notify( sample ); } ) );
+
+	print( sink, "Deferred_LF_Publisher 4 subscribers",
+			measure_notify_latency( deferred_publisher, []( const Sample & sample ) { deferred_publisher.notify( sample ); } ) );
+}
@@ -0,0 +1,271 @@
+/*
+ * Stress tests of the lock free bslib containers and publishers
+ * with real threads on the PC.
+ *
+ * Best run on a PC with several cores, and built with
+ * -fsanitize=thread, to find data races, too. ThreadSanitizer does not
+ * understand fences, so it reports the seqlock payload copy of
+ * Broadcast_Ring, which is a race by design.
+ */
+#include <sim_container_stress.hpp>
+#include <bslib-MPSC.hpp>
+#include <bslib-LF_publisher.hpp>
+#include <bslib-Deferred_publisher.hpp>
+#include <static_format.h>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace Tools;
+
+namespace {
+
+void print( wlib::StringSink_Interface & sink, const char *name, bool success )
+{
+	sink( static_format<100>( "%s: %s\n", name, success ? "ok" : "FAILED" ).c_str() );
+}
+
+/**
+ * some producers push blocks of 1..8 entries, the consumer pops them
+ * single and via peak_span()/drop(). Each entry is producer << 24 | sequence,
+ * bit 23 marks an entry that has to follow its predecessor of the same
+ * block directly. So lost, doubled, reordered and torn blocks are detected.
+ */
+bool stress_mpsc()
+{
+	constexpr std::size_t NUMBER_OF_PRODUCERS = 4;
+	constexpr uint32_t    ENTRIES_PER_PRODUCER = 200'000;
+	constexpr uint32_t    FOLLOWS_BIT = 1 << 23;
+	constexpr uint32_t    SEQUENCE_MASK = FOLLOWS_BIT - 1;
+
+	using queue_t = bslib::container::mpsc_queue_ex_mem<uint32_t>;
+
+	static queue_t::mem_payload_t    mem[257];
+	static queue_t::mem_slot_state_t slot_state[257];
+	queue_t queue( mem, slot_state );
+
+	std::vector<std::thread> producers;
+
+	for( uint32_t producer = 0; producer < NUMBER_OF_PRODUCERS; producer++ ) {
+		producers.emplace_back( [&queue, producer]() {
+			std::array<uint32_t,8> block;
+			uint32_t sequence = 0;
+
+			while( sequence < ENTRIES_PER_PRODUCER ) {
+				const uint32_t len = std::min<uint32_t>( 1 + ( sequence * 7 + producer ) % block.size(), ENTRIES_PER_PRODUCER - sequence );
+
+				for( uint32_t i = 0; i < len; i++ ) {
+					block[i] = producer << 24 | ( i > 0 ? FOLLOWS_BIT : 0 ) | ( sequence + i );
+				}
+
+				if( len == 1 ? queue.push_back( block[0] ) : queue.push_back( block.data(), len ) ) {
+					sequence += len;
+				} else {
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::array<uint32_t,NUMBER_OF_PRODUCERS> expected{};
+	std::optional<uint32_t> last;
+	bool success = true;
+	std::size_t received = 0;
+
+	auto check = [&]( uint32_t value ) {
+		const uint32_t producer = value >> 24;
+
+		if( producer >= NUMBER_OF_PRODUCERS || ( value & SEQUENCE_MASK ) != expected[producer] ) {
+			success = false;
+			return;
+		}
+
+		if( ( value & FOLLOWS_BIT ) && ( !last || *last >> 24 != producer ) ) {
+			success = false;
+		}
+
+		expected[producer]++;
+		last = value;
+		received++;
+	};
+
+	while( success && received < NUMBER_OF_PRODUCERS * ENTRIES_PER_PRODUCER ) {
+		if( received % 2 == 0 ) {
+			std::span<uint32_t> span = queue.peak_span();
+
+			for( uint32_t value : span ) {
+				check( value );
+			}
+
+			queue.drop( span.size() );
+
+			if( span.empty() ) {
+				std::this_thread::yield();
+			}
+		} else if( auto value = queue.pop_front(); value ) {
+			check( *value );
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	// on failure the producers have to be drained, to be able to join them
+	while( received < NUMBER_OF_PRODUCERS * ENTRIES_PER_PRODUCER ) {
+		if( queue.pop_front() ) {
+			received++;
+		} else {
+			std::this_thread::yield();
+		}
+	}
+
+	for( std::thread & producer : producers ) {
+		producer.join();
+	}
+
+	return success && queue.get_number_of_used_entries() == 0;
+}
+
+/**
+ * subscriber that knows the generation of its subscription: odd while
+ * subscribed, incremented before subscribe() and after unsubscribe()
+ * returned. A notify() that starts unsubscribed or is still running when
+ * the subscription ends is late. It is never deleted, so a late notify()
+ * can be detected safely.
+ */
+class CheckedSubscriber : public wlib::publisher::Publisher_Interface<uint32_t>::Subscription_Interface
+{
+public:
+	std::atomic<std::size_t> generation = 0;
+	std::atomic<std::size_t> notifications = 0;
+	std::atomic<std::size_t> late_notifications = 0;
+
+private:
+	void notify( const uint32_t & ) override {
+		const std::size_t subscription = generation;
+
+		if( subscription % 2 == 0 || generation != subscription ) {
+			late_notifications++;
+		}
+
+		notifications++;
+	}
+};
+
+/**
+ * notifier threads call notify() all the time, while other threads
+ * subscribe and unsubscribe. After unsubscribe() returned, the epoch
+ * reclamation guarantees that no notify() is still running in the subscriber.
+ *
+ * The subscriber stays unsubscribed, until every notifier finished two more
+ * calls, so a late notify() of the old subscription can not be taken for
+ * one of the next subscription.
+ */
+bool stress_epoch( wlib::publisher::Publisher_Interface<uint32_t> & pub,
+				   std::function<void(uint32_t)> notify,
+				   std::size_t number_of_notifiers,
+				   std::size_t & notifications )
+{
+	constexpr std::size_t NUMBER_OF_SUBSCRIBER_THREADS = 3;
+	constexpr std::size_t ROUNDS = 500;
+
+	std::atomic<bool> stop = false;
+	std::vector<std::thread> notifiers;
+	// finished notify() calls per notifier
+	const std::unique_ptr<std::atomic<std::size_t>[]> calls( new std::atomic<std::size_t>[number_of_notifiers]{} );
+
+	for( std::size_t i = 0; i < number_of_notifiers; i++ ) {
+		notifiers.emplace_back( [&, i]() {
+			for( uint32_t value = 0; !stop; value++ ) {
+				notify( value );
+				calls[i]++;
+			}
+		});
+	}
+
+	auto wait_for_notifiers = [&]() {
+		for( std::size_t i = 0; i < number_of_notifiers; i++ ) {
+			const std::size_t start = calls[i];
+
+			while( calls[i] < start + 2 ) {
+				std::this_thread::yield();
+			}
+		}
+	};
+
+	std::array<CheckedSubscriber,NUMBER_OF_SUBSCRIBER_THREADS> subscribers;
+	std::vector<std::thread> threads;
+
+	for( CheckedSubscriber & subscriber : subscribers ) {
+		threads.emplace_back( [&subscriber, &pub, &wait_for_notifiers]() {
+			for( std::size_t round = 0; round < ROUNDS; round++ ) {
+				subscriber.generation++;
+				subscriber.subscribe( pub );
+
+				for( std::size_t i = 0; i < round % 4; i++ ) {
+					std::this_thread::yield();
+				}
+
+				subscriber.unsubscribe();
+				subscriber.generation++;
+
+				wait_for_notifiers();
+			}
+		});
+	}
+
+	for( std::thread & thread : threads ) {
+		thread.join();
+	}
+
+	stop = true;
+
+	for( std::thread & thread : notifiers ) {
+		thread.join();
+	}
+
+	std::size_t late = 0;
+	notifications = 0;
+
+	for( CheckedSubscriber & subscriber : subscribers ) {
+		late += subscriber.late_notifications;
+		notifications += subscriber.notifications;
+	}
+
+	return late == 0;
+}
+
+} // namespace
+
+bool BSP::sim::container_stress( wlib::StringSink_Interface & sink )
+{
+	bool success = true;
+
+	auto run = [&]( const char *name, bool result ) {
+		print( sink, name, result );
+		success = success && result;
+	};
+
+	run( "mpsc_queue_ex_mem 4 producers", stress_mpsc() );
+
+	// the dispatcher task of the deferred publisher is stopped with the simulator
+	static bslib::publisher::LF_Publisher<uint32_t, 4> lf_publisher;
+	static bslib::publisher::Deferred_LF_Publisher<uint32_t, 4, 16> deferred_publisher{ "stress_pub" };
+	std::size_t notifications = 0;
+
+	// without notifications during the subscriptions the test would prove nothing
+	bool result = stress_epoch( lf_publisher, []( uint32_t value ) { lf_publisher.notify( value ); }, 2, notifications );
+	run( static_format<100>( "LF_Publisher subscribe/unsubscribe/notify, %d notifications", notifications ).c_str(),
+		 result && notifications > 0 );
+
+	// notify() of the deferred publisher allows one producer only
+	result = stress_epoch( deferred_publisher, []( uint32_t value ) { deferred_publisher.notify( value ); }, 1, notifications );
+	run( static_format<100>( "Deferred_LF_Publisher subscribe/unsubscribe/notify, %d notifications", notifications ).c_str(),
+		 result && notifications > 0 );
+
+	return success;
+}
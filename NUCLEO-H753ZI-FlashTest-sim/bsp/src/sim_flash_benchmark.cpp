@@ -0,0 +1,631 @@
+/*
+ * Throughput benchmark of the JBODGenericFlashDriver on two
+ * simulated flash banks, concatenated and striped, of the
+ * asynchronous flash job queue and of the PageCacheRawDriver.
+ */
+#include <sim_flash_benchmark.hpp>
+#include <sim_nor_flash.hpp>
+#include <sim_async_flash.hpp>
+#include <GenericFlashDriver.h>
+#include <JBODGenericFlashDriver.h>
+#include <PageCacheRawDriver.h>
+#include <os.hpp>
+#include <static_format.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <ctime>
+#include <mutex>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+using namespace Tools;
+using namespace stm32_internal_flash;
+
+namespace {
+
+constexpr std::size_t NUMBER_OF_BANKS = 2;
+constexpr std::size_t SECTOR_SIZE = 128 * 1024;
+constexpr std::size_t SECTORS_PER_BANK = 4;
+
+/**
+ * one task per flash bank, waiting for jobs of the JBODGenericFlashDriver
+ */
+class BankWorkers : public JBODGenericFlashDriver::ParallelExecutor
+{
+	class Worker : public os::Static_Task<16 * 1024>
+	{
+		BankWorkers & parent;
+		const std::size_t idx;
+
+	public:
+		os::binary_semaphore start_job{ 0 };
+
+		Worker( BankWorkers & parent_, std::size_t idx_ )
+		: os::Static_Task<16 * 1024>( "flash bank" ),
+		  parent( parent_ ),
+		  idx( idx_ )
+		{}
+
+	private:
+		void process() override {
+			while( true ) {
+				start_job.acquire();
+
+				if( parent.stop ) {
+					return;
+				}
+
+				(*parent.job)( idx );
+				parent.job_done.release();
+			}
+		}
+	};
+
+	std::atomic<bool> stop = false;
+	const std::function<void(std::size_t idx)> *job = nullptr;
+	os::counting_semaphore<NUMBER_OF_BANKS> job_done{ 0 };
+	Worker worker1{ *this, 0 };
+	Worker worker2{ *this, 1 };
+	std::array<Worker*,NUMBER_OF_BANKS> workers{ &worker1, &worker2 };
+
+public:
+	BankWorkers() {
+		for( Worker *worker : workers ) {
+			worker->start();
+		}
+	}
+
+	~BankWorkers() {
+		stop = true;
+
+		for( Worker *worker : workers ) {
+			worker->start_job.release();
+		}
+	}
+
+	void run( std::size_t count, const std::function<void(std::size_t idx)> & job_ ) override {
+		job = &job_;
+
+		for( std::size_t i = 0; i < count; i++ ) {
+			workers[i]->start_job.release();
+		}
+
+		for( std::size_t i = 0; i < count; i++ ) {
+			job_done.acquire();
+		}
+	}
+};
+
+BSP::sim::NorFlash::Configuration create_bank_configuration()
+{
+	BSP::sim::NorFlash::Configuration conf;
+	conf.size        = SECTORS_PER_BANK * SECTOR_SIZE;
+	conf.sector_size = SECTOR_SIZE;
+	conf.timing      = BSP::sim::NorFlash::Timing::Sleep;
+	// H7 timings scaled down by 10, so the benchmark finishes in seconds
+	conf.sector_erase_time = std::chrono::milliseconds( 100 );
+	conf.word_program_time = std::chrono::microseconds( 2 );
+
+	return conf;
+}
+
+/**
+ * returns the time for writing the whole JBOD, 0 on error
+ */
+std::chrono::milliseconds measure_write( std::size_t stripe_size, JBODGenericFlashDriver::ParallelExecutor *executor )
+{
+	BSP::sim::NorFlash bank1( create_bank_configuration() );
+	BSP::sim::NorFlash bank2( create_bank_configuration() );
+
+	GenericFlashDriver driver1( bank1 );
+	GenericFlashDriver driver2( bank2 );
+
+	// like overwriting old data, every page has to be erased
+	driver1.properties.DeltaProgramming = false;
+	driver2.properties.DeltaProgramming = false;
+
+	std::array<MemoryInterface*,NUMBER_OF_BANKS> drivers{ &driver1, &driver2 };
+	JBODGenericFlashDriver jbod( drivers, stripe_size, executor );
+
+	std::vector<std::byte> data( jbod.get_size() );
+
+	for( std::size_t i = 0; i < data.size(); i++ ) {
+		data[i] = static_cast<std::byte>( i * 7 + i / 256 );
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	const std::size_t len = jbod.write( 0, data );
+	auto duration = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+
+	std::vector<std::byte> data_read( data.size() );
+	std::span<std::byte> span_read( data_read );
+
+	if( len != data.size() || jbod.read( 0, span_read ) != data.size() || data != data_read ) {
+		return std::chrono::milliseconds( 0 );
+	}
+
+	return duration;
+}
+
+struct AsyncResult
+{
+	bool                      success = false;
+	// time the task was blocked in erase/write or in submitting the jobs
+	std::chrono::milliseconds blocked{};
+	std::chrono::milliseconds total{};
+	// cpu time of the whole process, while the flash was busy
+	std::chrono::milliseconds cpu{};
+};
+
+std::chrono::milliseconds get_cpu_time()
+{
+	return std::chrono::milliseconds( std::clock() * 1000 / CLOCKS_PER_SEC );
+}
+
+/**
+ * erases and programs one bank, the task is blocked the whole time
+ */
+AsyncResult measure_blocking( const std::vector<std::byte> & data )
+{
+	BSP::sim::NorFlash bank( create_bank_configuration() );
+	AsyncResult result;
+
+	auto start = std::chrono::steady_clock::now();
+	const std::chrono::milliseconds cpu_start = get_cpu_time();
+
+	result.success = bank.erase_page( 0, bank.get_size() ) && bank.write_page( 0, data ) == data.size();
+
+	result.total   = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+	result.blocked = result.total;
+	result.cpu     = get_cpu_time() - cpu_start;
+
+	return result;
+}
+
+/**
+ * erases and programs one bank via the job queue, the task only submits the
+ * jobs and waits for the completion of the last one on a semaphore.
+ */
+AsyncResult measure_async( const std::vector<std::byte> & data )
+{
+	BSP::sim::NorFlash::Configuration conf = create_bank_configuration();
+	conf.timing = BSP::sim::NorFlash::Timing::None;
+
+	BSP::sim::NorFlash bank( conf );
+	BSP::sim::AsyncFlashBackend backend( bank, create_bank_configuration().sector_erase_time, create_bank_configuration().word_program_time );
+	bslib::flash::Job_Queue<4> queue( backend );
+
+	os::binary_semaphore done{ 0 };
+	bslib::flash::Semaphore_Completion<os::binary_semaphore> completion( done );
+
+	AsyncResult result;
+
+	auto start = std::chrono::steady_clock::now();
+	const std::chrono::milliseconds cpu_start = get_cpu_time();
+
+	// jobs are processed in order, so only the last one needs a completion
+	bool submitted = queue.submit_erase( 0, bank.get_size() ) &&
+					 queue.submit_program( 0, std::span<const std::byte>( data ), &completion );
+
+	result.blocked = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+
+	if( submitted ) {
+		// here the task could do anything else
+		done.acquire();
+	}
+
+	result.total = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start );
+	result.cpu   = get_cpu_time() - cpu_start;
+
+	std::vector<std::byte> data_read( data.size() );
+	std::span<std::byte> span_read( data_read );
+
+	result.success = submitted &&
+					 completion.get_result() && completion.get_result()->success &&
+					 queue.get_statistics().jobs_failed == 0 &&
+					 bank.read_page( 0, span_read ) == data.size() && data == data_read;
+
+	return result;
+}
+
+/**
+ * refuses to start an operation like the H753 backend, while another
+ * user owns the flash controller or left its write buffer half filled
+ */
+class ControllerOwnedBackend : public BSP::sim::AsyncFlashBackend
+{
+public:
+	using BSP::sim::AsyncFlashBackend::AsyncFlashBackend;
+
+	std::atomic<bool> owned_by_other = false;
+
+	bool start_erase( std::size_t address ) noexcept override {
+		return !owned_by_other && AsyncFlashBackend::start_erase( address );
+	}
+
+	bool start_program( std::size_t address, std::span<const std::byte> word ) noexcept override {
+		return !owned_by_other && AsyncFlashBackend::start_program( address, word );
+	}
+};
+
+/**
+ * collects the results of all jobs, in the order of their completion
+ */
+class ResultRecorder : public bslib::flash::completion_t
+{
+	std::mutex mutex;
+	std::vector<bslib::flash::job_result_t> results;
+	os::counting_semaphore<> done{ 0 };
+
+public:
+	void operator()( const bslib::flash::job_result_t & result ) override {
+		{
+			std::lock_guard<std::mutex> lock( mutex );
+			results.push_back( result );
+		}
+
+		done.release();
+	}
+
+	// waits for the completion of count jobs and returns the results of all so far
+	std::vector<bslib::flash::job_result_t> wait( std::size_t count ) {
+		for( std::size_t i = 0; i < count; i++ ) {
+			if( !done.try_acquire_for( std::chrono::seconds( 5 ) ) ) {
+				break;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock( mutex );
+		return results;
+	}
+};
+
+bool is_result( const bslib::flash::job_result_t & result, std::size_t address, std::size_t done, bool success )
+{
+	return result.address == address && result.done == done && result.success == success;
+}
+
+/**
+ * a step the backend refuses fails the job at once, the queue goes on with the next job
+ */
+bool check_refused_step()
+{
+	BSP::sim::NorFlash::Configuration conf = create_bank_configuration();
+	conf.timing = BSP::sim::NorFlash::Timing::None;
+
+	BSP::sim::NorFlash bank( conf );
+	ControllerOwnedBackend backend( bank, std::chrono::milliseconds( 1 ), std::chrono::microseconds( 2 ) );
+	bslib::flash::Job_Queue<4> queue( backend );
+	ResultRecorder recorder;
+
+	const std::vector<std::byte> word( conf.flash_word_size, std::byte{ 0x5A } );
+
+	backend.owned_by_other = true;
+
+	// completed from submit, the queue is idle again
+	if( !queue.submit_erase( 0, SECTOR_SIZE, &recorder ) || !queue.is_idle() ) {
+		return false;
+	}
+
+	backend.owned_by_other = false;
+
+	if( !queue.submit_program( 0, std::span<const std::byte>( word ), &recorder ) ) {
+		return false;
+	}
+
+	const auto results = recorder.wait( 2 );
+
+	return results.size() == 2 &&
+		   is_result( results[0], 0, 0, false ) && results[0].type == bslib::flash::job_type_t::erase &&
+		   is_result( results[1], 0, word.size(), true ) &&
+		   queue.get_statistics().jobs_failed == 1 && queue.get_statistics().jobs_done == 1 &&
+		   backend.get_statistics().operations == 1;
+}
+
+/**
+ * a failing program (a word programmed twice) fails its job with the bytes
+ * programmed before, the following jobs are processed
+ */
+bool check_failed_operation()
+{
+	BSP::sim::NorFlash::Configuration conf = create_bank_configuration();
+	conf.timing = BSP::sim::NorFlash::Timing::None;
+
+	BSP::sim::NorFlash bank( conf );
+	BSP::sim::AsyncFlashBackend backend( bank, std::chrono::milliseconds( 1 ), std::chrono::microseconds( 2 ) );
+	bslib::flash::Job_Queue<4> queue( backend );
+	ResultRecorder recorder;
+
+	const std::size_t word_size = conf.flash_word_size;
+	const std::vector<std::byte> data( 3 * word_size, std::byte{ 0x5A } );
+	const std::span<const std::byte> one_word( data.data(), word_size );
+
+	const bool submitted = queue.submit_program( 2 * word_size, one_word, &recorder ) &&
+						   // its third word is already programmed
+						   queue.submit_program( 0, std::span<const std::byte>( data ), &recorder ) &&
+						   queue.submit_program( 4 * word_size, one_word, &recorder );
+
+	const auto results = recorder.wait( 3 );
+
+	return submitted && results.size() == 3 &&
+		   is_result( results[0], 2 * word_size, word_size, true ) &&
+		   is_result( results[1], 0, 2 * word_size, false ) &&
+		   is_result( results[2], 4 * word_size, word_size, true ) &&
+		   queue.get_statistics().jobs_failed == 1 && backend.get_statistics().failed == 1;
+}
+
+/**
+ * submit fails if the queue is full, the jobs in the queue are processed
+ */
+bool check_queue_full()
+{
+	BSP::sim::NorFlash::Configuration conf = create_bank_configuration();
+	conf.timing = BSP::sim::NorFlash::Timing::None;
+
+	BSP::sim::NorFlash bank( conf );
+	BSP::sim::AsyncFlashBackend backend( bank, std::chrono::milliseconds( 50 ), std::chrono::microseconds( 2 ) );
+	constexpr std::size_t QUEUE_SIZE = 4;
+	bslib::flash::Job_Queue<QUEUE_SIZE> queue( backend );
+	ResultRecorder recorder;
+
+	const std::vector<std::byte> word( conf.flash_word_size, std::byte{ 0x5A } );
+
+	// the engine takes the erase from the queue, then the queue can take QUEUE_SIZE jobs more
+	bool submitted = queue.submit_erase( SECTOR_SIZE, SECTOR_SIZE, &recorder );
+
+	for( std::size_t i = 0; i < QUEUE_SIZE; i++ ) {
+		submitted = submitted && queue.submit_program( i * word.size(), std::span<const std::byte>( word ), &recorder );
+	}
+
+	const bool rejected = !queue.submit_program( QUEUE_SIZE * word.size(), std::span<const std::byte>( word ), &recorder );
+
+	const auto results = recorder.wait( QUEUE_SIZE + 2 );
+
+	bool success = submitted && rejected && results.size() == QUEUE_SIZE + 1 &&
+				   is_result( results[0], SECTOR_SIZE, SECTOR_SIZE, true );
+
+	for( std::size_t i = 1; success && i < results.size(); i++ ) {
+		success = is_result( results[i], ( i - 1 ) * word.size(), word.size(), true );
+	}
+
+	// room again
+	return success && queue.is_idle() && queue.submit_program( QUEUE_SIZE * word.size(), std::span<const std::byte>( word ), &recorder ) &&
+		   recorder.wait( 1 ).size() == QUEUE_SIZE + 2;
+}
+
+/**
+ * a flash bank, whose programming can be made to fail
+ */
+class FailingFlash : public BSP::sim::NorFlash
+{
+public:
+	using BSP::sim::NorFlash::NorFlash;
+
+	bool fail = false;
+
+	std::size_t write_page( std::size_t address, const std::span<const std::byte> & buffer ) override {
+		return fail ? 0 : NorFlash::write_page( address, buffer );
+	}
+};
+
+/**
+ * a page, that could not be written back by flush(), stays in its
+ * frame and is written by the next flush()
+ */
+bool check_page_cache_failed_flush()
+{
+	BSP::sim::NorFlash::Configuration conf = create_bank_configuration();
+	conf.timing = BSP::sim::NorFlash::Timing::None;
+
+	FailingFlash bank( conf );
+	std::vector<std::byte> frame_memory( 2 * SECTOR_SIZE );
+	PageCacheRawDriver cache( bank, frame_memory );
+
+	const std::vector<std::byte> data( SECTOR_SIZE, std::byte{ 0x5A } );
+
+	if( cache.write_page( 0, data ) != data.size() || cache.write_page( SECTOR_SIZE, data ) != data.size() ) {
+		return false;
+	}
+
+	bank.fail = true;
+	const bool failed = !cache.flush();
+	bank.fail = false;
+
+	std::vector<std::byte> data_read( 2 * SECTOR_SIZE );
+	std::span<std::byte> span_read( data_read );
+
+	return failed && cache.flush() && bank.read_page( 0, span_read ) == data_read.size() &&
+		   std::all_of( data_read.begin(), data_read.end(), []( std::byte b ) { return b == std::byte{ 0x5A }; } );
+}
+
+struct CacheResult
+{
+	bool        success = false;
+	std::size_t erases = 0;
+	std::size_t programmed_words = 0;
+	GenericFlashDriver::Statistics driver_statistics{};
+	BSP::sim::NorFlash::Report report{};
+};
+
+enum class LogDriver
+{
+	direct,            // GenericFlashDriver, every write erases the page
+	page_cache,        // through a PageCacheRawDriver
+	delta_programming  // GenericFlashDriver with DeltaProgramming
+};
+
+enum class LogPass
+{
+	append,          // to erased flash
+	rewrite_same,    // a second time, with the same content
+	rewrite_changed  // a second time, with a different content
+};
+
+/**
+ * writes records of 96..288 bytes through GenericFlashDriver, like a log,
+ * directly to the flash, through a PageCacheRawDriver with one frame or
+ * with DeltaProgramming. Only the erases and programs of the measured pass
+ * are counted.
+ */
+CacheResult measure_page_cache( LogDriver log_driver, LogPass pass )
+{
+	const bool cached = log_driver == LogDriver::page_cache;
+
+	BSP::sim::NorFlash::Configuration conf = create_bank_configuration();
+	conf.timing = BSP::sim::NorFlash::Timing::None;
+
+	BSP::sim::NorFlash bank( conf );
+
+	std::vector<std::byte> frame_memory( cached ? SECTOR_SIZE : 0 );
+	PageCacheRawDriver cache( bank, frame_memory );
+
+	GenericFlashDriver driver( cached ? static_cast<RawDriverInterface&>( cache ) : bank );
+
+	// without it every write erases the page, the cache has to avoid it
+	driver.properties.DeltaProgramming = log_driver == LogDriver::delta_programming;
+
+	std::vector<std::byte> data( 3 * SECTOR_SIZE );
+
+	for( std::size_t i = 0; i < data.size(); i++ ) {
+		data[i] = static_cast<std::byte>( i * 7 + i / 256 );
+	}
+
+	auto write_records = [&]() {
+		std::size_t address = 0;
+
+		for( std::size_t i = 0; address < data.size(); i++ ) {
+			const std::size_t len = std::min( 96 + ( i * 37 ) % 193, data.size() - address );
+
+			if( driver.write( address, std::span<const std::byte>( data ).subspan( address, len ) ) != len ) {
+				return false;
+			}
+
+			address += len;
+		}
+
+		return cache.flush();
+	};
+
+	CacheResult result;
+
+	if( !write_records() ) {
+		return result;
+	}
+
+	if( pass != LogPass::append ) {
+		bank.reset_report();
+		driver.reset_statistics();
+
+		if( pass == LogPass::rewrite_changed ) {
+			for( std::byte & b : data ) {
+				b = ~b;
+			}
+		}
+
+		if( !write_records() ) {
+			return result;
+		}
+	}
+
+	const BSP::sim::NorFlash::Report report = bank.get_report();
+
+	std::vector<std::byte> data_read( data.size() );
+	std::span<std::byte> span_read( data_read );
+
+	result.success = report.program_violations == 0 && bank.read_page( 0, span_read ) == data.size() && data == data_read;
+	result.erases = report.erases;
+	result.programmed_words = report.programmed_words;
+	result.driver_statistics = driver.get_statistics();
+	result.report = report;
+
+	return result;
+}
+
+} // namespace
+
+void BSP::sim::flash_benchmark( wlib::StringSink_Interface & sink )
+{
+	const std::size_t size_kb = NUMBER_OF_BANKS * SECTORS_PER_BANK * SECTOR_SIZE / 1024;
+
+	auto print = [&]( const char *name, std::chrono::milliseconds duration ) {
+		if( duration.count() == 0 ) {
+			sink( static_format<100>( "%s: failed\n", name ).c_str() );
+			return;
+		}
+
+		sink( static_format<100>( "%s: %dKB in %dms %dKB/s\n",
+				name, size_kb, duration.count(), size_kb * 1000 / duration.count() ).c_str() );
+	};
+
+	print( "concatenated", measure_write( 0, nullptr ) );
+
+	BankWorkers workers;
+	print( "striped", measure_write( SECTOR_SIZE, &workers ) );
+
+	std::vector<std::byte> data( SECTORS_PER_BANK * SECTOR_SIZE );
+
+	for( std::size_t i = 0; i < data.size(); i++ ) {
+		data[i] = static_cast<std::byte>( i * 7 + i / 256 );
+	}
+
+	const std::size_t bank_size_kb = data.size() / 1024;
+
+	auto print_async = [&]( const char *name, const AsyncResult & result ) {
+		if( !result.success || result.total.count() == 0 ) {
+			sink( static_format<100>( "%s: failed\n", name ).c_str() );
+			return;
+		}
+
+		sink( static_format<150>( "%s: %dKB in %dms %dKB/s, task blocked %dms, cpu %dms (%d%%)\n",
+				name, bank_size_kb, result.total.count(), bank_size_kb * 1000 / result.total.count(),
+				result.blocked.count(), result.cpu.count(), result.cpu.count() * 100 / result.total.count() ).c_str() );
+	};
+
+	print_async( "erase+program blocking", measure_blocking( data ) );
+	print_async( "erase+program job queue", measure_async( data ) );
+
+	auto print_check = [&]( const char *name, bool success ) {
+		sink( static_format<100>( "%s: %s\n", name, success ? "ok" : "failed" ).c_str() );
+	};
+
+	print_check( "job queue refused step", check_refused_step() );
+	print_check( "job queue failed operation", check_failed_operation() );
+	print_check( "job queue full", check_queue_full() );
+	print_check( "page cache failed flush", check_page_cache_failed_flush() );
+
+	auto print_cache = [&]( const char *name, const CacheResult & result ) {
+		if( !result.success ) {
+			sink( static_format<100>( "%s: failed\n", name ).c_str() );
+			return;
+		}
+
+		sink( static_format<100>( "%s: %d erases, %d programmed flash words\n",
+				name, result.erases, result.programmed_words ).c_str() );
+	};
+
+	const std::array<std::pair<const char*,LogPass>,3> passes = {{
+		{ "log append", LogPass::append },
+		{ "log rewrite same", LogPass::rewrite_same },
+		{ "log rewrite changed", LogPass::rewrite_changed },
+	}};
+
+	for( const auto & [name, pass] : passes ) {
+		print_cache( static_format<100>( "%s direct", name ).c_str(), measure_page_cache( LogDriver::direct, pass ) );
+		print_cache( static_format<100>( "%s page cache", name ).c_str(), measure_page_cache( LogDriver::page_cache, pass ) );
+
+		const CacheResult delta = measure_page_cache( LogDriver::delta_programming, pass );
+		print_cache( static_format<100>( "%s delta programming", name ).c_str(), delta );
+
+		if( delta.success ) {
+			sink( static_format<150>( "  GenericFlashDriver: %d erases avoided, %d flash words skipped, %d flash words programmed\n",
+					delta.driver_statistics.erases_avoided, delta.driver_statistics.words_skipped,
+					delta.driver_statistics.words_programmed ).c_str() );
+
+			std::ostringstream report;
+			report << "  NorFlash: " << delta.report;
+			sink( report.str().c_str() );
+		}
+	}
+}
@@ -1,15 +1,88 @@
 #include <bsp_internal_fs.hpp>
 #include <H7TwoFace.h>
-#include <SimSTM32InternalFlashPc.h>
 #include <H7TwoFaceConfig.h>
+#include <sim_nor_flash.hpp>
+#include <iostream>
 
-void BSP::init_internal_fs()
+namespace {
+
+/**
+ * same as the FsFlashMemInterfaceProxy of the board,
+ * but with the NOR flash model instead of the HAL driver
+ */
+class FsNorFlashProxy : public SimpleFlashFs::FlashMemoryInterface
+{
+	BSP::sim::NorFlash & driver;
+
+public:
+	FsNorFlashProxy( BSP::sim::NorFlash & driver_ )
+	: driver( driver_ )
+	{}
+
+	FsNorFlashProxy() = delete;
+
+	std::size_t size() const override {
+		return driver.get_configuration().size;
+	}
+
+	std::size_t write( std::size_t address, const std::byte *data, std::size_t size ) override {
+		return driver.write_page( address, std::span( data, size ) );
+	}
+
+	std::size_t read( std::size_t address, std::byte *data, std::size_t size ) override {
+		std::span<std::byte> buffer( data, size );
+		return driver.read_page( address, buffer );
+	}
+
+	void erase( std::size_t address, std::size_t size ) override {
+		driver.erase_page( address, size );
+	}
+
+	bool can_map_read() const override {
+		return true;
+	}
+
+	const std::byte* map_read( std::size_t address, std::size_t size ) override {
+		return driver.map_read( address, size );
+	}
+};
+
+BSP::sim::NorFlash::Configuration create_configuration( const char *file_name )
 {
-	static SimpleFlashFs::SimPc::SimSTM32InternalFlashPc mem_mapped1(".flash_page1.bin",SFF_MAX_SIZE);
-	static SimpleFlashFs::SimPc::SimSTM32InternalFlashPc mem_mapped2(".flash_page2.bin",SFF_MAX_SIZE);
+	BSP::sim::NorFlash::Configuration conf;
+	// one 128k sector per face, like on the board
+	conf.size        = SFF_MAX_SIZE;
+	conf.sector_size = SFF_MAX_SIZE;
+	conf.file_name   = file_name;
 
-	H7TwoFace::set_memory_interface( &mem_mapped1, &mem_mapped2 );
+	return conf;
 }
 
+/**
+ * prints the wear and the time spent on flash operations when the simulator exits
+ */
+struct ReportOnExit
+{
+	const BSP::sim::NorFlash & flash1;
+	const BSP::sim::NorFlash & flash2;
+
+	~ReportOnExit() {
+		std::cout << "flash face 1: " << flash1.get_report()
+				  << "flash face 2: " << flash2.get_report();
+	}
+};
+
+} // namespace
 
+void BSP::init_internal_fs()
+{
+	static BSP::sim::NorFlash flash1( create_configuration( ".flash_page1.bin" ) );
+	static BSP::sim::NorFlash flash2( create_configuration( ".flash_page2.bin" ) );
+
+	static FsNorFlashProxy mem_fs1( flash1 );
+	static FsNorFlashProxy mem_fs2( flash2 );
 
+	static ReportOnExit report_on_exit{ flash1, flash2 };
+
+	H7TwoFace::set_memory_interface( &mem_fs1, &mem_fs2 );
+}
@@ -0,0 +1,1513 @@
+/*
+ * Accuracy checks of the optimized ex-math kernels, the CRC engines
+ * and SHA-256 against straightforward reference implementations or
+ * known answers on the PC, and their time and stack compared to
+ * these implementations.
+ */
+#include <sim_math_check.hpp>
+#include <exmath-blas.hpp>
+#include <exmath-blas_decomposition.hpp>
+#include <exmath-blas_expression.hpp>
+#include <exmath-polynominal.hpp>
+#include <exmath-statistics.hpp>
+#include <exmath-statistics_streaming.hpp>
+#include <sensors-TDK_NTC.hpp>
+#include <static_format.h>
+#include <wlib-CRC_32.hpp>
+#include <wlib-HASH.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace Tools;
+
+namespace {
+
+std::mt19937 random_generator( 4711 );
+
+/**
+ * a checked error, above the bound is a failure
+ */
+struct Result
+{
+	const char *name;
+	double error;
+	double bound;
+	const char *unit = "";
+};
+
+/**
+ * prints one line per result, returns false if one of them failed
+ */
+bool print_results( wlib::StringSink_Interface & sink, std::span<const Result> results )
+{
+	bool success = true;
+
+	for( const Result & result : results ) {
+		const bool ok = result.error <= result.bound;
+		sink( static_format<150>( "%s: %s, %g%s%s (bound %g)\n", result.name, ok ? "ok" : "FAILED",
+				result.error, *result.unit ? " " : "", result.unit, result.bound ).c_str() );
+		success = success && ok;
+	}
+
+	return success;
+}
+
+template <typename T, exmath::index_t N, exmath::index_t M>
+std::unique_ptr<exmath::matrix_t<T,N,M>> create_random_matrix()
+{
+	// the matrices are too large for the stack of a task
+	auto ret = std::make_unique<exmath::matrix_t<T,N,M>>();
+	std::uniform_real_distribution<T> dist( -1, 1 );
+
+	for( exmath::index_t e = 0; e < N * M; e++ ) {
+		ret->data()[e] = dist( random_generator );
+	}
+
+	return ret;
+}
+
+/**
+ * The product of the matrix_t operator (unrolled or blocked kernel) against a naive
+ * product in long double. Each element may differ by the rounding error of a sum of
+ * M products: M * epsilon * sum( |a(i,k) * b(k,j)| ), with a factor 2 of headroom.
+ * Returns the largest error relative to this bound, above 1 is a failure.
+ */
+template <typename T, exmath::index_t N, exmath::index_t M, exmath::index_t K>
+double check_gemm()
+{
+	auto a = create_random_matrix<T,N,M>();
+	auto b = create_random_matrix<T,M,K>();
+	auto c = std::make_unique<exmath::matrix_t<T,N,K>>( (*a) * (*b) );
+
+	double ret = 0;
+
+	for( exmath::index_t i = 0; i < N; i++ ) {
+		for( exmath::index_t j = 0; j < K; j++ ) {
+			long double ref = 0;
+			long double abs_sum = 0;
+
+			for( exmath::index_t k = 0; k < M; k++ ) {
+				ref += static_cast<long double>( (*a)( i, k ) ) * (*b)( k, j );
+				abs_sum += std::fabs( static_cast<long double>( (*a)( i, k ) ) * (*b)( k, j ) );
+			}
+
+			const long double bound = 2 * M * std::numeric_limits<T>::epsilon() * abs_sum;
+			const long double error = std::fabs( (*c)( i, j ) - ref );
+
+			if( error > 0 ) {
+				ret = std::max( ret, static_cast<double>( bound > 0 ? error / bound : 2 ) );
+			}
+		}
+	}
+
+	return ret;
+}
+
+bool check_gemm( wlib::StringSink_Interface & sink )
+{
+	const Result results[] = {
+		// unrolled kernel, with and without a remainder of the vector width
+		{ "gemm float 2x2x2",     check_gemm<float,2,2,2>(), 1, "of the bound" },
+		{ "gemm float 3x5x7",     check_gemm<float,3,5,7>(), 1, "of the bound" },
+		{ "gemm float 8x8x8",     check_gemm<float,8,8,8>(), 1, "of the bound" },
+		{ "gemm double 4x3x6",    check_gemm<double,4,3,6>(), 1, "of the bound" },
+		// blocked kernel, with remainders of the tiles and the blocks
+		{ "gemm float 9x9x9",     check_gemm<float,9,9,9>(), 1, "of the bound" },
+		{ "gemm float 17x33x9",   check_gemm<float,17,33,9>(), 1, "of the bound" },
+		{ "gemm float 67x70x65",  check_gemm<float,67,70,65>(), 1, "of the bound" },
+		{ "gemm double 67x70x65", check_gemm<double,67,70,65>(), 1, "of the bound" },
+	};
+
+	return print_results( sink, results );
+}
+
+template <typename T, exmath::index_t N, exmath::index_t M>
+double norm_inf( const exmath::matrix_t<T,N,M> & val )
+{
+	double ret = 0;
+
+	for( exmath::index_t i = 0; i < N; i++ ) {
+		double sum = 0;
+
+		for( exmath::index_t j = 0; j < M; j++ ) {
+			sum += std::fabs( val( i, j ) );
+		}
+
+		ret = std::max( ret, sum );
+	}
+
+	return ret;
+}
+
+/**
+ * Backward error of a solution: |A x - b| / (|A| |x| + |b|). A backward stable
+ * solver keeps it at a small multiple of N * epsilon, independent of the condition.
+ */
+template <typename T, exmath::index_t N, exmath::index_t M, exmath::index_t K>
+double get_backward_error( const exmath::matrix_t<T,N,M> & a, const exmath::matrix_t<T,M,K> & x, const exmath::matrix_t<T,N,K> & b )
+{
+	return norm_inf( exmath::matrix_t<T,N,K>( a * x - b ) ) / ( norm_inf( a ) * norm_inf( x ) + norm_inf( b ) );
+}
+
+template <typename T, exmath::index_t N>
+exmath::matrix_t<T,N,N> create_identity()
+{
+	exmath::matrix_t<T,N,N> ret;
+
+	for( exmath::index_t i = 0; i < N; i++ ) {
+		for( exmath::index_t j = 0; j < N; j++ ) {
+			ret( i, j ) = i == j ? T(1) : T(0);
+		}
+	}
+
+	return ret;
+}
+
+bool check_decompositions( wlib::StringSink_Interface & sink )
+{
+	constexpr exmath::index_t N = 6;
+	constexpr exmath::index_t M = 4;
+	constexpr exmath::index_t ROWS = 9;
+	// the residuals of the decompositions are relative to the size of A
+	constexpr double bound = 10 * ROWS * std::numeric_limits<double>::epsilon();
+
+	using matrix_type = exmath::matrix_t<double,N,N>;
+
+	const matrix_type a = *create_random_matrix<double,N,N>();
+	const exmath::matrix_t<double,N,M> b = *create_random_matrix<double,N,M>();
+	const exmath::matrix_t<double,N,1> u = *create_random_matrix<double,N,1>();
+	const exmath::matrix_t<double,N,1> v = *create_random_matrix<double,N,1>();
+
+	// P A = L U
+	const exmath::lu_t<double,N> lu( a );
+	matrix_type l = create_identity<double,N>();
+	matrix_type upper;
+	matrix_type pa;
+
+	for( exmath::index_t i = 0; i < N; i++ ) {
+		for( exmath::index_t j = 0; j < N; j++ ) {
+			if( j < i ) {
+				l( i, j ) = lu.get_lu()( i, j );
+			}
+
+			upper( i, j ) = j >= i ? lu.get_lu()( i, j ) : 0.0;
+			pa( i, j ) = a( lu.get_permutation( i ), j );
+		}
+	}
+
+	exmath::lu_t<double,N> lu_updated( a );
+	lu_updated.rank_1_update( u, v );
+	const matrix_type a_updated = a + matrix_type( u * exmath::transpose( v ) );
+
+	// the update cancels the first pivot of the regular A + u v^T, which has to be factorized again
+	matrix_type a_pivot = create_identity<double,N>();
+	a_pivot( 0, 1 ) = 1;
+	a_pivot( 1, 0 ) = 0.5;
+	exmath::matrix_t<double,N,1> u_pivot;
+	exmath::matrix_t<double,N,1> v_pivot;
+
+	for( exmath::index_t i = 0; i < N; i++ ) {
+		u_pivot( i, 0 ) = i == 0 ? 1.0 : 0.0;
+		v_pivot( i, 0 ) = i == 0 ? -1.0 : 0.0;
+	}
+
+	exmath::lu_t<double,N> lu_pivot( a_pivot );
+	const bool pivot_updated = lu_pivot.rank_1_update( u_pivot, v_pivot );
+	const matrix_type a_pivot_updated = a_pivot + matrix_type( u_pivot * exmath::transpose( v_pivot ) );
+
+	// A = L L^T for the positive definite A A^T + N I
+	const matrix_type spd = a * exmath::transpose( a ) + matrix_type( create_identity<double,N>() * double(N) );
+	exmath::cholesky_t<double,N> cholesky( spd );
+
+	exmath::cholesky_t<double,N> cholesky_updated( spd );
+	cholesky_updated.rank_1_update( u );
+	const matrix_type spd_updated = spd + matrix_type( u * exmath::transpose( u ) );
+
+	// A = Q R of an overdetermined system, x is the least squares solution
+	const exmath::matrix_t<double,ROWS,M> a_ls = *create_random_matrix<double,ROWS,M>();
+	const exmath::matrix_t<double,ROWS,1> b_ls = *create_random_matrix<double,ROWS,1>();
+	const exmath::qr_t<double,ROWS,M> qr( a_ls );
+	const exmath::matrix_t<double,M,1> x_ls = qr.solve( b_ls );
+	const exmath::matrix_t<double,ROWS,1> residual_ls = a_ls * x_ls - b_ls;
+
+	exmath::qr_t<double,ROWS,M> qr_updated( a_ls );
+	const exmath::matrix_t<double,ROWS,1> u_ls = *create_random_matrix<double,ROWS,1>();
+	const exmath::matrix_t<double,M,1> v_ls = *create_random_matrix<double,M,1>();
+	qr_updated.rank_1_update( u_ls, v_ls );
+	const exmath::matrix_t<double,ROWS,M> a_ls_updated = a_ls + exmath::matrix_t<double,ROWS,M>( u_ls * exmath::transpose( v_ls ) );
+
+	const Result results[] = {
+		{ "lu |P A - L U| / |A|",           norm_inf( matrix_type( pa - l * upper ) ) / norm_inf( a ), bound },
+		{ "lu solve backward error",        get_backward_error( a, lu.solve( b ), b ), bound },
+		{ "lu rank 1 update solve",         get_backward_error( a_updated, lu_updated.solve( b ), b ), bound },
+		{ "lu rank 1 update refactorized solve", get_backward_error( a_pivot_updated, lu_pivot.solve( b ), b ), bound },
+		{ "lu solve vs exmath::solve",      norm_inf( exmath::matrix_t<double,N,M>( lu.solve( b ) - exmath::solve( a, b ) ) ) /
+											( norm_inf( a ) * norm_inf( lu.solve( b ) ) ), bound },
+		{ "cholesky solve backward error",  get_backward_error( spd, cholesky.solve( b ), b ), bound },
+		{ "cholesky rank 1 update solve",   get_backward_error( spd_updated, cholesky_updated.solve( b ), b ), bound },
+		{ "qr |A - Q R| / |A|",             norm_inf( exmath::matrix_t<double,ROWS,M>( a_ls - qr.get_q() * qr.get_r() ) ) / norm_inf( a_ls ), bound },
+		{ "qr |Q^T Q - I|",                 norm_inf( exmath::matrix_t<double,ROWS,ROWS>( exmath::transpose( qr.get_q() ) * qr.get_q() - create_identity<double,ROWS>() ) ), bound },
+		// the residual of a least squares solution is orthogonal to the columns of A
+		{ "qr least squares |A^T r| / (|A| |r|)", norm_inf( exmath::matrix_t<double,M,1>( exmath::transpose( a_ls ) * residual_ls ) ) /
+											( norm_inf( a_ls ) * norm_inf( residual_ls ) ), bound },
+		{ "qr rank 1 update |A - Q R| / |A|", norm_inf( exmath::matrix_t<double,ROWS,M>( a_ls_updated - qr_updated.get_q() * qr_updated.get_r() ) ) /
+											norm_inf( a_ls_updated ), bound },
+	};
+
+	bool success = !lu.is_singular() && !lu_updated.is_singular() && pivot_updated && cholesky.is_positive_definite() &&
+				   cholesky_updated.is_positive_definite() && !qr.is_rank_deficient();
+
+	if( !success ) {
+		sink( "decompositions: a regular test matrix was not decomposed\n" );
+	}
+
+	return print_results( sink, results ) && success;
+}
+
+/**
+ * lu_t is constexpr: the rank 1 update of the regular A = [ 2 1; 1 1 ] with u = (1,0),
+ * v = (-2,0) cancels the first pivot, the refactorized A + u v^T = [ 0 1; 1 1 ] is
+ * solved for b = (1,2), x = (1,1).
+ */
+constexpr bool check_lu_constexpr()
+{
+	exmath::lu_t<double,2> lu( exmath::matrix_t<double,2,2>( { 2.0, 1.0, 1.0, 1.0 } ) );
+
+	if( !lu.rank_1_update( exmath::matrix_t<double,2,1>( { 1.0, 0.0 } ), exmath::matrix_t<double,2,1>( { -2.0, 0.0 } ) ) ) {
+		return false;
+	}
+
+	const exmath::matrix_t<double,2,1> x = lu.solve( exmath::matrix_t<double,2,1>( { 1.0, 2.0 } ) );
+
+	return x( 0, 0 ) == 1.0 && x( 1, 0 ) == 1.0 && lu.determinant() == -1.0;
+}
+
+static_assert( check_lu_constexpr() );
+
+template <class Fnc>
+std::chrono::nanoseconds measure( std::size_t count, Fnc fnc )
+{
+	const auto start = std::chrono::steady_clock::now();
+
+	for( std::size_t i = 0; i < count; i++ ) {
+		fnc( i );
+	}
+
+	return ( std::chrono::steady_clock::now() - start ) / count;
+}
+
+using gemm_function = void (*)( const float *a, const float *b, float *c, std::size_t n, std::size_t m, std::size_t k );
+
+/**
+ * the loop of matrix_t in constant evaluation, the product before the kernels
+ */
+void generic_gemm( const float *a, const float *b, float *c, std::size_t n, std::size_t m, std::size_t k )
+{
+	for( std::size_t i = 0; i < n; i++ ) {
+		for( std::size_t j = 0; j < k; j++ ) {
+			float val = 0;
+
+			for( std::size_t p = 0; p < m; p++ ) {
+				val += a[i * m + p] * b[p * k + j];
+			}
+
+			c[i * k + j] = val;
+		}
+	}
+}
+
+/**
+ * Time of the generic loop, the unrolled kernel and the blocked kernel with
+ * other panel and tile sizes (inner x columns x tile rows, 64x64x4 is the one
+ * matrix_t uses) for square float products. The blocked variants add the
+ * products in the same order, their results have to be equal.
+ */
+bool measure_gemm( wlib::StringSink_Interface & sink )
+{
+	namespace kernels = exmath::Internal::kernels;
+
+	struct Variant {
+		const char *name;
+		gemm_function fnc;
+	};
+
+	const Variant small_variants[] = {
+		{ "generic loop",  &generic_gemm },
+		{ "unrolled",      []( const float *a, const float *b, float *c, std::size_t, std::size_t, std::size_t ) {
+			kernels::gemm_small<float,8,8,8>( a, b, c );
+		} },
+		{ "blocked 64x64x4", &kernels::gemm_blocked<float,64,64,4> },
+	};
+
+	const Variant blocked_variants[] = {
+		{ "generic loop",      &generic_gemm },
+		{ "blocked 64x64x4",   &kernels::gemm_blocked<float,64,64,4> },
+		{ "blocked 16x16x4",   &kernels::gemm_blocked<float,16,16,4> },
+		{ "blocked 32x32x4",   &kernels::gemm_blocked<float,32,32,4> },
+		{ "blocked 128x128x4", &kernels::gemm_blocked<float,128,128,4> },
+		{ "blocked 64x64x1",   &kernels::gemm_blocked<float,64,64,1> },
+		{ "blocked 64x64x2",   &kernels::gemm_blocked<float,64,64,2> },
+		{ "blocked 64x64x8",   &kernels::gemm_blocked<float,64,64,8> },
+	};
+
+	std::uniform_real_distribution<float> dist( -1, 1 );
+	volatile float result = 0;
+	bool success = true;
+
+	auto sweep = [&]( std::size_t size, std::span<const Variant> variants ) {
+		std::vector<float> a( size * size );
+		std::vector<float> b( size * size );
+		std::vector<float> c( size * size );
+		std::vector<float> reference;
+
+		for( std::size_t i = 0; i < size * size; i++ ) {
+			a[i] = dist( random_generator );
+			b[i] = dist( random_generator );
+		}
+
+		// about 16M multiply adds per variant
+		const std::size_t count = std::max<std::size_t>( 1, ( std::size_t( 1 ) << 24 ) / ( size * size * size ) );
+
+		for( const Variant & variant : variants ) {
+			// once untimed, so the first variant does not pay for the cold caches
+			variant.fnc( a.data(), b.data(), c.data(), size, size, size );
+
+			const std::chrono::nanoseconds time = measure( count, [&]( std::size_t ) {
+				variant.fnc( a.data(), b.data(), c.data(), size, size, size );
+				result = c[0];
+			});
+
+			bool equal = true;
+
+			if( variant.fnc != &generic_gemm ) {
+				if( reference.empty() ) {
+					reference = c;
+				}
+
+				equal = c == reference;
+				success = equal && success;
+			}
+
+			sink( static_format<150>( "gemm float %dx%dx%d %s: %.2fus%s\n", size, size, size, variant.name,
+					std::chrono::duration<double,std::micro>( time ).count(), equal ? "" : ", result differs, FAILED" ).c_str() );
+		}
+	};
+
+	sweep( 8, small_variants );
+	sweep( 64, blocked_variants );
+	sweep( 128, blocked_variants );
+
+	return success;
+}
+
+/**
+ * Time of lu_t against the elimination of exmath::solve per right hand side,
+ * once for a new right hand side of the same A and once after a rank 1 update of A.
+ */
+void measure_decompositions( wlib::StringSink_Interface & sink )
+{
+	constexpr exmath::index_t N = 32;
+	constexpr std::size_t COUNT = 200;
+
+	using matrix_type = exmath::matrix_t<double,N,N>;
+	using vector_type = exmath::matrix_t<double,N,1>;
+
+	const auto a = create_random_matrix<double,N,N>();
+	const auto b = create_random_matrix<double,N,1>();
+	const auto u = create_random_matrix<double,N,1>();
+	const auto v = create_random_matrix<double,N,1>();
+	const auto lu = std::make_unique<exmath::lu_t<double,N>>( *a );
+	auto updated = std::make_unique<matrix_type>( *a );
+	volatile double sink_value = 0;
+
+	const std::chrono::nanoseconds lu_solve = measure( COUNT, [&]( std::size_t ) {
+		sink_value = lu->solve( *b )( 0, 0 );
+	});
+
+	const std::chrono::nanoseconds exmath_solve = measure( COUNT, [&]( std::size_t ) {
+		sink_value = exmath::solve( *a, *b )( 0, 0 );
+	});
+
+	const std::chrono::nanoseconds lu_update = measure( COUNT, [&]( std::size_t ) {
+		lu->rank_1_update( *u, *v );
+		sink_value = lu->solve( *b )( 0, 0 );
+	});
+
+	const std::chrono::nanoseconds exmath_update = measure( COUNT, [&]( std::size_t ) {
+		*updated = *updated + matrix_type( *u * exmath::transpose( *v ) );
+		sink_value = exmath::solve( *updated, vector_type( *b ) )( 0, 0 );
+	});
+
+	auto us = []( std::chrono::nanoseconds ns ) {
+		return std::chrono::duration<double,std::micro>( ns ).count();
+	};
+
+	sink( static_format<150>( "%dx%d solve: lu_t %.1fus, exmath::solve %.1fus\n", N, N, us( lu_solve ), us( exmath_solve ) ).c_str() );
+	sink( static_format<150>( "%dx%d rank 1 update + solve: lu_t %.1fus, exmath::solve %.1fus\n", N, N, us( lu_update ), us( exmath_update ) ).c_str() );
+}
+
+/**
+ * The lazy expressions against the operators of matrix_t, which build a temporary
+ * per step. Both sum up the same products, only the kernels may round differently.
+ */
+bool check_expressions( wlib::StringSink_Interface & sink )
+{
+	constexpr exmath::index_t N = 6;
+	constexpr exmath::index_t K = 2;
+	constexpr exmath::index_t L = 12;
+	constexpr double bound = 10 * L * std::numeric_limits<double>::epsilon();
+
+	using state_type = exmath::matrix_t<double,N,1>;
+	using matrix_type = exmath::matrix_t<double,N,N>;
+	using large_matrix_type = exmath::matrix_t<double,L,L>;
+
+	const matrix_type a = *create_random_matrix<double,N,N>();
+	const exmath::matrix_t<double,N,K> b = *create_random_matrix<double,N,K>();
+	const exmath::matrix_t<double,K,1> u = *create_random_matrix<double,K,1>();
+	const state_type c = *create_random_matrix<double,N,1>();
+	const state_type x = *create_random_matrix<double,N,1>();
+	const matrix_type p = *create_random_matrix<double,N,N>();
+	const matrix_type q = *create_random_matrix<double,N,N>();
+
+	const double scale = norm_inf( a ) * norm_inf( x ) + norm_inf( b ) * norm_inf( u ) + norm_inf( c );
+
+	// state update
+	const state_type update_direct = a * x + b * u - c;
+	const state_type update_lazy = exmath::lazy( a ) * x + exmath::lazy( b ) * u - c;
+
+	// the destination is an operand of the product
+	state_type alias_lazy = x;
+	alias_lazy = exmath::lazy( a ) * alias_lazy;
+	const state_type alias_direct = a * x;
+
+	// element wise only, one loop
+	const matrix_type elements_direct = ( p + q ) * 0.5 - q / 4.0 + p * -1.0;
+	const matrix_type elements_lazy = ( exmath::lazy( p ) + q ) * 0.5 - exmath::lazy( q ) / 4.0 + ( -exmath::lazy( p ) );
+
+	// += and -= without a temporary
+	state_type assign_lazy = c;
+	assign_lazy += exmath::lazy( a ) * x;
+	assign_lazy -= exmath::lazy( b ) * u;
+	const state_type assign_direct = c + a * x - b * u;
+
+	// a pure product is written into the destination by the blocked kernel
+	const auto large_a = create_random_matrix<double,L,L>();
+	const auto large_b = create_random_matrix<double,L,L>();
+	const auto product_direct = std::make_unique<large_matrix_type>( (*large_a) * (*large_b) );
+	auto product_lazy = std::make_unique<large_matrix_type>();
+	*product_lazy = exmath::lazy( *large_a ) * (*large_b);
+
+	const Result results[] = {
+		{ "expression A x + B u - c",  norm_inf( state_type( update_lazy - update_direct ) ) / scale, bound },
+		{ "expression x = A x",        norm_inf( state_type( alias_lazy - alias_direct ) ) / ( norm_inf( a ) * norm_inf( x ) ), bound },
+		{ "expression element wise",   norm_inf( matrix_type( elements_lazy - elements_direct ) ) / ( norm_inf( p ) + norm_inf( q ) ), bound },
+		{ "expression += and -=",      norm_inf( state_type( assign_lazy - assign_direct ) ) / scale, bound },
+		{ "expression product 12x12",  norm_inf( large_matrix_type( *product_lazy - *product_direct ) ) / ( norm_inf( *large_a ) * norm_inf( *large_b ) ), bound },
+	};
+
+	return print_results( sink, results );
+}
+
+constexpr std::size_t STACK_PAINT_SIZE = 4096;
+// the watermark of FreeRTOS
+constexpr unsigned char STACK_WATERMARK = 0xa5;
+
+EXMATH_NOINLINE void paint_stack()
+{
+	volatile unsigned char stack[STACK_PAINT_SIZE];
+
+	for( std::size_t i = 0; i < STACK_PAINT_SIZE; i++ ) {
+		stack[i] = STACK_WATERMARK;
+	}
+}
+
+/**
+ * has the same frame as paint_stack(), the stack grows down,
+ * so the callee used everything above the lowest overwritten byte
+ */
+EXMATH_NOINLINE std::size_t get_painted_stack_usage()
+{
+	volatile unsigned char stack[STACK_PAINT_SIZE];
+	std::size_t untouched = 0;
+
+	while( untouched < STACK_PAINT_SIZE && stack[untouched] == STACK_WATERMARK ) {
+		untouched++;
+	}
+
+	return STACK_PAINT_SIZE - untouched;
+}
+
+EXMATH_NOINLINE void call_nothing()
+{
+}
+
+/**
+ * stack of one call of fnc in bytes including its callees, without the
+ * return address and whatever else a call of an empty function costs
+ */
+template <class Fnc>
+std::size_t measure_stack( Fnc fnc )
+{
+	paint_stack();
+	call_nothing();
+	const std::size_t empty = get_painted_stack_usage();
+
+	paint_stack();
+	fnc();
+	const std::size_t used = get_painted_stack_usage();
+
+	return used > empty ? used - empty : 0;
+}
+
+using expression_state_type = exmath::matrix_t<double,6,1>;
+using expression_matrix_type = exmath::matrix_t<double,6,6>;
+using expression_input_type = exmath::matrix_t<double,6,2>;
+
+EXMATH_NOINLINE void update_direct( expression_state_type & x, const expression_matrix_type & a, const expression_input_type & b,
+									const exmath::matrix_t<double,2,1> & u, const expression_state_type & c )
+{
+	x = a * x + b * u - c;
+}
+
+EXMATH_NOINLINE void update_lazy( expression_state_type & x, const expression_matrix_type & a, const expression_input_type & b,
+								  const exmath::matrix_t<double,2,1> & u, const expression_state_type & c )
+{
+	x = exmath::lazy( a ) * x + exmath::lazy( b ) * u - c;
+}
+
+EXMATH_NOINLINE void elements_direct( expression_matrix_type & d, const expression_matrix_type & p, const expression_matrix_type & q )
+{
+	d = ( p + q ) * 0.5 - q + p * 2.0;
+}
+
+EXMATH_NOINLINE void elements_lazy( expression_matrix_type & d, const expression_matrix_type & p, const expression_matrix_type & q )
+{
+	d = ( exmath::lazy( p ) + q ) * 0.5 - q + exmath::lazy( p ) * 2.0;
+}
+
+EXMATH_NOINLINE void product_direct( expression_matrix_type & d, const expression_matrix_type & p, const expression_matrix_type & q )
+{
+	d = p * q;
+}
+
+EXMATH_NOINLINE void product_lazy( expression_matrix_type & d, const expression_matrix_type & p, const expression_matrix_type & q )
+{
+	d = exmath::lazy( p ) * q;
+}
+
+/**
+ * Stack (painted with a watermark) and time per call of the lazy expressions
+ * against the operators of matrix_t. The functions are not inlined, like a
+ * -fstack-usage measurement of them.
+ */
+void measure_expressions( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t COUNT = 100'000;
+
+	const expression_matrix_type a = *create_random_matrix<double,6,6>();
+	const expression_input_type b = *create_random_matrix<double,6,2>();
+	const exmath::matrix_t<double,2,1> u = *create_random_matrix<double,2,1>();
+	const expression_state_type c = *create_random_matrix<double,6,1>();
+	// keeps the state bounded over the calls
+	const expression_matrix_type a_stable = a * ( 0.5 / norm_inf( a ) );
+	expression_state_type x = *create_random_matrix<double,6,1>();
+	expression_matrix_type d;
+	// else the calls which only write d may be dropped
+	volatile double result = 0;
+
+	struct Measurement
+	{
+		const char *name;
+		std::size_t stack_direct;
+		std::size_t stack_lazy;
+		std::chrono::nanoseconds time_direct;
+		std::chrono::nanoseconds time_lazy;
+	};
+
+	const Measurement measurements[] = {
+		{ "x = A x + B u - c (6x6, 6x2)",
+		  measure_stack( [&]() { update_direct( x, a_stable, b, u, c ); } ),
+		  measure_stack( [&]() { update_lazy( x, a_stable, b, u, c ); } ),
+		  measure( COUNT, [&]( std::size_t ) { update_direct( x, a_stable, b, u, c ); } ),
+		  measure( COUNT, [&]( std::size_t ) { update_lazy( x, a_stable, b, u, c ); } ) },
+		{ "d = (a + b) * 0.5 - b + a * 2 (6x6)",
+		  measure_stack( [&]() { elements_direct( d, a, a_stable ); result = d( 0, 0 ); } ),
+		  measure_stack( [&]() { elements_lazy( d, a, a_stable ); result = d( 0, 0 ); } ),
+		  measure( COUNT, [&]( std::size_t ) { elements_direct( d, a, a_stable ); result = d( 0, 0 ); } ),
+		  measure( COUNT, [&]( std::size_t ) { elements_lazy( d, a, a_stable ); result = d( 0, 0 ); } ) },
+		{ "d = a * b (6x6)",
+		  measure_stack( [&]() { product_direct( d, a, a_stable ); result = d( 0, 0 ); } ),
+		  measure_stack( [&]() { product_lazy( d, a, a_stable ); result = d( 0, 0 ); } ),
+		  measure( COUNT, [&]( std::size_t ) { product_direct( d, a, a_stable ); result = d( 0, 0 ); } ),
+		  measure( COUNT, [&]( std::size_t ) { product_lazy( d, a, a_stable ); result = d( 0, 0 ); } ) },
+	};
+
+	for( const Measurement & m : measurements ) {
+		sink( static_format<200>( "%s: stack %d -> %d bytes, %dns -> %dns\n", m.name,
+				m.stack_direct, m.stack_lazy,
+				static_cast<long long>( m.time_direct.count() ), static_cast<long long>( m.time_lazy.count() ) ).c_str() );
+	}
+}
+
+/**
+ * Rounding bound of the evaluation of a polynominal of order n at x:
+ * 2 n epsilon sum( |para[i]| |x|^(n-i) ), with a factor 2 of headroom.
+ */
+template <typename T, std::size_t Size>
+double get_polynominal_bound( std::span<const T,Size> para, double x )
+{
+	double sum = 0;
+
+	for( std::size_t i = 0; i < Size; i++ ) {
+		sum = sum * std::fabs( x ) + std::fabs( para[i] );
+	}
+
+	return 4 * ( Size - 1 ) * std::numeric_limits<T>::epsilon() * sum;
+}
+
+/**
+ * Largest difference of estrin and of the batch evaluation to horner
+ * in [lower, upper], relative to the rounding bound.
+ */
+template <typename T, std::size_t Size>
+double check_estrin( std::span<const T,Size> para, T lower, T upper )
+{
+	constexpr std::size_t number_of_values = 1001;
+
+	std::vector<T> values( number_of_values );
+	std::vector<T> batch( number_of_values );
+
+	for( std::size_t i = 0; i < number_of_values; i++ ) {
+		values[i] = lower + ( upper - lower ) * static_cast<T>( i ) / static_cast<T>( number_of_values - 1 );
+	}
+
+	exmath::polynominal::horner( para, std::span<const T>( values ), std::span<T>( batch ) );
+
+	double ret = 0;
+
+	for( std::size_t i = 0; i < number_of_values; i++ ) {
+		const T horner = exmath::polynominal::horner( para, values[i] );
+		const double bound = get_polynominal_bound( para, values[i] );
+		const double error = std::max( std::fabs( exmath::polynominal::estrin( para, values[i] ) - horner ), std::fabs( batch[i] - horner ) );
+
+		if( error > 0 ) {
+			ret = std::max( ret, bound > 0 ? error / bound : 2 );
+		}
+	}
+
+	return ret;
+}
+
+bool check_polynominals( wlib::StringSink_Interface & sink )
+{
+	std::uniform_real_distribution<double> dist( -1, 1 );
+	exmath::polynominal::polynominal_t<double,9> poly9;
+
+	for( std::size_t i = 0; i < 10; i++ ) {
+		poly9[i] = dist( random_generator );
+	}
+
+	const exmath::polynominal::polynominal_t<double,4> poly4( 0.5, -1.25, 2.0, 0.75, -3.0 );
+
+	// the NTC polynominals are evaluated at ln(R / R25), over the range of the table
+	const float lower = static_cast<float>( std::log( 1.0 / 128 ) );
+	const float upper = static_cast<float>( std::log( 128.0 ) );
+	double estrin_ntc = 0;
+
+	for( const auto & para : { sensors::TDK_NTC::TDK_1038, sensors::TDK_NTC::TDK_2014, sensors::TDK_NTC::TDK_2901,
+							   sensors::TDK_NTC::TDK_8016, sensors::TDK_NTC::TDK_8018, sensors::TDK_NTC::TDK_8500,
+							   sensors::TDK_NTC::TDK_8501, sensors::TDK_NTC::TDK_8502, sensors::TDK_NTC::TDK_8507,
+							   sensors::TDK_NTC::TDK_8509 } ) {
+		estrin_ntc = std::max( estrin_ntc, check_estrin( std::span<const float,6>( para, 6 ), lower, upper ) );
+	}
+
+	// the tabulated NTC against the polynominal of the exact logarithm, in Kelvin
+	static constexpr sensors::TDK_NTC_table_t<> ntc_table{ sensors::TDK_NTC::TDK_8016, 10E3f };
+	const sensors::TDK_NTC ntc( sensors::TDK_NTC::TDK_8016, 10E3f );
+	double table_error = 0;
+	double ntc_error = 0;
+
+	for( double e = -7; e <= 7; e += 1.0 / 1024 ) {
+		const double resistance = 10E3 * std::exp2( e );
+		const double v = std::log( resistance / 10E3 );
+		double reference = sensors::TDK_NTC::TDK_8016[0];
+
+		for( std::size_t i = 1; i < 6; i++ ) {
+			reference = reference * v + sensors::TDK_NTC::TDK_8016[i];
+		}
+
+		table_error = std::max( table_error, std::fabs( ntc_table( static_cast<float>( resistance ) ) - reference ) );
+		ntc_error = std::max( ntc_error, std::fabs( ntc( static_cast<float>( resistance ) ) - reference ) );
+	}
+
+	// Q16: the rounding of each coefficient and each step is 2^-17, amplified by |x|^k
+	const exmath::polynominal::fixed_polynominal_t<4,16> poly4_fixed( poly4 );
+	double fixed_error = 0;
+
+	for( double x = -1; x <= 1; x += 1.0 / 256 ) {
+		const int32_t result = poly4_fixed( poly4_fixed.to_fixed( x ) );
+		double bound = 0;
+
+		for( std::size_t i = 0; i < 5; i++ ) {
+			bound = bound * std::fabs( x ) + 2.0 / 65536;
+		}
+
+		fixed_error = std::max( fixed_error, std::fabs( poly4_fixed.to_floating( result ) - poly4( x ) ) / bound );
+	}
+
+	const Result results[] = {
+		{ "estrin == horner, order 4",   check_estrin( poly4.get_parameter(), -4.0, 4.0 ), 1, "of the bound" },
+		{ "estrin == horner, order 9",   check_estrin( poly9.get_parameter(), -2.0, 2.0 ), 1, "of the bound" },
+		{ "estrin == horner, TDK float", estrin_ntc,                                        1, "of the bound" },
+		{ "TDK_NTC error",               ntc_error,                                         0.001, "K" },
+		// linear interpolation between 32 points per octave
+		{ "TDK_NTC_table_t<> error",     table_error,                                       0.01, "K" },
+		{ "fixed_polynominal_t Q16",     fixed_error,                                       1, "of the bound" },
+	};
+
+	return print_results( sink, results );
+}
+
+/**
+ * Time per value of each way to evaluate the NTC polynominal TDK_8016,
+ * at ln(R / R25) or at the resistance, over the range of the table
+ */
+void measure_polynominals( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t NUMBER_OF_VALUES = 1024;
+	constexpr std::size_t COUNT = 1000;
+
+	const std::span<const float,6> para( sensors::TDK_NTC::TDK_8016, 6 );
+	const exmath::polynominal::fixed_polynominal_t<5,16> fixed( para );
+	static constexpr sensors::TDK_NTC_table_t<> ntc_table{ sensors::TDK_NTC::TDK_8016, 10E3f };
+	const sensors::TDK_NTC ntc( sensors::TDK_NTC::TDK_8016, 10E3f );
+
+	std::uniform_real_distribution<double> dist( -7, 7 );
+	std::vector<float> resistances( NUMBER_OF_VALUES );
+	std::vector<float> values( NUMBER_OF_VALUES );
+	std::vector<int32_t> fixed_values( NUMBER_OF_VALUES );
+	std::vector<float> batch( NUMBER_OF_VALUES );
+
+	for( std::size_t i = 0; i < NUMBER_OF_VALUES; i++ ) {
+		const double resistance = 10E3 * std::exp2( dist( random_generator ) );
+		resistances[i] = static_cast<float>( resistance );
+		values[i] = static_cast<float>( std::log( resistance / 10E3 ) );
+		fixed_values[i] = fixed.to_fixed( values[i] );
+	}
+
+	volatile float result = 0;
+
+	// nanoseconds per value, all values are evaluated in one call
+	auto per_value = []( std::chrono::nanoseconds duration ) {
+		return static_cast<double>( duration.count() ) / NUMBER_OF_VALUES;
+	};
+
+	auto for_each_value = [&]( auto fnc ) {
+		return per_value( measure( COUNT, [&]( std::size_t ) {
+			float sum = 0;
+
+			for( std::size_t i = 0; i < NUMBER_OF_VALUES; i++ ) {
+				sum += fnc( i );
+			}
+
+			result = sum;
+		}) );
+	};
+
+	struct Measurement
+	{
+		const char *name;
+		double time;
+	};
+
+	const Measurement measurements[] = {
+		{ "horner",                    for_each_value( [&]( std::size_t i ) { return exmath::polynominal::horner( para, values[i] ); } ) },
+		{ "estrin",                    for_each_value( [&]( std::size_t i ) { return exmath::polynominal::estrin( para, values[i] ); } ) },
+		{ "horner batch",              per_value( measure( COUNT, [&]( std::size_t ) {
+										   exmath::polynominal::horner( para, std::span<const float>( values ), std::span<float>( batch ) );
+										   result = batch[0];
+									   }) ) },
+		{ "fixed_polynominal_t Q16",   for_each_value( [&]( std::size_t i ) { return static_cast<float>( fixed( fixed_values[i] ) ); } ) },
+		{ "TDK_NTC_table_t<>",         for_each_value( [&]( std::size_t i ) { return ntc_table( resistances[i] ); } ) },
+		{ "TDK_NTC std::log + horner", for_each_value( [&]( std::size_t i ) { return ntc( resistances[i] ); } ) },
+	};
+
+	for( const Measurement & m : measurements ) {
+		sink( static_format<150>( "%s: %.2fns per value, %.0fM values/s\n", m.name, m.time, 1E3 / m.time ).c_str() );
+	}
+}
+
+/**
+ * QuantileDigest against the exact quantiles and ExponentialStatistics
+ * against the weighted mean and variance, both fed sequentially and
+ * merged from blocks, like the block means of the ADC
+ */
+bool check_streaming_statistics( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t NUMBER_OF_VALUES = 100000;
+	constexpr std::size_t BLOCK_SIZE = 100;
+
+	std::normal_distribution<double> dist( 25, 2 );
+	std::vector<double> values( NUMBER_OF_VALUES );
+
+	for( double & value : values ) {
+		value = dist( random_generator );
+	}
+
+	exmath::statistics::QuantileDigest<16> digest;
+	exmath::statistics::QuantileDigest<16> digest_merged;
+	exmath::statistics::ExponentialStatistics ewma( 0.01 );
+	exmath::statistics::ExponentialStatistics ewma_merged( 0.01 );
+
+	for( std::size_t i = 0; i < values.size(); i += BLOCK_SIZE ) {
+		const std::span<const double> block( values.data() + i, BLOCK_SIZE );
+
+		digest( block );
+		digest_merged( exmath::statistics::QuantileDigest<16>( block ) );
+		ewma( block );
+		ewma_merged( exmath::statistics::ExponentialStatistics( block, 0.01 ) );
+	}
+
+	// NaNs are ignored
+	digest( std::numeric_limits<double>::quiet_NaN() );
+	ewma( std::numeric_limits<double>::quiet_NaN() );
+
+	std::vector<double> sorted( values );
+	std::sort( sorted.begin(), sorted.end() );
+
+	// error of the rank, that is the fraction of the values below the estimated quantile
+	auto get_rank_error = [&]( const exmath::statistics::QuantileDigest<16> & d ) {
+		double error = 0;
+
+		for( double q : { 0.01, 0.05, 0.25, 0.5, 0.75, 0.95, 0.99 } ) {
+			const double estimate = d.get_quantile( q );
+			const double rank = static_cast<double>( std::lower_bound( sorted.begin(), sorted.end(), estimate ) - sorted.begin() ) / sorted.size();
+			error = std::max( error, std::fabs( rank - q ) );
+		}
+
+		return error;
+	};
+
+	// the direct sums of the weights (1 - alpha)^age
+	double weight = 0;
+	double weighted_sum = 0;
+
+	for( std::size_t i = 0; i < values.size(); i++ ) {
+		const double w = std::pow( 1 - 0.01, static_cast<double>( values.size() - 1 - i ) );
+		weight += w;
+		weighted_sum += w * values[i];
+	}
+
+	const double mean = weighted_sum / weight;
+	double weighted_m2 = 0;
+
+	for( std::size_t i = 0; i < values.size(); i++ ) {
+		weighted_m2 += std::pow( 1 - 0.01, static_cast<double>( values.size() - 1 - i ) ) * ( values[i] - mean ) * ( values[i] - mean );
+	}
+
+	const double variance = weighted_m2 / weight;
+
+	auto get_ewma_error = [&]( const exmath::statistics::ExponentialStatistics & e ) {
+		return std::max( std::fabs( e.get_mean() - mean ) / mean, std::fabs( e.get_variance() - variance ) / variance );
+	};
+
+	const Result results[] = {
+		{ "QuantileDigest<16> p01..p99",        get_rank_error( digest ),         0.005, "rank" },
+		{ "QuantileDigest<16> p01..p99 merged", get_rank_error( digest_merged ),  0.005, "rank" },
+		{ "QuantileDigest<16> count",           std::fabs( static_cast<double>( digest.get_number_of_values() ) - NUMBER_OF_VALUES ), 0, "values" },
+		{ "ExponentialStatistics",              get_ewma_error( ewma ),           1E-9, "relative" },
+		{ "ExponentialStatistics merged",       get_ewma_error( ewma_merged ),    1E-9, "relative" },
+		{ "ExponentialStatistics count",        std::fabs( static_cast<double>( ewma.get_number_of_values() ) - NUMBER_OF_VALUES ), 0, "values" },
+	};
+
+	return print_results( sink, results );
+}
+
+/**
+ * BatchStatistics before the Welford update: it summed up the values and their
+ * squares, the variance is the difference of two large numbers. Reference for
+ * the accuracy and the time of the current one.
+ */
+class Sum_Of_Squares_Statistics
+{
+	std::size_t m_count = 0;
+	double m_mean = 0;
+	double m_x_sqr = 0;
+	double m_max = -std::numeric_limits<double>::infinity();
+	double m_min = std::numeric_limits<double>::infinity();
+
+	void add( double value )
+	{
+		if( std::isnan( value ) ) {
+			return;
+		}
+
+		if( m_max < value ) {
+			m_max = value;
+		}
+		if( m_min > value ) {
+			m_min = value;
+		}
+
+		m_mean += value;
+		m_x_sqr += value * value;
+	}
+
+	void scale()
+	{
+		const double scale = 1.0 / static_cast<double>( m_count );
+		m_mean *= scale;
+		m_x_sqr *= scale;
+	}
+
+public:
+	Sum_Of_Squares_Statistics() = default;
+
+	explicit Sum_Of_Squares_Statistics( std::span<const double> values )
+	{
+		for( const double value : values ) {
+			add( value );
+		}
+
+		m_count = values.size();
+		scale();
+	}
+
+	template <class Functor>
+	Sum_Of_Squares_Statistics( const Functor & ftor, std::size_t max_idx )
+	{
+		for( std::size_t i = 0; i < max_idx; i++ ) {
+			add( ftor( i ) );
+		}
+
+		m_count = max_idx;
+		scale();
+	}
+
+	Sum_Of_Squares_Statistics & operator()( double value )
+	{
+		if( std::isnan( value ) ) {
+			return *this;
+		}
+
+		if( m_max < value ) {
+			m_max = value;
+		}
+		if( m_min > value ) {
+			m_min = value;
+		}
+
+		m_count++;
+		const double scale = 1.0 / static_cast<double>( m_count );
+		m_mean += ( value - m_mean ) * scale;
+		m_x_sqr += ( value * value - m_x_sqr ) * scale;
+		return *this;
+	}
+
+	double get_mean() const { return m_mean; }
+
+	double get_variance() const
+	{
+		return std::abs( m_x_sqr - m_mean * m_mean ) * static_cast<double>( m_count ) / static_cast<double>( m_count - 1 );
+	}
+};
+
+/**
+ * The variance of BatchStatistics from a span, one value at a time and merged
+ * from blocks against a two pass reference in long double, for values with a
+ * large offset, where the sum of squares of the old implementation cancels.
+ * NaNs are skipped and not counted by all paths.
+ */
+bool check_batch_statistics( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t NUMBER_OF_VALUES = 100000;
+	constexpr std::size_t BLOCK_SIZE = 100;
+
+	std::vector<Result> results;
+	std::vector<double> values( NUMBER_OF_VALUES );
+
+	struct Case {
+		const char *name;
+		double offset;
+	};
+
+	const Case cases[] = {
+		{ "BatchStatistics variance N(0, 1)",   0 },
+		{ "BatchStatistics variance N(1e4, 1)", 1E4 },
+		{ "BatchStatistics variance N(1e8, 1)", 1E8 },
+	};
+
+	for( const Case & c : cases ) {
+		std::normal_distribution<double> dist( c.offset, 1 );
+
+		for( double & value : values ) {
+			value = dist( random_generator );
+		}
+
+		long double sum = 0;
+
+		for( const double value : values ) {
+			sum += value;
+		}
+
+		const long double mean = sum / values.size();
+		long double m2 = 0;
+
+		for( const double value : values ) {
+			m2 += ( value - mean ) * ( value - mean );
+		}
+
+		const double variance = static_cast<double>( m2 / ( values.size() - 1 ) );
+
+		exmath::statistics::BatchStatistics one_at_a_time;
+		exmath::statistics::BatchStatistics merged;
+
+		for( std::size_t i = 0; i < values.size(); i++ ) {
+			one_at_a_time( values[i] );
+
+			if( i % BLOCK_SIZE == 0 ) {
+				merged( std::span<const double>( values.data() + i, BLOCK_SIZE ) );
+			}
+		}
+
+		auto get_error = [&]( double estimate ) {
+			return std::fabs( estimate - variance ) / variance;
+		};
+
+		const double span_error = get_error( exmath::statistics::BatchStatistics( values ).get_variance() );
+		const double one_at_a_time_error = get_error( one_at_a_time.get_variance() );
+		const double merged_error = get_error( merged.get_variance() );
+		const double old_error = get_error( Sum_Of_Squares_Statistics( values ).get_variance() );
+
+		sink( static_format<200>( "%s: span %.1e, one at a time %.1e, merged %.1e, sum of squares before %.1e relative\n",
+				c.name, span_error, one_at_a_time_error, merged_error, old_error ).c_str() );
+
+		// the values are rounded to epsilon * offset, which limits the deviations from the mean
+		const double bound = 1E-12 + std::numeric_limits<double>::epsilon() * c.offset;
+
+		results.push_back( { c.name, std::max( { span_error, one_at_a_time_error, merged_error } ), bound, "relative" } );
+	}
+
+	// every 10th value is a NaN
+	std::vector<double> with_nan( 1000 );
+	std::vector<float> with_nan_float( with_nan.size() );
+	std::vector<double> without_nan;
+	std::normal_distribution<double> dist( 25, 2 );
+
+	for( std::size_t i = 0; i < with_nan.size(); i++ ) {
+		with_nan[i] = i % 10 == 3 ? std::numeric_limits<double>::quiet_NaN() : dist( random_generator );
+		with_nan_float[i] = static_cast<float>( with_nan[i] );
+
+		if( !std::isnan( with_nan[i] ) ) {
+			without_nan.push_back( with_nan[i] );
+		}
+	}
+
+	exmath::statistics::BatchStatistics one_at_a_time;
+
+	for( const double value : with_nan ) {
+		one_at_a_time( value );
+	}
+
+	const exmath::statistics::BatchStatistics stats[] = {
+		exmath::statistics::BatchStatistics( with_nan ),
+		exmath::statistics::BatchStatistics( with_nan_float ),
+		exmath::statistics::BatchStatistics( [&]( std::size_t i ) { return with_nan[i]; }, with_nan.size() ),
+		exmath::statistics::BatchStatistics()( std::span<const double>( with_nan ).first( 500 ) )( std::span<const double>( with_nan ).subspan( 500 ) ),
+		one_at_a_time,
+	};
+
+	const exmath::statistics::BatchStatistics reference( without_nan );
+	double count_error = 0;
+	double mean_error = 0;
+
+	for( const exmath::statistics::BatchStatistics & s : stats ) {
+		count_error = std::max( count_error, std::fabs( static_cast<double>( s.get_number_of_values() ) - without_nan.size() ) );
+		mean_error = std::max( mean_error, std::fabs( s.get_mean() - reference.get_mean() ) / reference.get_mean() );
+	}
+
+	results.push_back( { "BatchStatistics count with NaNs", count_error, 0, "values" } );
+	// the float values are rounded
+	results.push_back( { "BatchStatistics mean with NaNs", mean_error, 1E-7, "relative" } );
+
+	return print_results( sink, results );
+}
+
+/**
+ * time of BatchStatistics against the sum of squares before, per call
+ */
+void measure_batch_statistics( wlib::StringSink_Interface & sink )
+{
+	std::normal_distribution<double> dist( 25, 2 );
+	std::vector<double> values( 10000 );
+
+	for( double & value : values ) {
+		value = dist( random_generator );
+	}
+
+	const std::span<const double> small( values.data(), 100 );
+	volatile double result = 0;
+
+	struct Measurement {
+		const char *name;
+		std::chrono::nanoseconds before;
+		std::chrono::nanoseconds now;
+	};
+
+	const Measurement measurements[] = {
+		{ "100 doubles, span",
+		  measure( 10000, [&]( std::size_t ) { result = Sum_Of_Squares_Statistics( small ).get_variance(); } ),
+		  measure( 10000, [&]( std::size_t ) { result = exmath::statistics::BatchStatistics( small ).get_variance(); } ) },
+		{ "100 values, functor",
+		  measure( 10000, [&]( std::size_t ) { result = Sum_Of_Squares_Statistics( [&]( std::size_t i ) { return small[i]; }, small.size() ).get_variance(); } ),
+		  measure( 10000, [&]( std::size_t ) { result = exmath::statistics::BatchStatistics( [&]( std::size_t i ) { return small[i]; }, small.size() ).get_variance(); } ) },
+		{ "100 values, one at a time",
+		  measure( 10000, [&]( std::size_t ) {
+			  Sum_Of_Squares_Statistics s;
+			  for( const double value : small ) {
+				  s( value );
+			  }
+			  result = s.get_variance();
+		  } ),
+		  measure( 10000, [&]( std::size_t ) {
+			  exmath::statistics::BatchStatistics s;
+			  for( const double value : small ) {
+				  s( value );
+			  }
+			  result = s.get_variance();
+		  } ) },
+		{ "10000 doubles, span",
+		  measure( 100, [&]( std::size_t ) { result = Sum_Of_Squares_Statistics( values ).get_variance(); } ),
+		  measure( 100, [&]( std::size_t ) { result = exmath::statistics::BatchStatistics( values ).get_variance(); } ) },
+	};
+
+	for( const Measurement & m : measurements ) {
+		sink( static_format<150>( "BatchStatistics %s: %lldns, sum of squares before %lldns\n", m.name,
+				static_cast<long long>( m.now.count() ), static_cast<long long>( m.before.count() ) ).c_str() );
+	}
+}
+
+uint32_t reverse_bits( uint32_t value, unsigned bits )
+{
+	uint32_t ret = 0;
+
+	for( unsigned i = 0; i < bits; i++ ) {
+		ret = ( ret << 1 ) | ( ( value >> i ) & 1 );
+	}
+
+	return ret;
+}
+
+/**
+ * Model of the STM32H7 CRC unit, as the board programs it: 32 bit polynominal,
+ * the input is bit reversed by the size of each write (REV_IN by word, a byte
+ * write reverses the byte) and the output is bit reversed (REV_OUT).
+ */
+class CRC_Unit_Model
+{
+	uint32_t m_crc = 0;
+	uint32_t m_poly = 0;
+
+public:
+	void reset( uint32_t init, uint32_t poly )
+	{
+		m_crc = init;
+		m_poly = poly;
+	}
+
+	void write( uint32_t data, unsigned bits )
+	{
+		m_crc ^= reverse_bits( data, bits ) << ( 32 - bits );
+
+		for( unsigned i = 0; i < bits; i++ ) {
+			m_crc = ( m_crc & 0x8000'0000 ) ? ( m_crc << 1 ) ^ m_poly : m_crc << 1;
+		}
+	}
+
+	uint32_t read() const
+	{
+		return reverse_bits( m_crc, 32 );
+	}
+};
+
+/**
+ * the CRC_32 engine of the board (local_crc32_engine() of bsp_internal_fs.cpp)
+ * on the model of the CRC unit: seeded with the reversed state, words first,
+ * the rest bytewise
+ */
+uint32_t crc_32_engine_unit_model( uint32_t crc, const std::byte *data, std::size_t len ) noexcept
+{
+	CRC_Unit_Model unit;
+	unit.reset( reverse_bits( crc, 32 ), 0x04C1'1DB7 );
+
+	std::size_t i = 0;
+
+	for( ; i < ( len & ~std::size_t{ 0b11 } ); i += 4 ) {
+		uint32_t word;
+		std::memcpy( &word, data + i, sizeof( word ) );
+		unit.write( word, 32 );
+	}
+
+	for( ; i < len; i++ ) {
+		unit.write( static_cast<uint8_t>( data[i] ), 8 );
+	}
+
+	return unit.read();
+}
+
+struct CRC_Engine
+{
+	const char *name;
+	wlib::crc::CRC_32::engine_t engine;
+};
+
+const CRC_Engine crc_32_engines[] = {
+	{ "CRC_32 bytewise",       &wlib::crc::CRC_32::engine_bytewise },
+	{ "CRC_32 slicing by 4",   &wlib::crc::CRC_32::engine_slicing_by_4 },
+	{ "CRC_32 slicing by 8",   &wlib::crc::CRC_32::engine_slicing_by_8 },
+	{ "CRC_32 slicing by 16",  &wlib::crc::CRC_32::engine_slicing_by_16 },
+	{ "CRC_32 pclmul",         &wlib::crc::crc_32_engine_pclmul },
+	{ "CRC_32 CRC unit model", &crc_32_engine_unit_model },
+};
+
+/**
+ * Every CRC_32 engine against the bytewise one, for all lengths up to a few
+ * PCLMUL blocks, at any alignment and continued over a split, and against
+ * the check value of the CRC catalogue (CRC of "123456789").
+ */
+bool check_crc( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t MAX_LENGTH = 1100;
+
+	std::uniform_int_distribution<unsigned> dist( 0, 255 );
+	std::vector<std::byte> data( MAX_LENGTH + 16 );
+
+	for( std::byte & b : data ) {
+		b = static_cast<std::byte>( dist( random_generator ) );
+	}
+
+	const char check[] = "123456789";
+	std::vector<Result> results;
+
+	for( const CRC_Engine & e : crc_32_engines ) {
+		std::size_t mismatches = 0;
+
+		for( std::size_t len = 0; len <= MAX_LENGTH; len++ ) {
+			const std::byte *begin = data.data() + len % 16;
+			const uint32_t reference = wlib::crc::CRC_32::engine_bytewise( 0xFFFF'FFFF, begin, len );
+			const std::size_t split = len / 3;
+
+			if( e.engine( 0xFFFF'FFFF, begin, len ) != reference ||
+				e.engine( e.engine( 0xFFFF'FFFF, begin, split ), begin + split, len - split ) != reference ) {
+				mismatches++;
+			}
+		}
+
+		wlib::crc::CRC_32::set_engine( e.engine );
+
+		if( wlib::crc::CRC_32::calculate( std::as_bytes( std::span( check, 9 ) ) ) != 0xCBF4'3926 ) {
+			mismatches++;
+		}
+
+		wlib::crc::CRC_32::set_engine( nullptr );
+
+		results.push_back( { e.name, static_cast<double>( mismatches ), 0, "mismatches" } );
+	}
+
+	return print_results( sink, results );
+}
+
+/**
+ * throughput of each CRC_32 engine over 1MB, the model of the CRC unit
+ * is left out, its time says nothing about the unit
+ */
+void measure_crc( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t SIZE = 1024 * 1024;
+	constexpr std::size_t COUNT = 10;
+
+	const std::vector<std::byte> data( SIZE, std::byte{ 0x5a } );
+	volatile uint32_t result = 0;
+
+	for( const CRC_Engine & e : crc_32_engines ) {
+		if( e.engine == &crc_32_engine_unit_model ) {
+			continue;
+		}
+
+		const std::chrono::nanoseconds duration = measure( COUNT, [&]( std::size_t ) {
+			result = e.engine( 0xFFFF'FFFF, data.data(), data.size() );
+		});
+
+		sink( static_format<150>( "%s: %.0fMB/s%s\n", e.name, static_cast<double>( SIZE ) * 1E3 / duration.count(),
+				e.engine == &wlib::crc::crc_32_engine_pclmul && !wlib::crc::is_crc_32_pclmul_supported() ? " (no PCLMULQDQ, slicing by 16)" : "" ).c_str() );
+	}
+}
+
+std::string to_hex( const wlib::hash::sha_256::hash_t & hash )
+{
+	std::string ret;
+
+	for( std::byte b : hash ) {
+		ret += static_format<3>( "%02x", static_cast<unsigned>( b ) ).c_str();
+	}
+
+	return ret;
+}
+
+/**
+ * The known answers of FIPS 180-2 for sha_256, with and without the SHA extensions:
+ * hashed at once, in pieces of 1 and 7 bytes (the pending block is topped up) and as
+ * a group of the multi-buffer calculate(), where the messages share some blocks.
+ */
+bool check_sha_256( wlib::StringSink_Interface & sink )
+{
+	struct Known_Answer
+	{
+		std::string data;
+		std::string_view hash;
+	};
+
+	const Known_Answer known_answers[] = {
+		{ "", "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855" },
+		{ "abc", "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad" },
+		{ "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq", "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1" },
+		{ std::string( 1'000'000, 'a' ), "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0" },
+	};
+
+	std::vector<Result> results;
+
+	for( bool sha_ni : { false, true } ) {
+		if( sha_ni && !wlib::hash::sha_256::is_sha_ni_supported() ) {
+			sink( "sha_256 SHA extensions: not supported by this CPU\n" );
+			continue;
+		}
+
+		wlib::hash::sha_256::set_sha_ni_enabled( sha_ni );
+
+		std::size_t mismatches = 0;
+		std::vector<std::span<const std::byte>> messages;
+
+		for( const Known_Answer & known_answer : known_answers ) {
+			const auto data = std::as_bytes( std::span( known_answer.data ) );
+			messages.push_back( data );
+
+			for( std::size_t piece : { data.size(), std::size_t{ 1 }, std::size_t{ 7 } } ) {
+				wlib::hash::sha_256 sha;
+
+				for( std::size_t pos = 0; pos < data.size(); pos += piece ) {
+					sha( data.subspan( pos, std::min( piece, data.size() - pos ) ) );
+				}
+
+				if( to_hex( sha.get() ) != known_answer.hash ) {
+					mismatches++;
+				}
+			}
+		}
+
+		// a fifth message fills a second group, which has a single lane
+		messages.push_back( messages.back() );
+		std::vector<wlib::hash::sha_256::hash_t> hashes( messages.size() );
+		wlib::hash::sha_256::calculate( messages, hashes );
+
+		for( std::size_t i = 0; i < hashes.size(); i++ ) {
+			if( to_hex( hashes[i] ) != known_answers[std::min( i, std::size( known_answers ) - 1 )].hash ) {
+				mismatches++;
+			}
+		}
+
+		results.push_back( { sha_ni ? "sha_256 FIPS 180-2 SHA extensions" : "sha_256 FIPS 180-2 portable",
+							 static_cast<double>( mismatches ), 0, "mismatches" } );
+	}
+
+	wlib::hash::sha_256::set_sha_ni_enabled( true );
+
+	return print_results( sink, results );
+}
+
+/**
+ * throughput of sha_256 over 1MB, block-wise and as 8 messages of 128KB
+ * with the multi-buffer calculate(), each with and without the SHA extensions
+ */
+void measure_sha_256( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t SIZE = 1024 * 1024;
+	constexpr std::size_t NUMBER_OF_MESSAGES = 8;
+	constexpr std::size_t COUNT = 5;
+
+	std::uniform_int_distribution<unsigned> dist( 0, 255 );
+	std::vector<std::byte> data( SIZE );
+
+	for( std::byte & b : data ) {
+		b = static_cast<std::byte>( dist( random_generator ) );
+	}
+
+	std::vector<std::span<const std::byte>> messages;
+
+	for( std::size_t i = 0; i < NUMBER_OF_MESSAGES; i++ ) {
+		messages.push_back( std::span<const std::byte>( data ).subspan( i * SIZE / NUMBER_OF_MESSAGES, SIZE / NUMBER_OF_MESSAGES ) );
+	}
+
+	std::vector<wlib::hash::sha_256::hash_t> hashes( NUMBER_OF_MESSAGES );
+	volatile std::byte result{};
+
+	for( bool sha_ni : { false, true } ) {
+		if( sha_ni && !wlib::hash::sha_256::is_sha_ni_supported() ) {
+			continue;
+		}
+
+		wlib::hash::sha_256::set_sha_ni_enabled( sha_ni );
+
+		const std::chrono::nanoseconds block_wise = measure( COUNT, [&]( std::size_t ) {
+			wlib::hash::sha_256 sha;
+			sha( data );
+			result = sha.get()[0];
+		});
+
+		const std::chrono::nanoseconds multi_buffer = measure( COUNT, [&]( std::size_t ) {
+			wlib::hash::sha_256::calculate( messages, hashes );
+			result = hashes[0][0];
+		});
+
+		const char *name = sha_ni ? "SHA extensions" : "portable";
+
+		sink( static_format<150>( "sha_256 %s: %.0fMB/s, multi-buffer %dx%dKB %.0fMB/s\n", name,
+				static_cast<double>( SIZE ) * 1E3 / block_wise.count(), NUMBER_OF_MESSAGES, SIZE / NUMBER_OF_MESSAGES / 1024,
+				static_cast<double>( SIZE ) * 1E3 / multi_buffer.count() ).c_str() );
+	}
+
+	wlib::hash::sha_256::set_sha_ni_enabled( true );
+}
+
+} // namespace
+
+bool BSP::sim::math_check( wlib::StringSink_Interface & sink )
+{
+	bool success = true;
+
+	success = check_gemm( sink ) && success;
+	success = measure_gemm( sink ) && success;
+	success = check_decompositions( sink ) && success;
+	measure_decompositions( sink );
+	success = check_expressions( sink ) && success;
+	measure_expressions( sink );
+	success = check_polynominals( sink ) && success;
+	measure_polynominals( sink );
+	success = check_streaming_statistics( sink ) && success;
+	success = check_batch_statistics( sink ) && success;
+	measure_batch_statistics( sink );
+	success = check_crc( sink ) && success;
+	measure_crc( sink );
+	success = check_sha_256( sink ) && success;
+	measure_sha_256( sink );
+
+	return success;
+}
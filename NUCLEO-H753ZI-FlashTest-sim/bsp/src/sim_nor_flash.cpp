@@ -0,0 +1,225 @@
+/*
+ * NOR flash model for the simulator.
+ */
+#include <sim_nor_flash.hpp>
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <thread>
+
+namespace BSP::sim {
+
+std::size_t NorFlash::Report::get_max_erases() const
+{
+	std::size_t ret = 0;
+
+	for( const SectorStatistics & sector : sectors ) {
+		ret = std::max( ret, sector.erases );
+	}
+
+	return ret;
+}
+
+std::size_t NorFlash::Report::get_min_erases() const
+{
+	if( sectors.empty() ) {
+		return 0;
+	}
+
+	std::size_t ret = sectors[0].erases;
+
+	for( const SectorStatistics & sector : sectors ) {
+		ret = std::min( ret, sector.erases );
+	}
+
+	return ret;
+}
+
+NorFlash::NorFlash( const Configuration & conf_ )
+: conf( conf_ ),
+  data( conf_.size, std::byte(0xFF) ),
+  programmed( conf_.size / conf_.flash_word_size, false )
+{
+	report.sectors.resize( conf.size / conf.sector_size );
+
+	if( conf.file_name.empty() ) {
+		return;
+	}
+
+	// keep the content of a previous run, a new file starts erased
+	if( !std::filesystem::exists( conf.file_name ) ) {
+		std::ofstream out( conf.file_name, std::ios_base::binary );
+		out.write( reinterpret_cast<const char*>(data.data()), data.size() );
+	}
+
+	file.open( conf.file_name, std::ios_base::in | std::ios_base::out | std::ios_base::binary );
+	file.read( reinterpret_cast<char*>(data.data()), data.size() );
+	file.clear();
+
+	// a word which is not erased was programmed before
+	for( std::size_t word = 0; word < programmed.size(); word++ ) {
+		auto first = data.begin() + word * conf.flash_word_size;
+		programmed[word] = std::any_of( first, first + conf.flash_word_size, []( std::byte b ) { return b != std::byte(0xFF); } );
+	}
+}
+
+bool NorFlash::erase_page( std::size_t address, std::size_t size )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	if( address % conf.sector_size != 0 || size % conf.sector_size != 0 || address + size > conf.size ) {
+		return false;
+	}
+
+	for( std::size_t sector_address = address; sector_address < address + size; sector_address += conf.sector_size ) {
+		std::fill_n( data.begin() + sector_address, conf.sector_size, std::byte(0xFF) );
+		std::fill_n( programmed.begin() + sector_address / conf.flash_word_size, conf.sector_size / conf.flash_word_size, false );
+
+		report.sectors[sector_address / conf.sector_size].erases++;
+		report.erases++;
+
+		busy( conf.sector_erase_time );
+	}
+
+	write_through( address, size );
+
+	return true;
+}
+
+std::size_t NorFlash::write_page( std::size_t address, const std::span<const std::byte> & buffer )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	if( address % conf.flash_word_size != 0 || buffer.size() % conf.flash_word_size != 0 || address + buffer.size() > conf.size ) {
+		return 0;
+	}
+
+	std::size_t len = 0;
+
+	for( ; len < buffer.size(); len += conf.flash_word_size ) {
+		const std::size_t word = ( address + len ) / conf.flash_word_size;
+		SectorStatistics & sector = report.sectors[( address + len ) / conf.sector_size];
+
+		if( programmed[word] && conf.strict_program_once ) {
+			sector.program_violations++;
+			report.program_violations++;
+			break;
+		}
+
+		// programming can only clear bits
+		for( std::size_t i = 0; i < conf.flash_word_size; i++ ) {
+			data[address + len + i] &= buffer[len + i];
+		}
+
+		programmed[word] = true;
+		sector.programmed_words++;
+		report.programmed_words++;
+	}
+
+	// one sleep for all words, a few microseconds cannot be slept exactly
+	busy( conf.word_program_time * ( len / conf.flash_word_size ) );
+
+	report.bytes_written += len;
+	write_through( address, len );
+
+	return len;
+}
+
+std::size_t NorFlash::read_page( std::size_t address, std::span<std::byte> & buffer )
+{
+	std::lock_guard<std::mutex> lock( mutex );
+
+	if( address >= conf.size ) {
+		return 0;
+	}
+
+	const std::size_t len = std::min( buffer.size(), conf.size - address );
+	memcpy( buffer.data(), data.data() + address, len );
+
+	report.bytes_read += len;
+
+	return len;
+}
+
+const std::byte* NorFlash::map_read( std::size_t address, std::size_t size )
+{
+	if( address + size > conf.size ) {
+		return nullptr;
+	}
+
+	return data.data() + address;
+}
+
+bool NorFlash::is_word_programmed( std::size_t address ) const
+{
+	if( address >= conf.size ) {
+		return true;
+	}
+
+	std::lock_guard<std::mutex> lock( mutex );
+	return programmed[address / conf.flash_word_size];
+}
+
+NorFlash::Report NorFlash::get_report() const
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	return report;
+}
+
+void NorFlash::reset_report()
+{
+	std::lock_guard<std::mutex> lock( mutex );
+	report = Report{};
+	report.sectors.resize( conf.size / conf.sector_size );
+}
+
+void NorFlash::busy( std::chrono::microseconds duration )
+{
+	switch( conf.timing ) {
+	case Timing::None:
+		return;
+
+	case Timing::Account:
+		report.busy_time += duration;
+		return;
+
+	case Timing::Sleep:
+		report.busy_time += duration;
+		std::this_thread::sleep_for( duration );
+		return;
+	}
+}
+
+void NorFlash::write_through( std::size_t address, std::size_t size )
+{
+	if( !file.is_open() || size == 0 ) {
+		return;
+	}
+
+	file.seekp( address );
+	file.write( reinterpret_cast<const char*>(data.data() + address), size );
+	file.flush();
+}
+
+std::ostream & operator<<( std::ostream & out, const NorFlash::Report & report )
+{
+	out << "erases: " << report.erases
+		<< " (per sector min: " << report.get_min_erases() << " max: " << report.get_max_erases() << ")"
+		<< " programmed words: " << report.programmed_words
+		<< " program violations: " << report.program_violations
+		<< " bytes written: " << report.bytes_written
+		<< " bytes read: " << report.bytes_read
+		<< " busy: " << std::chrono::duration_cast<std::chrono::milliseconds>(report.busy_time).count() << "ms\n";
+
+	for( std::size_t i = 0; i < report.sectors.size(); i++ ) {
+		const NorFlash::SectorStatistics & sector = report.sectors[i];
+		out << "  sector " << i
+			<< ": erases: " << sector.erases
+			<< " programmed words: " << sector.programmed_words
+			<< " program violations: " << sector.program_violations << "\n";
+	}
+
+	return out;
+}
+
+} // namespace BSP::sim
@@ -0,0 +1,30 @@
+/*
+ * wlib::memory::Flash_Memory_Interface on top of the NOR flash model.
+ */
+#include <sim_nor_flash_memory.hpp>
+#include <stdexcept>
+
+namespace BSP::sim {
+
+void NorFlashMemory::erase( std::size_t add, std::size_t size )
+{
+	if( !flash.erase_page( add, size ) ) {
+		throw std::runtime_error( "erasing the flash failed" );
+	}
+}
+
+void NorFlashMemory::write( std::size_t add, std::span<const std::byte> data )
+{
+	if( flash.write_page( add, data ) != data.size() ) {
+		throw std::runtime_error( "programming the flash failed" );
+	}
+}
+
+void NorFlashMemory::read( std::size_t add, std::span<std::byte> data )
+{
+	if( flash.read_page( add, data ) != data.size() ) {
+		throw std::runtime_error( "reading the flash failed" );
+	}
+}
+
+} // namespace BSP::sim
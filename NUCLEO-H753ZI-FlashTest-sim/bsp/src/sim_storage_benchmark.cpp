@@ -0,0 +1,807 @@
+/*
+ * Flash wear of the wlib storage strategies on the simulated flash.
+ */
+#include <sim_storage_benchmark.hpp>
+#include <sim_nor_flash.hpp>
+#include <sim_nor_flash_memory.hpp>
+#include <bslib-Provider.hpp>
+#include <wlib-storage.hpp>
+#include <wlib-storage_log.hpp>
+#include <wlib-memory_coalescing.hpp>
+#include <wlib-BLOB.hpp>
+#include <wlib-BLOB_Schema.hpp>
+#include <static_format.h>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace Tools;
+
+namespace {
+
+enum class calibration_mode_t : uint8_t { off, single, continuous };
+
+/**
+ * record of the schema check, cache is not part of the schema
+ */
+struct calibration_t
+{
+	double timestamp;
+	float gain;
+	std::array<int16_t,3> offsets;
+	uint32_t serial;
+	calibration_mode_t mode;
+	uint8_t cache;
+};
+
+// packed in the order of the list, not of the declaration
+template <std::endian Endian>
+using calibration_schema_t = wlib::blob::basic_schema<Endian, &calibration_t::serial, &calibration_t::mode,
+		&calibration_t::offsets, &calibration_t::gain, &calibration_t::timestamp>;
+
+using calibration_schema = calibration_schema_t<std::endian::little>;
+using big_calibration_schema = calibration_schema_t<std::endian::big>;
+
+static_assert( calibration_schema::size == 23 );
+static_assert( calibration_schema::field_sizes == std::array<std::size_t,5>{ 4, 1, 6, 4, 8 } );
+static_assert( calibration_schema::offsets == std::array<std::size_t,5>{ 0, 4, 5, 11, 15 } );
+static_assert( calibration_schema::offset_of<&calibration_t::gain> == 11 );
+static_assert( calibration_schema::offset_of<&calibration_t::timestamp> == 15 );
+static_assert( calibration_schema::index_of<&calibration_t::cache> == calibration_schema::number_of_fields );
+static_assert( big_calibration_schema::offsets == calibration_schema::offsets );
+
+} // namespace
+
+template <>
+struct wlib::blob::schema_of<calibration_t>
+{
+	using type = calibration_schema;
+};
+
+namespace {
+
+constexpr std::size_t SECTOR_SIZE = 128 * 1024;
+constexpr std::size_t NUMBER_OF_SECTORS = 2;
+// more than fit into the ring, so log_storage_t wraps around
+constexpr std::size_t NUMBER_OF_SAVES = 10000;
+// value, padding and crc, one flash word
+constexpr std::size_t RECORD_SIZE = 32;
+
+using settings_t = std::array<uint32_t,4>;
+
+BSP::sim::NorFlash::Configuration create_configuration()
+{
+	BSP::sim::NorFlash::Configuration conf;
+	conf.size        = NUMBER_OF_SECTORS * SECTOR_SIZE;
+	conf.sector_size = SECTOR_SIZE;
+	// only the busy time is interesting, not the waiting
+	conf.timing      = BSP::sim::NorFlash::Timing::Account;
+
+	return conf;
+}
+
+settings_t create_settings( std::size_t idx )
+{
+	return { static_cast<uint32_t>( idx ), static_cast<uint32_t>( idx * 3 ), 0x1234, static_cast<uint32_t>( idx % 7 ) };
+}
+
+/**
+ * A flash, that is written like a memory at fixed addresses, as
+ * mirrow_storage_t does: every write reads the sectors, erases them and
+ * programs them again with the new data.
+ */
+class RewriteMemory : public wlib::memory::Non_Volatile_Memory_Interface
+{
+	BSP::sim::NorFlashMemory & flash;
+	std::vector<std::byte> sector;
+
+public:
+	explicit RewriteMemory( BSP::sim::NorFlashMemory & flash_ )
+	: flash( flash_ ),
+	  sector( flash_.get_sector_size() )
+	{}
+
+	void write( std::size_t add, std::span<const std::byte> data ) override {
+		const std::size_t sector_size = flash.get_sector_size();
+		const std::size_t word_size = flash.get_program_size();
+
+		for( std::size_t pos = 0; pos < data.size(); ) {
+			const std::size_t sector_address = ( add + pos ) / sector_size * sector_size;
+			const std::size_t offset = add + pos - sector_address;
+			const std::size_t len = std::min( data.size() - pos, sector_size - offset );
+
+			flash.read( sector_address, sector );
+			std::copy_n( data.begin() + pos, len, sector.begin() + offset );
+			flash.erase( sector_address, sector_size );
+
+			// erased words stay erased
+			for( std::size_t word = 0; word < sector_size; word += word_size ) {
+				std::span<const std::byte> word_data( sector.data() + word, word_size );
+
+				if( std::any_of( word_data.begin(), word_data.end(), []( std::byte b ) { return b != std::byte(0xFF); } ) ) {
+					flash.write( sector_address + word, word_data );
+				}
+			}
+
+			pos += len;
+		}
+	}
+
+	void flush() override {
+	}
+
+	void read( std::size_t add, std::span<std::byte> data ) override {
+		flash.read( add, data );
+	}
+};
+
+/**
+ * Forwards to the flash, but the write number fail_at fails: only torn_words
+ * flash words are started, the last of them is programmed only half, like a
+ * write interrupted by a power loss. After a power loss every access fails
+ * until restart().
+ */
+class FaultyMemory : public wlib::memory::Flash_Memory_Interface
+{
+	BSP::sim::NorFlashMemory & flash;
+	const std::size_t fail_at;
+	const std::size_t torn_words;
+	const bool power_loss;
+	std::size_t writes = 0;
+	bool off = false;
+
+public:
+	FaultyMemory( BSP::sim::NorFlashMemory & flash_, std::size_t fail_at_, std::size_t torn_words_, bool power_loss_ )
+	: flash( flash_ ),
+	  fail_at( fail_at_ ),
+	  torn_words( torn_words_ ),
+	  power_loss( power_loss_ )
+	{}
+
+	void restart() {
+		off = false;
+	}
+
+	std::size_t get_size() const override {
+		return flash.get_size();
+	}
+
+	std::size_t get_sector_size() const override {
+		return flash.get_sector_size();
+	}
+
+	std::size_t get_program_size() const override {
+		return flash.get_program_size();
+	}
+
+	void erase( std::size_t add, std::size_t size ) override {
+		check_on();
+		flash.erase( add, size );
+	}
+
+	void write( std::size_t add, std::span<const std::byte> data ) override {
+		check_on();
+
+		if( ++writes != fail_at ) {
+			flash.write( add, data );
+			return;
+		}
+
+		const std::size_t word_size = flash.get_program_size();
+
+		for( std::size_t word = 0; word < torn_words && word * word_size < data.size(); word++ ) {
+			std::vector<std::byte> word_data( data.begin() + word * word_size, data.begin() + ( word + 1 ) * word_size );
+
+			if( word + 1 == torn_words ) {
+				std::fill( word_data.begin() + word_size / 2, word_data.end(), std::byte( 0xFF ) );
+			}
+
+			flash.write( add + word * word_size, word_data );
+		}
+
+		off = power_loss;
+		throw std::runtime_error( "write failed" );
+	}
+
+	void flush() override {
+		check_on();
+	}
+
+	void read( std::size_t add, std::span<std::byte> data ) override {
+		check_on();
+		flash.read( add, data );
+	}
+
+private:
+	void check_on() {
+		if( off ) {
+			throw std::runtime_error( "power loss" );
+		}
+	}
+};
+
+/**
+ * log_storage_t with a write failing at every save of the first laps of the ring,
+ * torn after 0, 1/2 or 1 1/2 flash words of the record. After a power loss the
+ * storage is mounted again, it has to load the value saved before and to go on
+ * without programming a flash word twice. A failed write without power loss
+ * has to be retried by save().
+ */
+bool check_torn_writes( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t TORN_SECTOR_SIZE = 4096;
+	// two flash words, so a record can be torn in between
+	constexpr std::size_t TORN_RECORD_SIZE = 64;
+	constexpr std::size_t NUMBER_OF_CUTS = 400;
+	constexpr std::size_t SAVES_AFTER_CUT = 150;
+
+	BSP::sim::NorFlash::Configuration conf;
+	conf.size        = NUMBER_OF_SECTORS * TORN_SECTOR_SIZE;
+	conf.sector_size = TORN_SECTOR_SIZE;
+	conf.timing      = BSP::sim::NorFlash::Timing::None;
+
+	std::array<std::byte,TORN_RECORD_SIZE> buffer;
+	bslib::Shared_Memory_Provider provider( buffer );
+
+	using storage_t = wlib::storage::strategy::log_storage_t<settings_t>;
+
+	std::size_t power_losses = 0;
+	std::size_t failed_writes = 0;
+	std::size_t failed = 0;
+
+	for( bool power_loss : { true, false } ) {
+		for( std::size_t cut = 1; cut <= NUMBER_OF_CUTS; cut++ ) {
+			for( std::size_t torn_words = 0; torn_words <= 2; torn_words++ ) {
+				BSP::sim::NorFlash flash( conf );
+				BSP::sim::NorFlashMemory flash_memory( flash );
+				FaultyMemory memory( flash_memory, cut, torn_words, power_loss );
+
+				bool ok = true;
+				std::size_t next = 1;
+
+				try {
+					storage_t storage( memory, TORN_RECORD_SIZE, 0, NUMBER_OF_SECTORS, provider );
+
+					for( ; next <= cut + SAVES_AFTER_CUT; next++ ) {
+						storage.save( create_settings( next ) );
+					}
+
+					ok = !power_loss && storage.get_number_of_failed_writes() == 1;
+					failed_writes++;
+				} catch( const std::runtime_error & ) {
+					ok = power_loss && next == cut;
+					power_losses++;
+				}
+
+				memory.restart();
+
+				try {
+					storage_t storage( memory, TORN_RECORD_SIZE, 0, NUMBER_OF_SECTORS, provider );
+
+					// the value of the failed save is lost, the one before has to be there
+					const settings_t expected = next == 1 ? settings_t{} : create_settings( next - 1 );
+					ok = ok && storage.load() == expected;
+
+					for( ; next <= cut + SAVES_AFTER_CUT; next++ ) {
+						storage.save( create_settings( next ) );
+					}
+				} catch( const std::exception & ) {
+					ok = false;
+				}
+
+				try {
+					storage_t storage( memory, TORN_RECORD_SIZE, 0, NUMBER_OF_SECTORS, provider );
+					ok = ok && storage.load() == create_settings( cut + SAVES_AFTER_CUT );
+				} catch( const std::exception & ) {
+					ok = false;
+				}
+
+				if( !ok || flash.get_report().program_violations != 0 ) {
+					failed++;
+				}
+			}
+		}
+	}
+
+	sink( static_format<200>( "log_storage_t: %d power losses and %d failed writes within a record, %d lost or wrong values\n",
+			power_losses, failed_writes, failed ).c_str() );
+
+	return failed == 0;
+}
+
+/**
+ * appends entries of 8 bytes to the flash, each one flushed, like a log
+ * does. Without buffering each entry would program its flash word again,
+ * Write_Coalescing_Memory completes the flash words in RAM and programs
+ * runs of them at once.
+ */
+bool measure_write_coalescing( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t ENTRY_SIZE = 8;
+	constexpr std::size_t NUMBER_OF_FRAMES = 8;
+
+	BSP::sim::NorFlash flash( create_configuration() );
+	BSP::sim::NorFlashMemory flash_memory( flash );
+
+	const std::size_t word_size = flash_memory.get_program_size();
+	std::vector<std::byte> frames( NUMBER_OF_FRAMES * word_size );
+
+	// written back only when the buffer is full, the entries are appended, so all flash
+	// words are complete then. A threshold would write back the last word half filled.
+	wlib::memory::Write_Coalescing_Memory<NUMBER_OF_FRAMES>::policy_t policy;
+	policy.max_age     = std::chrono::hours( 1 );
+	policy.defer_flush = true;
+
+	wlib::memory::Write_Coalescing_Memory<NUMBER_OF_FRAMES> memory( flash_memory, frames, word_size, SECTOR_SIZE, policy );
+
+	auto create_entry = []( std::size_t idx ) {
+		std::array<std::byte,ENTRY_SIZE> entry;
+
+		for( std::size_t i = 0; i < ENTRY_SIZE; i++ ) {
+			entry[i] = static_cast<std::byte>( idx * 13 + i );
+		}
+
+		return entry;
+	};
+
+	for( std::size_t i = 0; i < NUMBER_OF_SAVES; i++ ) {
+		memory.write( i * ENTRY_SIZE, create_entry( i ) );
+		memory.flush();
+	}
+
+	memory.barrier();
+
+	bool success = flash.get_report().program_violations == 0;
+
+	for( std::size_t i = 0; success && i < NUMBER_OF_SAVES; i++ ) {
+		std::array<std::byte,ENTRY_SIZE> entry;
+		flash_memory.read( i * ENTRY_SIZE, entry );
+		success = entry == create_entry( i );
+	}
+
+	const auto & statistics = memory.get_statistics();
+
+	sink( static_format<250>( "Write_Coalescing_Memory: %d entries of %d bytes, %d bytes coalesced, %d program operations instead of %d (%d saved), "
+			"%d programmed flash words, %s\n",
+			NUMBER_OF_SAVES, ENTRY_SIZE, statistics.bytes_coalesced, statistics.program_operations, statistics.page_writes_requested,
+			statistics.get_number_of_saved_program_operations(), flash.get_report().programmed_words, success ? "ok" : "FAILED" ).c_str() );
+
+	// a unit size of 0 or a page size, that is no multiple of it, is rejected
+	for( const auto & [unit_size, page_size] : { std::pair<std::size_t,std::size_t>{ 0, SECTOR_SIZE }, { word_size, 0 }, { word_size, word_size + 8 } } ) {
+		try {
+			wlib::memory::Write_Coalescing_Memory<NUMBER_OF_FRAMES> invalid( flash_memory, frames, unit_size, page_size );
+
+			sink( static_format<150>( "Write_Coalescing_Memory: unit size %d and page size %d accepted\n", unit_size, page_size ).c_str() );
+			success = false;
+		} catch( const std::invalid_argument & ) {
+		}
+	}
+
+	return success;
+}
+
+/**
+ * MemoryBlob as it was before the bulk copies: every insert shifts the
+ * content and copies the value byte by byte, like the helpers of
+ * wlib-BLOB.hpp did. Reference for the time and the content.
+ */
+class ByteLoopBlob
+{
+	std::span<std::byte> m_data;
+	std::size_t m_pos_idx = 0;
+
+public:
+	explicit ByteLoopBlob( std::span<std::byte> data )
+	: m_data( data )
+	{}
+
+	template <typename T>
+	void insert( std::size_t offset, const T & value, std::endian endian )
+	{
+		if( offset > m_pos_idx || m_data.size() - m_pos_idx < sizeof( T ) ) {
+			throw std::out_of_range( "ByteLoopBlob full" );
+		}
+
+		for( std::size_t i = m_pos_idx; offset < i; ) {
+			--i;
+			m_data[i + sizeof( T )] = m_data[i];
+		}
+
+		const std::byte *src = reinterpret_cast<const std::byte*>( &value );
+
+		for( std::size_t i = 0; i < sizeof( T ); i++ ) {
+			m_data[offset + i] = endian == std::endian::native ? src[i] : src[sizeof( T ) - 1 - i];
+		}
+
+		m_pos_idx += sizeof( T );
+	}
+
+	template <typename T>
+	void insert_back( const T & value, std::endian endian )
+	{
+		insert( m_pos_idx, value, endian );
+	}
+
+	template <typename T>
+	void insert_front( const T & value, std::endian endian )
+	{
+		insert( 0, value, endian );
+	}
+
+	std::span<const std::byte> get_span() const
+	{
+		return m_data.first( m_pos_idx );
+	}
+};
+
+/**
+ * a record of 120 bytes: 16 x uint32_t, 8 x float, 4 x uint16_t
+ * and 2 x double, each one passed to fnc
+ */
+template <class Fnc>
+void for_each_field( std::size_t idx, Fnc fnc )
+{
+	for( uint32_t i = 0; i < 16; i++ ) {
+		fnc( static_cast<uint32_t>( idx * 16 + i ) );
+	}
+
+	for( uint32_t i = 0; i < 8; i++ ) {
+		fnc( static_cast<float>( idx ) + 0.25f * i );
+	}
+
+	for( uint32_t i = 0; i < 4; i++ ) {
+		fnc( static_cast<uint16_t>( idx + i ) );
+	}
+
+	for( uint32_t i = 0; i < 2; i++ ) {
+		fnc( static_cast<double>( idx ) / ( i + 3 ) );
+	}
+}
+
+/**
+ * Time to serialize a big-endian record field by field with the byte loops
+ * MemoryBlob used before, with the bulk copies of MemoryBlob now and with
+ * AppendWriter. All of them have to write the same bytes.
+ */
+bool measure_blob( wlib::StringSink_Interface & sink )
+{
+	constexpr std::size_t RECORD_BYTES = 120;
+	constexpr std::size_t NUMBER_OF_RECORDS = 100'000;
+	constexpr std::endian ENDIAN = std::endian::big;
+
+	std::array<std::byte,RECORD_BYTES> buffer;
+	std::array<std::byte,RECORD_BYTES> reference_back;
+	std::array<std::byte,RECORD_BYTES> reference_front;
+	volatile std::byte result{};
+	bool success = true;
+
+	auto measure = [&]( auto fnc ) {
+		const auto start = std::chrono::steady_clock::now();
+
+		for( std::size_t i = 0; i < NUMBER_OF_RECORDS; i++ ) {
+			fnc( i );
+		}
+
+		return std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ) / NUMBER_OF_RECORDS;
+	};
+
+	// the content of the last record is compared
+	auto same_as = [&]( std::span<const std::byte> content, const std::array<std::byte,RECORD_BYTES> & reference ) {
+		return content.size() == RECORD_BYTES && std::equal( content.begin(), content.end(), reference.begin() );
+	};
+
+	const std::chrono::nanoseconds old_back = measure( [&]( std::size_t idx ) {
+		ByteLoopBlob blob( buffer );
+		for_each_field( idx, [&]( auto value ) { blob.insert_back( value, ENDIAN ); } );
+		std::copy( blob.get_span().begin(), blob.get_span().end(), reference_back.begin() );
+		result = reference_back[0];
+	});
+
+	const std::chrono::nanoseconds old_front = measure( [&]( std::size_t idx ) {
+		ByteLoopBlob blob( buffer );
+		for_each_field( idx, [&]( auto value ) { blob.insert_front( value, ENDIAN ); } );
+		std::copy( blob.get_span().begin(), blob.get_span().end(), reference_front.begin() );
+		result = reference_front[0];
+	});
+
+	const std::chrono::nanoseconds new_back = measure( [&]( std::size_t idx ) {
+		wlib::blob::MemoryBlob blob( buffer );
+		for_each_field( idx, [&]( auto value ) { blob.insert_back( value, ENDIAN ); } );
+		result = blob.get_span()[0];
+
+		if( idx == NUMBER_OF_RECORDS - 1 ) {
+			success = same_as( blob.get_span(), reference_back ) && success;
+		}
+	});
+
+	const std::chrono::nanoseconds new_front = measure( [&]( std::size_t idx ) {
+		wlib::blob::MemoryBlob blob( buffer );
+		for_each_field( idx, [&]( auto value ) { blob.insert_front( value, ENDIAN ); } );
+		result = blob.get_span()[0];
+
+		if( idx == NUMBER_OF_RECORDS - 1 ) {
+			success = same_as( blob.get_span(), reference_front ) && success;
+		}
+	});
+
+	const std::chrono::nanoseconds append_writer = measure( [&]( std::size_t idx ) {
+		wlib::blob::MemoryBlob blob( buffer );
+
+		{
+			wlib::blob::AppendWriter writer( blob, RECORD_BYTES );
+			for_each_field( idx, [&]( auto value ) { writer.append( value, ENDIAN ); } );
+		}
+
+		result = blob.get_span()[0];
+
+		if( idx == NUMBER_OF_RECORDS - 1 ) {
+			success = same_as( blob.get_span(), reference_back ) && success;
+		}
+	});
+
+	auto ns = []( std::chrono::nanoseconds duration ) {
+		return static_cast<long long>( duration.count() );
+	};
+
+	sink( static_format<250>( "MemoryBlob %d byte big-endian record per field: insert_back %dns -> %dns, insert_front %dns -> %dns, "
+			"AppendWriter %dns, same content %s\n",
+			RECORD_BYTES, ns( old_back ), ns( new_back ), ns( old_front ), ns( new_front ), ns( append_writer ),
+			success ? "ok" : "FAILED" ).c_str() );
+
+	return success;
+}
+
+bool same_fields( const calibration_t & lhs, const calibration_t & rhs )
+{
+	return lhs.serial == rhs.serial && lhs.mode == rhs.mode && lhs.offsets == rhs.offsets
+		&& lhs.gain == rhs.gain && lhs.timestamp == rhs.timestamp;
+}
+
+/**
+ * the bytes of the record encoded field by field with MemoryBlob
+ */
+std::array<std::byte,calibration_schema::size> encode_field_by_field( const calibration_t & value, std::endian endian )
+{
+	std::array<std::byte,calibration_schema::size> ret;
+	wlib::blob::MemoryBlob blob( ret );
+
+	blob.insert_back( value.serial, endian );
+	blob.insert_back( static_cast<uint8_t>( value.mode ), endian );
+
+	for( const int16_t offset : value.offsets ) {
+		blob.insert_back( offset, endian );
+	}
+
+	blob.insert_back( value.gain, endian );
+	blob.insert_back( value.timestamp, endian );
+	return ret;
+}
+
+/**
+ * Round trip of wlib::blob::schema through encode / decode, a blob with the
+ * stream operators and the views, and the byte order of the encoding
+ * against the fields encoded one by one. Offsets and sizes are checked by
+ * the static_asserts above.
+ */
+bool check_blob_schema( wlib::StringSink_Interface & sink )
+{
+	const calibration_t records[] = {
+		{ 1234.5, 1.25f, { -1, 2, -300 }, 0x11223344, calibration_mode_t::single, 0xee },
+		{ -0.0, -3.5e-7f, { INT16_MIN, 0, INT16_MAX }, 0, calibration_mode_t::continuous, 0xee },
+		{ 1e300, 65504.0f, { 7, 8, 9 }, UINT32_MAX, calibration_mode_t::off, 0xee },
+	};
+
+	bool round_trip = true;
+	bool byte_order = true;
+	bool blob_stream = true;
+	bool views = true;
+	bool range_checks = true;
+
+	for( const calibration_t & record : records ) {
+		std::array<std::byte,calibration_schema::size> little;
+		std::array<std::byte,calibration_schema::size> big;
+		calibration_schema::encode( record, little );
+		big_calibration_schema::encode( record, big );
+
+		// the decoder leaves members out of the schema alone
+		calibration_t decoded{};
+		decoded.cache = 0x55;
+		calibration_schema::decode( little, decoded );
+		round_trip = round_trip && same_fields( decoded, record ) && decoded.cache == 0x55;
+
+		decoded = {};
+		big_calibration_schema::decode( big, decoded );
+		round_trip = round_trip && same_fields( decoded, record );
+
+		byte_order = byte_order
+			&& little == encode_field_by_field( record, std::endian::little )
+			&& big == encode_field_by_field( record, std::endian::big );
+
+		const calibration_schema::view view( little );
+		views = views && view.get<&calibration_t::gain>() == record.gain
+			&& view.get<&calibration_t::offsets>() == record.offsets
+			&& same_fields( view.get(), record );
+
+		// overwrite a single field in place
+		calibration_schema::mutable_view mutable_view( little );
+		mutable_view.set<&calibration_t::timestamp>( 42.0 );
+		calibration_schema::decode( little, decoded );
+		views = views && decoded.timestamp == 42.0 && decoded.gain == record.gain && decoded.serial == record.serial;
+	}
+
+	// the serial 0x11223344 at offset 0
+	{
+		std::array<std::byte,calibration_schema::size> little;
+		std::array<std::byte,calibration_schema::size> big;
+		calibration_schema::encode( records[0], little );
+		big_calibration_schema::encode( records[0], big );
+
+		const std::array<std::byte,4> little_serial = { std::byte( 0x44 ), std::byte( 0x33 ), std::byte( 0x22 ), std::byte( 0x11 ) };
+		const std::array<std::byte,4> big_serial = { std::byte( 0x11 ), std::byte( 0x22 ), std::byte( 0x33 ), std::byte( 0x44 ) };
+		byte_order = byte_order
+			&& std::equal( little_serial.begin(), little_serial.end(), little.begin() )
+			&& std::equal( big_serial.begin(), big_serial.end(), big.begin() )
+			&& little[calibration_schema::offset_of<&calibration_t::mode>] == std::byte( 1 );
+	}
+
+	try {
+		std::array<std::byte,3 * calibration_schema::size> buffer;
+		wlib::blob::MemoryBlob blob( buffer );
+
+		for( const calibration_t & record : records ) {
+			blob << record;
+		}
+
+		blob_stream = blob.get_span().size() == buffer.size()
+			&& !calibration_schema::try_insert_back( blob, records[0] );
+
+		wlib::blob::ConstMemoryBlob const_blob( blob.get_span() );
+
+		for( const calibration_t & record : records ) {
+			calibration_t decoded{};
+			const_blob >> decoded;
+			blob_stream = blob_stream && same_fields( decoded, record );
+		}
+
+		calibration_t decoded{};
+		blob_stream = blob_stream && const_blob.get_span().empty() && !calibration_schema::try_extract_front( const_blob, decoded );
+	} catch( const std::exception & error ) {
+		sink( static_format<200>( "blob schema stream: failed: %s\n", error.what() ).c_str() );
+		blob_stream = false;
+	}
+
+	// one byte too short
+	{
+		std::array<std::byte,calibration_schema::size> buffer{};
+		const std::span<std::byte> too_short = std::span<std::byte>( buffer ).first( calibration_schema::size - 1 );
+		calibration_t decoded{};
+
+		range_checks = !calibration_schema::try_encode( records[0], too_short )
+			&& !calibration_schema::try_decode( too_short, decoded )
+			&& !calibration_schema::try_view( too_short ).has_value()
+			&& calibration_schema::try_view( std::span<std::byte>( buffer ) ).has_value();
+	}
+
+	const struct {
+		const char *name;
+		bool ok;
+	} results[] = {
+		{ "round trip", round_trip },
+		{ "byte order", byte_order },
+		{ "blob stream", blob_stream },
+		{ "views", views },
+		{ "range checks", range_checks },
+	};
+
+	bool success = true;
+
+	for( const auto & result : results ) {
+		sink( static_format<150>( "blob schema %s: %s\n", result.name, result.ok ? "ok" : "FAILED" ).c_str() );
+		success = success && result.ok;
+	}
+
+	return success;
+}
+
+void print_report( wlib::StringSink_Interface & sink, const char *name, const BSP::sim::NorFlash::Report & report )
+{
+	sink( static_format<200>( "%s: %d saves, %d erases (max %d per sector), %d programmed flash words, flash busy %dms\n",
+			name, NUMBER_OF_SAVES, report.erases, report.get_max_erases(), report.programmed_words,
+			std::chrono::duration_cast<std::chrono::milliseconds>( report.busy_time ).count() ).c_str() );
+}
+
+} // namespace
+
+bool BSP::sim::storage_benchmark( wlib::StringSink_Interface & sink )
+{
+	std::array<std::byte,RECORD_SIZE> buffer;
+	bslib::Shared_Memory_Provider provider( buffer );
+
+	bool success = true;
+
+	try {
+		BSP::sim::NorFlash flash( create_configuration() );
+		BSP::sim::NorFlashMemory flash_memory( flash );
+		RewriteMemory memory( flash_memory );
+
+		wlib::storage::strategy::mirrow_storage_t<settings_t> storage( memory, RECORD_SIZE, { 0, SECTOR_SIZE }, provider );
+		flash.reset_report();
+
+		for( std::size_t i = 1; i <= NUMBER_OF_SAVES; i++ ) {
+			storage.save( create_settings( i ) );
+		}
+
+		print_report( sink, "mirrow_storage_t", flash.get_report() );
+	} catch( const std::exception & error ) {
+		sink( static_format<200>( "mirrow_storage_t: failed: %s\n", error.what() ).c_str() );
+		success = false;
+	}
+
+	try {
+		BSP::sim::NorFlash flash( create_configuration() );
+		BSP::sim::NorFlashMemory flash_memory( flash );
+
+		{
+			wlib::storage::strategy::log_storage_t<settings_t> storage( flash_memory, RECORD_SIZE, 0, NUMBER_OF_SECTORS, provider );
+			flash.reset_report();
+
+			for( std::size_t i = 1; i <= NUMBER_OF_SAVES; i++ ) {
+				storage.save( create_settings( i ) );
+			}
+		}
+
+		const BSP::sim::NorFlash::Report report = flash.get_report();
+		print_report( sink, "log_storage_t", report );
+
+		// like after a reset
+		wlib::storage::strategy::log_storage_t<settings_t> storage( flash_memory, RECORD_SIZE, 0, NUMBER_OF_SECTORS, provider );
+
+		if( storage.load() != create_settings( NUMBER_OF_SAVES ) ) {
+			sink( "log_storage_t: last value not found after a restart\n" );
+			success = false;
+		}
+
+		if( report.program_violations != 0 ) {
+			sink( "log_storage_t: programmed a flash word twice\n" );
+			success = false;
+		}
+	} catch( const std::exception & error ) {
+		sink( static_format<200>( "log_storage_t: failed: %s\n", error.what() ).c_str() );
+		success = false;
+	}
+
+	if( !check_torn_writes( sink ) ) {
+		success = false;
+	}
+
+	if( !measure_write_coalescing( sink ) ) {
+		success = false;
+	}
+
+	if( !measure_blob( sink ) ) {
+		success = false;
+	}
+
+	if( !check_blob_schema( sink ) ) {
+		success = false;
+	}
+
+	// a record size of 0 is rejected, not divided by
+	try {
+		BSP::sim::NorFlash flash( create_configuration() );
+		BSP::sim::NorFlashMemory flash_memory( flash );
+		wlib::storage::strategy::log_storage_t<settings_t> storage( flash_memory, 0, 0, NUMBER_OF_SECTORS, provider );
+
+		sink( "log_storage_t: record size 0 accepted\n" );
+		success = false;
+	} catch( const std::invalid_argument & ) {
+	}
+
+	return success;
+}
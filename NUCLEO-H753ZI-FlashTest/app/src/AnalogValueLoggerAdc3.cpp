@@ -17,18 +17,36 @@ void analog_value_logger_adc3::process()
 	  if (!timeout)
 	  {
 		std::optional<analog_values_t> tmp = this->m_input_buffer.pop_front();
+		if (!tmp.has_value())
+		{
+			continue;
+		}
+
 		while (tmp.has_value())
 		{
 			const float temperature = tmp->ext_temperature.get_mean();
 			LAST_STATE_NTC->set( NTCState( temperature ) );
 
+			this->m_ext_temperature_quantiles( temperature );
+			this->m_ext_temperature_trend( temperature );
+
 			this->m_circ_buffer.push(tmp.value());
 			tmp = this->m_input_buffer.pop_front();
 		}
+
+		// summed once per new block here, so readers only copy it
+		this->m_window = {};
+		for (analog_values_t const& el : this->m_circ_buffer)
+		{
+			this->m_window += el;
+		}
 	  }
 	  else
 	  {
 		this->m_circ_buffer.clear();
+		this->m_window                    = {};
+		this->m_ext_temperature_quantiles = {};
+		this->m_ext_temperature_trend     = exmath::statistics::ExponentialStatistics{ 0.1 };
 	  }
 	}
 }
@@ -44,27 +62,33 @@ auto analog_value_logger_adc3::print(wlib::StringSink_Interface& sink) const ->
 {
     auto tmp = this->get_analog_values();
 
-    auto buf = static_format<500>(
+    exmath::statistics::QuantileDigest<16>    quantiles;
+    exmath::statistics::ExponentialStatistics trend{ 0.1 };
+    {
+      os::lock_guard l{ this->m_mtex };
+      quantiles = this->m_ext_temperature_quantiles;
+      trend     = this->m_ext_temperature_trend;
+    }
+
+    // the first rows cover the last blocks, the percentiles and the trend all block means since the last gap of the ADC
+    auto buf = static_format<700>(
             "       NTC_max: %10.5f,        NTC_min: %10.5f,        NTC_mean: %10.5f,        NTC_var: %10.9E %d samples\n"
             "       CPU_max: %10.5f,        CPU_min: %10.5f,        CPU_mean: %10.5f,        CPU_var: %10.9E\n"
-    		"      VREF_max: %10.5f,       VREF_min: %10.5f,       VREF_mean: %10.5f,       VREF_var: %10.9E\n",
+    		"      VREF_max: %10.5f,       VREF_min: %10.5f,       VREF_mean: %10.5f,       VREF_var: %10.9E\n"
+            "       NTC_p05: %10.5f,        NTC_p50: %10.5f,         NTC_p95: %10.5f,       NTC_ewma: %10.5f of %d block means since the last gap\n",
              tmp.ext_temperature.get_max(), tmp.ext_temperature.get_min(), tmp.ext_temperature.get_mean(),
              tmp.ext_temperature.get_variance(), tmp.ext_temperature.get_number_of_values(),                                                        //
              tmp.cpu_temperature.get_max(), tmp.cpu_temperature.get_min(), tmp.cpu_temperature.get_mean(), tmp.cpu_temperature.get_variance(),            //
-             tmp.ref_voltage.get_max(), tmp.ref_voltage.get_min(), tmp.ref_voltage.get_mean(), tmp.ref_voltage.get_variance()                             //
+             tmp.ref_voltage.get_max(), tmp.ref_voltage.get_min(), tmp.ref_voltage.get_mean(), tmp.ref_voltage.get_variance(),                            //
+             quantiles.get_quantile(0.05), quantiles.get_median(), quantiles.get_quantile(0.95), trend.get_mean(), quantiles.get_number_of_values()       //
     );
     sink(buf.c_str());
 }
 
 auto analog_value_logger_adc3::get_analog_values() const -> analog_values_t
 {
-  os::lock_guard  l{ this->m_mtex };
-  analog_values_t ret;
-  for (analog_values_t const& el : this->m_circ_buffer)
-  {
-    ret += el;
-  }
-  return ret;
+  os::lock_guard l{ this->m_mtex };
+  return this->m_window;
 }
 
 analog_value_logger_adc3::analog_value_logger_adc3(wlib::publisher::Publisher_Interface<analog_values_t>& analog_value_pup,
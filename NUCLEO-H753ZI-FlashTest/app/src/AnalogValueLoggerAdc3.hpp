@@ -47,6 +47,12 @@ private:
   os::Static_MemberfunctionCallbackTask<this_t, 0>                            m_worker;
   bslib::container::SPSC<analog_values_t, 2>                                  m_input_buffer = {};
   wlib::container::circular_buffer_t<analog_values_t, 10>                     m_circ_buffer  = {};
+  // sum of m_circ_buffer, oldest first
+  analog_values_t                                                             m_window       = {};
+  // percentiles and trend of the block means of ext_temperature since the last gap of the ADC (not only
+  // the blocks of m_circ_buffer), kept here and not in the ADC interrupt
+  exmath::statistics::QuantileDigest<16>                                      m_ext_temperature_quantiles = {};
+  exmath::statistics::ExponentialStatistics                                   m_ext_temperature_trend{ 0.1 };
   wlib::StringSink_Interface&                                                 m_sink;
 };
 
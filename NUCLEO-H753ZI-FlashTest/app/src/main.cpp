@@ -13,6 +13,7 @@
 #include "bsp_internal_fs.hpp"
 #include "task_status_led.h"
 
+#include <algorithm>
 #include <bslib.hpp>
 #include <bsp.hpp>
 #include <bsp_uart_usb.hpp>
@@ -27,6 +28,16 @@
 #include <SimpleFlashFsFileBuffer.h>
 #include <unistd.h>
 #include "AnalogValueLoggerAdc3.hpp"
+#ifndef SIMULATOR
+#  include <bsp_async_flash.hpp>
+#endif
+#ifdef SIMULATOR
+#  include <sim_flash_benchmark.hpp>
+#  include <sim_container_benchmark.hpp>
+#  include <sim_container_stress.hpp>
+#  include <sim_storage_benchmark.hpp>
+#  include <sim_math_check.hpp>
+#endif
 
 using namespace Tools;
 using namespace app;
@@ -303,21 +314,33 @@ bool cmd_log_temp(wlib::StringSink_Interface& sink, std::string_view param)
 
 // USB UART reader
 
-bslib::publisher::LF_Publisher<char, 5> usb_uart_input;
+bslib::publisher::LF_Publisher<std::span<char const>, 5> usb_uart_input;
 
 void task_usb_uart_listener()
 {
+  static std::array<char, 64> buffer;
+
   while (os::this_thread::keep_running())
   {
-    auto o_ch = BSP::usb_uart_get_char();
+    std::span<char const> chars = BSP::usb_uart_read_available(buffer);
 
-    if (o_ch)
+    if (chars.empty())
     {
-      if( *o_ch ==  static_cast<char>(EOF) ) {
-    	  break;
-      }
+      continue;
+    }
 
-      usb_uart_input.notify(*o_ch);
+    // the chars in front of EOF are still delivered
+    std::size_t const len_until_eof = static_cast<std::size_t>(std::find(chars.begin(), chars.end(), static_cast<char>(EOF)) - chars.begin());
+    bool const        eof_received  = len_until_eof != chars.size();
+
+    if (len_until_eof > 0)
+    {
+      usb_uart_input.notify(chars.first(len_until_eof));
+    }
+
+    if (eof_received)
+    {
+      break;
     }
   }
 }
@@ -398,6 +421,39 @@ bool cmd_fs(wlib::StringSink_Interface& sink, std::string_view param)
 
 bool application_quit = false;
 
+#ifndef SIMULATOR
+bool cmd_update(wlib::StringSink_Interface& sink, std::string_view param)
+{
+	if( param != "erase" ) {
+		sink( "sub commands are:\n" );
+		sink( "\terase\n" );
+		return param.empty();
+	}
+
+	std::span<const std::byte> area = BSP::get_update_flash_area();
+
+	os::binary_semaphore done{ 0 };
+	bslib::flash::Semaphore_Completion<os::binary_semaphore> completion( done );
+
+	{
+		// waits for the file system, it uses the same bank
+		BSP::Flash_Controller_Guard guard( true );
+
+		if( !BSP::get_update_flash_queue().submit_erase( reinterpret_cast<std::size_t>( area.data() ), area.size(), &completion ) ) {
+			sink( "cannot submit the erase job\n" );
+			return false;
+		}
+	}
+
+	// the sectors are erased from the flash interrupt, the task only waits for the end
+	done.acquire();
+
+	const bslib::flash::job_result_t & result = *completion.get_result();
+	sink( static_format<100>( "erased %d of %d bytes: %s\n", result.done, result.size, result.success ? "ok" : "failed" ).c_str() );
+	return result.success;
+}
+#endif
+
 #ifdef SIMULATOR
 bool cmd_quit(bslib::StringSink_Interface& sink, std::string_view param)
 {
@@ -405,6 +461,33 @@ bool cmd_quit(bslib::StringSink_Interface& sink, std::string_view param)
 	application_quit = true;
 	return true;
 }
+
+bool cmd_flash_benchmark(bslib::StringSink_Interface& sink, std::string_view param)
+{
+	BSP::sim::flash_benchmark( sink );
+	return true;
+}
+
+bool cmd_container_benchmark(bslib::StringSink_Interface& sink, std::string_view param)
+{
+	BSP::sim::container_benchmark( sink );
+	return true;
+}
+
+bool cmd_container_stress(bslib::StringSink_Interface& sink, std::string_view param)
+{
+	return BSP::sim::container_stress( sink );
+}
+
+bool cmd_storage_benchmark(bslib::StringSink_Interface& sink, std::string_view param)
+{
+	return BSP::sim::storage_benchmark( sink );
+}
+
+bool cmd_math_check(bslib::StringSink_Interface& sink, std::string_view param)
+{
+	return BSP::sim::math_check( sink );
+}
 #endif
 
 #ifdef _MSC_VER
@@ -527,6 +610,9 @@ int main()
   test_y2038();
 
   BSP::init_internal_fs();
+#ifndef SIMULATOR
+  BSP::init_async_flash();
+#endif
   H7TwoFace::set_lock_unlock_callback( []( bool lock ) {
 	  static os::mutex m_lock{};
 
@@ -547,8 +633,16 @@ int main()
   static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_status = { cmd_status };
   static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_fs = { cmd_fs };
   static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_log_temp = { cmd_log_temp };
+#ifndef SIMULATOR
+  static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_update = { cmd_update };
+#endif
 #ifdef SIMULATOR
   static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_quit = { cmd_quit };
+  static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_flash_benchmark = { cmd_flash_benchmark };
+  static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_container_benchmark = { cmd_container_benchmark };
+  static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_container_stress = { cmd_container_stress };
+  static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_storage_benchmark = { cmd_storage_benchmark };
+  static wlib::Function_Callback<app::Serial_Commando_Parser::CMD::callback_t::signature_t> cmd_cb_math_check = { cmd_math_check };
 #endif
 
   static char            line_buffer_parser[1024] = {};
@@ -557,8 +651,16 @@ int main()
     { "status",   "shows the device status", cmd_cb_status },
 	{ "fs", 	  "filesystem operations",   cmd_cb_fs },
 	{ "log_temp", "[enable,disable] log temperature to file", cmd_cb_log_temp },
+#ifndef SIMULATOR
+	{ "update",   "[erase] erase the update area from the flash interrupt", cmd_cb_update },
+#endif
 #ifdef SIMULATOR
 	{ "quit", 	  "quit simulator",          cmd_cb_quit },
+	{ "flash_bench", "write throughput of two flash banks, concatenated and striped", cmd_cb_flash_benchmark },
+	{ "container_bench", "throughput and latency of the bslib containers", cmd_cb_container_benchmark },
+	{ "container_stress", "multi threaded stress tests of the bslib containers", cmd_cb_container_stress },
+	{ "storage_bench", "flash erases of mirrow_storage_t and log_storage_t", cmd_cb_storage_benchmark },
+	{ "math_check", "accuracy of the optimized ex-math kernels", cmd_cb_math_check },
 #endif
   };
 
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <bslib.hpp>
+#include <span>
+
+namespace BSP
+{
+  using update_flash_queue_t = bslib::flash::Job_Queue<8>;
+
+  /*
+   * registers the flash interrupt, call once before using the queue
+   */
+  void init_async_flash();
+
+  /*
+   * Job queue of the update area (FLASH_UPDATE, bank 2), the erase and program
+   * jobs run from the flash interrupt. Addresses are absolute.
+   *
+   * Submit only while holding a Flash_Controller_Guard, it waits for
+   * the polling flash users of the task (the file system).
+   */
+  update_flash_queue_t& get_update_flash_queue();
+
+  std::span<std::byte const> get_update_flash_area();
+
+  /*
+   * Exclusive use of the flash controller by a task. Waits until the file
+   * system and the jobs of the update queue are done, so the polling drivers
+   * (H753_internal_flash_update_memory, the HAL driver) do not interfere with
+   * the jobs of the queue. The destructor programs a write buffer the
+   * polling drivers left half filled, the queue could not start else.
+   *
+   * with submit_jobs the controller is released again at once, so the jobs
+   * submitted while holding the guard can start, other tasks still wait.
+   */
+  class Flash_Controller_Guard
+  {
+  public:
+    explicit Flash_Controller_Guard(bool submit_jobs = false);
+    ~Flash_Controller_Guard();
+
+    Flash_Controller_Guard(Flash_Controller_Guard const&)            = delete;
+    Flash_Controller_Guard& operator=(Flash_Controller_Guard const&) = delete;
+
+  private:
+    bool m_owns_controller;
+  };
+}    // namespace BSP
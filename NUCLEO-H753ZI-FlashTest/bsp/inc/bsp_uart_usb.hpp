@@ -2,6 +2,7 @@
 
 #include <bslib.hpp>
 #include <optional>
+#include <span>
 
 namespace BSP
 {
@@ -12,5 +13,12 @@ namespace BSP
   wlib::StringSink_Interface& get_usb_uart_output_debug();
 
   std::optional<char> usb_uart_get_char();
+
+  /*
+   * blocks until at least one char was received and then returns all chars
+   * received without a gap, at most buffer.size()
+   * returns an empty span if nothing was received (e.g. on shutdown)
+   */
+  std::span<char const> usb_uart_read_available(std::span<char> buffer);
 }    // namespace BSP
 
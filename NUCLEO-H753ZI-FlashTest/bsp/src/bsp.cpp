@@ -26,7 +26,8 @@ namespace
   auto& get_uart_debug()
   {
     using T = uC::UART__TX_DMA__RX_IRQ;
-    static T obj(T::UART_1__TX_A_09__RX__A_10, uC::DMA_Streams::DMA_1_Stream_0, 1024 * 5);
+    static T::mem_slot_state_t slot_state[1024 * 5];
+    static T obj(T::UART_1__TX_A_09__RX__A_10, uC::DMA_Streams::DMA_1_Stream_0, 1024 * 5, slot_state);
     return obj;
   }
 }    // namespace
@@ -494,7 +494,8 @@ private:
 
   }
 
-  sensors::TDK_NTC                                                 m_ntc_sen{ sensors::TDK_NTC::TDK_8016, 10E3 };
+  // tabulated at compile time, no std::log per sample
+  static constexpr sensors::TDK_NTC_table_t<>                      m_ntc_sen{ sensors::TDK_NTC::TDK_8016, 10E3f };
   sensors::TDK_NTC                                                 m_ntc_board_sen{ sensors::TDK_NTC::TDK_8509, 10E3 };
   sensors::cpu_temperature_sensor_t                                m_cpu_temp_fnc{};
   uint32_t*                                                        m_buffer_adc1_a = nullptr;
@@ -547,7 +548,8 @@ struct BspAdcContainer
 {
 	bslib::publisher::LF_Publisher<BSP::analog_values_adc1_t, 5> pub_adc1;
 	bslib::publisher::LF_Publisher<BSP::analog_values_adc2_t, 5> pub_adc2;
-	bslib::publisher::LF_Publisher<BSP::analog_values_adc3_t, 5> pub_adc3;
+	// adc3 runs the temperature logging subscribers, keep them out of the DMA ISR
+	bslib::publisher::Deferred_LF_Publisher<BSP::analog_values_adc3_t, 5, 4> pub_adc3{ "adc3_pub" };
 
 	bsp_ADC_t	adc{ pub_adc1, bsp_ADC_t::TIM_6_TRGO, pub_adc2, bsp_ADC_t::TIM_8_TRGO, pub_adc3,  bsp_ADC_t::TIM_15_TRGO };
 
@@ -0,0 +1,103 @@
+#include <bsp_async_flash.hpp>
+#include <bslib-h753_async_flash_backend.hpp>
+#include <bslib-h753_flash_controller.hpp>
+#include <chrono>
+#include <os.hpp>
+#include <uC_IRQ_Manager.hpp>
+
+extern "C" uint32_t _FLASH_UPDATE;
+extern "C" uint32_t _FLASH_UPDATE_SIZE;
+
+namespace
+{
+  os::mutex& get_flash_mutex()
+  {
+    // taken by the tasks, the interrupt only uses BSP::H753_flash_controller
+    static os::mutex obj;
+    return obj;
+  }
+
+  BSP::H753_async_flash_backend& get_update_flash_backend()
+  {
+    static BSP::H753_async_flash_backend obj{ 2 };
+    return obj;
+  }
+
+  // programs a write buffer a polling driver left half filled and locks the bank, else the backend refuses to start
+  void flush_write_buffer(uint32_t volatile& key, uint32_t volatile& cr, uint32_t volatile& sr)
+  {
+    if ((sr & FLASH_SR_WBNE) == 0 && (cr & FLASH_CR_PG) == 0)
+    {
+      return;
+    }
+
+    if ((cr & FLASH_CR_LOCK) != 0)
+    {
+      key = 0x4567'0123;
+      key = 0xCDEF'89AB;
+    }
+
+    if ((sr & FLASH_SR_WBNE) != 0)
+    {
+      cr |= FLASH_CR_FW;
+      while ((sr & FLASH_SR_QW) != 0)
+      {
+      }
+    }
+
+    cr &= ~FLASH_CR_PG;
+    cr |= FLASH_CR_LOCK;
+  }
+}    // namespace
+
+namespace BSP
+{
+  void init_async_flash()
+  {
+    // the backend of each bank checks its own status register, only bank 2 is used
+    static wlib::Memberfunction_Callback<H753_async_flash_backend, void()> cb{ get_update_flash_backend(), &H753_async_flash_backend::irq_handler };
+
+    get_update_flash_queue();
+    uC::IRQ_Manager::register_flash_irq(cb, 6);
+  }
+
+  update_flash_queue_t& get_update_flash_queue()
+  {
+    static update_flash_queue_t obj{ get_update_flash_backend() };
+    return obj;
+  }
+
+  std::span<std::byte const> get_update_flash_area()
+  {
+    return { reinterpret_cast<std::byte const*>(&_FLASH_UPDATE), reinterpret_cast<std::size_t>(&_FLASH_UPDATE_SIZE) };
+  }
+
+  Flash_Controller_Guard::Flash_Controller_Guard(bool submit_jobs)
+      : m_owns_controller{ !submit_jobs }
+  {
+    get_flash_mutex().lock();
+
+    // the queue releases the controller after its last job
+    while (!H753_flash_controller::try_lock())
+    {
+      os::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    if (submit_jobs)
+    {
+      H753_flash_controller::unlock();
+    }
+  }
+
+  Flash_Controller_Guard::~Flash_Controller_Guard()
+  {
+    if (this->m_owns_controller)
+    {
+      flush_write_buffer(FLASH->KEYR1, FLASH->CR1, FLASH->SR1);
+      flush_write_buffer(FLASH->KEYR2, FLASH->CR2, FLASH->SR2);
+      H753_flash_controller::unlock();
+    }
+
+    get_flash_mutex().unlock();
+  }
+}    // namespace BSP
@@ -1,4 +1,5 @@
 #include <bsp_internal_fs.hpp>
+#include <bsp_async_flash.hpp>
 #include <bslib-h753_internal_flash_update_memory.hpp>
 #include "stm32h7xx_hal_rcc.h"
 #include "H7TwoFace.h"
@@ -7,6 +8,9 @@
 #include "stm32h753_flash_config.h"
 #include <CpputilsDebug.h>
 #include <static_format.h>
+#include <cstring>
+#include <os.hpp>
+#include <wlib-CRC_32.hpp>
 
 using namespace BSP;
 using namespace stm32_internal_flash;
@@ -24,23 +28,36 @@ static void local_crc32_enable() {
   __HAL_RCC_CRC_CLK_ENABLE();
 } 
 
-static uint32_t local_crc32(const std::byte *buffer, size_t size) {
+static os::mutex & local_crc32_mutex() {
+  // the CRC unit is shared by the filesystem and every wlib::crc::CRC_32 object
+  static os::mutex mtx;
+  return mtx;
+}
+
+/**
+ * continues the raw (reflected, not inverted) CRC-32 register crc with the CRC unit,
+ * usable as wlib::crc::CRC_32 engine
+ */
+static uint32_t local_crc32_engine(uint32_t crc, const std::byte *buffer, size_t size) noexcept {
+  os::lock_guard<os::mutex> lock(local_crc32_mutex());
+
   // If the clock was turned on previously and kept on then it isn't necessary to do that here each time.
   // Did it here to match ST's example in AN4187 (page 8)
   // https://www.st.com/resource/en/application_note/dm00068118-using-the-crc-peripheral-in-the-stm32-family-stmicroelectronics.pdf)
   //__HAL_RCC_CRC_CLK_ENABLE();
   // For standard (Ethernet) CRC-32 bit order is reversed on input and output
   CRC->CR = CRC_CR_REV_IN_0 | CRC_CR_REV_IN_1 | CRC_CR_REV_OUT;
-  // The initial value and polynomial are set up during initialization.
-  // Conveniently, in my case, the reset values are already correct:
-  CRC->INIT = 0xFFFFFFFF;
+  // The unit works on the not reflected register, so the reflected state is reversed back
+  CRC->INIT = __RBIT(crc);
   CRC->POL = 0x04C11DB7;
   CRC->CR |= CRC_CR_RESET;
   uint32_t i = 0;
   // First work on as many full 32-bit words as we can
-  uint32_t full_word_bytes = size & 0b11;
+  uint32_t full_word_bytes = size & ~uint32_t{0b11};
   while (i < full_word_bytes) {
-    CRC->DR = *(uint32_t*)&buffer[i];
+    uint32_t word;
+    std::memcpy(&word, &buffer[i], sizeof(word));
+    CRC->DR = word;
     i += 4;
   }
   // Now handle any additional bytes one at a time
@@ -48,13 +65,16 @@ static uint32_t local_crc32(const std::byte *buffer, size_t size) {
     // Here we are using 8-bit access to the CRC peripheral's data register
     // so it does not introduce padding into the computation.
     // (e.g. the CRC of 4 zeros is different than for only 1)
-    *(uint8_t*)&CRC->DR = static_cast<uint8_t>(buffer[i]);
+    *(volatile uint8_t*)&CRC->DR = static_cast<uint8_t>(buffer[i]);
     i++;
   }
+  // REV_OUT: the result already is the reflected register
+  return CRC->DR;
+}
+
+static uint32_t local_crc32(const std::byte *buffer, size_t size) {
   // For standard (Ethernet) CRC-32 output bits need to all flip
-  i = CRC->DR ^ 0xFFFFFFFF;
-  //__HAL_RCC_CRC_CLK_DISABLE();
-  return i;
+  return local_crc32_engine(0xFFFFFFFF, buffer, size) ^ 0xFFFFFFFF;
 }
 
 
@@ -76,6 +96,7 @@ public:
 	}
 
 	std::size_t write( std::size_t address, const std::byte *data, std::size_t size ) override {
+		Flash_Controller_Guard guard;
 		return driver.write_page( address, std::span( data, size ) );
 	}
 
@@ -85,6 +106,7 @@ public:
 	}
 
 	void erase( std::size_t address, std::size_t size ) override {
+		Flash_Controller_Guard guard;
 		driver.erase_page( address, size );
 	}
 
@@ -112,6 +134,9 @@ public:
 
 	std::size_t write( std::size_t address, const std::byte *data, std::size_t size ) override {
 
+		// the jobs of the update flash queue use the same bank
+		Flash_Controller_Guard guard;
+
 		set_page_tested( address, size, false );
 
 		bool *val = get_page_written( address, size );
@@ -164,6 +189,8 @@ public:
 
 	void erase( std::size_t address, std::size_t size ) override
 	{
+		Flash_Controller_Guard guard;
+
 		set_page_tested( address, size, false );
 		set_page_written( address, size, false );
 		base_t::erase( address, size );
@@ -295,6 +322,7 @@ void BSP::init_internal_fs()
   local_crc32_enable();
 
   H7TwoFace::set_crc32_func(local_crc32);
+  wlib::crc::CRC_32::set_engine(local_crc32_engine);
 #else
   init_fs();
 #endif
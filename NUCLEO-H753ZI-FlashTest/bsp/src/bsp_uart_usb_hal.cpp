@@ -80,6 +80,25 @@ std::optional<char> BSP::usb_uart_get_char()
   return {};
 }
 
+std::span<char const> BSP::usb_uart_read_available(std::span<char> buffer)
+{
+  if( buffer.empty() ) {
+	  return {};
+  }
+
+  if( HAL_UART_Receive(&huart3, (uint8_t*)buffer.data(), 1, HAL_MAX_DELAY) != HAL_OK ) {
+	  return {};
+  }
+
+  // collect the rest of the burst, a gap of one tick ends it
+  std::size_t len = 1;
+  while( len < buffer.size() && HAL_UART_Receive(&huart3, (uint8_t*)&buffer[len], 1, 1) == HAL_OK ) {
+	  len++;
+  }
+
+  return buffer.first(len);
+}
+
 void BSP::init_uart_usb()
 {
   MX_USART3_UART_Init();
@@ -8,6 +8,8 @@
 #include "GenericFlashDriver.h"
 #include <alloca.h>
 #include <string.h>
+#include <algorithm>
+#include <array>
 
 namespace stm32_internal_flash {
 
@@ -32,6 +34,154 @@ std::size_t GenericFlashDriver::get_page_size() const
 }
 
 std::size_t GenericFlashDriver::write( std::size_t address, const std::span<const std::byte> & data )
+{
+	if( !properties.DeltaProgramming ) {
+		return write_erase( address, data );
+	}
+
+	const std::size_t page_size = get_page_size();
+	std::size_t len_written = 0;
+
+	// page by page, so only the pages with changed programmed flash words are erased
+	while( len_written < data.size() ) {
+		const std::size_t current_address = address + len_written;
+		const std::size_t len = std::min( page_size - current_address % page_size, data.size() - len_written );
+		auto slice = data.subspan( len_written, len );
+
+		std::size_t len_slice = 0;
+
+		if( auto len_delta = write_delta( current_address, slice ); len_delta ) {
+			len_slice = *len_delta;
+		} else {
+			len_slice = write_erase( current_address, slice );
+		}
+
+		len_written += len_slice;
+
+		if( len_slice != len ) {
+			return len_written;
+		}
+	}
+
+	return len_written;
+}
+
+std::optional<std::size_t> GenericFlashDriver::write_delta( std::size_t address, const std::span<const std::byte> & data )
+{
+	const std::size_t write_size = raw_driver.get_write_size();
+
+	if( write_size == 0 || write_size > MAX_WRITE_SIZE || get_page_size() % write_size != 0 ) {
+		return {};
+	}
+
+	const std::size_t first_word_address = address - address % write_size;
+	const std::size_t end_address = address + data.size();
+	const std::size_t last_word_end_address = end_address + ( write_size - end_address % write_size ) % write_size;
+
+	const std::byte *current = raw_driver.map_read( first_word_address, last_word_end_address - first_word_address );
+
+	if( !current ) {
+		return {};
+	}
+
+	std::array<std::byte,MAX_WRITE_SIZE> word_buffer;
+	std::span<std::byte> word( word_buffer.data(), write_size );
+
+	// content of the flash word after the write
+	auto get_new_word = [&]( std::size_t word_address ) {
+		const std::byte *current_word = current + ( word_address - first_word_address );
+		memcpy( word.data(), current_word, write_size );
+
+		const std::size_t start = std::max( word_address, address );
+		const std::size_t end = std::min( word_address + write_size, end_address );
+		memcpy( word.data() + ( start - word_address ), data.data() + ( start - address ), end - start );
+
+		return current_word;
+	};
+
+	// a flash word programmed with 0xFF looks erased, only the raw driver can tell it
+	auto is_erased = [&]( std::size_t word_address, const std::byte *word_data ) {
+		return std::all_of( word_data, word_data + write_size, []( std::byte b ) {
+			return b == std::byte(0xFF);
+		}) && !raw_driver.is_word_programmed( word_address );
+	};
+
+	// first check everything, the page must not be half written, when an erase is required
+	for( std::size_t word_address = first_word_address; word_address < last_word_end_address; word_address += write_size ) {
+		const std::byte *current_word = get_new_word( word_address );
+
+		if( memcmp( current_word, word.data(), write_size ) != 0 &&
+			!is_erased( word_address, current_word ) ) {
+			// a flash word can only be programmed once after an erase
+			return {};
+		}
+	}
+
+	for( std::size_t word_address = first_word_address; word_address < last_word_end_address; word_address += write_size ) {
+		const std::byte *current_word = get_new_word( word_address );
+
+		if( memcmp( current_word, word.data(), write_size ) == 0 ) {
+			statistics.words_skipped++;
+			continue;
+		}
+
+		if( raw_driver.write_page( word_address, word ) != write_size ) {
+			// the page is erased and written again
+			return {};
+		}
+
+		statistics.words_programmed++;
+	}
+
+	if( MemoryInterface::properties.AutoErasePage ) {
+		statistics.erases_avoided++;
+	}
+
+	return data.size();
+}
+
+std::size_t GenericFlashDriver::program_page( std::size_t address, const std::span<const std::byte> & data )
+{
+	const std::size_t write_size = raw_driver.get_write_size();
+
+	if( !properties.DeltaProgramming || write_size == 0 || address % write_size != 0 || data.size() % write_size != 0 ) {
+		return raw_driver.write_page( address, data );
+	}
+
+	// runs of flash words, that are not 0xFF
+	std::size_t offset = 0;
+
+	while( offset < data.size() ) {
+		auto is_erased = [&]( std::size_t word_offset ) {
+			return std::all_of( data.begin() + word_offset, data.begin() + word_offset + write_size, []( std::byte b ) {
+				return b == std::byte(0xFF);
+			});
+		};
+
+		if( is_erased( offset ) ) {
+			statistics.words_skipped++;
+			offset += write_size;
+			continue;
+		}
+
+		std::size_t end = offset + write_size;
+
+		while( end < data.size() && !is_erased( end ) ) {
+			end += write_size;
+		}
+
+		if( raw_driver.write_page( address + offset, data.subspan( offset, end - offset ) ) != end - offset ) {
+			return offset;
+		}
+
+		statistics.words_programmed += ( end - offset ) / write_size;
+		offset = end;
+	}
+
+	return data.size();
+}
+
+std::size_t GenericFlashDriver::write_erase( std::size_t address, const std::span<const std::byte> & data )
 {
 	auto data_int = data;
 	const std::size_t page_size = get_page_size();
@@ -39,7 +189,7 @@ std::size_t GenericFlashDriver::write( std::size_t address, const std::span<cons
 
 	// address is not page aligned
 	if( const std::size_t first_slice_len = address % page_size; first_slice_len != 0 ) {
-		const std::size_t data_left_on_first_page = page_size - first_slice_len;
+		const std::size_t data_left_on_first_page = std::min( page_size - first_slice_len, data.size() );
 
 		std::size_t len = 0;
 
@@ -58,7 +208,7 @@ std::size_t GenericFlashDriver::write( std::size_t address, const std::span<cons
 		data_int = data_int.subspan( len_written );
 	}
 
-	std::size_t page_aligned_data_len = data_int.size() - len_written;
+	std::size_t page_aligned_data_len = data_int.size();
 	page_aligned_data_len -= page_aligned_data_len % page_size;
 
 	if( page_aligned_data_len > 0 ) {
@@ -69,7 +219,7 @@ std::size_t GenericFlashDriver::write( std::size_t address, const std::span<cons
 		}
 
 		auto data_to_write = data_int.subspan(0, page_aligned_data_len);
-		std::size_t len = raw_driver.write_page(address + len_written, data_to_write);
+		std::size_t len = program_page(address + len_written, data_to_write);
 		len_written += len;
 
 		if( len != data_to_write.size() ) {
@@ -124,6 +274,17 @@ std::size_t GenericFlashDriver::write_unaligned_first_page( std::size_t address,
 		return 0;
 	}
 
+	// data can end before the page, read the end of the page too
+	auto span_to_read_after = span_buffer.subspan( size_to_read_from_page + data.size() );
+
+	if( !span_to_read_after.empty() ) {
+		len = read( address + data.size(), span_to_read_after );
+
+		if( len != span_to_read_after.size() ) {
+			return 0;
+		}
+	}
+
 	// copy rest of first page into buffer
 	auto rest_of_data = span_buffer.subspan( size_to_read_from_page );
 	memcpy( rest_of_data.data(), data.data(), data.size() );
@@ -136,13 +297,13 @@ std::size_t GenericFlashDriver::write_unaligned_first_page( std::size_t address,
 	}
 
 	// now write it
-	len = raw_driver.write_page(page_start_address, span_buffer);
+	len = program_page(page_start_address, span_buffer);
 
 	if( len != span_buffer.size() ) {
 		return 0;
 	}
 
-	len -= size_to_read_from_page;
+	len -= size_to_read_from_page + span_to_read_after.size();
 
 	// amount of new data written to flash
 	// must be data.size()
@@ -194,7 +355,7 @@ std::size_t GenericFlashDriver::write_unaligned_last_page( std::size_t address,
 	}
 
 	// now write it
-	len = raw_driver.write_page(address, span_buffer);
+	len = program_page(address, span_buffer);
 
 	if( len != span_buffer.size() ) {
 		return 0;
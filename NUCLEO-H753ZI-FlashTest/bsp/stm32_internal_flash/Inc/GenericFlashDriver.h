@@ -11,6 +11,7 @@
 
 #include "RawDriverInterface.h"
 #include "MemoryInterface.h"
+#include <optional>
 
 namespace stm32_internal_flash {
 
@@ -24,15 +25,45 @@ public:
 		// GenericFlashDriver::set( GenericFlashDriver::Property::CanRestoreDataOnUnaligendWrites( false ) );
 		PropertyTypes::PropertyValue<std::span<std::byte>*> PageBuffer{};
 
+		/**
+		 * Compare the data with the current content of the flash (raw driver has
+		 * to support map_read() and get_write_size()). Unchanged flash words are
+		 * skipped, changed flash words that are still erased are programmed
+		 * without erasing the page. Only if a programmed flash word has to change,
+		 * or programming fails, the page is erased and written as before.
+		 * A flash word is only erased, if the raw driver reports it with
+		 * is_word_programmed() as not programmed.
+		 *
+		 * The H7 raw drivers (STM32InternalFlashHalRawBase) do not override
+		 * is_word_programmed(), so on the board every changed flash word forces
+		 * an erase, only writes of unchanged content are skipped. Only the
+		 * simulated NorFlash tracks the programmed words.
+		 */
+		PropertyTypes::PropertyValue<bool> DeltaProgramming{};
+
 		void set_property_changed_func( std::function<void()> property_changed_func_ ) {
 			PageBuffer.set_property_changed_func(property_changed_func_);
+			DeltaProgramming.set_property_changed_func(property_changed_func_);
 		}
 	};
 
+	struct Statistics
+	{
+		// pages written without erasing them, by DeltaProgramming
+		std::size_t erases_avoided = 0;
+		// flash words not programmed, because the content was already there
+		std::size_t words_skipped = 0;
+		std::size_t words_programmed = 0;
+	};
+
+	// largest flash word DeltaProgramming can handle
+	static constexpr std::size_t MAX_WRITE_SIZE = 32;
+
 	properties_storage_t properties;
 
 protected:
 	RawDriverInterface & raw_driver;
+	Statistics statistics{};
 
 public:
 	/**
@@ -52,7 +83,33 @@ public:
 
 	bool erase( std::size_t address, std::size_t size ) override;
 
+	const Statistics & get_statistics() const {
+		return statistics;
+	}
+
+	void reset_statistics() {
+		statistics = Statistics{};
+	}
+
 protected:
+	/**
+	 * writes data by erasing and rewriting the affected pages
+	 */
+	std::size_t write_erase( std::size_t address, const std::span<const std::byte> & data );
+
+	/**
+	 * writes data located in one page, by programming changed flash words only.
+	 * Returns std::nullopt if this is not possible or programming failed,
+	 * the page has to be erased then.
+	 */
+	std::optional<std::size_t> write_delta( std::size_t address, const std::span<const std::byte> & data );
+
+	/**
+	 * programs data to erased flash. With DeltaProgramming flash words
+	 * that are 0xFF are not programmed, so they can be written later.
+	 */
+	std::size_t program_page( std::size_t address, const std::span<const std::byte> & data );
+
 	/**
 	 * writes an unaligned amount of data, by reading the required page data before
 	 * data.size() has to be <= PAGE_SIZE
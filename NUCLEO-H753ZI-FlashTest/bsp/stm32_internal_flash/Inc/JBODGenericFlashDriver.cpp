@@ -2,18 +2,66 @@
  * @author Copyright (c) 2024 Martin Oberzalek
  */
 #include "JBODGenericFlashDriver.h"
+#include <algorithm>
 
 namespace stm32_internal_flash {
 
-std::size_t JBODGenericFlashDriver::get_size() const
+JBODGenericFlashDriver::JBODGenericFlashDriver( const std::span<MemoryInterface*> & drivers_,
+												std::size_t stripe_size_,
+												ParallelExecutor *executor_ )
+: drivers( drivers_.size() <= MAX_DRIVERS ? drivers_ : drivers_.first( 0 ) ),
+  stripe_size( stripe_size_ ),
+  executor( executor_ )
 {
-	std::size_t size = 0;
+	// no silent truncation, the data of the missing drivers would be lost
+	if( drivers_.size() > MAX_DRIVERS ) {
+		return;
+	}
 
-	for( MemoryInterface* driver : drivers ) {
-		size += driver->get_size();
+	// the sizes of the drivers don't change, so the lookup table is calculated once
+	for( std::size_t i = 0; i < drivers.size(); i++ ) {
+		address_offsets[i+1] = address_offsets[i] + drivers[i]->get_size();
+	}
+
+	if( !drivers.empty() ) {
+		equal_driver_size = drivers[0]->get_size();
+
+		for( MemoryInterface* driver : drivers ) {
+			if( driver->get_size() != equal_driver_size ) {
+				equal_driver_size = 0;
+			}
+		}
+	}
+
+	if( is_striped() ) {
+		if( drivers.empty() || !equal_driver_size ) {
+			return;
+		}
+
+		const std::size_t page_size = drivers[0]->get_page_size();
+
+		for( MemoryInterface* driver : drivers ) {
+			if( driver->get_page_size() != page_size ) {
+				return;
+			}
+		}
+
+		// a smaller stripe would erase and program the page of the driver once per stripe
+		if( stripe_size != page_size ) {
+			return;
+		}
+	}
+
+	valid = true;
+}
+
+std::size_t JBODGenericFlashDriver::get_size() const
+{
+	if( !valid ) {
+		return 0;
 	}
 
-	return size;
+	return address_offsets[drivers.size()];
 }
 
 std::size_t JBODGenericFlashDriver::get_page_size() const
@@ -24,11 +72,36 @@ std::size_t JBODGenericFlashDriver::get_page_size() const
 		max_page_size = std::max( max_page_size, driver->get_page_size() );
 	}
 
+	if( is_striped() ) {
+		return max_page_size * drivers.size();
+	}
+
 	return max_page_size;
 }
 
 bool JBODGenericFlashDriver::erase( std::size_t address, std::size_t size )
 {
+	if( !valid ) {
+		return false;
+	}
+
+	if( is_striped() ) {
+		const std::size_t page_size = get_page_size();
+
+		if( !equal_driver_size || address % page_size != 0 || size % page_size != 0 || address + size > get_size() ) {
+			return false;
+		}
+
+		// a page of the JBOD is the same page on each driver
+		std::array<bool,MAX_DRIVERS> ret{};
+
+		run_parallel( [&]( std::size_t idx ) {
+			ret[idx] = drivers[idx]->erase( address / drivers.size(), size / drivers.size() );
+		});
+
+		return std::all_of( ret.begin(), ret.begin() + drivers.size(), []( bool b ) { return b; } );
+	}
+
 	DriverInfo info = get_driver_idx_by_address( address );
 
 	if( !info ) {
@@ -40,7 +113,7 @@ bool JBODGenericFlashDriver::erase( std::size_t address, std::size_t size )
 	for( unsigned idx = info.driver_idx; idx < drivers.size(); idx++ ) {
 		MemoryInterface *driver = drivers[idx];
 
-		std::size_t local_size = std::min( driver->get_size(), size );
+		std::size_t local_size = std::min( driver->get_size() - address, size );
 
 		if( !driver->erase( address, local_size ) ) {
 			return false;
@@ -48,9 +121,11 @@ bool JBODGenericFlashDriver::erase( std::size_t address, std::size_t size )
 
 		size -= local_size;
 
-		if( driver->get_size() > size ) {
+		if( size == 0 ) {
 			return true;
 		}
+
+		address = 0;
 	}
 
 	return false;
@@ -58,37 +133,30 @@ bool JBODGenericFlashDriver::erase( std::size_t address, std::size_t size )
 
 MemoryInterface* JBODGenericFlashDriver::get_driver_by_address( std::size_t address ) const
 {
-	for( MemoryInterface* driver : drivers ) {
-		if( driver->get_size() > address ) {
-			return driver;
-		}
-		address -= driver->get_size();
-	}
-
-	return nullptr;
+	return get_driver_idx_by_address( address ).driver;
 }
 
 JBODGenericFlashDriver::DriverInfo JBODGenericFlashDriver::get_driver_idx_by_address( std::size_t address ) const
 {
 	DriverInfo info;
-	std::size_t current_address = address;
-	std::size_t address_offset = 0;
 
-	for( std::size_t i = 0; i < drivers.size(); i++ ) {
-
-		const std::size_t junk_size = drivers[i]->get_size();
+	if( address >= get_size() ) {
+		return info;
+	}
 
-		if( junk_size > address ) {
-			info.driver = drivers[i];
-			info.driver_idx = i;
-			info.address_offset = address_offset;
-			return info;
-		}
+	std::size_t idx = 0;
 
-		current_address -= junk_size;
-		address_offset += junk_size;
+	if( equal_driver_size ) {
+		idx = address / equal_driver_size;
+	} else {
+		auto end = address_offsets.begin() + drivers.size() + 1;
+		idx = std::upper_bound( address_offsets.begin() + 1, end, address ) - address_offsets.begin() - 1;
 	}
 
+	info.driver = drivers[idx];
+	info.driver_idx = idx;
+	info.address_offset = address_offsets[idx];
+
 	return info;
 }
 
@@ -130,12 +198,67 @@ std::size_t JBODGenericFlashDriver::read_write( std::size_t address, SPAN & data
 	return len;
 }
 
+template<class SPAN, class FUNC>
+std::size_t JBODGenericFlashDriver::read_write_striped( std::size_t address, SPAN & data, FUNC func )
+{
+	if( !equal_driver_size || address >= get_size() ) {
+		return 0;
+	}
+
+	const std::size_t size = std::min( data.size(), get_size() - address );
+	const std::size_t number_of_drivers = drivers.size();
+
+	// offset in data of the first stripe that failed, per driver
+	std::array<std::size_t,MAX_DRIVERS> failed_at{};
+	failed_at.fill( size );
+
+	run_parallel( [&]( std::size_t idx ) {
+		MemoryInterface *driver = drivers[idx];
+
+		for( std::size_t offset = 0; offset < size; ) {
+			const std::size_t current_address = address + offset;
+			const std::size_t stripe = current_address / stripe_size;
+			const std::size_t offset_in_stripe = current_address % stripe_size;
+			const std::size_t len = std::min( stripe_size - offset_in_stripe, size - offset );
+
+			if( stripe % number_of_drivers == idx ) {
+				const std::size_t local_address = ( stripe / number_of_drivers ) * stripe_size + offset_in_stripe;
+				auto sub_data = data.subspan( offset, len );
+
+				if( func( driver, local_address, sub_data ) != len ) {
+					failed_at[idx] = offset;
+					return;
+				}
+			}
+
+			offset += len;
+		}
+	});
+
+	return *std::min_element( failed_at.begin(), failed_at.begin() + number_of_drivers );
+}
+
+void JBODGenericFlashDriver::run_parallel( const std::function<void(std::size_t idx)> & job )
+{
+	if( executor ) {
+		executor->run( drivers.size(), job );
+		return;
+	}
+
+	for( std::size_t idx = 0; idx < drivers.size(); idx++ ) {
+		job( idx );
+	}
+}
+
 std::size_t JBODGenericFlashDriver::write( std::size_t address, const std::span<const std::byte> & data )
 {
 	auto write_func=[]( MemoryInterface *driver, std::size_t address, const std::span<const std::byte> & data ) {
 		return driver->write( address, data );
 	};
 
+	if( is_striped() ) {
+		return read_write_striped( address, data, write_func );
+	}
 
 	return read_write( address, data, write_func );
 }
@@ -146,6 +269,9 @@ std::size_t JBODGenericFlashDriver::read( std::size_t address, std::span<std::by
 		return driver->read( address, data );
 	};
 
+	if( is_striped() ) {
+		return read_write_striped( address, data, read_func );
+	}
 
 	return read_write( address, data, read_func );
 }
@@ -158,5 +284,3 @@ void JBODGenericFlashDriver::properties_changed()
 }
 
 } // namespace stm32_internal_flash
-
-
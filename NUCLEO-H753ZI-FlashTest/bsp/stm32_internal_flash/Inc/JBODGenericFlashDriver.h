@@ -11,11 +11,54 @@
 #define DRIVERS_STM32_INTERNAL_FLASH_INC_JBODGENERICFLASHDRIVER_H_
 
 #include "MemoryInterface.h"
+#include <array>
 
 namespace stm32_internal_flash {
 
+/**
+ * Striping (RAID-0): with a stripe_size > 0 the address space is interleaved:
+ * stripe 0 on driver 0, stripe 1 on driver 1, ... So large writes are spread over
+ * all drivers.
+ *
+ * In striping mode all drivers must have the same size and page size
+ * and the stripe_size must be the page size of the drivers. The page size of the JBOD is then
+ * the page size of a driver times the number of drivers, so an erased page is one page on each driver.
+ * Each stripe is written with one erase and program of a whole page, smaller stripes
+ * would cause a read-modify-write of the page for each stripe, so they are rejected.
+ * At most MAX_DRIVERS drivers are supported. An invalid configuration is rejected,
+ * operator!() returns true then and all operations fail.
+ *
+ * With an executor the operations on the drivers are done in parallel, eg. in one task
+ * per flash bank. Without, one driver after the other.
+ *
+ * Only use an executor, if the drivers can work at the same time. The HAL based
+ * drivers of the STM32H7 can't, even on different banks: HAL_FLASH_Program()
+ * takes the global HAL lock of the flash and returns HAL_BUSY for the second
+ * task, and HAL_FLASH_Lock() of the AutoLockFlash locks CR1 and CR2 together,
+ * so one bank is locked while the other one is still programming.
+ * With these drivers, use striping without an executor.
+ *
+ * The board has no executor yet, BankWorkers of the simulator is the only
+ * implementation, so the parallel operation only exists in the simulator.
+ */
 class JBODGenericFlashDriver : public MemoryInterface
 {
+public:
+	static constexpr std::size_t MAX_DRIVERS = 4;
+
+	class ParallelExecutor
+	{
+	public:
+		virtual ~ParallelExecutor() {}
+
+		/**
+		 * calls job(0) ... job(count - 1), each one in it's own task,
+		 * and returns when all have finished
+		 */
+		virtual void run( std::size_t count, const std::function<void(std::size_t idx)> & job ) = 0;
+	};
+
+protected:
 	struct DriverInfo {
 		MemoryInterface *driver         = nullptr;
 		unsigned         driver_idx     = 0;
@@ -26,19 +69,40 @@ class JBODGenericFlashDriver : public MemoryInterface
 		}
 	};
 
-protected:
-	const std::span<MemoryInterface*> & drivers;
+	const std::span<MemoryInterface*> drivers;
+	const std::size_t stripe_size;
+	ParallelExecutor *executor;
+
+	// start address of each driver, the last entry is the total size
+	std::array<std::size_t,MAX_DRIVERS + 1> address_offsets{};
+
+	// if all drivers have the same size, the driver is found by a division
+	std::size_t equal_driver_size = 0;
+
+	// false if there are too many drivers or the striping does not fit
+	bool valid = false;
 
 public:
 
-	JBODGenericFlashDriver( const std::span<MemoryInterface*> & drivers_ )
-	: drivers( drivers_ )
-	{}
+	/**
+	 * stripe_size: 0 concatenates the drivers
+	 */
+	JBODGenericFlashDriver( const std::span<MemoryInterface*> & drivers_,
+							std::size_t stripe_size_ = 0,
+							ParallelExecutor *executor_ = nullptr );
+
+	/**
+	 * true, if the configuration was rejected
+	 */
+	bool operator!() const {
+		return !valid;
+	}
 
 	std::size_t get_size() const override;
 
 	/**
-	 * returns the largest page size of the bunch of discs
+	 * returns the largest page size of the bunch of discs,
+	 * in striping mode the page size of all discs together
 	 */
 	std::size_t get_page_size() const override;
 
@@ -50,11 +114,19 @@ public:
 
 	bool erase( std::size_t address, std::size_t size ) override;
 
+	bool is_striped() const {
+		return stripe_size > 0;
+	}
+
+	void set_executor( ParallelExecutor *executor_ ) {
+		executor = executor_;
+	}
+
 private:
 	MemoryInterface* get_driver_by_address( std::size_t address ) const;
 
 	/**
-	 * returns -1 if out of range
+	 * returns an empty DriverInfo if out of range
 	 */
 	DriverInfo get_driver_idx_by_address( std::size_t address ) const;
 
@@ -62,6 +134,15 @@ private:
 	template<class SPAN, class FUNC>
 	std::size_t read_write( std::size_t address, SPAN & data, FUNC func );
 
+	/**
+	 * calls func for each stripe of data, the stripes of one driver are
+	 * handled in one job of the executor
+	 */
+	template<class SPAN, class FUNC>
+	std::size_t read_write_striped( std::size_t address, SPAN & data, FUNC func );
+
+	void run_parallel( const std::function<void(std::size_t idx)> & job );
+
 	void properties_changed() override;
 };
 
@@ -0,0 +1,354 @@
+/*
+ * Write back page cache in front of a RawDriverInterface.
+ *
+ * @author Copyright (c) 2024 Martin Oberzalek
+ */
+#include "PageCacheRawDriver.h"
+#include <algorithm>
+#include <string.h>
+
+namespace stm32_internal_flash {
+
+PageCacheRawDriver::PageCacheRawDriver( RawDriverInterface & raw_driver_, std::span<std::byte> frame_memory )
+: raw_driver( raw_driver_ )
+{
+	const std::size_t page_size = raw_driver.get_page_size();
+
+	number_of_frames = std::min( frame_memory.size() / page_size, MAX_FRAMES );
+
+	for( std::size_t i = 0; i < number_of_frames; i++ ) {
+		frames[i].data = frame_memory.data() + i * page_size;
+	}
+}
+
+PageCacheRawDriver::~PageCacheRawDriver()
+{
+	flush();
+}
+
+std::size_t PageCacheRawDriver::get_size()
+{
+	return raw_driver.get_size();
+}
+
+std::size_t PageCacheRawDriver::get_page_size()
+{
+	return raw_driver.get_page_size();
+}
+
+bool PageCacheRawDriver::erase_page( std::size_t address, std::size_t size )
+{
+	const std::size_t page_size = get_page_size();
+
+	if( address % page_size != 0 || size % page_size != 0 ) {
+		return false;
+	}
+
+	for( std::size_t page_address = address; page_address < address + size; page_address += page_size ) {
+
+		statistics.erases_requested++;
+
+		if( number_of_frames == 0 ) {
+			if( !raw_driver.erase_page( page_address, page_size ) ) {
+				return false;
+			}
+			statistics.erases_done++;
+			continue;
+		}
+
+		// no need to load the page, it will be 0xFF anyway
+		Frame *frame = get_frame( page_address, false );
+
+		if( !frame ) {
+			return false;
+		}
+
+		memset( frame->data, 0xFF, page_size );
+		frame->dirty = true;
+	}
+
+	return true;
+}
+
+std::size_t PageCacheRawDriver::write_page( std::size_t address, const std::span<const std::byte> & buffer )
+{
+	const std::size_t page_size = get_page_size();
+
+	if( address % page_size != 0 || buffer.size() % page_size != 0 ) {
+		return 0;
+	}
+
+	std::size_t len_written = 0;
+
+	for( ; len_written < buffer.size(); len_written += page_size ) {
+		const std::size_t page_address = address + len_written;
+		auto page_data = buffer.subspan( len_written, page_size );
+
+		if( find_frame( page_address ) ) {
+			statistics.write_hits++;
+		} else {
+			statistics.write_misses++;
+		}
+
+		if( number_of_frames == 0 ) {
+			if( raw_driver.write_page( page_address, page_data ) != page_size ) {
+				return len_written;
+			}
+			statistics.pages_written++;
+			continue;
+		}
+
+		Frame *frame = get_frame( page_address, true );
+
+		if( !frame ) {
+			return len_written;
+		}
+
+		// programming can only clear bits
+		for( std::size_t i = 0; i < page_size; i++ ) {
+			frame->data[i] &= page_data[i];
+		}
+
+		frame->dirty = true;
+	}
+
+	return len_written;
+}
+
+std::size_t PageCacheRawDriver::read_page( std::size_t address, std::span<std::byte> & buffer )
+{
+	const std::size_t page_size = get_page_size();
+	std::size_t len_read = 0;
+
+	while( len_read < buffer.size() ) {
+		const std::size_t current_address = address + len_read;
+		const std::size_t offset = current_address % page_size;
+		const std::size_t len = std::min( page_size - offset, buffer.size() - len_read );
+		auto target = buffer.subspan( len_read, len );
+
+		if( Frame *frame = find_frame( current_address - offset ); frame ) {
+			statistics.read_hits++;
+			touch( *frame );
+			memcpy( target.data(), frame->data + offset, len );
+		} else {
+			statistics.read_misses++;
+			if( raw_driver.read_page( current_address, target ) != len ) {
+				return len_read;
+			}
+		}
+
+		len_read += len;
+	}
+
+	return len_read;
+}
+
+bool PageCacheRawDriver::flush()
+{
+	bool ret = true;
+	const Frame *last = nullptr;
+
+	// ascending addresses, so a driver spanning multiple banks
+	// can work on one bank after the other
+	for( ;; ) {
+		Frame *next = nullptr;
+
+		for( std::size_t i = 0; i < number_of_frames; i++ ) {
+			Frame & frame = frames[i];
+
+			// behind the last one, a frame that failed stays dirty
+			if( frame.valid && frame.dirty && ( !last || frame.page_address > last->page_address ) &&
+				( !next || frame.page_address < next->page_address ) ) {
+				next = &frame;
+			}
+		}
+
+		if( !next ) {
+			return ret;
+		}
+
+		// keep the data, the next flush() or the eviction tries it again
+		if( !write_back( *next ) ) {
+			ret = false;
+		}
+
+		last = next;
+	}
+}
+
+PageCacheRawDriver::Frame* PageCacheRawDriver::find_frame( std::size_t page_address )
+{
+	for( std::size_t i = 0; i < number_of_frames; i++ ) {
+		if( frames[i].valid && frames[i].page_address == page_address ) {
+			return &frames[i];
+		}
+	}
+
+	return nullptr;
+}
+
+PageCacheRawDriver::Frame* PageCacheRawDriver::get_frame( std::size_t page_address, bool load )
+{
+	if( Frame *frame = find_frame( page_address ); frame ) {
+		touch( *frame );
+		return frame;
+	}
+
+	if( number_of_frames == 0 ) {
+		return nullptr;
+	}
+
+	// a free frame, or the least recently used one
+	Frame *frame = &frames[0];
+
+	for( std::size_t i = 0; i < number_of_frames; i++ ) {
+		if( !frames[i].valid ) {
+			frame = &frames[i];
+			break;
+		}
+
+		if( frames[i].last_used < frame->last_used ) {
+			frame = &frames[i];
+		}
+	}
+
+	if( frame->valid ) {
+		// keep the data, the caller has to report the error
+		if( !write_back( *frame ) ) {
+			return nullptr;
+		}
+		statistics.evictions++;
+	}
+
+	frame->valid = true;
+	frame->dirty = false;
+	frame->page_address = page_address;
+	touch( *frame );
+
+	if( load ) {
+		std::span<std::byte> buffer( frame->data, get_page_size() );
+		if( raw_driver.read_page( page_address, buffer ) != buffer.size() ) {
+			frame->valid = false;
+			return nullptr;
+		}
+	}
+
+	return frame;
+}
+
+bool PageCacheRawDriver::write_back( Frame & frame )
+{
+	if( !frame.dirty ) {
+		return true;
+	}
+
+	const std::size_t page_size = get_page_size();
+	const std::size_t write_size = get_program_unit();
+
+	// a flash word can only be programmed once after an erase,
+	// so the page has to be erased, if a programmed word changes
+	bool erase_required = false;
+
+	for( std::size_t offset = 0; offset < page_size && !erase_required; offset += write_size ) {
+		auto state = get_word_state( frame, offset, write_size );
+
+		if( !state ) {
+			return false;
+		}
+
+		erase_required = *state == WordState::programmed;
+	}
+
+	if( erase_required ) {
+		if( !raw_driver.erase_page( frame.page_address, page_size ) ) {
+			return false;
+		}
+
+		statistics.erases_done++;
+	}
+
+	bool programmed = false;
+
+	for( std::size_t offset = 0; offset < page_size; offset += write_size ) {
+		const std::byte *word = frame.data + offset;
+
+		if( erase_required ) {
+			// nothing to program on the erased flash
+			if( std::all_of( word, word + write_size, []( std::byte b ) { return b == std::byte(0xFF); } ) ) {
+				continue;
+			}
+		} else {
+			auto state = get_word_state( frame, offset, write_size );
+
+			if( !state ) {
+				return false;
+			}
+
+			if( *state == WordState::unchanged ) {
+				continue;
+			}
+		}
+
+		std::span<const std::byte> buffer( word, write_size );
+
+		if( raw_driver.write_page( frame.page_address + offset, buffer ) != write_size ) {
+			return false;
+		}
+
+		statistics.words_programmed++;
+		programmed = true;
+	}
+
+	if( programmed ) {
+		statistics.pages_written++;
+	}
+
+	frame.dirty = false;
+
+	return true;
+}
+
+std::size_t PageCacheRawDriver::get_program_unit()
+{
+	const std::size_t page_size = get_page_size();
+	const std::size_t write_size = raw_driver.get_write_size();
+
+	if( write_size == 0 || page_size % write_size != 0 ) {
+		return page_size;
+	}
+
+	return write_size;
+}
+
+std::optional<PageCacheRawDriver::WordState> PageCacheRawDriver::get_word_state( const Frame & frame, std::size_t offset, std::size_t size )
+{
+	std::array<std::byte,MAX_WRITE_SIZE> chunk_buffer;
+	bool changed = false;
+	bool erased = true;
+
+	// a page sized word is compared in pieces
+	for( std::size_t pos = offset; pos < offset + size; pos += MAX_WRITE_SIZE ) {
+		const std::size_t len = std::min( MAX_WRITE_SIZE, offset + size - pos );
+		std::span<std::byte> chunk( chunk_buffer.data(), len );
+
+		if( raw_driver.read_page( frame.page_address + pos, chunk ) != len ) {
+			return {};
+		}
+
+		changed |= memcmp( chunk.data(), frame.data + pos, len ) != 0;
+		erased &= std::all_of( chunk.begin(), chunk.end(), []( std::byte b ) { return b == std::byte(0xFF); } );
+	}
+
+	if( !changed ) {
+		return WordState::unchanged;
+	}
+
+	// a flash word programmed with 0xFF looks erased, only the raw driver can tell it
+	if( erased && !raw_driver.is_word_programmed( frame.page_address + offset ) ) {
+		return WordState::erased;
+	}
+
+	return WordState::programmed;
+}
+
+} // namespace smt32_internal_flash
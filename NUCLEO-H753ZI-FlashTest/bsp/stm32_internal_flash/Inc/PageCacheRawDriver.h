@@ -0,0 +1,163 @@
+/*
+ * Write back page cache in front of a RawDriverInterface.
+ *
+ * Erases and writes of a page are done in a RAM frame of page size,
+ * the page is written back once, when the frame is evicted or flush()
+ * is called. So a sequence of small unaligned writes from
+ * GenericFlashDriver to the same page costs at most one erase and one
+ * program, instead of one for each write.
+ *
+ * On write back the frame is compared with the flash, flash word by
+ * flash word (get_write_size() of the raw driver, else the whole page).
+ * Unchanged words are skipped, changed words that are still erased
+ * (is_word_programmed() of the raw driver) are programmed. Only if a
+ * programmed word changes, the page is erased and programmed again.
+ *
+ * GenericFlashDriver( PageCacheRawDriver( STM32InternalFlashHalRawH7 ) )
+ *
+ * Reads of pages that are not cached are passed through, frames are
+ * only allocated by erase and write. The least recently used frame
+ * is written back, if no frame is free.
+ *
+ * Data in dirty frames is lost on power loss. Call flush() before
+ * the data has to be on flash.
+ *
+ * @author Copyright (c) 2024 Martin Oberzalek
+ */
+
+#ifndef APP_STM32_INTERNAL_FLASH_INC_PAGECACHERAWDRIVER_H_
+#define APP_STM32_INTERNAL_FLASH_INC_PAGECACHERAWDRIVER_H_
+
+#include "RawDriverInterface.h"
+#include <array>
+#include <cstdint>
+#include <optional>
+
+namespace stm32_internal_flash {
+
+class PageCacheRawDriver : public RawDriverInterface
+{
+public:
+	static constexpr std::size_t MAX_FRAMES = 8;
+
+	struct Statistics
+	{
+		std::size_t read_hits = 0;
+		std::size_t read_misses = 0;
+		std::size_t write_hits = 0;
+		std::size_t write_misses = 0;
+
+		// erase requests of the user and erases done on the raw driver
+		std::size_t erases_requested = 0;
+		std::size_t erases_done = 0;
+
+		// pages programmed on the raw driver
+		std::size_t pages_written = 0;
+		// flash words programmed on the raw driver
+		std::size_t words_programmed = 0;
+		std::size_t evictions = 0;
+	};
+
+protected:
+	struct Frame
+	{
+		std::size_t page_address = 0;
+		std::byte *data = nullptr;
+		bool valid = false;
+		bool dirty = false;
+		uint32_t last_used = 0;
+	};
+
+	enum class WordState
+	{
+		unchanged,
+		erased,     // changed, the flash word can still be programmed
+		programmed  // changed, the flash word has been programmed already
+	};
+
+	// largest flash word, that is compared at once
+	static constexpr std::size_t MAX_WRITE_SIZE = 32;
+
+	RawDriverInterface & raw_driver;
+	std::array<Frame,MAX_FRAMES> frames{};
+	std::size_t number_of_frames = 0;
+	uint32_t usage_counter = 0;
+	Statistics statistics{};
+
+public:
+	/**
+	 * frame_memory: RAM for the frames, the number of frames is
+	 *               frame_memory.size() / page size, at most MAX_FRAMES.
+	 */
+	PageCacheRawDriver( RawDriverInterface & raw_driver_, std::span<std::byte> frame_memory );
+
+	~PageCacheRawDriver();
+
+	std::size_t get_size() override;
+	std::size_t get_page_size() override;
+
+	/**
+	 * erases the pages in the frames only. The raw driver erases the page,
+	 * when the frame is written back and a programmed flash word changes.
+	 */
+	bool erase_page( std::size_t address, std::size_t size ) override;
+
+	/**
+	 * like programming flash, data can only clear bits of the page
+	 * in the frame. Call erase_page() before.
+	 */
+	std::size_t write_page( std::size_t address, const std::span<const std::byte> & buffer ) override;
+
+	std::size_t read_page( std::size_t address, std::span<std::byte> & buffer ) override;
+
+	/**
+	 * writes back all dirty frames, in address order.
+	 * returns false, if one page could not be written, its frame stays
+	 * dirty and is written back by the next flush() or its eviction.
+	 */
+	bool flush();
+
+	std::size_t get_number_of_frames() const {
+		return number_of_frames;
+	}
+
+	const Statistics & get_statistics() const {
+		return statistics;
+	}
+
+	void reset_statistics() {
+		statistics = Statistics{};
+	}
+
+protected:
+	Frame* find_frame( std::size_t page_address );
+
+	/**
+	 * returns a frame for the page. If load is true, a newly
+	 * allocated frame is filled with the content of the flash.
+	 * Returns nullptr if the evicted frame could not be written back
+	 * (it stays in the cache) or the page could not be loaded.
+	 */
+	Frame* get_frame( std::size_t page_address, bool load );
+
+	bool write_back( Frame & frame );
+
+	/**
+	 * the flash word size of the raw driver, or the page size if it is unknown
+	 */
+	std::size_t get_program_unit();
+
+	/**
+	 * compares [offset, offset + size) of the frame with the flash.
+	 * std::nullopt if the flash could not be read.
+	 */
+	std::optional<WordState> get_word_state( const Frame & frame, std::size_t offset, std::size_t size );
+
+	void touch( Frame & frame ) {
+		frame.last_used = ++usage_counter;
+	}
+};
+
+} // namespace smt32_internal_flash
+
+#endif /* APP_STM32_INTERNAL_FLASH_INC_PAGECACHERAWDRIVER_H_ */
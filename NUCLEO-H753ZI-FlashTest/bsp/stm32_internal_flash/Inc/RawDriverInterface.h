@@ -27,6 +27,31 @@ public:
 	virtual std::size_t write_page( std::size_t address, const std::span<const std::byte> & buffer ) = 0;
 
 	virtual std::size_t read_page( std::size_t address, std::span<std::byte> & buffer ) = 0;
+
+	/**
+	 * smallest unit that can be programmed, eg the 256 bit flash word of the H7.
+	 * 0 if unknown.
+	 */
+	virtual std::size_t get_write_size() {
+		return 0;
+	}
+
+	/**
+	 * direct access to the content, if the flash is memory mapped.
+	 * nullptr if not supported.
+	 */
+	virtual const std::byte* map_read( std::size_t /* address */, std::size_t /* size */ ) {
+		return nullptr;
+	}
+
+	/**
+	 * true, if the flash word at address was programmed since the last erase.
+	 * A flash word programmed with 0xFF looks erased, but can not be programmed
+	 * a second time. Drivers that can not tell it, report every word as programmed.
+	 */
+	virtual bool is_word_programmed( std::size_t /* address */ ) const {
+		return true;
+	}
 };
 
 } // namespace smt32_internal_flash
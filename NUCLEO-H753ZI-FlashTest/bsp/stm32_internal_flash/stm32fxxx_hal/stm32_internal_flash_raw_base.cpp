@@ -71,7 +71,12 @@ bool STM32InternalFlashHalRawBase::erase_page_by_page_startaddress( std::size_t
 
 	clear_flags();
 
-	if (HAL_FLASHEx_Erase(&EraseInitStruct, &PAGEError) != HAL_OK) {
+	const HAL_StatusTypeDef ret = HAL_FLASHEx_Erase(&EraseInitStruct, &PAGEError);
+
+	// also on error, some sectors may be erased already
+	invalidate_data_cache( address, EraseInitStruct.NbSectors * sector->size );
+
+	if( ret != HAL_OK ) {
 		error = Error(Error::ErrorErasingFlash);
 		return false;
 	}
@@ -79,6 +84,16 @@ bool STM32InternalFlashHalRawBase::erase_page_by_page_startaddress( std::size_t
 	return true;
 }
 
+void STM32InternalFlashHalRawBase::invalidate_data_cache( std::size_t address, std::size_t size )
+{
+#if defined(STM32H753xx)
+	SCB_InvalidateDCache_by_Addr( reinterpret_cast<uint32_t*>(address), size );
+#else
+	(void)address;
+	(void)size;
+#endif
+}
+
 void STM32InternalFlashHalRawBase::clear_flags()
 {
 	uint32_t flags = 		   FLASH_FLAG_EOP |
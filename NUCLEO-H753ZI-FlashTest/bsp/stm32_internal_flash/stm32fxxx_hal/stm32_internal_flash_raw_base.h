@@ -64,13 +64,23 @@ public:
 	 */
 	bool erase_page( std::size_t address, std::size_t size ) override;
 
-	const std::byte* map_read( std::size_t address, std::size_t size ) {
+	/**
+	 * the flash is read via the data cache, erase_page() and write_page()
+	 * invalidate the changed range, so the mapped content is never stale.
+	 */
+	const std::byte* map_read( std::size_t address, std::size_t size ) override {
 		return conf.data_ptr + address;
 	}
 
 protected:
 	std::optional<Configuration::Sector> get_sector_from_address( std::size_t address ) const;
 	void clear_flags();
+
+	/**
+	 * invalidates the data cache after an erase or program of [address, address + size),
+	 * address is an absolute address. Nothing to do on processors without data cache.
+	 */
+	void invalidate_data_cache( std::size_t address, std::size_t size );
 };
 
 } // namespace smt32_internal_flash
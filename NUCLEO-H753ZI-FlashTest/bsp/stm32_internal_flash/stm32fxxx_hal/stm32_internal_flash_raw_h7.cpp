@@ -81,7 +81,7 @@ std::size_t STM32InternalFlashHalRawH7::write_page( std::size_t address, const s
 	clear_flags();
 
 	auto do_write = [this]( uint32_t TypeProgram, std::size_t address, const std::span<const std::byte> & buffer ) {
-		constexpr uint32_t data_step_size = 8 * sizeof(uint32_t);
+		constexpr uint32_t data_step_size = FLASH_WORD_SIZE;
 		std::size_t size_written = 0;
 		const uint32_t start_offset = reinterpret_cast<uint32_t>(conf.data_ptr);
 
@@ -124,13 +124,17 @@ std::size_t STM32InternalFlashHalRawH7::write_page( std::size_t address, const s
 
 	std::size_t size_written = 0;
 
-	if( buffer.size() % 256 == 0 ) {
+	// whole flash words, 256 bit
+	if( buffer.size() % FLASH_WORD_SIZE == 0 ) {
 		size_written = do_write( FLASH_TYPEPROGRAM_FLASHWORD, address, buffer );
 	} else {
 		error = Error(Error::ErrorUnalignedData);
 		return 0;
 	}
 
+	// also the failing flash word, it may be programmed partly
+	invalidate_data_cache( reinterpret_cast<uint32_t>(conf.data_ptr) + address, std::min( size_written + FLASH_WORD_SIZE, buffer.size() ) );
+
 	return size_written;
 }
 
@@ -14,6 +14,9 @@ namespace stm32_internal_flash {
 class STM32InternalFlashHalRawH7 : public STM32InternalFlashHalRawBase
 {
 public:
+	// one flash word, 256 bit
+	static constexpr std::size_t FLASH_WORD_SIZE = 8 * sizeof(uint32_t);
+
 	STM32InternalFlashHalRawH7( Configuration & conf )
 	 : STM32InternalFlashHalRawBase( conf )
 	{
@@ -30,6 +33,10 @@ public:
 
 	std::size_t read_page( std::size_t address, std::span<std::byte> & buffer ) override;
 
+	std::size_t get_write_size() override {
+		return FLASH_WORD_SIZE;
+	}
+
 protected:
 	virtual HAL_StatusTypeDef FLASH_Program(uint32_t TypeProgram, uint32_t FlashAddress, uint32_t DataAddress);
 };
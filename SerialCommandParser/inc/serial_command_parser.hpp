@@ -15,6 +15,7 @@ namespace app
 
     using stack_t              = os::internal::stack_t;
     using StringSink_Interface = wlib::StringSink_Interface;
+    using input_t              = std::span<char const>;
 
     class CMD
     {
@@ -48,14 +49,14 @@ namespace app
       using this_t = Parser<0>;
 
     public:
-      Parser(wlib::publisher::Publisher_Interface<char>& pub,
-             std::span<char>                             line_buffer,
-             std::span<CMD>                              cmds,
-             wlib::StringSink_Interface&                sink,
-             std::span<stack_t>                          stack);
+      Parser(wlib::publisher::Publisher_Interface<input_t>& pub,
+             std::span<char>                                line_buffer,
+             std::span<CMD>                                 cmds,
+             wlib::StringSink_Interface&                   sink,
+             std::span<stack_t>                             stack);
 
     private:
-      void notify_new_char(char const& value);
+      void notify_new_chars(input_t const& values);
       bool execute(std::string_view cmd_str);
       void process();
       bool show_help(StringSink_Interface& sink, std::string_view param);
@@ -65,7 +66,7 @@ namespace app
       std::span<stack_t>                                                  m_stack        = {};
       os::Static_MemberfunctionCallbackTask<this_t, 0>                    m_worker       = { *this, &this_t::process, m_stack, "cmd_parser" };
       wlib::Memberfunction_Callback<this_t, CMD::callback_t::signature_t> m_help_cb      = { *this, &this_t::show_help };
-      wlib::publisher::Memberfunction_CallbackSubscriber<this_t, char>    m_sub          = { *this, &this_t::notify_new_char };
+      wlib::publisher::Memberfunction_CallbackSubscriber<this_t, input_t> m_sub          = { *this, &this_t::notify_new_chars };
       CMD                                                                 m_help_cmd     = { "?", "shows help", this->m_help_cb };
       std::span<char>                                                     m_line_buffer  = {};
       std::span<CMD>                                                      m_cmds         = {};
@@ -78,7 +79,7 @@ namespace app
       std::array<stack_t, (N + sizeof(stack_t) - 1) / sizeof(stack_t)> m_stack;
 
     public:
-      Parser(wlib::publisher::Publisher_Interface<char>& pub, std::span<char> line_buffer, std::span<CMD> cmds, wlib::StringSink_Interface& sink)
+      Parser(wlib::publisher::Publisher_Interface<input_t>& pub, std::span<char> line_buffer, std::span<CMD> cmds, wlib::StringSink_Interface& sink)
           : Parser<0>(pub, line_buffer, cmds, sink, m_stack)
       {
       }
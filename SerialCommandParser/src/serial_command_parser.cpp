@@ -2,11 +2,11 @@
 
 namespace app::Serial_Commando_Parser
 {
-  Parser<0>::Parser(wlib::publisher::Publisher_Interface<char>& pub,
-                    std::span<char>                             line_buffer,
-                    std::span<CMD>                              cmds,
-                    wlib::StringSink_Interface&                sink,
-                    std::span<stack_t>                          stack)
+  Parser<0>::Parser(wlib::publisher::Publisher_Interface<input_t>& pub,
+                    std::span<char>                                line_buffer,
+                    std::span<CMD>                                 cmds,
+                    wlib::StringSink_Interface&                   sink,
+                    std::span<stack_t>                             stack)
       : m_stack(stack)
       , m_line_buffer(line_buffer)
       , m_cmds{ cmds }
@@ -18,10 +18,13 @@ namespace app::Serial_Commando_Parser
     this->print_help(sink);
   }
 
-  void Parser<0>::notify_new_char(char const& value)
+  void Parser<0>::notify_new_chars(input_t const& values)
   {
-    this->m_input_buffer.push_back(value);
-    this->m_worker.notify();
+    // chars which do not fit into the input buffer are dropped
+    if (this->m_input_buffer.push_back(values) > 0)
+    {
+      this->m_worker.notify();
+    }
   }
 
   bool Parser<0>::execute(std::string_view cmd_str)
@@ -76,41 +79,51 @@ namespace app::Serial_Commando_Parser
     {
       os::this_thread::wait_for_notify();
 
-      for (auto tmp = this->m_input_buffer.pop_front(); tmp.has_value(); tmp = this->m_input_buffer.pop_front())
+      for (std::span<char> blk = this->m_input_buffer.peak_span(); !blk.empty(); blk = this->m_input_buffer.peak_span())
       {
-        char cur = tmp.value();
-
-        if (cur == '~')
-        {
-          cmd_began = true;
-          pos       = this->m_line_buffer.data();
-          *pos      = '\0';
-          continue;
-        }
-
-        if (!cmd_began)
-          continue;
-
-        // input from a console on windows will only give us \r, so we
-        // also have to react on this
-        if (cur == '\n' || cur == '\r')
-        {
-          cmd_began = false;
-          *pos      = '\0';
-
-          if (this->execute(std::string_view{ this->m_line_buffer.data(), pos }))
-            this->m_sink("CMD SUCCESS\n");
-          else
-            this->m_sink("CMD FAIL\n");
-
-          continue;
-        }
-
-        if (pos < end)
+        std::size_t consumed = 0;
+        while (consumed < blk.size())
         {
-          *pos++ = cur;
-          continue;
+          char const cur = blk[consumed++];
+
+          if (cur == '~')
+          {
+            cmd_began = true;
+            pos       = this->m_line_buffer.data();
+            *pos      = '\0';
+            continue;
+          }
+
+          if (!cmd_began)
+            continue;
+
+          // input from a console on windows will only give us \r, so we
+          // also have to react on this
+          if (cur == '\n' || cur == '\r')
+          {
+            cmd_began = false;
+            *pos      = '\0';
+
+            // the line is copied, free its chars before the command runs, so the input is not dropped meanwhile
+            this->m_input_buffer.drop(consumed);
+            blk      = blk.subspan(consumed);
+            consumed = 0;
+
+            if (this->execute(std::string_view{ this->m_line_buffer.data(), pos }))
+              this->m_sink("CMD SUCCESS\n");
+            else
+              this->m_sink("CMD FAIL\n");
+
+            continue;
+          }
+
+          if (pos < end)
+          {
+            *pos++ = cur;
+            continue;
+          }
         }
+        this->m_input_buffer.drop(consumed);
       }
     }
   }
@@ -0,0 +1,150 @@
+#pragma once
+#ifndef BSLIB_CONTAINER_BROADCAST_RING_HPP_INCLUDED
+#define BSLIB_CONTAINER_BROADCAST_RING_HPP_INCLUDED
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <type_traits>
+
+namespace bslib::container
+{
+  /*
+   * Single producer / multi consumer broadcast ring.
+   *
+   * Every Reader has its own cursor and sees every entry written after it was
+   * created. The writer never waits for readers: it simply overwrites the
+   * oldest entry. Each slot is guarded by a sequence counter (seqlock), so a
+   * reader that was lapped by the writer detects it, skips ahead to the oldest
+   * entry still available and accounts the skipped entries as lost.
+   *
+   * Readers copy the payload while the writer may overwrite it, therefore T
+   * has to be trivially copyable. N has to be a power of 2, the slot of a
+   * position is found by masking.
+   */
+  template <typename T, std::size_t N>
+  requires(N > 1 && (N & (N - 1)) == 0 && std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>) class Broadcast_Ring
+  {
+  public:
+    using payload_t = std::remove_cv_t<T>;
+
+    static constexpr std::size_t cache_line_size = 64;
+
+    class Reader
+    {
+    public:
+      explicit Reader(Broadcast_Ring const& ring) noexcept
+          : m_ring(ring)
+          , m_pos(ring.m_w_pos.load(std::memory_order_acquire))
+      {
+      }
+
+      Reader(Reader const&)            = delete;
+      Reader(Reader&&)                 = delete;
+      Reader& operator=(Reader const&) = delete;
+      Reader& operator=(Reader&&)      = delete;
+      ~Reader()                        = default;
+
+      std::optional<payload_t> try_read() noexcept
+      {
+        while (true)
+        {
+          std::size_t const w_pos = this->m_ring.m_w_pos.load(std::memory_order_acquire);
+          if (this->m_pos == w_pos)
+            return std::nullopt;
+
+          if (w_pos - this->m_pos > number_of_entries)
+          {
+            this->skip_to(w_pos - number_of_entries);
+            continue;
+          }
+
+          payload_t ret;
+          if (this->m_ring.read_slot(this->m_pos, ret))
+          {
+            this->m_pos++;
+            return ret;
+          }
+
+          // the writer overtook us while we were copying
+          this->skip_to(this->m_ring.m_w_pos.load(std::memory_order_acquire) - number_of_entries + 1);
+        }
+      }
+
+      std::size_t get_number_of_available_entries() const noexcept
+      {
+        std::size_t const n = this->m_ring.m_w_pos.load(std::memory_order_acquire) - this->m_pos;
+        return (n > number_of_entries) ? number_of_entries : n;
+      }
+
+      std::size_t get_number_of_lost_entries() const noexcept { return this->m_lost; }
+
+      // drops everything not read so far without accounting it as lost
+      void skip_to_newest() noexcept { this->m_pos = this->m_ring.m_w_pos.load(std::memory_order_acquire); }
+
+    private:
+      void skip_to(std::size_t const& pos) noexcept
+      {
+        this->m_lost += pos - this->m_pos;
+        this->m_pos = pos;
+      }
+
+      Broadcast_Ring const& m_ring;
+      std::size_t           m_pos  = 0;
+      std::size_t           m_lost = 0;
+    };
+
+  private:
+    static constexpr std::size_t number_of_entries = N;
+    static constexpr std::size_t index_mask        = N - 1;
+
+  public:
+    inline Broadcast_Ring() noexcept = default;
+
+    // producer only
+    void push_back(payload_t const& v) noexcept
+    {
+      std::size_t const pos  = this->m_w_pos.load(std::memory_order_relaxed);
+      slot_t&           slot = this->m_slots[pos & index_mask];
+
+      // odd sequence: slot is being written
+      slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_release);
+      std::memcpy(&slot.mem, &v, sizeof(payload_t));
+      slot.seq.store(2 * pos + 2, std::memory_order_release);
+
+      this->m_w_pos.store(pos + 1, std::memory_order_release);
+    }
+
+    constexpr std::size_t get_number_of_entries() const noexcept { return number_of_entries; }
+
+    std::size_t get_number_of_written_entries() const noexcept { return this->m_w_pos.load(std::memory_order_acquire); }
+
+  private:
+    struct slot_t
+    {
+      std::atomic<std::size_t> seq = 0;
+      payload_t                mem;
+    };
+
+    bool read_slot(std::size_t const& pos, payload_t& dst) const noexcept
+    {
+      slot_t const&     slot     = this->m_slots[pos & index_mask];
+      std::size_t const expected = 2 * pos + 2;
+
+      if (slot.seq.load(std::memory_order_acquire) != expected)
+        return false;
+      std::memcpy(&dst, &slot.mem, sizeof(payload_t));
+      std::atomic_thread_fence(std::memory_order_acquire);
+      return slot.seq.load(std::memory_order_relaxed) == expected;
+    }
+
+    alignas(cache_line_size) std::atomic<std::size_t> m_w_pos = 0;
+    alignas(cache_line_size) slot_t m_slots[number_of_entries]{};
+  };
+}    // namespace bslib::container
+
+#endif
@@ -2,8 +2,12 @@
 #ifndef BSLIB_CONTAINER_HPP_INCLUDED
 #define BSLIB_CONTAINER_HPP_INCLUDED
 
+#include <bslib-Broadcast_Ring.hpp>
+#include <bslib-Epoch.hpp>
+#include <bslib-MPMC.hpp>
 #include <bslib-MPSC.hpp>
 #include <bslib-SPSC.hpp>
+#include <bslib-SPSC_aligned.hpp>
 
 
 #endif
@@ -0,0 +1,107 @@
+#pragma once
+#ifndef BSLIB_CONTAINER_EPOCH_HPP_INCLUDED
+#define BSLIB_CONTAINER_EPOCH_HPP_INCLUDED
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace bslib::container
+{
+  /*
+   * Quiescent state based reclamation with two reader counters (in the style
+   * of sleepable RCU).
+   *
+   * Readers (e.g. a notify() running in an ISR) enter a read side critical
+   * section by incrementing the counter of the current epoch parity and
+   * leave it by decrementing the same counter. They never wait and never
+   * retry.
+   *
+   * A writer first unlinks the object (e.g. stores nullptr into the slot a
+   * reader loads the pointer from) and then calls synchronize(). It flips
+   * the epoch twice and waits after each flip until the counter of the
+   * previous parity drained. Afterwards no reader can still use the unlinked
+   * object. Readers entering after a flip use the other counter, so the
+   * wait is bounded by the read side critical sections that were already
+   * running and cannot be starved by continuous readers.
+   *
+   * synchronize() must not be called from a read side critical section or
+   * from an ISR. Concurrent writers are serialized.
+   */
+  class Epoch_Domain
+  {
+  public:
+    using epoch_t = std::size_t;
+
+    class Read_Guard
+    {
+    public:
+      explicit Read_Guard(Epoch_Domain& domain) noexcept
+          : m_domain(domain)
+          , m_epoch(domain.enter())
+      {
+      }
+
+      Read_Guard(Read_Guard const&)            = delete;
+      Read_Guard(Read_Guard&&)                 = delete;
+      Read_Guard& operator=(Read_Guard const&) = delete;
+      Read_Guard& operator=(Read_Guard&&)      = delete;
+
+      ~Read_Guard() noexcept { this->m_domain.leave(this->m_epoch); }
+
+    private:
+      Epoch_Domain& m_domain;
+      epoch_t const m_epoch;
+    };
+
+    inline Epoch_Domain() noexcept = default;
+
+    /*
+     * @return epoch which has to be passed to leave()
+     */
+    epoch_t enter() noexcept
+    {
+      epoch_t const epoch = this->m_epoch.load(std::memory_order_seq_cst);
+      this->m_readers[epoch & 1].fetch_add(1, std::memory_order_seq_cst);
+      return epoch;
+    }
+
+    void leave(epoch_t const& epoch) noexcept { this->m_readers[epoch & 1].fetch_sub(1, std::memory_order_release); }
+
+    /*
+     * waits until every reader which may have seen the state before this call left
+     * wait is called repeatedly while waiting, e.g. to yield the CPU
+     */
+    template <typename wait_fnc_t>
+      requires(std::invocable<wait_fnc_t&>)
+    void synchronize(wait_fnc_t&& wait)
+    {
+      while (this->m_sync_ongoing.test_and_set(std::memory_order_acquire))
+      {
+        wait();
+      }
+
+      // the second flip catches readers that loaded the epoch before the first flip but incremented afterwards
+      for (std::size_t i = 0; i < 2; i++)
+      {
+        epoch_t const prev = this->m_epoch.fetch_add(1, std::memory_order_seq_cst);
+        while (this->m_readers[prev & 1].load(std::memory_order_seq_cst) != 0)
+        {
+          wait();
+        }
+      }
+
+      this->m_sync_ongoing.clear(std::memory_order_release);
+    }
+
+    epoch_t get_epoch() const noexcept { return this->m_epoch.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<epoch_t>     m_epoch        = 0;
+    std::atomic<std::size_t> m_readers[2]   = {};
+    std::atomic_flag         m_sync_ongoing = ATOMIC_FLAG_INIT;
+  };
+}    // namespace bslib::container
+
+#endif
@@ -0,0 +1,174 @@
+#pragma once
+#ifndef BSLIB_CONTAINER_MPMC_HPP_INCLUDED
+#define BSLIB_CONTAINER_MPMC_HPP_INCLUDED
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <optional>
+#include <type_traits>
+
+namespace bslib::container
+{
+  /*
+   * Bounded multi producer / multi consumer queue (D. Vyukov).
+   *
+   * Every cell carries a sequence number which tells producers and consumers
+   * in which lap the cell is writable / readable, so a producer or consumer
+   * only has to win one CAS on its own position counter. N has to be a power
+   * of two to keep the position -> cell mapping valid across counter overflow.
+   */
+  template <typename T, std::size_t N>
+  requires(N > 1 && (N & (N - 1)) == 0 && std::is_destructible_v<T> && (std::is_copy_constructible_v<T> || std::is_move_constructible_v<T>)) class MPMC
+  {
+  public:
+    using payload_t = std::remove_cv_t<T>;
+
+    static constexpr std::size_t cache_line_size = 64;
+
+  private:
+    using mem_payload_t                            = std::aligned_storage_t<sizeof(payload_t), alignof(payload_t)>;
+    static constexpr std::size_t number_of_entries = N;
+    static constexpr std::size_t idx_mask          = N - 1;
+
+    static constexpr bool is_copy_constructible_v         = std::is_copy_constructible_v<payload_t>;
+    static constexpr bool is_nothrow_copy_constructible_v = std::is_nothrow_copy_constructible_v<payload_t>;
+    static constexpr bool is_move_constructible_v         = std::is_move_constructible_v<payload_t>;
+    static constexpr bool is_nothrow_move_constructible_v = std::is_nothrow_move_constructible_v<payload_t>;
+    static constexpr bool is_nothrow_destructible_v       = std::is_nothrow_destructible_v<payload_t>;
+
+  public:
+    inline MPMC() noexcept
+    {
+      for (std::size_t i = 0; i < number_of_entries; i++)
+      {
+        this->m_cells[i].seq.store(i, std::memory_order_relaxed);
+      }
+    }
+
+    inline ~MPMC() noexcept(is_nothrow_destructible_v)
+    {
+      while (this->pop_front().has_value())
+      {
+      }
+    }
+
+    template <typename = void> requires(is_copy_constructible_v) bool push_back(payload_t const& v) noexcept(is_nothrow_copy_constructible_v)
+    {
+      std::optional<std::size_t> const pos = this->reserve_for_write();
+      if (!pos.has_value())
+        return false;
+
+      cell_t& cell = this->m_cells[pos.value() & idx_mask];
+      ::new (&cell.mem) payload_t(v);
+      cell.seq.store(pos.value() + 1, std::memory_order_release);
+      return true;
+    }
+
+    template <typename = void> requires(is_move_constructible_v) bool push_back(payload_t&& v) noexcept(is_nothrow_move_constructible_v)
+    {
+      std::optional<std::size_t> const pos = this->reserve_for_write();
+      if (!pos.has_value())
+        return false;
+
+      cell_t& cell = this->m_cells[pos.value() & idx_mask];
+      ::new (&cell.mem) payload_t(std::move(v));
+      cell.seq.store(pos.value() + 1, std::memory_order_release);
+      return true;
+    }
+
+    std::optional<payload_t> pop_front() noexcept(is_move_constructible_v ? is_nothrow_move_constructible_v : is_nothrow_copy_constructible_v)
+    {
+      std::size_t pos = this->m_r_pos.pos.load(std::memory_order_relaxed);
+      cell_t*     cell;
+      while (true)
+      {
+        cell                    = &this->m_cells[pos & idx_mask];
+        std::size_t const seq   = cell->seq.load(std::memory_order_acquire);
+        std::ptrdiff_t const df = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+        if (df == 0)
+        {
+          if (this->m_r_pos.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            break;
+        }
+        else if (df < 0)
+        {
+          return std::nullopt;
+        }
+        else
+        {
+          pos = this->m_r_pos.pos.load(std::memory_order_relaxed);
+        }
+      }
+
+      payload_t&               obj = *std::launder(reinterpret_cast<payload_t*>(&cell->mem));
+      std::optional<payload_t> ret;
+      if constexpr (is_move_constructible_v)
+        ret.emplace(std::move(obj));
+      else
+        ret.emplace(obj);
+      obj.~payload_t();
+
+      cell->seq.store(pos + number_of_entries, std::memory_order_release);
+      return ret;
+    }
+
+    constexpr std::size_t get_number_of_entries() const noexcept { return number_of_entries; }
+
+    // only a snapshot while producers or consumers are active
+    std::size_t get_number_of_used_entries() const noexcept
+    {
+      std::size_t const r = this->m_r_pos.pos.load(std::memory_order_acquire);
+      std::size_t const w = this->m_w_pos.pos.load(std::memory_order_acquire);
+      std::size_t const n = w - r;
+      return (n > number_of_entries) ? 0 : n;
+    }
+
+    std::size_t get_number_of_free_entries() const noexcept { return number_of_entries - this->get_number_of_used_entries(); }
+
+  private:
+    struct cell_t
+    {
+      std::atomic<std::size_t> seq;
+      mem_payload_t            mem;
+    };
+
+    struct alignas(cache_line_size) position_t
+    {
+      std::atomic<std::size_t> pos = 0;
+    };
+
+    // returns the position reserved for the calling producer
+    std::optional<std::size_t> reserve_for_write() noexcept
+    {
+      std::size_t pos = this->m_w_pos.pos.load(std::memory_order_relaxed);
+      while (true)
+      {
+        cell_t* const        cell = &this->m_cells[pos & idx_mask];
+        std::size_t const    seq  = cell->seq.load(std::memory_order_acquire);
+        std::ptrdiff_t const df   = static_cast<std::ptrdiff_t>(seq - pos);
+        if (df == 0)
+        {
+          if (this->m_w_pos.pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            return pos;
+        }
+        else if (df < 0)
+        {
+          return std::nullopt;
+        }
+        else
+        {
+          pos = this->m_w_pos.pos.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    position_t m_w_pos = {};
+    position_t m_r_pos = {};
+    alignas(cache_line_size) cell_t m_cells[number_of_entries];
+  };
+}    // namespace bslib::container
+
+#endif
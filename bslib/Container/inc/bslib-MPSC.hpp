@@ -2,6 +2,7 @@
 #ifndef BSLIB_CONTAINER_MPSC_HPP_INCLUDED
 #define BSLIB_CONTAINER_MPSC_HPP_INCLUDED
 
+#include <algorithm>
 #include <atomic>
 #include <concepts>
 #include <cstddef>
@@ -13,12 +14,28 @@
 
 namespace bslib::container
 {
+  /*
+   * Bounded multi producer / single consumer queue on external memory.
+   *
+   * Producers reserve a block of consecutive entries with a CAS on the write
+   * index, construct the payload and then commit the block by writing its
+   * length into the slot state of its first entry (per slot state in the
+   * style of D. Vyukov's bounded queue). The consumer only follows committed
+   * blocks in order and clears their slot state before it releases the
+   * entries, so a block that is still being written by a preempted producer
+   * is never exposed and producers never wait for each other.
+   *
+   * The payload entries stay contiguous, so peak_span()/drop() can hand them
+   * to a DMA directly.
+   */
   template <typename T> requires(std::is_destructible_v<T> && (std::is_copy_constructible_v<T> || std::is_move_constructible_v<T>)) class mpsc_queue_ex_mem
   {
 
   public:
-    using payload_t     = std::remove_cv_t<T>;
-    using mem_payload_t = std::aligned_storage_t<sizeof(payload_t), alignof(payload_t)>;
+    using payload_t        = std::remove_cv_t<T>;
+    using mem_payload_t    = std::aligned_storage_t<sizeof(payload_t), alignof(payload_t)>;
+    using slot_state_t     = std::atomic<std::size_t>;
+    using mem_slot_state_t = std::aligned_storage_t<sizeof(slot_state_t), alignof(slot_state_t)>;
 
   private:
     static constexpr bool is_copy_constructible_v         = std::is_copy_constructible_v<payload_t>;
@@ -29,120 +46,155 @@ namespace bslib::container
 
   public:
     template <std::size_t N>
-    requires(N > 1) inline mpsc_queue_ex_mem(mem_payload_t (&mem)[N])
-        : mpsc_queue_ex_mem(mem, N)
+    requires(N > 1) inline mpsc_queue_ex_mem(mem_payload_t (&mem)[N], mem_slot_state_t (&slot_state)[N])
+        : mpsc_queue_ex_mem(mem, slot_state, N)
     {
     }
 
-    inline mpsc_queue_ex_mem(std::span<mem_payload_t> mem)
-        : mpsc_queue_ex_mem(mem.data(), mem.size())
+    inline mpsc_queue_ex_mem(std::span<mem_payload_t> mem, std::span<mem_slot_state_t> slot_state)
+        : mpsc_queue_ex_mem(mem.data(), slot_state.data(), std::min(mem.size(), slot_state.size()))
     {
     }
 
-    inline mpsc_queue_ex_mem(mem_payload_t* mem, std::size_t const& number_of_elements)
+    inline mpsc_queue_ex_mem(mem_payload_t* mem, mem_slot_state_t* slot_state, std::size_t const& number_of_elements)
         : m_mem{ mem }
+        , m_slot_state{ reinterpret_cast<slot_state_t*>(slot_state) }
         , m_mem_len{ number_of_elements }
     {
+      for (std::size_t i = 0; i < this->m_mem_len; i++)
+      {
+        ::new (&slot_state[i]) slot_state_t(0);
+      }
     }
 
     inline ~mpsc_queue_ex_mem() noexcept(is_nothrow_destructible_v)
     {
-      std::size_t const w = this->m_idx_wr;
+      this->collect_committed_blocks();
+
+      std::size_t const w = this->m_idx_ready;
       std::size_t       r = this->m_idx_r;
       while (r != w)
       {
-        payload_t& tmp = *std::launder(reinterpret_cast<payload_t*>(&this->m_mem[r]));
-        tmp.~payload_t();
+        this->get_ptr(r)->~payload_t();
         r = advance_idx(r, 1);
       }
       this->m_idx_r = r;
+
+      for (std::size_t i = 0; i < this->m_mem_len; i++)
+      {
+        this->m_slot_state[i].~slot_state_t();
+      }
     }
 
     constexpr std::size_t get_number_of_entries() const noexcept { return this->m_mem_len - 1; }
 
-    constexpr std::size_t get_number_of_used_entries() const noexcept
+    // includes entries which are reserved but not yet committed by a producer
+    std::size_t get_number_of_used_entries() const noexcept
     {
-      std::size_t const r = this->m_idx_r;
-      std::size_t const w = this->m_idx_ww;
+      std::size_t const r = this->m_idx_r.load(std::memory_order_acquire);
+      std::size_t const w = this->m_idx_ww.load(std::memory_order_acquire);
 
       if (r <= w)
         return w - r;
       return this->m_mem_len + w - r;
     }
 
-    constexpr std::size_t get_number_of_free_entries() const noexcept
+    std::size_t get_number_of_free_entries() const noexcept
     {
-      std::size_t const r = this->m_idx_r;
-      std::size_t const w = this->m_idx_ww;
+      std::size_t const r = this->m_idx_r.load(std::memory_order_acquire);
+      std::size_t const w = this->m_idx_ww.load(std::memory_order_acquire);
       return this->calc_number_of_free_entries(r, w);
     }
+
+    /*
+     * pushes all len elements as one block or nothing at all
+     */
     template <typename = void>
-    requires(is_copy_constructible_v) constexpr bool push_back(payload_t const* v, std::size_t const& len) noexcept(is_nothrow_copy_constructible_v)
+    requires(is_copy_constructible_v) bool push_back(payload_t const* v, std::size_t const& len) noexcept(is_nothrow_copy_constructible_v)
     {
-      this->m_idx_tmp += len;
-      bool const ret = this->p_push_back(v, len);
+      if (len == 0)
+        return true;
 
-      std::size_t const w = this->m_idx_ww;
-      if (this->m_idx_tmp == len)
+      std::optional<std::size_t> const w_idx = this->reserve(len);
+      if (!w_idx.has_value())
+        return false;
+
+      std::size_t idx = w_idx.value();
+      for (std::size_t i = 0; i < len; i++)
       {
-        this->m_idx_wr = w;
+        ::new (&this->m_mem[idx]) payload_t(v[i]);
+        idx = this->advance_idx(idx, 1);
       }
-      this->m_idx_tmp -= len;
-      return ret;
+
+      this->m_slot_state[w_idx.value()].store(len, std::memory_order_release);
+      return true;
+    }
+
+    template <typename = void> requires(is_copy_constructible_v) bool push_back(std::span<payload_t const> v) noexcept(is_nothrow_copy_constructible_v)
+    {
+      return this->push_back(v.data(), v.size());
     }
 
-    template <typename = void> requires(is_copy_constructible_v) constexpr bool push_back(payload_t const& v) noexcept(is_nothrow_copy_constructible_v)
+    template <typename = void> requires(is_copy_constructible_v) bool push_back(payload_t const& v) noexcept(is_nothrow_copy_constructible_v)
     {
       return this->push_back(&v, 1);
     }
 
-    template <typename = void> requires(is_move_constructible_v) constexpr bool push_back(payload_t&& v) noexcept(is_nothrow_move_constructible_v)
+    template <typename = void> requires(is_move_constructible_v) bool push_back(payload_t&& v) noexcept(is_nothrow_move_constructible_v)
     {
-      this->m_idx_tmp += 1;
-      bool const ret           = this->p_push_back(std::move(v));
-      bool       wr_idx_update = false;
+      std::optional<std::size_t> const w_idx = this->reserve(1);
+      if (!w_idx.has_value())
+        return false;
 
-      std::size_t const w = this->m_idx_ww;
-      if (this->m_idx_tmp == 1)
-      {
-        this->m_idx_wr = w;
-      }
-      this->m_idx_tmp -= 1;
-      return ret;
+      ::new (&this->m_mem[w_idx.value()]) payload_t(std::move(v));
+
+      this->m_slot_state[w_idx.value()].store(1, std::memory_order_release);
+      return true;
     }
 
+    /*
+     * consumer only: contiguous span of committed entries starting at the read index
+     *
+     * collects the committed blocks, so it changes the state of the consumer,
+     * if several contexts may consume, they need a flag that decides who is the consumer
+     */
     std::span<payload_t> peak_span()
     {
-      std::size_t const r_idx = this->m_idx_r;
-      std::size_t const w_idx = this->m_idx_wr;
+      this->collect_committed_blocks();
+
+      std::size_t const r_idx = this->m_idx_r.load(std::memory_order_relaxed);
+      std::size_t const w_idx = this->m_idx_ready;
 
       if (r_idx <= w_idx)
-        return { reinterpret_cast<payload_t*>(&this->m_mem[r_idx]), w_idx - r_idx };
-      return { reinterpret_cast<payload_t*>(&this->m_mem[r_idx]), this->m_mem_len - r_idx };
+        return { this->get_ptr(r_idx), w_idx - r_idx };
+      return { this->get_ptr(r_idx), this->m_mem_len - r_idx };
     }
 
+    /*
+     * consumer only: releases len entries previously returned by peak_span()
+     */
     void drop(std::size_t const& len)
     {
-      std::size_t r = this->m_idx_r;
+      std::size_t const r = this->m_idx_r.load(std::memory_order_relaxed);
       for (std::size_t i = 0; i < len; i++)
       {
-        payload_t& tmp = *std::launder(reinterpret_cast<payload_t*>(&this->m_mem[r]));
-        tmp.~payload_t();
-        r = advance_idx(r, 1);
+        this->get_ptr(this->advance_idx(r, i))->~payload_t();
       }
 
-      this->m_idx_r = this->advance_idx(this->m_idx_r, len);
+      this->m_idx_r.store(this->advance_idx(r, len), std::memory_order_release);
     }
 
-    constexpr std::optional<payload_t> pop_front() noexcept(is_move_constructible_v ? is_nothrow_move_constructible_v : is_nothrow_copy_constructible_v)
+    std::optional<payload_t> pop_front() noexcept(is_move_constructible_v ? is_nothrow_move_constructible_v : is_nothrow_copy_constructible_v)
     {
-      std::size_t const w = this->m_idx_wr;
-      std::size_t const r = this->m_idx_r;
+      this->collect_committed_blocks();
+
+      std::size_t const w = this->m_idx_ready;
+      std::size_t const r = this->m_idx_r.load(std::memory_order_relaxed);
 
       if (r == w)
         return std::nullopt;
 
-      payload_deleter_t tmp{ *std::launder(reinterpret_cast<payload_t*>(&this->m_mem[r])), this->m_r_idx, advance_idx(r, 1) };
+      payload_deleter_t tmp{ *this->get_ptr(r), this->m_idx_r, advance_idx(r, 1) };
       if constexpr (is_move_constructible_v)
       {
         return { std::move(tmp.obj) };
@@ -154,44 +206,40 @@ namespace bslib::container
     }
 
   private:
-    template <typename = void>
-    requires(is_copy_constructible_v) constexpr bool p_push_back(payload_t const* v, std::size_t const& len) noexcept(is_nothrow_copy_constructible_v)
+    std::optional<std::size_t> reserve(std::size_t const& len) noexcept
     {
-      std::size_t const r_idx = this->m_idx_r;
-      std::size_t       w_idx = this->m_idx_ww;
+      std::size_t w_idx = this->m_idx_ww.load(std::memory_order_relaxed);
       do
       {
+        // acquire: the consumer has destroyed the entries it released
+        std::size_t const r_idx = this->m_idx_r.load(std::memory_order_acquire);
         if (this->calc_number_of_free_entries(r_idx, w_idx) < len)
         {
-          return false;
+          return std::nullopt;
         }
-      } while (!this->m_idx_ww.compare_exchange_weak(w_idx, this->advance_idx(w_idx, len)));
-
-      for (std::size_t i = 0; i < len; i++)
-      {
-        ::new (&this->m_mem[w_idx]) payload_t(v[i]);
-        w_idx = this->advance_idx(w_idx, 1);
-      }
-      return true;
+      } while (!this->m_idx_ww.compare_exchange_weak(w_idx, this->advance_idx(w_idx, len), std::memory_order_relaxed));
+      return w_idx;
     }
 
-    template <typename = void> requires(is_move_constructible_v) constexpr bool p_push_back(payload_t&& v) noexcept(is_nothrow_move_constructible_v)
+    // follows the committed blocks behind m_idx_ready and stops at the first one still in progress
+    void collect_committed_blocks() noexcept
     {
-      std::size_t const r_idx = this->m_idx_r;
-      std::size_t       w_idx = this->m_idx_ww;
-      do
+      std::size_t ready = this->m_idx_ready;
+      while (true)
       {
-        if (this->calc_number_of_free_entries(r_idx, w_idx) < 1)
-        {
-          return false;
-        }
-      } while (!this->m_idx_ww.compare_exchange_weak(w_idx, this->advance_idx(w_idx, 1)));
+        std::size_t const blk_len = this->m_slot_state[ready].load(std::memory_order_acquire);
+        if (blk_len == 0)
+          break;
 
-      ::new (&this->m_mem[w_idx]) payload_t(std::move(v));
-
-      return true;
+        // cleared before the entries are released by drop(), so the next producer of this slot sees 0
+        this->m_slot_state[ready].store(0, std::memory_order_relaxed);
+        ready = this->advance_idx(ready, blk_len);
+      }
+      this->m_idx_ready = ready;
     }
 
+    inline payload_t* get_ptr(std::size_t const& idx) noexcept { return std::launder(reinterpret_cast<payload_t*>(&this->m_mem[idx])); }
+
     inline constexpr std::size_t calc_number_of_free_entries(std::size_t const& r_idx, std::size_t const& w_idx) const noexcept
     {
       if (r_idx <= w_idx)
@@ -199,14 +247,11 @@ namespace bslib::container
       return r_idx - w_idx - 1;
     }
 
-    inline constexpr std::size_t advance_idx(std::size_t idx, std::size_t val) noexcept
+    inline constexpr std::size_t advance_idx(std::size_t idx, std::size_t val) const noexcept
     {
-      std::size_t ret = idx + val;
-      while (ret >= this->m_mem_len)
-      {
-        ret -= this->m_mem_len;
-      }
-      return ret;
+      // idx < m_mem_len and val < m_mem_len, so one subtraction is enough
+      std::size_t const ret = idx + val;
+      return (ret >= this->m_mem_len) ? ret - this->m_mem_len : ret;
     }
 
     struct payload_deleter_t
@@ -222,7 +267,7 @@ namespace bslib::container
       inline ~payload_deleter_t() noexcept(is_nothrow_destructible_v)
       {
         this->obj.~payload_t();
-        this->r_idx = this->next_idx;
+        this->r_idx.store(this->next_idx, std::memory_order_release);
       }
 
       payload_t&                obj;
@@ -230,13 +275,13 @@ namespace bslib::container
       std::size_t               next_idx;
     };
 
-    std::atomic<std::size_t> m_idx_tmp = 0;
-    std::atomic<std::size_t> m_idx_ww  = 0;
-    std::atomic<std::size_t> m_idx_wr  = 0;
-    std::atomic<std::size_t> m_idx_r   = 0;
-    mem_payload_t*           m_mem     = {};
-    std::size_t const        m_mem_len = {};
+    std::atomic<std::size_t> m_idx_ww    = 0;
+    std::atomic<std::size_t> m_idx_r     = 0;
+    std::size_t              m_idx_ready = 0;
+    mem_payload_t*           m_mem        = {};
+    slot_state_t*            m_slot_state = {};
+    std::size_t const        m_mem_len    = {};
   };
-}    // namespace wlib::container
+}    // namespace bslib::container
 
 #endif
@@ -2,12 +2,15 @@
 #ifndef BSLIB_CONTAINER_SPSC_HPP_INCLUDED
 #define BSLIB_CONTAINER_SPSC_HPP_INCLUDED
 
+#include <algorithm>
 #include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <cstdint>
+#include <memory>
 #include <new>
 #include <optional>
+#include <span>
 #include <type_traits>
 
 namespace bslib::container
@@ -28,6 +31,9 @@ namespace bslib::container
     static constexpr bool is_move_constructible_v         = std::is_move_constructible_v<payload_t>;
     static constexpr bool is_nothrow_move_constructible_v = std::is_nothrow_move_constructible_v<payload_t>;
     static constexpr bool is_nothrow_destructible_v       = std::is_nothrow_destructible_v<payload_t>;
+    static constexpr bool is_move_assignable_v            = std::is_move_assignable_v<payload_t>;
+    static constexpr bool is_nothrow_move_assignable_v    = std::is_nothrow_move_assignable_v<payload_t>;
+    static constexpr bool is_trivially_copyable_v         = std::is_trivially_copyable_v<payload_t>;
 
   public:
     inline constexpr SPSC() noexcept = default;
@@ -94,29 +100,141 @@ namespace bslib::container
       }
     }
 
-    constexpr std::size_t get_number_of_entries() const noexcept { return number_of_entries; }
+    /*
+     * copies as many elements of values as fit into the queue and publishes
+     * them with a single write index update.
+     *
+     * @return number of elements taken from values
+     */
+    template <typename = void>
+    requires(is_copy_constructible_v) constexpr std::size_t push_back(std::span<payload_t const> values) noexcept(is_nothrow_copy_constructible_v)
+    {
+      std::size_t const r   = this->m_r_idx;
+      std::size_t const w   = this->m_w_idx;
+      std::size_t const len = std::min(values.size(), calc_number_of_free_entries(r, w));
+      if (len == 0)
+        return 0;
 
-    constexpr std::size_t get_number_of_used_entries() const noexcept
+      std::size_t const first_len = std::min(len, max_idx - w);
+      std::uninitialized_copy_n(values.data(), first_len, get_ptr(w));
+      std::uninitialized_copy_n(values.data() + first_len, len - first_len, get_ptr(0));
+
+      this->m_w_idx = advance(w, len);
+      return len;
+    }
+
+    /*
+     * moves as many elements as available into dst and releases them with a
+     * single read index update.
+     *
+     * @return number of elements written to dst
+     */
+    template <typename = void>
+    requires(is_move_assignable_v) constexpr std::size_t pop_front(std::span<payload_t> dst) noexcept(is_nothrow_move_assignable_v && is_nothrow_destructible_v)
+    {
+      std::size_t const w   = this->m_w_idx;
+      std::size_t const r   = this->m_r_idx;
+      std::size_t const len = std::min(dst.size(), calc_number_of_used_entries(r, w));
+      if (len == 0)
+        return 0;
+
+      std::size_t const first_len = std::min(len, max_idx - r);
+      move_out_and_destroy(get_ptr(r), first_len, dst.data());
+      move_out_and_destroy(get_ptr(0), len - first_len, dst.data() + first_len);
+
+      this->m_r_idx = advance(r, len);
+      return len;
+    }
+
+    /*
+     * producer side of the two phase api: returns the contiguous free region
+     * behind the write index (at most max_len elements). The region has to be
+     * filled and then published with commit().
+     */
+    template <typename = void> requires(is_trivially_copyable_v) constexpr std::span<payload_t> reserve_span(std::size_t max_len = number_of_entries) noexcept
     {
       std::size_t const r = this->m_r_idx;
       std::size_t const w = this->m_w_idx;
 
+      std::size_t len = (r <= w) ? max_idx - w : r - w - 1;
+      if (r == 0 && r <= w)
+        len -= 1;
+
+      return { get_ptr(w), std::min(len, max_len) };
+    }
+
+    template <typename = void> requires(is_trivially_copyable_v) constexpr void commit(std::size_t const& len) noexcept
+    {
+      this->m_w_idx = advance(this->m_w_idx, len);
+    }
+
+    /*
+     * consumer side of the two phase api: returns the contiguous region of
+     * used entries behind the read index. Consumed entries have to be released
+     * with drop().
+     */
+    constexpr std::span<payload_t> peak_span() noexcept
+    {
+      std::size_t const w = this->m_w_idx;
+      std::size_t const r = this->m_r_idx;
+
       if (r <= w)
-        return w - r;
-      return max_idx + w - r;
+        return { get_ptr(r), w - r };
+      return { get_ptr(r), max_idx - r };
+    }
+
+    constexpr void drop(std::size_t const& len) noexcept(is_nothrow_destructible_v)
+    {
+      std::size_t const r = this->m_r_idx;
+      for (std::size_t i = 0; i < len; i++)
+      {
+        get_ptr(advance(r, i))->~payload_t();
+      }
+      this->m_r_idx = advance(r, len);
+    }
+
+    constexpr std::size_t get_number_of_entries() const noexcept { return number_of_entries; }
+
+    constexpr std::size_t get_number_of_used_entries() const noexcept
+    {
+      std::size_t const r = this->m_r_idx;
+      std::size_t const w = this->m_w_idx;
+      return calc_number_of_used_entries(r, w);
     }
 
     constexpr std::size_t get_number_of_free_entries() const noexcept
     {
       std::size_t const r = this->m_r_idx;
       std::size_t const w = this->m_w_idx;
+      return calc_number_of_free_entries(r, w);
+    }
+
+  private:
+    static inline constexpr std::size_t calc_number_of_used_entries(std::size_t const& r, std::size_t const& w) noexcept
+    {
+      if (r <= w)
+        return w - r;
+      return max_idx + w - r;
+    }
 
+    static inline constexpr std::size_t calc_number_of_free_entries(std::size_t const& r, std::size_t const& w) noexcept
+    {
       if (r <= w)
         return number_of_entries + r - w;
       return r - w - 1;
     }
 
-  private:
+    inline payload_t* get_ptr(std::size_t const& idx) noexcept { return std::launder(reinterpret_cast<payload_t*>(&this->m_mem[idx])); }
+
+    static inline void move_out_and_destroy(payload_t* src, std::size_t const& len, payload_t* dst) noexcept(is_nothrow_move_assignable_v && is_nothrow_destructible_v)
+    {
+      for (std::size_t i = 0; i < len; i++)
+      {
+        dst[i] = std::move(src[i]);
+        src[i].~payload_t();
+      }
+    }
+
     static inline constexpr std::size_t advance(std::size_t idx, std::size_t val) noexcept
     {
       std::size_t ret = idx + val;
@@ -0,0 +1,301 @@
+#pragma once
+#ifndef BSLIB_CONTAINER_SPSC_ALIGNED_HPP_INCLUDED
+#define BSLIB_CONTAINER_SPSC_ALIGNED_HPP_INCLUDED
+
+#include <algorithm>
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <span>
+#include <type_traits>
+
+namespace bslib::container
+{
+  /*
+   * Same interface as SPSC<T, N>, but tuned for producer and consumer running
+   * on different cores / threads:
+   *  - write index, read index and payload live on separate cache lines
+   *  - each side caches the index of the other side and only reloads it when
+   *    the queue looks full (producer) or empty (consumer)
+   *  - acquire/release ordering instead of seq_cst
+   *  - index wrap is a mask if N + 1 is a power of two, a single compare otherwise
+   */
+  template <typename T, std::size_t N>
+  requires(N > 0 && std::is_destructible_v<T> && (std::is_copy_constructible_v<T> || std::is_move_constructible_v<T>)) class SPSC_aligned
+  {
+  public:
+    using payload_t = std::remove_cv_t<T>;
+
+    static constexpr std::size_t cache_line_size = 64;
+
+  private:
+    using mem_payload_t                            = std::aligned_storage_t<sizeof(payload_t), alignof(payload_t)>;
+    static constexpr std::size_t number_of_entries = N;
+    static constexpr std::size_t max_idx           = number_of_entries + 1;
+    static constexpr bool        is_power_of_two   = (max_idx & (max_idx - 1)) == 0;
+
+    static constexpr bool is_copy_constructible_v         = std::is_copy_constructible_v<payload_t>;
+    static constexpr bool is_nothrow_copy_constructible_v = std::is_nothrow_copy_constructible_v<payload_t>;
+    static constexpr bool is_move_constructible_v         = std::is_move_constructible_v<payload_t>;
+    static constexpr bool is_nothrow_move_constructible_v = std::is_nothrow_move_constructible_v<payload_t>;
+    static constexpr bool is_nothrow_destructible_v       = std::is_nothrow_destructible_v<payload_t>;
+    static constexpr bool is_move_assignable_v            = std::is_move_assignable_v<payload_t>;
+    static constexpr bool is_nothrow_move_assignable_v    = std::is_nothrow_move_assignable_v<payload_t>;
+    static constexpr bool is_trivially_copyable_v         = std::is_trivially_copyable_v<payload_t>;
+
+  public:
+    inline SPSC_aligned() noexcept = default;
+
+    inline ~SPSC_aligned() noexcept(is_nothrow_destructible_v)
+    {
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_acquire);
+      std::size_t       r = this->m_consumer.r_idx.load(std::memory_order_relaxed);
+      while (r != w)
+      {
+        get_ptr(r)->~payload_t();
+        r = advance(r, 1);
+      }
+      this->m_consumer.r_idx.store(r, std::memory_order_release);
+    }
+
+    template <typename = void> requires(is_copy_constructible_v) bool push_back(payload_t const& v) noexcept(is_nothrow_copy_constructible_v)
+    {
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_relaxed);
+      if (this->free_entries_for_producer(w, 1) == 0)
+        return false;
+
+      ::new (&this->m_mem[w]) payload_t(v);
+
+      this->m_producer.w_idx.store(advance(w, 1), std::memory_order_release);
+      return true;
+    }
+
+    template <typename = void> requires(is_move_constructible_v) bool push_back(payload_t&& v) noexcept(is_nothrow_move_constructible_v)
+    {
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_relaxed);
+      if (this->free_entries_for_producer(w, 1) == 0)
+        return false;
+
+      ::new (&this->m_mem[w]) payload_t(std::move(v));
+
+      this->m_producer.w_idx.store(advance(w, 1), std::memory_order_release);
+      return true;
+    }
+
+    /*
+     * @return number of elements taken from values
+     */
+    template <typename = void>
+    requires(is_copy_constructible_v) std::size_t push_back(std::span<payload_t const> values) noexcept(is_nothrow_copy_constructible_v)
+    {
+      std::size_t const w   = this->m_producer.w_idx.load(std::memory_order_relaxed);
+      std::size_t const len = std::min(values.size(), this->free_entries_for_producer(w, values.size()));
+      if (len == 0)
+        return 0;
+
+      std::size_t const first_len = std::min(len, max_idx - w);
+      std::uninitialized_copy_n(values.data(), first_len, get_ptr(w));
+      std::uninitialized_copy_n(values.data() + first_len, len - first_len, get_ptr(0));
+
+      this->m_producer.w_idx.store(advance(w, len), std::memory_order_release);
+      return len;
+    }
+
+    std::optional<payload_t> pop_front() noexcept(is_move_constructible_v ? is_nothrow_move_constructible_v : is_nothrow_copy_constructible_v)
+    {
+      std::size_t const r = this->m_consumer.r_idx.load(std::memory_order_relaxed);
+      if (this->used_entries_for_consumer(r, 1) == 0)
+        return std::nullopt;
+
+      payload_deleter_t tmp{ *get_ptr(r), this->m_consumer.r_idx, advance(r, 1) };
+      if constexpr (is_move_constructible_v)
+      {
+        return { std::move(tmp.obj) };
+      }
+      else
+      {
+        return { tmp.obj };
+      }
+    }
+
+    /*
+     * @return number of elements written to dst
+     */
+    template <typename = void>
+    requires(is_move_assignable_v) std::size_t pop_front(std::span<payload_t> dst) noexcept(is_nothrow_move_assignable_v && is_nothrow_destructible_v)
+    {
+      std::size_t const r   = this->m_consumer.r_idx.load(std::memory_order_relaxed);
+      std::size_t const len = std::min(dst.size(), this->used_entries_for_consumer(r, dst.size()));
+      if (len == 0)
+        return 0;
+
+      std::size_t const first_len = std::min(len, max_idx - r);
+      move_out_and_destroy(get_ptr(r), first_len, dst.data());
+      move_out_and_destroy(get_ptr(0), len - first_len, dst.data() + first_len);
+
+      this->m_consumer.r_idx.store(advance(r, len), std::memory_order_release);
+      return len;
+    }
+
+    template <typename = void> requires(is_trivially_copyable_v) std::span<payload_t> reserve_span(std::size_t max_len = number_of_entries) noexcept
+    {
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_relaxed);
+      std::size_t const r = this->m_producer.r_idx_cache = this->m_consumer.r_idx.load(std::memory_order_acquire);
+
+      std::size_t len = (r <= w) ? max_idx - w : r - w - 1;
+      if (r == 0 && r <= w)
+        len -= 1;
+
+      return { get_ptr(w), std::min(len, max_len) };
+    }
+
+    template <typename = void> requires(is_trivially_copyable_v) void commit(std::size_t const& len) noexcept
+    {
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_relaxed);
+      this->m_producer.w_idx.store(advance(w, len), std::memory_order_release);
+    }
+
+    std::span<payload_t> peak_span() noexcept
+    {
+      std::size_t const r = this->m_consumer.r_idx.load(std::memory_order_relaxed);
+      std::size_t const w = this->m_consumer.w_idx_cache = this->m_producer.w_idx.load(std::memory_order_acquire);
+
+      if (r <= w)
+        return { get_ptr(r), w - r };
+      return { get_ptr(r), max_idx - r };
+    }
+
+    void drop(std::size_t const& len) noexcept(is_nothrow_destructible_v)
+    {
+      std::size_t const r = this->m_consumer.r_idx.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < len; i++)
+      {
+        get_ptr(advance(r, i))->~payload_t();
+      }
+      this->m_consumer.r_idx.store(advance(r, len), std::memory_order_release);
+    }
+
+    constexpr std::size_t get_number_of_entries() const noexcept { return number_of_entries; }
+
+    std::size_t get_number_of_used_entries() const noexcept
+    {
+      std::size_t const r = this->m_consumer.r_idx.load(std::memory_order_acquire);
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_acquire);
+      return calc_number_of_used_entries(r, w);
+    }
+
+    std::size_t get_number_of_free_entries() const noexcept
+    {
+      std::size_t const r = this->m_consumer.r_idx.load(std::memory_order_acquire);
+      std::size_t const w = this->m_producer.w_idx.load(std::memory_order_acquire);
+      return calc_number_of_free_entries(r, w);
+    }
+
+  private:
+    static inline constexpr std::size_t advance(std::size_t idx, std::size_t val) noexcept
+    {
+      if constexpr (is_power_of_two)
+      {
+        return (idx + val) & (max_idx - 1);
+      }
+      else
+      {
+        // idx < max_idx and val <= max_idx, so one subtraction is enough
+        std::size_t const ret = idx + val;
+        return (ret >= max_idx) ? ret - max_idx : ret;
+      }
+    }
+
+    static inline constexpr std::size_t calc_number_of_used_entries(std::size_t const& r, std::size_t const& w) noexcept
+    {
+      if (r <= w)
+        return w - r;
+      return max_idx + w - r;
+    }
+
+    static inline constexpr std::size_t calc_number_of_free_entries(std::size_t const& r, std::size_t const& w) noexcept
+    {
+      if (r <= w)
+        return number_of_entries + r - w;
+      return r - w - 1;
+    }
+
+    // only reloads the read index of the consumer if the cached one does not leave enough room
+    inline std::size_t free_entries_for_producer(std::size_t const& w, std::size_t const& required) noexcept
+    {
+      std::size_t free = calc_number_of_free_entries(this->m_producer.r_idx_cache, w);
+      if (free < required)
+      {
+        this->m_producer.r_idx_cache = this->m_consumer.r_idx.load(std::memory_order_acquire);
+        free                         = calc_number_of_free_entries(this->m_producer.r_idx_cache, w);
+      }
+      return free;
+    }
+
+    // only reloads the write index of the producer if the cached one does not provide enough entries
+    inline std::size_t used_entries_for_consumer(std::size_t const& r, std::size_t const& required) noexcept
+    {
+      std::size_t used = calc_number_of_used_entries(r, this->m_consumer.w_idx_cache);
+      if (used < required)
+      {
+        this->m_consumer.w_idx_cache = this->m_producer.w_idx.load(std::memory_order_acquire);
+        used                         = calc_number_of_used_entries(r, this->m_consumer.w_idx_cache);
+      }
+      return used;
+    }
+
+    inline payload_t* get_ptr(std::size_t const& idx) noexcept { return std::launder(reinterpret_cast<payload_t*>(&this->m_mem[idx])); }
+
+    static inline void move_out_and_destroy(payload_t* src, std::size_t const& len, payload_t* dst) noexcept(is_nothrow_move_assignable_v && is_nothrow_destructible_v)
+    {
+      for (std::size_t i = 0; i < len; i++)
+      {
+        dst[i] = std::move(src[i]);
+        src[i].~payload_t();
+      }
+    }
+
+    struct payload_deleter_t
+    {
+    public:
+      inline constexpr payload_deleter_t(payload_t& obj, std::atomic<std::size_t>& r_idx, std::size_t next_idx_value) noexcept
+          : obj(obj)
+          , r_idx(r_idx)
+          , next_idx(next_idx_value)
+      {
+      }
+
+      inline ~payload_deleter_t() noexcept(is_nothrow_destructible_v)
+      {
+        this->obj.~payload_t();
+        this->r_idx.store(this->next_idx, std::memory_order_release);
+      }
+
+      payload_t&                obj;
+      std::atomic<std::size_t>& r_idx;
+      std::size_t               next_idx;
+    };
+
+    struct alignas(cache_line_size) producer_t
+    {
+      std::atomic<std::size_t> w_idx       = 0;
+      std::size_t              r_idx_cache = 0;
+    };
+
+    struct alignas(cache_line_size) consumer_t
+    {
+      std::atomic<std::size_t> r_idx       = 0;
+      std::size_t              w_idx_cache = 0;
+    };
+
+    producer_t                            m_producer = {};
+    consumer_t                            m_consumer = {};
+    alignas(cache_line_size) mem_payload_t m_mem[max_idx]{};
+  };
+}    // namespace bslib::container
+
+#endif
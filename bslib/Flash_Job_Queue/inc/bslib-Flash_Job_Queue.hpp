@@ -0,0 +1,284 @@
+#pragma once
+#ifndef BSLIB_FLASH_JOB_QUEUE_HPP_INCLUDED
+#define BSLIB_FLASH_JOB_QUEUE_HPP_INCLUDED
+
+#include <bslib-MPSC.hpp>
+#include <wlib-Callback.hpp>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <span>
+
+namespace bslib::flash
+{
+  enum class job_type_t : uint8_t
+  {
+    erase,
+    program,
+  };
+
+  struct job_result_t
+  {
+    job_type_t  type;
+    std::size_t address;
+    std::size_t size;
+    std::size_t done;    // bytes erased or programmed until the end or the first error
+    bool        success;
+  };
+
+  using completion_t = wlib::Callback<void(job_result_t const&)>;
+
+  /*
+   * Flash controller of one bank. Starts a single step, the erase of one
+   * sector or the programming of one flash word, and returns at once. The
+   * end of the step is reported to the operation done callback, usually
+   * from the end of operation interrupt.
+   */
+  class Flash_Backend_Interface
+  {
+  public:
+    virtual ~Flash_Backend_Interface() noexcept = default;
+
+    virtual std::size_t get_sector_size() const noexcept     = 0;
+    virtual std::size_t get_flash_word_size() const noexcept = 0;
+
+    virtual void set_operation_done_callback(wlib::Callback<void(bool)>* callback) noexcept = 0;
+
+    virtual bool start_erase(std::size_t address) noexcept                                    = 0;
+    virtual bool start_program(std::size_t address, std::span<std::byte const> word) noexcept = 0;
+  };
+
+  /*
+   * Queue of erase and program jobs for one flash bank, the jobs are
+   * processed one step after the other from the operation done callback of
+   * the backend, so the submitting task does not wait for the flash.
+   *
+   * Any task may submit jobs (the queue is a MPSC queue and the task which
+   * finds the engine idle starts it). The completion callback is called
+   * from the context of the operation done callback (the interrupt), use
+   * Semaphore_Completion or Publisher_Completion to hand the result to a task.
+   *
+   * The data of a program job must stay valid until its completion.
+   */
+  template <std::size_t N>
+    requires(N > 0)
+  class Job_Queue
+  {
+    static constexpr std::size_t max_flash_word_size = 32;
+
+    struct job_t
+    {
+      job_type_t                 type;
+      std::size_t                address;
+      std::size_t                size;
+      std::span<std::byte const> data;
+      completion_t*              completion;
+    };
+
+    using queue_t = bslib::container::mpsc_queue_ex_mem<job_t>;
+
+  public:
+    struct statistics_t
+    {
+      std::size_t jobs_done        = 0;
+      std::size_t jobs_failed      = 0;
+      std::size_t sectors_erased   = 0;
+      std::size_t words_programmed = 0;
+    };
+
+    Job_Queue(Flash_Backend_Interface& backend) noexcept
+        : m_backend{ backend }
+    {
+      this->m_backend.set_operation_done_callback(&this->m_operation_done_cb);
+    }
+
+    Job_Queue(Job_Queue const&)            = delete;
+    Job_Queue& operator=(Job_Queue const&) = delete;
+
+    ~Job_Queue() noexcept { this->m_backend.set_operation_done_callback(nullptr); }
+
+    // address and size have to be sector aligned, false if not or if the queue is full
+    bool submit_erase(std::size_t address, std::size_t size, completion_t* completion = nullptr) noexcept
+    {
+      std::size_t const sector_size = this->m_backend.get_sector_size();
+      if (size == 0 || (address % sector_size) != 0 || (size % sector_size) != 0)
+        return false;
+
+      return this->submit({ job_type_t::erase, address, size, {}, completion });
+    }
+
+    // address has to be flash word aligned, an incomplete last flash word is filled with 0xFF
+    bool submit_program(std::size_t address, std::span<std::byte const> data, completion_t* completion = nullptr) noexcept
+    {
+      std::size_t const word_size = this->m_backend.get_flash_word_size();
+      if (data.empty() || word_size > max_flash_word_size || (address % word_size) != 0)
+        return false;
+
+      return this->submit({ job_type_t::program, address, data.size(), data, completion });
+    }
+
+    bool is_idle() const noexcept { return !this->m_busy && this->m_queue.get_number_of_used_entries() == 0; }
+
+    statistics_t const& get_statistics() const noexcept { return this->m_statistics; }
+
+  private:
+    bool submit(job_t const& job) noexcept
+    {
+      if (!this->m_queue.push_back(job))
+        return false;
+
+      // tells a finishing engine, that there is a new job, even if it already found the queue empty
+      this->m_kick = true;
+      this->try_start();
+      return true;
+    }
+
+    // the one who gets the busy flag is the consumer of the queue
+    void try_start() noexcept
+    {
+      do
+      {
+        if (this->m_busy.exchange(true))
+          return;
+
+        this->m_kick = false;
+
+        if (std::optional<job_t> job = this->m_queue.pop_front(); job.has_value())
+        {
+          this->m_current  = job.value();
+          this->m_progress = 0;
+          this->start_step();
+          return;
+        }
+
+        this->m_busy = false;
+      } while (this->m_kick);
+    }
+
+    void start_step() noexcept
+    {
+      std::size_t const address = this->m_current.address + this->m_progress;
+      bool              started = false;
+
+      if (this->m_current.type == job_type_t::erase)
+      {
+        started = this->m_backend.start_erase(address);
+      }
+      else
+      {
+        std::size_t const word_size = this->m_backend.get_flash_word_size();
+        std::size_t const len       = std::min(word_size, this->m_current.size - this->m_progress);
+
+        std::fill_n(this->m_word.begin(), word_size, std::byte{ 0xFF });
+        std::memcpy(this->m_word.data(), this->m_current.data.data() + this->m_progress, len);
+
+        started = this->m_backend.start_program(address, std::span<std::byte const>(this->m_word.data(), word_size));
+      }
+
+      if (!started)
+        this->finish(false);
+    }
+
+    void operation_done(bool success) noexcept
+    {
+      if (!success)
+        return this->finish(false);
+
+      if (this->m_current.type == job_type_t::erase)
+      {
+        this->m_progress += this->m_backend.get_sector_size();
+        this->m_statistics.sectors_erased++;
+      }
+      else
+      {
+        this->m_progress += this->m_backend.get_flash_word_size();
+        this->m_statistics.words_programmed++;
+      }
+
+      if (this->m_progress >= this->m_current.size)
+        return this->finish(true);
+
+      this->start_step();
+    }
+
+    void finish(bool success) noexcept
+    {
+      job_result_t const result = { this->m_current.type, this->m_current.address, this->m_current.size, std::min(this->m_progress, this->m_current.size),
+                                    success };
+
+      if (success)
+        this->m_statistics.jobs_done++;
+      else
+        this->m_statistics.jobs_failed++;
+
+      completion_t* const completion = this->m_current.completion;
+
+      this->m_busy = false;
+      this->try_start();
+
+      if (completion != nullptr)
+        (*completion)(result);
+    }
+
+    Flash_Backend_Interface&                                       m_backend;
+    wlib::Memberfunction_Callback<Job_Queue, void(bool)>           m_operation_done_cb{ *this, &Job_Queue::operation_done };
+    typename queue_t::mem_payload_t                                m_mem_queue[N + 1];
+    typename queue_t::mem_slot_state_t                             m_mem_slot_state[N + 1];
+    queue_t                                                        m_queue{ m_mem_queue, m_mem_slot_state };
+    std::atomic<bool>                                              m_busy = false;
+    std::atomic<bool>                                              m_kick = false;
+    job_t                                                          m_current{};
+    std::size_t                                                    m_progress = 0;
+    alignas(uint64_t) std::array<std::byte, max_flash_word_size>   m_word{};
+    statistics_t                                                   m_statistics{};
+  };
+
+  /*
+   * completion, that releases a semaphore, a task can wait for with acquire()
+   */
+  template <typename Semaphore> class Semaphore_Completion final: public completion_t
+  {
+  public:
+    Semaphore_Completion(Semaphore& semaphore)
+        : m_semaphore{ semaphore }
+    {
+    }
+
+    void operator()(job_result_t const& result) override
+    {
+      this->m_result = result;
+      this->m_semaphore.release();
+    }
+
+    std::optional<job_result_t> const& get_result() const noexcept { return this->m_result; }
+
+  private:
+    Semaphore&                  m_semaphore;
+    std::optional<job_result_t> m_result{};
+  };
+
+  /*
+   * completion, that notifies all subscribers of a publisher with the result
+   */
+  template <typename Publisher> class Publisher_Completion final: public completion_t
+  {
+  public:
+    Publisher_Completion(Publisher& publisher)
+        : m_publisher{ publisher }
+    {
+    }
+
+    void operator()(job_result_t const& result) override { this->m_publisher.notify(result); }
+
+  private:
+    Publisher& m_publisher;
+  };
+
+}    // namespace bslib::flash
+
+#endif
@@ -0,0 +1,2 @@
+#include <bslib-Flash_Job_Queue.hpp>
+
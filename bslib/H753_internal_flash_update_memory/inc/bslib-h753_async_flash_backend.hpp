@@ -0,0 +1,69 @@
+#pragma once
+#include <stm32h753xx.h>
+#include <bslib-Flash_Job_Queue.hpp>
+#include <bslib-h753_flash_controller.hpp>
+#include <wlib-Callback.hpp>
+
+namespace BSP {
+
+  /**
+   * Interrupt driven erase and program of one bank of the internal flash,
+   * backend of a bslib::flash::Job_Queue.
+   *
+   * The operation is started and the function returns, the end of operation
+   * (or an error) is reported from irq_handler(), which has to be called from
+   * the callback registered with uC::IRQ_Manager::register_flash_irq().
+   * Addresses are the absolute addresses of the flash.
+   *
+   * An operation is only started, if H753_flash_controller is free, else the
+   * step and so the job of the queue fails. So tasks using the HAL driver or
+   * H753_internal_flash_update_memory must not submit jobs while they own
+   * the controller.
+   *
+   * No operation is started, while the write buffer is not empty (WBNE) or
+   * an operation is queued (QW), the owner of the controller has to flush the
+   * write buffer before releasing it.
+   */
+  class H753_async_flash_backend:  public bslib::flash::Flash_Backend_Interface
+  {
+    static constexpr std::size_t sector_size     = 128 * 1024;
+    static constexpr std::size_t flash_word_size = 32;
+    static constexpr std::size_t bank_size       = 1024 * 1024;
+
+    static constexpr uint32_t error_flags = FLASH_SR_WRPERR | FLASH_SR_PGSERR | FLASH_SR_STRBERR | FLASH_SR_INCERR | FLASH_SR_OPERR;
+
+  public:
+    // bank 1 or 2
+    H753_async_flash_backend(uint8_t bank);
+
+    std::size_t get_sector_size() const noexcept override { return sector_size; }
+    std::size_t get_flash_word_size() const noexcept override { return flash_word_size; }
+
+    void set_operation_done_callback(wlib::Callback<void(bool)>* callback) noexcept override { this->m_operation_done = callback; }
+
+    bool start_erase(std::size_t address) noexcept override;
+    bool start_program(std::size_t address, std::span<std::byte const> word) noexcept override;
+
+    // call from FLASH_IRQHandler, both banks share the interrupt
+    void irq_handler() noexcept;
+
+  protected:
+    uint32_t volatile& m_key;
+    uint32_t volatile& m_cr;
+    uint32_t volatile& m_sr;
+    uint32_t volatile& m_ccr;
+    std::size_t const  m_bank_start_address;
+
+    wlib::Callback<void(bool)>* m_operation_done = nullptr;
+
+    // range to invalidate in the data cache after the operation
+    std::size_t m_pending_address = 0;
+    std::size_t m_pending_size    = 0;
+
+    // takes the controller and unlocks the bank, releases the controller on failure
+    bool unlock();
+    bool is_in_bank(std::size_t address, std::size_t size) const;
+    bool is_idle() const;
+  };
+
+} // namespace BSP
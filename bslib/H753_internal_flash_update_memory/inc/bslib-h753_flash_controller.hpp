@@ -0,0 +1,29 @@
+#pragma once
+#include <atomic>
+
+namespace BSP {
+
+  /**
+   * Ownership of the flash controller. The HAL driver (HAL_FLASH_Lock() locks
+   * CR1 and CR2 together), H753_internal_flash_update_memory and the
+   * H753_async_flash_backend of both banks program the same registers, only
+   * the owner may unlock the controller and start an operation.
+   *
+   * The backend owns the controller from the start of an operation until its
+   * interrupt, the next operation of the queue is started from there, so it
+   * is free again when the queue is idle. Polling drivers have to wait for it
+   * in their task.
+   *
+   * Does not block, try_lock() and unlock() may be called from interrupts.
+   */
+  class H753_flash_controller
+  {
+  public:
+    static bool try_lock() noexcept { return !s_owned.exchange(true, std::memory_order_acquire); }
+    static void unlock() noexcept { s_owned.store(false, std::memory_order_release); }
+
+  private:
+    static inline std::atomic<bool> s_owned = false;
+  };
+
+} // namespace BSP
@@ -0,0 +1,138 @@
+#include <bslib-h753_async_flash_backend.hpp>
+#include <cstring>
+#include <stdexcept>
+
+namespace BSP {
+
+H753_async_flash_backend::H753_async_flash_backend(uint8_t bank)
+    : m_key(bank == 1 ? FLASH->KEYR1 : FLASH->KEYR2)
+    , m_cr(bank == 1 ? FLASH->CR1 : FLASH->CR2)
+    , m_sr(bank == 1 ? FLASH->SR1 : FLASH->SR2)
+    , m_ccr(bank == 1 ? FLASH->CCR1 : FLASH->CCR2)
+    , m_bank_start_address(bank == 1 ? 0x0800'0000 : 0x0810'0000)
+{
+  if (bank != 1 && bank != 2)
+  {
+    throw std::runtime_error("Please check your config");
+  }
+}
+
+bool H753_async_flash_backend::unlock()
+{
+  if (!H753_flash_controller::try_lock())
+  {
+    return false;
+  }
+
+  if ((this->m_cr & FLASH_CR_LOCK) != 0)
+  {
+    this->m_key = 0x4567'0123;
+    this->m_key = 0xCDEF'89AB;
+  }
+
+  if ((this->m_cr & FLASH_CR_LOCK) != 0)
+  {
+    H753_flash_controller::unlock();
+    return false;
+  }
+
+  return true;
+}
+
+bool H753_async_flash_backend::is_in_bank(std::size_t address, std::size_t size) const
+{
+  return address >= this->m_bank_start_address && (address + size) <= (this->m_bank_start_address + bank_size);
+}
+
+bool H753_async_flash_backend::is_idle() const
+{
+  // a polling driver left a half filled write buffer, the words of the operation would be merged into it
+  return (this->m_sr & (FLASH_SR_QW | FLASH_SR_WBNE)) == 0;
+}
+
+bool H753_async_flash_backend::start_erase(std::size_t address) noexcept
+{
+  if (!this->is_in_bank(address, sector_size) || (address % sector_size) != 0 || !this->is_idle())
+  {
+    return false;
+  }
+
+  if (!this->unlock())
+  {
+    return false;
+  }
+
+  uint32_t const sec = (address - this->m_bank_start_address) / sector_size;
+
+  this->m_pending_address = address;
+  this->m_pending_size    = sector_size;
+
+  this->m_ccr = FLASH_CCR_CLR_EOP | FLASH_CCR_CLR_WRPERR | FLASH_CCR_CLR_PGSERR | FLASH_CCR_CLR_STRBERR | FLASH_CCR_CLR_INCERR | FLASH_CCR_CLR_OPERR;
+
+  this->m_cr = (this->m_cr & ~(FLASH_CR_SNB_Msk | FLASH_CR_SER_Msk | FLASH_CR_BER_Msk | FLASH_CR_PG_Msk)) | ((sec << FLASH_CR_SNB_Pos) & FLASH_CR_SNB_Msk) | FLASH_CR_SER |
+               FLASH_CR_EOPIE | FLASH_CR_WRPERRIE | FLASH_CR_PGSERRIE | FLASH_CR_STRBERRIE | FLASH_CR_INCERRIE | FLASH_CR_OPERRIE;
+  this->m_cr |= FLASH_CR_START;
+  return true;
+}
+
+bool H753_async_flash_backend::start_program(std::size_t address, std::span<std::byte const> word) noexcept
+{
+  if (word.size() != flash_word_size || !this->is_in_bank(address, flash_word_size) || (address % flash_word_size) != 0 || !this->is_idle())
+  {
+    return false;
+  }
+
+  if (!this->unlock())
+  {
+    return false;
+  }
+
+  this->m_pending_address = address;
+  this->m_pending_size    = flash_word_size;
+
+  this->m_ccr = FLASH_CCR_CLR_EOP | FLASH_CCR_CLR_WRPERR | FLASH_CCR_CLR_PGSERR | FLASH_CCR_CLR_STRBERR | FLASH_CCR_CLR_INCERR | FLASH_CCR_CLR_OPERR;
+
+  this->m_cr = (this->m_cr & ~(FLASH_CR_SER_Msk | FLASH_CR_BER_Msk)) | FLASH_CR_PG | FLASH_CR_EOPIE | FLASH_CR_WRPERRIE | FLASH_CR_PGSERRIE | FLASH_CR_STRBERRIE |
+               FLASH_CR_INCERRIE | FLASH_CR_OPERRIE;
+
+  // the write buffer is full after a complete flash word, programming starts on its own
+  uint32_t volatile* dest = reinterpret_cast<uint32_t volatile*>(address);
+  for (std::size_t i = 0; i < flash_word_size / sizeof(uint32_t); ++i)
+  {
+    uint32_t value;
+    std::memcpy(&value, word.data() + i * sizeof(uint32_t), sizeof(uint32_t));
+    dest[i] = value;
+  }
+
+  __DSB();
+  return true;
+}
+
+void H753_async_flash_backend::irq_handler() noexcept
+{
+  uint32_t const sr = this->m_sr;
+
+  if (this->m_pending_size == 0 || (sr & (FLASH_SR_EOP | error_flags)) == 0)
+  {
+    // no operation of this backend, the other bank
+    return;
+  }
+
+  this->m_ccr = FLASH_CCR_CLR_EOP | FLASH_CCR_CLR_WRPERR | FLASH_CCR_CLR_PGSERR | FLASH_CCR_CLR_STRBERR | FLASH_CCR_CLR_INCERR | FLASH_CCR_CLR_OPERR;
+
+  this->m_cr &= ~(FLASH_CR_PG | FLASH_CR_SER | FLASH_CR_EOPIE | FLASH_CR_WRPERRIE | FLASH_CR_PGSERRIE | FLASH_CR_STRBERRIE | FLASH_CR_INCERRIE | FLASH_CR_OPERRIE);
+  this->m_cr |= FLASH_CR_LOCK;
+
+  SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(this->m_pending_address), this->m_pending_size);
+  this->m_pending_size = 0;
+
+  H753_flash_controller::unlock();
+
+  // the callback may start the next operation at once
+  if (this->m_operation_done != nullptr)
+  {
+    (*this->m_operation_done)((sr & error_flags) == 0);
+  }
+}
+
+} // namespace BSP
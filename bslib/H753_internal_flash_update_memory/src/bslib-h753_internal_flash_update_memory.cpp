@@ -142,7 +142,7 @@ bool H753_internal_flash_update_memory::flush_data(uint32_t volatile& key, uint3
     {
     }
   }
-  cr &= FLASH_CR_PG;
+  cr &= ~FLASH_CR_PG;
   cr |= FLASH_CR_LOCK;
   SCB_InvalidateDCache_by_Addr(reinterpret_cast<uint32_t*>(this->m_start_address), this->m_size_in_byte);
   return (cr & FLASH_CR_LOCK) != 0;
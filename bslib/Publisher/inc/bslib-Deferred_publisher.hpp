@@ -0,0 +1,142 @@
+#pragma once
+#ifndef BSLIB_DEFERRED_PUBLISHER_HPP_INCLUDED
+#define BSLIB_DEFERRED_PUBLISHER_HPP_INCLUDED
+
+#include <array>
+#include <atomic>
+#include <bslib-Container.hpp>
+#include <cstddef>
+#include <os.hpp>
+#include <utility>
+#include <wlib.hpp>
+
+namespace bslib::publisher
+{
+  using namespace wlib::publisher;
+
+  /*
+   * Publisher with the interface of LF_Publisher, but notify() does not call
+   * the subscribers. It only copies the value into a Broadcast_Ring of Q (a power of 2)
+   * entries and wakes a dispatcher task, so the cost in the caller (e.g. a
+   * DMA ISR) is constant and independent of the subscribers.
+   *
+   * The dispatcher task runs every subscriber at task priority. Each
+   * subscriber slot has its own read cursor; values a subscriber could not
+   * take before the ring wrapped are counted per subscriber.
+   */
+  template <typename T, std::size_t N, std::size_t Q = 4, std::size_t StackSize = 2048>
+    requires(N > 0 && Q > 1 && (Q & (Q - 1)) == 0)
+  class Deferred_LF_Publisher
+      : public Publisher_Interface<T>
+      , public Publisher_Interface<T>::Notifyable_Interface
+  {
+    using Notifyable_Interface = typename Publisher_Interface<T>::Notifyable_Interface;
+    using this_t               = Deferred_LF_Publisher;
+    using ring_t               = bslib::container::Broadcast_Ring<T, Q>;
+    using reader_t             = typename ring_t::Reader;
+
+  public:
+    using payload_t = typename Publisher_Interface<T>::payload_t;
+
+    static constexpr std::size_t max_number_of_subscribers = N;
+    static constexpr std::size_t queue_size                = Q;
+
+    Deferred_LF_Publisher(char const* name = "deferred_pub", os::Task_Interface::Priority const& prio = os::Task_Interface::Priority::high)
+        : m_dispatcher{ *this, &this_t::dispatch, name, prio }
+    {
+      this->m_dispatcher.start();
+    }
+
+    // constant time and safe to be called from an ISR (single producer)
+    void notify(payload_t const& value) noexcept override
+    {
+      this->m_ring.push_back(value);
+      this->m_dispatcher.notify();
+    }
+
+    std::size_t get_number_of_published_values() const noexcept { return this->m_ring.get_number_of_written_entries(); }
+
+    // values the subscriber in slot subscriber_idx missed because the ring wrapped
+    std::size_t get_number_of_dropped_values(std::size_t const& subscriber_idx) const noexcept
+    {
+      if (subscriber_idx >= max_number_of_subscribers)
+        return 0;
+      return this->m_dropped[subscriber_idx].load(std::memory_order_relaxed);
+    }
+
+  private:
+    bool try_add_subscriber(Notifyable_Interface& sub) override
+    {
+      for (auto& cur_entry : m_subscriber_list)
+      {
+        Notifyable_Interface* expected = nullptr;
+        if (cur_entry.compare_exchange_strong(expected, &sub))
+        {
+          return true;
+        }
+      }
+      return false;
+    }
+
+    void remove_subscriber(Notifyable_Interface& sub) override
+    {
+      for (auto& cur_entry : m_subscriber_list)
+      {
+        Notifyable_Interface* expected = &sub;
+        cur_entry.compare_exchange_strong(expected, nullptr);
+      }
+      this->m_epoch.synchronize([]() { os::this_thread::yield(); });
+    }
+
+    void dispatch()
+    {
+      while (os::this_thread::keep_running())
+      {
+        os::this_thread::wait_for_notify();
+
+        bslib::container::Epoch_Domain::Read_Guard const guard{ this->m_epoch };
+        for (std::size_t i = 0; i < max_number_of_subscribers; i++)
+        {
+          Notifyable_Interface* subscriber = this->m_subscriber_list[i].load(std::memory_order_seq_cst);
+          reader_t&             reader     = this->m_readers[i];
+
+          if (subscriber != this->m_known_subscriber[i])
+          {
+            // a new subscriber only gets values published after the dispatcher noticed it
+            reader.skip_to_newest();
+            this->m_known_subscriber[i] = subscriber;
+            this->m_lost_base[i]        = reader.get_number_of_lost_entries();
+            this->m_dropped[i].store(0, std::memory_order_relaxed);
+          }
+
+          if (subscriber == nullptr)
+            continue;
+
+          for (auto value = reader.try_read(); value.has_value(); value = reader.try_read())
+          {
+            subscriber->notify(value.value());
+          }
+          this->m_dropped[i].store(reader.get_number_of_lost_entries() - this->m_lost_base[i], std::memory_order_relaxed);
+        }
+      }
+    }
+
+    template <std::size_t... I> static std::array<reader_t, sizeof...(I)> make_readers(ring_t const& ring, std::index_sequence<I...>)
+    {
+      return { ((void)I, reader_t{ ring })... };
+    }
+
+  private:
+    ring_t                                                   m_ring    = {};
+    std::array<reader_t, max_number_of_subscribers>          m_readers = make_readers(m_ring, std::make_index_sequence<max_number_of_subscribers>{});
+    Notifyable_Interface*                                    m_known_subscriber[max_number_of_subscribers] = {};
+    std::size_t                                              m_lost_base[max_number_of_subscribers]        = {};
+    std::atomic<std::size_t>                                 m_dropped[max_number_of_subscribers]          = {};
+    std::atomic<Notifyable_Interface*>                       m_subscriber_list[max_number_of_subscribers]  = {};
+    bslib::container::Epoch_Domain                           m_epoch                                       = {};
+    os::Static_MemberfunctionCallbackTask<this_t, StackSize> m_dispatcher;
+  };
+
+}    // namespace bslib::publisher
+
+#endif
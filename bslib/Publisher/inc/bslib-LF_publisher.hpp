@@ -3,6 +3,7 @@
 #define BSLIB_LOCKFREE_PUBLISHER_HPP_INCLUDED
 
 #include <atomic>
+#include <bslib-Container.hpp>
 #include <concepts>
 #include <cstddef>
 #include <os.hpp>
@@ -28,16 +29,16 @@ namespace bslib::publisher
   public:
     void notify(payload_t const& value) noexcept
     {
-      this->m_notify_ongoing = true;
+      bslib::container::Epoch_Domain::Read_Guard const guard{ this->m_epoch };
       for (auto& cur_entry : m_subscriber_list)
       {
-        Notifyable_Interface* subscriber = cur_entry.load(std::memory_order_acquire);
+        // seq_cst: has to be ordered after entering the epoch, see Epoch_Domain
+        Notifyable_Interface* subscriber = cur_entry.load(std::memory_order_seq_cst);
         if (subscriber != nullptr)
         {
           subscriber->notify(value);
         }
       }
-      this->m_notify_ongoing = false;
     }
 
   private:
@@ -61,15 +62,13 @@ namespace bslib::publisher
         Notifyable_Interface* expected = &sub;
         cur_entry.compare_exchange_strong(expected, nullptr);
       }
-      while (this->m_notify_ongoing)
-      {
-        os::this_thread::yield();
-      }
+      // waits only for notifications which may still use sub, new ones already see nullptr
+      this->m_epoch.synchronize([]() { os::this_thread::yield(); });
     }
 
   private:
     std::atomic<Notifyable_Interface*> m_subscriber_list[max_number_of_subscribers] = {};
-    std::atomic<bool>                  m_notify_ongoing                             = false;
+    bslib::container::Epoch_Domain     m_epoch                                      = {};
   };
 
   template <std::size_t N>
@@ -88,16 +87,16 @@ namespace bslib::publisher
   public:
     void notify() noexcept
     {
-      this->m_notify_ongoing = true;
+      bslib::container::Epoch_Domain::Read_Guard const guard{ this->m_epoch };
       for (auto& cur_entry : m_subscriber_list)
       {
-        Notifyable_Interface* subscriber = cur_entry.load(std::memory_order_acquire);
+        // seq_cst: has to be ordered after entering the epoch, see Epoch_Domain
+        Notifyable_Interface* subscriber = cur_entry.load(std::memory_order_seq_cst);
         if (subscriber != nullptr)
         {
           subscriber->notify();
         }
       }
-      this->m_notify_ongoing = false;
     }
 
   private:
@@ -121,15 +120,13 @@ namespace bslib::publisher
         Notifyable_Interface* expected = &sub;
         cur_entry.compare_exchange_strong(expected, nullptr);
       }
-      while (this->m_notify_ongoing)
-      {
-        os::this_thread::yield();
-      }
+      // waits only for notifications which may still use sub, new ones already see nullptr
+      this->m_epoch.synchronize([]() { os::this_thread::yield(); });
     }
 
   private:
     std::atomic<Notifyable_Interface*> m_subscriber_list[max_number_of_subscribers] = {};
-    std::atomic<bool>                  m_notify_ongoing                             = false;
+    bslib::container::Epoch_Domain     m_epoch                                      = {};
   };
 
 }    // namespace bslib::publisher
@@ -2,6 +2,7 @@
 #ifndef BSLIB_PUBLISHER_HPP_INCLUDED
 #define BSLIB_PUBLISHER_HPP_INCLUDED
 
+#include <bslib-Deferred_publisher.hpp>
 #include <bslib-LF_publisher.hpp>
 #include <bslib-SPSC_subscriber.hpp>
 
@@ -7,6 +7,8 @@
 #include <bslib-Provider.hpp>
 #include <bslib-Publisher.hpp>
 #include <bslib-utility_Interfaces.hpp>
+#include <bslib-Flash_Job_Queue.hpp>
 #include <bslib-h753_internal_flash_update_memory.hpp>
+#include <bslib-h753_async_flash_backend.hpp>
 
 #endif
@@ -2,8 +2,12 @@
 #ifndef EXMATH_BLAS_HPP_INCLUDED
 #define EXMATH_BLAS_HPP_INCLUDED
 
+#include <algorithm>
 #include <cstdint>
+#include <exmath-blas_kernels.hpp>
 #include <exmath-constants.hpp>
+#include <type_traits>
+#include <utility>
 
 namespace exmath
 {
@@ -12,6 +16,10 @@ namespace exmath
   template <index_t N, index_t M> class matrix_size_t;
   template <typename T, index_t N, index_t M> class matrix_t;
 
+  // lazy expression of exmath-blas_expression.hpp, matrix_t can be constructed and assigned from it
+  template <typename E>
+  concept MatrixExpression = requires { requires E::is_matrix_expression; };
+
   template <index_t N, index_t M> class matrix_size_t
   {
   public:
@@ -59,34 +67,54 @@ namespace exmath
         }
     }
 
+    template <MatrixExpression E>
+      requires(E::number_of_rows == N && E::number_of_columns == M)
+    constexpr matrix_t(E const& expr) noexcept
+    {
+      expr.assign_to(*this);
+    }
+
+    template <MatrixExpression E>
+      requires(E::number_of_rows == N && E::number_of_columns == M)
+    constexpr matrix_t& operator=(E const& expr) noexcept
+    {
+      expr.assign_to(*this);
+      return *this;
+    }
+
     [[nodiscard]] constexpr value_type operator()(index_t const& r, index_t const& c) const& noexcept { return this->m_data[size_t::p_calc_idx(r, c)]; }
     [[nodiscard]] constexpr value_type operator[](index_t const& e) const& noexcept { return this->m_data[e]; }
 
     [[nodiscard]] constexpr value_type& operator()(index_t const& r, index_t const& c) & noexcept { return this->m_data[size_t::p_calc_idx(r, c)]; }
     [[nodiscard]] constexpr value_type& operator[](index_t const& e) & noexcept { return this->m_data[e]; }
 
+    // row major elements
+    [[nodiscard]] constexpr value_type const* data() const noexcept { return this->m_data; }
+    [[nodiscard]] constexpr value_type*       data() noexcept { return this->m_data; }
+
     constexpr void row_swap(index_t const& row_a, index_t const& row_b)
     {
-      matrix_t& self = *this;
-      for (index_t j = 0; j < size_t::number_of_columns; ++j)
-        std::swap(self(row_a, j), self(row_b, j));
+      std::swap_ranges(this->p_row(row_a), this->p_row(row_a) + size_t::number_of_columns, this->p_row(row_b));
     }
 
     constexpr void row_div(index_t const& row, T const& val)
     {
-      matrix_t& self = *this;
+      value_type* const ptr = this->p_row(row);
       for (index_t j = 0; j < size_t::number_of_columns; ++j)
-        self(row, j) /= val;
+        ptr[j] /= val;
     }
 
     constexpr void row_sub_n_times_row(index_t const& row_a, T const& fac, index_t const& row_b)
     {
-      matrix_t& self = *this;
+      value_type* const       ptr_a = this->p_row(row_a);
+      value_type const* const ptr_b = this->p_row(row_b);
       for (index_t j = 0; j < size_t::number_of_columns; ++j)
-        self(row_a, j) -= self(row_b, j) * fac;
+        ptr_a[j] -= ptr_b[j] * fac;
     }
 
   private:
+    constexpr value_type* p_row(index_t const& row) noexcept { return this->m_data + size_t::p_calc_idx(row, 0); }
+
     value_type m_data[size_t::number_of_elements] = {};
   };
 
@@ -104,6 +132,8 @@ namespace exmath
     constexpr value_type operator()(index_t const& r, index_t const& c) const& noexcept { return this->m_data[size_t::p_calc_idx(r, c)]; }
     constexpr value_type operator[](index_t const& e) const& noexcept { return this->m_data[e]; }
 
+    [[nodiscard]] constexpr value_type const* data() const noexcept { return this->m_data; }
+
   private:
     value_type const (&m_data)[size_t::number_of_elements];
   };
@@ -128,12 +158,22 @@ namespace exmath
     {
     }
 
+    template <MatrixExpression E>
+      requires(E::number_of_rows == 1 && E::number_of_columns == 1)
+    constexpr matrix_t(E const& expr) noexcept
+    {
+      expr.assign_to(*this);
+    }
+
     constexpr value_type operator()(index_t const&, index_t const&) const& noexcept { return this->m_data; }
     constexpr value_type operator[](index_t const&) const& noexcept { return this->m_data; }
 
     constexpr value_type& operator()(index_t const&, index_t const&) & noexcept { return this->m_data; }
     constexpr value_type& operator[](index_t const&) & noexcept { return this->m_data; }
 
+    [[nodiscard]] constexpr value_type const* data() const noexcept { return &this->m_data; }
+    [[nodiscard]] constexpr value_type*       data() noexcept { return &this->m_data; }
+
     constexpr matrix_t& operator=(value_type const& val)
     {
       matrix_t& self = *this;
@@ -141,6 +181,14 @@ namespace exmath
       return self;
     }
 
+    template <MatrixExpression E>
+      requires(E::number_of_rows == 1 && E::number_of_columns == 1)
+    constexpr matrix_t& operator=(E const& expr) noexcept
+    {
+      expr.assign_to(*this);
+      return *this;
+    }
+
     constexpr operator value_type() const& { return this->m_data; }
 
   private:
@@ -168,81 +216,69 @@ namespace exmath
 
     constexpr operator value_type() const& { return this->m_data; }
 
+    [[nodiscard]] constexpr value_type const* data() const noexcept { return &this->m_data; }
+
   private:
     value_type const& m_data;
   };
 
   namespace Internal
   {
+    // the element wise operations run over the flat row major elements, which the compiler can vectorize
+
     template <typename TL, typename TR> [[nodiscard]] constexpr bool equal(TL const& lhs, TR const& rhs) noexcept
     {
-      for (index_t i = 0; i < lhs.number_of_rows; ++i)
-        for (index_t j = 0; j < lhs.number_of_columns; ++j)
-        {
-          if (lhs(i, j) != rhs(i, j))
-            return false;
-        }
+      for (index_t e = 0; e < lhs.number_of_elements; ++e)
+      {
+        if (lhs[e] != rhs[e])
+          return false;
+      }
       return true;
     }
 
-    template <typename TL, typename TR> [[nodiscard]] constexpr bool not_equal(TL const& lhs, TR const& rhs) noexcept
-    {
-      for (index_t i = 0; i < lhs.number_of_rows; ++i)
-        for (index_t j = 0; j < lhs.number_of_columns; ++j)
-        {
-          if (lhs(i, j) != rhs(i, j))
-            return true;
-        }
-      return false;
-    }
+    template <typename TL, typename TR> [[nodiscard]] constexpr bool not_equal(TL const& lhs, TR const& rhs) noexcept { return !equal(lhs, rhs); }
 
     template <typename TL, typename TR, typename TE> [[nodiscard]] constexpr TE matrix_add(TL const& lhs, TR const& rhs) noexcept
     {
       TE ret;
-      for (index_t i = 0; i < ret.number_of_rows; ++i)
-        for (index_t j = 0; j < ret.number_of_columns; ++j)
-        {
-          ret(i, j) = lhs(i, j) + rhs(i, j);
-        }
+      for (index_t e = 0; e < ret.number_of_elements; ++e)
+        ret[e] = lhs[e] + rhs[e];
       return ret;
     }
 
     template <typename TL, typename TR, typename TE> [[nodiscard]] constexpr TE matrix_sub(TL const& lhs, TR const& rhs) noexcept
     {
       TE ret;
-      for (index_t i = 0; i < ret.number_of_rows; ++i)
-        for (index_t j = 0; j < ret.number_of_columns; ++j)
-        {
-          ret(i, j) = lhs(i, j) - rhs(i, j);
-        }
+      for (index_t e = 0; e < ret.number_of_elements; ++e)
+        ret[e] = lhs[e] - rhs[e];
       return ret;
     }
 
     template <typename TM, typename TS, typename TE> [[nodiscard]] constexpr TE matrix_skalar_product(TM const& mat, TS const& sca) noexcept
     {
       TE ret;
-      for (index_t i = 0; i < ret.number_of_rows; ++i)
-        for (index_t j = 0; j < ret.number_of_columns; ++j)
-        {
-          ret(i, j) = mat(i, j) * sca;
-        }
+      for (index_t e = 0; e < ret.number_of_elements; ++e)
+        ret[e] = mat[e] * sca;
       return ret;
     }
 
     template <typename TM, typename TS, typename TE> [[nodiscard]] constexpr TE matrix_skalar_quotient(TM const& mat, TS const& sca) noexcept
     {
       TE ret;
-      for (index_t i = 0; i < ret.number_of_rows; ++i)
-        for (index_t j = 0; j < ret.number_of_columns; ++j)
-        {
-          ret(i, j) = mat(i, j) / sca;
-        }
+      for (index_t e = 0; e < ret.number_of_elements; ++e)
+        ret[e] = mat[e] / sca;
       return ret;
     }
 
     template <typename TL, typename TR, typename TE> [[nodiscard]] constexpr TE matrix_matrix_product(TL const& lhs, TR const& rhs) noexcept
     {
       TE ret;
+      if (!std::is_constant_evaluated())
+      {
+        kernels::gemm<typename TE::value_type, TL::number_of_rows, TL::number_of_columns, TE::number_of_columns>(lhs.data(), rhs.data(), ret.data());
+        return ret;
+      }
+
       for (index_t i = 0; i < ret.number_of_rows; ++i)
         for (index_t j = 0; j < ret.number_of_columns; ++j)
         {
@@ -256,41 +292,29 @@ namespace exmath
 
     template <typename TL, typename TR> constexpr TL& matrix_add_assign(TL& lhs, TR const& rhs) noexcept
     {
-      for (index_t i = 0; i < lhs.number_of_rows; ++i)
-        for (index_t j = 0; j < lhs.number_of_columns; ++j)
-        {
-          lhs(i, j) += rhs(i, j);
-        }
+      for (index_t e = 0; e < lhs.number_of_elements; ++e)
+        lhs[e] += rhs[e];
       return lhs;
     }
 
     template <typename TL, typename TR> constexpr TL& matrix_sub_assign(TL& lhs, TR const& rhs) noexcept
     {
-      for (index_t i = 0; i < lhs.number_of_rows; ++i)
-        for (index_t j = 0; j < lhs.number_of_columns; ++j)
-        {
-          lhs(i, j) -= rhs(i, j);
-        }
+      for (index_t e = 0; e < lhs.number_of_elements; ++e)
+        lhs[e] -= rhs[e];
       return lhs;
     }
 
     template <typename TM, typename TS> constexpr TM& matrix_skalar_product_assign(TM& lhs, TS const& sca) noexcept
     {
-      for (index_t i = 0; i < lhs.number_of_rows; ++i)
-        for (index_t j = 0; j < lhs.number_of_columns; ++j)
-        {
-          lhs(i, j) *= sca;
-        }
+      for (index_t e = 0; e < lhs.number_of_elements; ++e)
+        lhs[e] *= sca;
       return lhs;
     }
 
     template <typename TM, typename TS> constexpr TM& matrix_skalar_quotient_assign(TM& lhs, TS const& sca) noexcept
     {
-      for (index_t i = 0; i < lhs.number_of_rows; ++i)
-        for (index_t j = 0; j < lhs.number_of_columns; ++j)
-        {
-          lhs(i, j) /= sca;
-        }
+      for (index_t e = 0; e < lhs.number_of_elements; ++e)
+        lhs[e] /= sca;
       return lhs;
     }
 
@@ -0,0 +1,564 @@
+#pragma once
+#ifndef EXMATH_BLAS_DECOMPOSITION_HPP_INCLUDED
+#define EXMATH_BLAS_DECOMPOSITION_HPP_INCLUDED
+
+#include <cmath>
+#include <exmath-blas.hpp>
+#include <limits>
+#include <type_traits>
+#include <utility>
+
+/*
+ * Decompositions which are calculated once and then solve any number of
+ * right hand sides in O(n^2) each, instead of the O(n^3) elimination of
+ * exmath::solve on every call.
+ *
+ *   lu_t<T, N>:       P A = L U with partial pivoting, for any regular A
+ *   cholesky_t<T, N>: A = L L^T, for symmetric positive definite A
+ *   qr_t<T, N, M>:    A = Q R with N >= M, least squares solutions
+ *
+ * All of them support rank 1 updates of A in O(n^2), e.g. to add a sample
+ * to the normal equations of a fit without factorizing again. Everything
+ * is constexpr. Errors (a singular or not positive definite matrix) are
+ * reported by the state of the object, there are no exceptions.
+ */
+namespace exmath
+{
+  namespace Internal
+  {
+    template <typename T> [[nodiscard]] constexpr T abs_value(T const& val) noexcept { return (val < T(0)) ? -val : val; }
+
+    // std::sqrt is not constexpr
+    template <typename T> [[nodiscard]] constexpr T sqrt_value(T const& val) noexcept
+    {
+      if (!std::is_constant_evaluated())
+        return std::sqrt(val);
+
+      if (val < T(0))
+        return std::numeric_limits<T>::quiet_NaN();
+      if (val == T(0))
+        return val;
+
+      // newton from above decreases monotonically until it is exact
+      T ret = (val > T(1)) ? val : T(1);
+      while (true)
+      {
+        T const next = (ret + val / ret) / T(2);
+        if (next >= ret)
+          return ret;
+        ret = next;
+      }
+    }
+
+    template <typename T> struct givens_t
+    {
+      T c = T(1);
+      T s = T(0);
+
+      // rotation which maps (a, b) to (r, 0)
+      static constexpr givens_t make(T const& a, T const& b) noexcept
+      {
+        if (b == T(0))
+          return {};
+        T const r = sqrt_value(a * a + b * b);
+        return { a / r, b / r };
+      }
+
+      constexpr void apply(T& a, T& b) const noexcept
+      {
+        T const tmp_a = a;
+        a             = this->c * tmp_a + this->s * b;
+        b             = this->c * b - this->s * tmp_a;
+      }
+    };
+  }    // namespace Internal
+
+  /*
+   * LU decomposition with partial pivoting: P A = L U, L with unit
+   * diagonal and both stored in one matrix.
+   */
+  template <typename T, index_t N> class lu_t
+  {
+  public:
+    using value_type  = std::remove_cv_t<T>;
+    using matrix_type = matrix_t<value_type, N, N>;
+    using vector_type = matrix_t<value_type, N, 1>;
+
+    constexpr explicit lu_t(matrix_type const& val) noexcept
+        : m_lu(val)
+    {
+      this->p_factorize();
+    }
+
+    constexpr explicit lu_t(matrix_t<const T, N, N> const& val) noexcept
+        : lu_t(matrix_type(val))
+    {
+    }
+
+    [[nodiscard]] constexpr bool is_singular() const noexcept { return this->m_singular; }
+
+    [[nodiscard]] constexpr value_type determinant() const noexcept
+    {
+      value_type ret = this->m_odd_permutation ? value_type(-1) : value_type(1);
+      for (index_t i = 0; i < N; ++i)
+        ret *= this->m_lu(i, i);
+      return ret;
+    }
+
+    // x with A x = rhs, O(n^2) per column
+    template <index_t M> [[nodiscard]] constexpr matrix_t<value_type, N, M> solve(matrix_t<value_type, N, M> const& rhs) const noexcept
+    {
+      matrix_t<value_type, N, M> ret;
+      for (index_t c = 0; c < M; ++c)
+      {
+        for (index_t i = 0; i < N; ++i)
+        {
+          value_type val = rhs(this->m_perm[i], c);
+          for (index_t k = 0; k < i; ++k)
+            val -= this->m_lu(i, k) * ret(k, c);
+          ret(i, c) = val;
+        }
+        for (index_t i = N; i-- > 0;)
+        {
+          value_type val = ret(i, c);
+          for (index_t k = i + 1; k < N; ++k)
+            val -= this->m_lu(i, k) * ret(k, c);
+          ret(i, c) = val / this->m_lu(i, i);
+        }
+      }
+      return ret;
+    }
+
+    template <index_t M> [[nodiscard]] constexpr matrix_t<value_type, N, M> solve(matrix_t<const T, N, M> const& rhs) const noexcept
+    {
+      return this->solve(matrix_t<value_type, N, M>(rhs));
+    }
+
+    [[nodiscard]] constexpr matrix_type inverse() const noexcept
+    {
+      matrix_type rhs = {};
+      for (index_t i = 0; i < N; ++i)
+        rhs(i, i) = value_type(1);
+      return this->solve(rhs);
+    }
+
+    /*
+     * decomposition of A + u v^T in O(n^2) (Bennett). The update keeps the
+     * pivot order of the original decomposition, it can not pivot again. If
+     * a pivot loses most of its digits by cancellation, A + u v^T is
+     * factorized again with new pivots from P^T L U + u v^T in O(n^3).
+     * Returns false if A + u v^T is singular.
+     */
+    constexpr bool rank_1_update(vector_type const& u, vector_type const& v) noexcept
+    {
+      lu_t updated = *this;
+      if (updated.p_rank_1(u, v))
+      {
+        *this = updated;
+        return true;
+      }
+
+      matrix_type val;
+      for (index_t i = 0; i < N; ++i)
+      {
+        for (index_t j = 0; j < N; ++j)
+        {
+          value_type sum = (j >= i) ? this->m_lu(i, j) : value_type(0);
+          for (index_t k = 0; k < i && k <= j; ++k)
+            sum += this->m_lu(i, k) * this->m_lu(k, j);
+          val(this->m_perm[i], j) = sum + u(this->m_perm[i], 0) * v(j, 0);
+        }
+      }
+
+      *this = lu_t(val);
+      return !this->m_singular;
+    }
+
+    // L below and U on and above the diagonal
+    [[nodiscard]] constexpr matrix_type const& get_lu() const noexcept { return this->m_lu; }
+
+    // row i of L U is row get_permutation(i) of A
+    [[nodiscard]] constexpr index_t get_permutation(index_t const& i) const noexcept { return this->m_perm[i]; }
+
+  private:
+    // false if a pivot became too small, the object is unusable then
+    constexpr bool p_rank_1(vector_type const& u, vector_type const& v) noexcept
+    {
+      value_type const tolerance = Internal::sqrt_value(std::numeric_limits<value_type>::epsilon());
+
+      value_type x[N] = {};
+      value_type y[N] = {};
+      for (index_t i = 0; i < N; ++i)
+      {
+        x[i] = u(this->m_perm[i], 0);
+        y[i] = v(i, 0);
+      }
+
+      for (index_t k = 0; k < N; ++k)
+      {
+        value_type const pivot = this->m_lu(k, k);
+        value_type const diag  = pivot + x[k] * y[k];
+        if (!(Internal::abs_value(diag) > tolerance * (Internal::abs_value(pivot) + Internal::abs_value(x[k] * y[k]))))
+          return false;
+        this->m_lu(k, k) = diag;
+
+        for (index_t j = k + 1; j < N; ++j)
+        {
+          value_type const u_kj = this->m_lu(k, j);
+          this->m_lu(k, j)      = u_kj + x[k] * y[j];
+          y[j]                  = (pivot * y[j] - y[k] * u_kj) / diag;
+        }
+        for (index_t i = k + 1; i < N; ++i)
+        {
+          value_type const l_ik = this->m_lu(i, k);
+          this->m_lu(i, k)      = (pivot * l_ik + y[k] * x[i]) / diag;
+          x[i] -= x[k] * l_ik;
+        }
+      }
+      this->m_singular = false;
+      return true;
+    }
+
+    constexpr void p_factorize() noexcept
+    {
+      for (index_t i = 0; i < N; ++i)
+        this->m_perm[i] = i;
+
+      for (index_t k = 0; k < N; ++k)
+      {
+        index_t    idx     = k;
+        value_type max_val = Internal::abs_value(this->m_lu(k, k));
+        for (index_t i = k + 1; i < N; ++i)
+        {
+          value_type const tmp = Internal::abs_value(this->m_lu(i, k));
+          if (tmp > max_val)
+          {
+            idx     = i;
+            max_val = tmp;
+          }
+        }
+
+        if (max_val == value_type(0))
+        {
+          this->m_singular = true;
+          continue;
+        }
+
+        if (idx != k)
+        {
+          this->m_lu.row_swap(k, idx);
+          std::swap(this->m_perm[k], this->m_perm[idx]);
+          this->m_odd_permutation = !this->m_odd_permutation;
+        }
+
+        value_type const pivot = this->m_lu(k, k);
+        for (index_t i = k + 1; i < N; ++i)
+        {
+          value_type const fac = this->m_lu(i, k) / pivot;
+          this->m_lu(i, k)     = fac;
+          for (index_t j = k + 1; j < N; ++j)
+            this->m_lu(i, j) -= fac * this->m_lu(k, j);
+        }
+      }
+    }
+
+    matrix_type m_lu;
+    index_t     m_perm[N]         = {};
+    bool        m_odd_permutation = false;
+    bool        m_singular        = false;
+  };
+
+  /*
+   * Cholesky decomposition of a symmetric positive definite matrix:
+   * A = L L^T. Only the lower triangle of A is used.
+   */
+  template <typename T, index_t N> class cholesky_t
+  {
+  public:
+    using value_type  = std::remove_cv_t<T>;
+    using matrix_type = matrix_t<value_type, N, N>;
+    using vector_type = matrix_t<value_type, N, 1>;
+
+    constexpr explicit cholesky_t(matrix_type const& val) noexcept { this->p_factorize(val); }
+
+    constexpr explicit cholesky_t(matrix_t<const T, N, N> const& val) noexcept
+        : cholesky_t(matrix_type(val))
+    {
+    }
+
+    [[nodiscard]] constexpr bool is_positive_definite() const noexcept { return this->m_positive_definite; }
+
+    [[nodiscard]] constexpr value_type determinant() const noexcept
+    {
+      value_type ret = value_type(1);
+      for (index_t i = 0; i < N; ++i)
+        ret *= this->m_l(i, i);
+      return ret * ret;
+    }
+
+    // x with A x = rhs, O(n^2) per column
+    template <index_t M> [[nodiscard]] constexpr matrix_t<value_type, N, M> solve(matrix_t<value_type, N, M> const& rhs) const noexcept
+    {
+      matrix_t<value_type, N, M> ret;
+      for (index_t c = 0; c < M; ++c)
+      {
+        for (index_t i = 0; i < N; ++i)
+        {
+          value_type val = rhs(i, c);
+          for (index_t k = 0; k < i; ++k)
+            val -= this->m_l(i, k) * ret(k, c);
+          ret(i, c) = val / this->m_l(i, i);
+        }
+        for (index_t i = N; i-- > 0;)
+        {
+          value_type val = ret(i, c);
+          for (index_t k = i + 1; k < N; ++k)
+            val -= this->m_l(k, i) * ret(k, c);
+          ret(i, c) = val / this->m_l(i, i);
+        }
+      }
+      return ret;
+    }
+
+    template <index_t M> [[nodiscard]] constexpr matrix_t<value_type, N, M> solve(matrix_t<const T, N, M> const& rhs) const noexcept
+    {
+      return this->solve(matrix_t<value_type, N, M>(rhs));
+    }
+
+    // decomposition of A + x x^T in O(n^2)
+    constexpr void rank_1_update(vector_type const& x) noexcept { this->p_rank_1(x, value_type(1)); }
+
+    /*
+     * decomposition of A - x x^T in O(n^2), e.g. to remove a sample again.
+     * Returns false if the result is not positive definite, the
+     * decomposition is unusable then.
+     */
+    constexpr bool rank_1_downdate(vector_type const& x) noexcept { return this->p_rank_1(x, value_type(-1)); }
+
+    [[nodiscard]] constexpr matrix_type const& get_l() const noexcept { return this->m_l; }
+
+  private:
+    constexpr void p_factorize(matrix_type const& val) noexcept
+    {
+      for (index_t j = 0; j < N; ++j)
+      {
+        value_type diag = val(j, j);
+        for (index_t k = 0; k < j; ++k)
+          diag -= this->m_l(j, k) * this->m_l(j, k);
+        if (!(diag > value_type(0)))
+        {
+          this->m_positive_definite = false;
+          return;
+        }
+        this->m_l(j, j) = Internal::sqrt_value(diag);
+
+        for (index_t i = j + 1; i < N; ++i)
+        {
+          value_type tmp = val(i, j);
+          for (index_t k = 0; k < j; ++k)
+            tmp -= this->m_l(i, k) * this->m_l(j, k);
+          this->m_l(i, j) = tmp / this->m_l(j, j);
+        }
+      }
+    }
+
+    constexpr bool p_rank_1(vector_type const& val, value_type const& sign) noexcept
+    {
+      value_type x[N] = {};
+      for (index_t i = 0; i < N; ++i)
+        x[i] = val(i, 0);
+
+      for (index_t k = 0; k < N; ++k)
+      {
+        value_type const l_kk = this->m_l(k, k);
+        value_type const r2   = l_kk * l_kk + sign * x[k] * x[k];
+        if (!(r2 > value_type(0)))
+        {
+          this->m_positive_definite = false;
+          return false;
+        }
+
+        value_type const r = Internal::sqrt_value(r2);
+        value_type const c = r / l_kk;
+        value_type const s = x[k] / l_kk;
+        this->m_l(k, k)    = r;
+        for (index_t i = k + 1; i < N; ++i)
+        {
+          this->m_l(i, k) = (this->m_l(i, k) + sign * s * x[i]) / c;
+          x[i]            = c * x[i] - s * this->m_l(i, k);
+        }
+      }
+      return true;
+    }
+
+    matrix_type m_l                 = {};
+    bool        m_positive_definite = true;
+  };
+
+  /*
+   * QR decomposition (Householder) of an N x M matrix with N >= M: A = Q R,
+   * Q orthogonal N x N and R upper triangular N x M. Q is kept explicitly,
+   * which costs N x N elements but allows rank 1 updates.
+   */
+  template <typename T, index_t N, index_t M>
+    requires(N >= M)
+  class qr_t
+  {
+  public:
+    using value_type = std::remove_cv_t<T>;
+
+    constexpr explicit qr_t(matrix_t<value_type, N, M> const& val) noexcept
+        : m_r(val)
+    {
+      this->p_factorize();
+    }
+
+    constexpr explicit qr_t(matrix_t<const T, N, M> const& val) noexcept
+        : qr_t(matrix_t<value_type, N, M>(val))
+    {
+    }
+
+    // a zero on the diagonal of R, the columns of A are linear dependent
+    [[nodiscard]] constexpr bool is_rank_deficient() const noexcept
+    {
+      for (index_t i = 0; i < M; ++i)
+      {
+        if (this->m_r(i, i) == value_type(0))
+          return true;
+      }
+      return false;
+    }
+
+    // x which minimizes |A x - rhs| (the solution of A x = rhs for N == M), O(N M) per column
+    template <index_t K> [[nodiscard]] constexpr matrix_t<value_type, M, K> solve(matrix_t<value_type, N, K> const& rhs) const noexcept
+    {
+      matrix_t<value_type, M, K> ret;
+      for (index_t c = 0; c < K; ++c)
+      {
+        // first M elements of Q^T rhs
+        for (index_t i = 0; i < M; ++i)
+        {
+          value_type val = value_type(0);
+          for (index_t r = 0; r < N; ++r)
+            val += this->m_q(r, i) * rhs(r, c);
+          ret(i, c) = val;
+        }
+        for (index_t i = M; i-- > 0;)
+        {
+          value_type val = ret(i, c);
+          for (index_t k = i + 1; k < M; ++k)
+            val -= this->m_r(i, k) * ret(k, c);
+          ret(i, c) = val / this->m_r(i, i);
+        }
+      }
+      return ret;
+    }
+
+    template <index_t K> [[nodiscard]] constexpr matrix_t<value_type, M, K> solve(matrix_t<const T, N, K> const& rhs) const noexcept
+    {
+      return this->solve(matrix_t<value_type, N, K>(rhs));
+    }
+
+    // decomposition of A + u v^T in O(N^2 + N M) by Givens rotations
+    constexpr void rank_1_update(matrix_t<value_type, N, 1> const& u, matrix_t<value_type, M, 1> const& v) noexcept
+    {
+      // w = Q^T u
+      value_type w[N] = {};
+      for (index_t i = 0; i < N; ++i)
+        for (index_t r = 0; r < N; ++r)
+          w[i] += this->m_q(r, i) * u(r, 0);
+
+      // rotate w to a multiple of e_1, R gets upper Hessenberg
+      for (index_t k = N - 1; k > 0; --k)
+      {
+        auto const rot = Internal::givens_t<value_type>::make(w[k - 1], w[k]);
+        rot.apply(w[k - 1], w[k]);
+        this->p_rotate(rot, k - 1, k);
+      }
+
+      for (index_t j = 0; j < M; ++j)
+        this->m_r(0, j) += w[0] * v(j, 0);
+
+      // back to upper triangular
+      for (index_t k = 0; (k < M) && (k + 1 < N); ++k)
+      {
+        auto const rot = Internal::givens_t<value_type>::make(this->m_r(k, k), this->m_r(k + 1, k));
+        this->p_rotate(rot, k, k + 1);
+        this->m_r(k + 1, k) = value_type(0);
+      }
+    }
+
+    [[nodiscard]] constexpr matrix_t<value_type, N, N> const& get_q() const noexcept { return this->m_q; }
+    [[nodiscard]] constexpr matrix_t<value_type, N, M> const& get_r() const noexcept { return this->m_r; }
+
+  private:
+    constexpr void p_factorize() noexcept
+    {
+      for (index_t i = 0; i < N; ++i)
+        this->m_q(i, i) = value_type(1);
+
+      for (index_t k = 0; (k < M) && (k + 1 < N); ++k)
+      {
+        // householder vector which maps column k below the diagonal to a multiple of e_k
+        value_type v[N] = {};
+        value_type norm = value_type(0);
+        for (index_t i = k; i < N; ++i)
+        {
+          v[i] = this->m_r(i, k);
+          norm += v[i] * v[i];
+        }
+        norm = Internal::sqrt_value(norm);
+        if (norm == value_type(0))
+          continue;
+
+        v[k] += (v[k] < value_type(0)) ? -norm : norm;
+        value_type v_norm2 = value_type(0);
+        for (index_t i = k; i < N; ++i)
+          v_norm2 += v[i] * v[i];
+        value_type const fac = value_type(2) / v_norm2;
+
+        // R = H R
+        for (index_t j = k; j < M; ++j)
+        {
+          value_type dot = value_type(0);
+          for (index_t i = k; i < N; ++i)
+            dot += v[i] * this->m_r(i, j);
+          dot *= fac;
+          for (index_t i = k; i < N; ++i)
+            this->m_r(i, j) -= dot * v[i];
+        }
+        for (index_t i = k + 1; i < N; ++i)
+          this->m_r(i, k) = value_type(0);
+
+        // Q = Q H
+        for (index_t r = 0; r < N; ++r)
+        {
+          value_type dot = value_type(0);
+          for (index_t i = k; i < N; ++i)
+            dot += this->m_q(r, i) * v[i];
+          dot *= fac;
+          for (index_t i = k; i < N; ++i)
+            this->m_q(r, i) -= dot * v[i];
+        }
+      }
+    }
+
+    // rotation of the rows a, b of R and of the columns a, b of Q, Q R stays unchanged
+    constexpr void p_rotate(Internal::givens_t<value_type> const& rot, index_t const& a, index_t const& b) noexcept
+    {
+      for (index_t j = 0; j < M; ++j)
+        rot.apply(this->m_r(a, j), this->m_r(b, j));
+      for (index_t i = 0; i < N; ++i)
+        rot.apply(this->m_q(i, a), this->m_q(i, b));
+    }
+
+    matrix_t<value_type, N, N> m_q = {};
+    matrix_t<value_type, N, M> m_r;
+  };
+
+  template <typename T, index_t N> lu_t(matrix_t<T, N, N> const&) -> lu_t<std::remove_cv_t<T>, N>;
+  template <typename T, index_t N> cholesky_t(matrix_t<T, N, N> const&) -> cholesky_t<std::remove_cv_t<T>, N>;
+  template <typename T, index_t N, index_t M> qr_t(matrix_t<T, N, M> const&) -> qr_t<std::remove_cv_t<T>, N, M>;
+}    // namespace exmath
+
+#endif
@@ -0,0 +1,379 @@
+#pragma once
+#ifndef EXMATH_BLAS_EXPRESSION_HPP_INCLUDED
+#define EXMATH_BLAS_EXPRESSION_HPP_INCLUDED
+
+#include <cstddef>
+#include <exmath-blas.hpp>
+#include <exmath-blas_kernels.hpp>
+#include <type_traits>
+
+#if defined(_MSC_VER)
+#define EXMATH_NOINLINE __declspec(noinline)
+#else
+#define EXMATH_NOINLINE __attribute__((noinline))
+#endif
+
+/*
+ * Lazy evaluation of matrix_t arithmetic.
+ *
+ * The operators of exmath-blas.hpp return a matrix_t for every operation,
+ * so A * x + B * u - c builds a temporary per step. An expression starts
+ * with lazy() and is evaluated when it is assigned to a matrix_t:
+ *
+ *   x = exmath::lazy(A) * x + exmath::lazy(B) * u - c;
+ *
+ * Element wise operations (+, -, unary -, * and / by a scalar) are fused
+ * into one loop which writes into the destination directly. A product is
+ * calculated per element of the destination; an operand of a product which
+ * is an expression itself is evaluated once into the product node. A pure
+ * product of two matrices is written into the destination by the kernels
+ * of exmath-blas_kernels.hpp.
+ *
+ * If the destination is an operand of a product (x = lazy(A) * x) the
+ * result is calculated into a temporary first, element wise operations do
+ * not need that. A temporary larger than 64 bytes lives in a function of
+ * its own, so an assignment which does not alias does not reserve stack
+ * for it.
+ *
+ * An expression refers to its matrices, it must not outlive them. Mixing
+ * with matrix_t works in both directions, e.g. lazy(A) + B or B - lazy(A).
+ */
+namespace exmath
+{
+  namespace Internal
+  {
+    template <typename T> struct is_matrix: std::false_type
+    {
+    };
+    template <typename T, index_t N, index_t M> struct is_matrix<matrix_t<T, N, M>>: std::true_type
+    {
+    };
+
+    template <typename T>
+    concept Matrix = is_matrix<std::remove_cvref_t<T>>::value;
+
+    template <typename T>
+    concept MatrixOperand = Matrix<T> || MatrixExpression<T>;
+
+    /*
+     * base of all nodes, Derived provides value_type, has_product,
+     * operator[](e), operator()(r, c) and aliases(ptr)
+     */
+    template <typename Derived, index_t N, index_t M> class expression_t: public matrix_size_t<N, M>
+    {
+    public:
+      static constexpr bool is_matrix_expression = true;
+
+      template <typename D> constexpr void assign_to(D& dst) const noexcept
+      {
+        Derived const& self = static_cast<Derived const&>(*this);
+        if constexpr (Derived::has_product)
+        {
+          if (self.aliases(dst.data()))
+          {
+            if constexpr (sizeof(typename Derived::value_type) * N * M > large_temporary_size)
+              return p_assign_via_large_temporary(self, dst);
+            return p_assign_via_temporary(self, dst);
+          }
+        }
+        self.evaluate_to(dst);
+      }
+
+      template <typename D> constexpr void evaluate_to(D& dst) const noexcept
+      {
+        Derived const& self = static_cast<Derived const&>(*this);
+        if constexpr (Derived::has_product)
+        {
+          for (index_t i = 0; i < N; ++i)
+            for (index_t j = 0; j < M; ++j)
+              dst(i, j) = self(i, j);
+        }
+        else
+        {
+          for (index_t e = 0; e < N * M; ++e)
+            dst[e] = self[e];
+        }
+      }
+
+    private:
+      // a small temporary costs less stack than the call
+      static constexpr std::size_t large_temporary_size = 64;
+
+      template <typename D> static constexpr void p_assign_via_temporary(Derived const& self, D& dst) noexcept
+      {
+        matrix_t<typename Derived::value_type, N, M> tmp;
+        self.evaluate_to(tmp);
+        dst = tmp;
+      }
+
+      template <typename D> EXMATH_NOINLINE static constexpr void p_assign_via_large_temporary(Derived const& self, D& dst) noexcept
+      {
+        p_assign_via_temporary(self, dst);
+      }
+    };
+
+    // leaf, a matrix by reference, a const view by value (it is a reference itself)
+    template <typename Mat>
+    class matrix_ref_t: public expression_t<matrix_ref_t<Mat>, Mat::number_of_rows, Mat::number_of_columns>
+    {
+      static constexpr bool is_view = !std::is_same_v<Mat, matrix_t<typename Mat::value_type, Mat::number_of_rows, Mat::number_of_columns>>;
+
+      using storage_t = std::conditional_t<is_view, Mat, Mat const&>;
+
+    public:
+      using value_type = typename Mat::value_type;
+
+      static constexpr bool has_product = false;
+
+      constexpr explicit matrix_ref_t(Mat const& mat) noexcept
+          : m_mat(mat)
+      {
+      }
+
+      [[nodiscard]] constexpr value_type operator[](index_t const& e) const noexcept { return this->m_mat[e]; }
+      [[nodiscard]] constexpr value_type operator()(index_t const& r, index_t const& c) const noexcept { return this->m_mat(r, c); }
+      [[nodiscard]] constexpr bool       aliases(void const* ptr) const noexcept { return this->m_mat.data() == ptr; }
+      [[nodiscard]] constexpr value_type const* data() const noexcept { return this->m_mat.data(); }
+
+    private:
+      storage_t m_mat;
+    };
+
+    template <MatrixOperand T> [[nodiscard]] constexpr auto as_expression(T const& val) noexcept
+    {
+      if constexpr (Matrix<T>)
+        return matrix_ref_t<T>(val);
+      else
+        return val;
+    }
+
+    template <MatrixOperand T> using expression_of_t = decltype(as_expression(std::declval<T const&>()));
+
+    struct op_add
+    {
+      template <typename A, typename B> static constexpr auto apply(A const& a, B const& b) noexcept { return a + b; }
+    };
+    struct op_sub
+    {
+      template <typename A, typename B> static constexpr auto apply(A const& a, B const& b) noexcept { return a - b; }
+    };
+    struct op_mul
+    {
+      template <typename A, typename B> static constexpr auto apply(A const& a, B const& b) noexcept { return a * b; }
+    };
+    struct op_div
+    {
+      template <typename A, typename B> static constexpr auto apply(A const& a, B const& b) noexcept { return a / b; }
+    };
+
+    template <typename Op, typename L, typename R>
+    class binary_t: public expression_t<binary_t<Op, L, R>, L::number_of_rows, L::number_of_columns>
+    {
+    public:
+      using value_type = typename L::value_type;
+
+      static constexpr bool has_product = L::has_product || R::has_product;
+
+      constexpr binary_t(L const& lhs, R const& rhs) noexcept
+          : m_lhs(lhs)
+          , m_rhs(rhs)
+      {
+      }
+
+      [[nodiscard]] constexpr value_type operator[](index_t const& e) const noexcept { return Op::apply(this->m_lhs[e], this->m_rhs[e]); }
+      [[nodiscard]] constexpr value_type operator()(index_t const& r, index_t const& c) const noexcept
+      {
+        return Op::apply(this->m_lhs(r, c), this->m_rhs(r, c));
+      }
+      [[nodiscard]] constexpr bool aliases(void const* ptr) const noexcept { return this->m_lhs.aliases(ptr) || this->m_rhs.aliases(ptr); }
+
+    private:
+      L m_lhs;
+      R m_rhs;
+    };
+
+    // expression op scalar
+    template <typename Op, typename E>
+    class scalar_t: public expression_t<scalar_t<Op, E>, E::number_of_rows, E::number_of_columns>
+    {
+    public:
+      using value_type = typename E::value_type;
+
+      static constexpr bool has_product = E::has_product;
+
+      constexpr scalar_t(E const& expr, value_type const& sca) noexcept
+          : m_expr(expr)
+          , m_sca(sca)
+      {
+      }
+
+      [[nodiscard]] constexpr value_type operator[](index_t const& e) const noexcept { return Op::apply(this->m_expr[e], this->m_sca); }
+      [[nodiscard]] constexpr value_type operator()(index_t const& r, index_t const& c) const noexcept { return Op::apply(this->m_expr(r, c), this->m_sca); }
+      [[nodiscard]] constexpr bool       aliases(void const* ptr) const noexcept { return this->m_expr.aliases(ptr); }
+
+    private:
+      E          m_expr;
+      value_type m_sca;
+    };
+
+    template <typename E> class negate_t: public expression_t<negate_t<E>, E::number_of_rows, E::number_of_columns>
+    {
+    public:
+      using value_type = typename E::value_type;
+
+      static constexpr bool has_product = E::has_product;
+
+      constexpr explicit negate_t(E const& expr) noexcept
+          : m_expr(expr)
+      {
+      }
+
+      [[nodiscard]] constexpr value_type operator[](index_t const& e) const noexcept { return -this->m_expr[e]; }
+      [[nodiscard]] constexpr value_type operator()(index_t const& r, index_t const& c) const noexcept { return -this->m_expr(r, c); }
+      [[nodiscard]] constexpr bool       aliases(void const* ptr) const noexcept { return this->m_expr.aliases(ptr); }
+
+    private:
+      E m_expr;
+    };
+
+    // an operand of a product is accessed many times: matrices by reference, expressions evaluated once
+    template <typename E> struct product_operand
+    {
+      using type = matrix_t<typename E::value_type, E::number_of_rows, E::number_of_columns>;
+    };
+    template <typename Mat> struct product_operand<matrix_ref_t<Mat>>
+    {
+      using type = matrix_ref_t<Mat>;
+    };
+
+    template <typename L, typename R>
+    class product_t: public expression_t<product_t<L, R>, L::number_of_rows, R::number_of_columns>
+    {
+      using lhs_t = typename product_operand<L>::type;
+      using rhs_t = typename product_operand<R>::type;
+
+    public:
+      using value_type = typename L::value_type;
+
+      static constexpr bool has_product = true;
+
+      constexpr product_t(L const& lhs, R const& rhs) noexcept
+          : m_lhs(lhs)
+          , m_rhs(rhs)
+      {
+      }
+
+      [[nodiscard]] constexpr value_type operator()(index_t const& r, index_t const& c) const noexcept
+      {
+        value_type ret = value_type(0);
+        for (index_t k = 0; k < L::number_of_columns; ++k)
+          ret += this->m_lhs(r, k) * this->m_rhs(k, c);
+        return ret;
+      }
+      [[nodiscard]] constexpr value_type operator[](index_t const& e) const noexcept
+      {
+        return (*this)(e / R::number_of_columns, e % R::number_of_columns);
+      }
+      [[nodiscard]] constexpr bool aliases(void const* ptr) const noexcept { return p_aliases(this->m_lhs, ptr) || p_aliases(this->m_rhs, ptr); }
+
+      // the whole product at once into the destination
+      template <typename D> constexpr void evaluate_to(D& dst) const noexcept
+      {
+        if (std::is_constant_evaluated())
+          return expression_t<product_t<L, R>, L::number_of_rows, R::number_of_columns>::evaluate_to(dst);
+
+        kernels::gemm<value_type, L::number_of_rows, L::number_of_columns, R::number_of_columns>(this->m_lhs.data(), this->m_rhs.data(), dst.data());
+      }
+
+    private:
+      // an evaluated operand is a copy, it cannot alias the destination
+      template <typename Op> static constexpr bool p_aliases(Op const& op, void const* ptr) noexcept
+      {
+        if constexpr (MatrixExpression<Op>)
+          return op.aliases(ptr);
+        else
+          return false;
+      }
+
+      lhs_t m_lhs;
+      rhs_t m_rhs;
+    };
+
+    template <typename L, typename R>
+    concept SameShape = (std::remove_cvref_t<L>::number_of_rows == std::remove_cvref_t<R>::number_of_rows)
+                        && (std::remove_cvref_t<L>::number_of_columns == std::remove_cvref_t<R>::number_of_columns);
+
+    template <typename L, typename R>
+    concept ExpressionPair = MatrixOperand<L> && MatrixOperand<R> && (MatrixExpression<L> || MatrixExpression<R>);
+  }    // namespace Internal
+
+  // starts a lazy expression
+  template <Internal::Matrix Mat> [[nodiscard]] constexpr Internal::matrix_ref_t<Mat> lazy(Mat const& mat) noexcept { return Internal::matrix_ref_t<Mat>(mat); }
+
+  // evaluates an expression into a new matrix
+  template <MatrixExpression E> [[nodiscard]] constexpr matrix_t<typename E::value_type, E::number_of_rows, E::number_of_columns> evaluate(E const& expr) noexcept
+  {
+    return matrix_t<typename E::value_type, E::number_of_rows, E::number_of_columns>(expr);
+  }
+
+  template <typename L, typename R>
+    requires(Internal::ExpressionPair<L, R> && Internal::SameShape<L, R>)
+  [[nodiscard]] constexpr auto operator+(L const& lhs, R const& rhs) noexcept
+  {
+    using lhs_t = Internal::expression_of_t<L>;
+    using rhs_t = Internal::expression_of_t<R>;
+    return Internal::binary_t<Internal::op_add, lhs_t, rhs_t>(Internal::as_expression(lhs), Internal::as_expression(rhs));
+  }
+
+  template <typename L, typename R>
+    requires(Internal::ExpressionPair<L, R> && Internal::SameShape<L, R>)
+  [[nodiscard]] constexpr auto operator-(L const& lhs, R const& rhs) noexcept
+  {
+    using lhs_t = Internal::expression_of_t<L>;
+    using rhs_t = Internal::expression_of_t<R>;
+    return Internal::binary_t<Internal::op_sub, lhs_t, rhs_t>(Internal::as_expression(lhs), Internal::as_expression(rhs));
+  }
+
+  template <typename L, typename R>
+    requires(Internal::ExpressionPair<L, R> && (std::remove_cvref_t<L>::number_of_columns == std::remove_cvref_t<R>::number_of_rows))
+  [[nodiscard]] constexpr auto operator*(L const& lhs, R const& rhs) noexcept
+  {
+    using lhs_t = Internal::expression_of_t<L>;
+    using rhs_t = Internal::expression_of_t<R>;
+    return Internal::product_t<lhs_t, rhs_t>(Internal::as_expression(lhs), Internal::as_expression(rhs));
+  }
+
+  template <MatrixExpression E> [[nodiscard]] constexpr auto operator-(E const& expr) noexcept { return Internal::negate_t<E>(expr); }
+
+  template <MatrixExpression E> [[nodiscard]] constexpr auto operator*(E const& expr, typename E::value_type const& sca) noexcept
+  {
+    return Internal::scalar_t<Internal::op_mul, E>(expr, sca);
+  }
+
+  template <MatrixExpression E> [[nodiscard]] constexpr auto operator*(typename E::value_type const& sca, E const& expr) noexcept
+  {
+    return Internal::scalar_t<Internal::op_mul, E>(expr, sca);
+  }
+
+  template <MatrixExpression E> [[nodiscard]] constexpr auto operator/(E const& expr, typename E::value_type const& sca) noexcept
+  {
+    return Internal::scalar_t<Internal::op_div, E>(expr, sca);
+  }
+
+  // dst += expr and dst -= expr without a temporary (unless dst is an operand of a product)
+  template <typename T, index_t N, index_t M, MatrixExpression E>
+    requires(E::number_of_rows == N && E::number_of_columns == M)
+  constexpr matrix_t<T, N, M>& operator+=(matrix_t<T, N, M>& lhs, E const& rhs) noexcept
+  {
+    return lhs = lazy(lhs) + rhs;
+  }
+
+  template <typename T, index_t N, index_t M, MatrixExpression E>
+    requires(E::number_of_rows == N && E::number_of_columns == M)
+  constexpr matrix_t<T, N, M>& operator-=(matrix_t<T, N, M>& lhs, E const& rhs) noexcept
+  {
+    return lhs = lazy(lhs) - rhs;
+  }
+}    // namespace exmath
+
+#endif
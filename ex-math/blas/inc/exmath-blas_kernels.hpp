@@ -0,0 +1,264 @@
+#pragma once
+#ifndef EXMATH_BLAS_KERNELS_HPP_INCLUDED
+#define EXMATH_BLAS_KERNELS_HPP_INCLUDED
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#if defined(__AVX__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+#if defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 2)
+#  include <arm_mve.h>
+#endif
+#if defined(EXMATH_BLAS_USE_CMSIS_DSP)
+#  include <arm_math.h>
+#endif
+
+/*
+ * Runtime kernels of the matrix product, on row major arrays.
+ *
+ * Small products (all dimensions up to 8) are unrolled completely at
+ * compile time, larger ones use a blocked product with a 4 row micro
+ * kernel. Both work on vectors of simd_t<T>::width elements: SSE / AVX on
+ * the host (as enabled by the compiler flags, e.g. -mavx), Helium (MVE)
+ * on a Cortex-M55/M85 and single elements otherwise.
+ *
+ * On target the blocked path can be passed to a library by specializing
+ * gemm_hook<T>. With EXMATH_BLAS_USE_CMSIS_DSP defined, gemm_hook<float>
+ * calls arm_mat_mult_f32 of CMSIS-DSP.
+ */
+namespace exmath::Internal::kernels
+{
+  template <std::size_t Count, typename F> inline void static_for(F&& f)
+  {
+    [&]<std::size_t... I>(std::index_sequence<I...>) { (f(std::integral_constant<std::size_t, I>{}), ...); }(std::make_index_sequence<Count>{});
+  }
+
+  // vector of width elements, single elements by default
+  template <typename T> struct simd_t
+  {
+    using reg_t = T;
+
+    static constexpr std::size_t width = 1;
+
+    static reg_t load(T const* src) noexcept { return *src; }
+    static void  store(T* trg, reg_t val) noexcept { *trg = val; }
+    static reg_t set1(T val) noexcept { return val; }
+    static reg_t zero() noexcept { return T{}; }
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return acc + a * b; }
+  };
+
+#if defined(__AVX__)
+  template <> struct simd_t<float>
+  {
+    using reg_t = __m256;
+
+    static constexpr std::size_t width = 8;
+
+    static reg_t load(float const* src) noexcept { return _mm256_loadu_ps(src); }
+    static void  store(float* trg, reg_t val) noexcept { _mm256_storeu_ps(trg, val); }
+    static reg_t set1(float val) noexcept { return _mm256_set1_ps(val); }
+    static reg_t zero() noexcept { return _mm256_setzero_ps(); }
+#  if defined(__FMA__)
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return _mm256_fmadd_ps(a, b, acc); }
+#  else
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return _mm256_add_ps(acc, _mm256_mul_ps(a, b)); }
+#  endif
+  };
+
+  template <> struct simd_t<double>
+  {
+    using reg_t = __m256d;
+
+    static constexpr std::size_t width = 4;
+
+    static reg_t load(double const* src) noexcept { return _mm256_loadu_pd(src); }
+    static void  store(double* trg, reg_t val) noexcept { _mm256_storeu_pd(trg, val); }
+    static reg_t set1(double val) noexcept { return _mm256_set1_pd(val); }
+    static reg_t zero() noexcept { return _mm256_setzero_pd(); }
+#  if defined(__FMA__)
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return _mm256_fmadd_pd(a, b, acc); }
+#  else
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return _mm256_add_pd(acc, _mm256_mul_pd(a, b)); }
+#  endif
+  };
+#elif defined(__SSE2__)
+  template <> struct simd_t<float>
+  {
+    using reg_t = __m128;
+
+    static constexpr std::size_t width = 4;
+
+    static reg_t load(float const* src) noexcept { return _mm_loadu_ps(src); }
+    static void  store(float* trg, reg_t val) noexcept { _mm_storeu_ps(trg, val); }
+    static reg_t set1(float val) noexcept { return _mm_set1_ps(val); }
+    static reg_t zero() noexcept { return _mm_setzero_ps(); }
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return _mm_add_ps(acc, _mm_mul_ps(a, b)); }
+  };
+
+  template <> struct simd_t<double>
+  {
+    using reg_t = __m128d;
+
+    static constexpr std::size_t width = 2;
+
+    static reg_t load(double const* src) noexcept { return _mm_loadu_pd(src); }
+    static void  store(double* trg, reg_t val) noexcept { _mm_storeu_pd(trg, val); }
+    static reg_t set1(double val) noexcept { return _mm_set1_pd(val); }
+    static reg_t zero() noexcept { return _mm_setzero_pd(); }
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return _mm_add_pd(acc, _mm_mul_pd(a, b)); }
+  };
+#elif defined(__ARM_FEATURE_MVE) && (__ARM_FEATURE_MVE & 2)
+  template <> struct simd_t<float>
+  {
+    using reg_t = float32x4_t;
+
+    static constexpr std::size_t width = 4;
+
+    static reg_t load(float const* src) noexcept { return vld1q_f32(src); }
+    static void  store(float* trg, reg_t val) noexcept { vst1q_f32(trg, val); }
+    static reg_t set1(float val) noexcept { return vdupq_n_f32(val); }
+    static reg_t zero() noexcept { return vdupq_n_f32(0.0f); }
+    static reg_t mul_add(reg_t a, reg_t b, reg_t acc) noexcept { return vfmaq_f32(acc, a, b); }
+  };
+#endif
+
+  /*
+   * specialize to pass the blocked product c[n][k] = a[n][m] * b[m][k] to a
+   * library, return false to fall back to the built in kernel
+   */
+  template <typename T> struct gemm_hook
+  {
+    static bool run(T const*, T const*, T*, std::size_t, std::size_t, std::size_t) noexcept { return false; }
+  };
+
+#if defined(EXMATH_BLAS_USE_CMSIS_DSP)
+  template <> struct gemm_hook<float>
+  {
+    static bool run(float const* a, float const* b, float* c, std::size_t n, std::size_t m, std::size_t k) noexcept
+    {
+      if ((n > UINT16_MAX) || (m > UINT16_MAX) || (k > UINT16_MAX))
+        return false;
+
+      // CMSIS-DSP does not write to the sources, the instances are not const only
+      arm_matrix_instance_f32 const src_a = { static_cast<uint16_t>(n), static_cast<uint16_t>(m), const_cast<float*>(a) };
+      arm_matrix_instance_f32 const src_b = { static_cast<uint16_t>(m), static_cast<uint16_t>(k), const_cast<float*>(b) };
+      arm_matrix_instance_f32       dst   = { static_cast<uint16_t>(n), static_cast<uint16_t>(k), c };
+      return arm_mat_mult_f32(&src_a, &src_b, &dst) == ARM_MATH_SUCCESS;
+    }
+  };
+#endif
+
+  // largest dimension handled by the unrolled kernel
+  inline constexpr std::size_t small_size = 8;
+
+  /*
+   * c[N][K] = a[N][M] * b[M][K], all rows of a vector column are accumulated
+   * at once, so N independent multiply adds share one load of b and do not
+   * wait for each other. The loops have compile time bounds and are unrolled.
+   */
+  template <typename T, std::size_t N, std::size_t M, std::size_t K> inline void gemm_small(T const* a, T const* b, T* c) noexcept
+  {
+    using vec                     = simd_t<T>;
+    constexpr std::size_t W       = vec::width;
+    constexpr std::size_t vectors = K / W;
+
+    for (std::size_t j = 0; j < vectors * W; j += W)
+    {
+      typename vec::reg_t acc[N];
+      static_for<N>([&](auto r) { acc[r] = vec::zero(); });
+      static_for<M>([&](auto p) {
+        typename vec::reg_t const b_vec = vec::load(b + p * K + j);
+        static_for<N>([&](auto r) { acc[r] = vec::mul_add(vec::set1(a[r * M + p]), b_vec, acc[r]); });
+      });
+      static_for<N>([&](auto r) { vec::store(c + r * K + j, acc[r]); });
+    }
+
+    for (std::size_t j = vectors * W; j < K; ++j)
+    {
+      T acc[N] = {};
+      static_for<M>([&](auto p) {
+        T const b_val = b[p * K + j];
+        static_for<N>([&](auto r) { acc[r] += a[r * M + p] * b_val; });
+      });
+      static_for<N>([&](auto r) { c[r * K + j] = acc[r]; });
+    }
+  }
+
+  // c[i..i+R][...] += a[i..i+R][kb..ke] * b[kb..ke][jb..je], the b loads are shared by R rows
+  template <typename T, std::size_t R>
+  inline void gemm_tile(T const* a, T const* b, T* c, std::size_t i, std::size_t kb, std::size_t ke, std::size_t jb, std::size_t je, std::size_t m, std::size_t k) noexcept
+  {
+    using vec               = simd_t<T>;
+    constexpr std::size_t W = vec::width;
+
+    std::size_t j = jb;
+    for (; j + W <= je; j += W)
+    {
+      typename vec::reg_t acc[R];
+      static_for<R>([&](auto r) { acc[r] = vec::load(c + (i + r) * k + j); });
+      for (std::size_t p = kb; p < ke; ++p)
+      {
+        typename vec::reg_t const b_vec = vec::load(b + p * k + j);
+        static_for<R>([&](auto r) { acc[r] = vec::mul_add(vec::set1(a[(i + r) * m + p]), b_vec, acc[r]); });
+      }
+      static_for<R>([&](auto r) { vec::store(c + (i + r) * k + j, acc[r]); });
+    }
+    for (; j < je; ++j)
+    {
+      T acc[R];
+      static_for<R>([&](auto r) { acc[r] = c[(i + r) * k + j]; });
+      for (std::size_t p = kb; p < ke; ++p)
+      {
+        T const b_val = b[p * k + j];
+        static_for<R>([&](auto r) { acc[r] += a[(i + r) * m + p] * b_val; });
+      }
+      static_for<R>([&](auto r) { c[(i + r) * k + j] = acc[r]; });
+    }
+  }
+
+  /*
+   * c[n][k] = a[n][m] * b[m][k], blocked so a panel of b stays in the cache while it is used by all rows.
+   * The sizes of the panel and the tile are parameters for the sweep of the simulator, every choice
+   * adds the products of an element in the same order.
+   */
+  template <typename T, std::size_t block_inner = 64, std::size_t block_columns = 64, std::size_t tile_rows = 4>
+  inline void gemm_blocked(T const* a, T const* b, T* c, std::size_t n, std::size_t m, std::size_t k) noexcept
+  {
+    std::fill(c, c + n * k, T{});
+
+    for (std::size_t kb = 0; kb < m; kb += block_inner)
+    {
+      std::size_t const ke = std::min(m, kb + block_inner);
+      for (std::size_t jb = 0; jb < k; jb += block_columns)
+      {
+        std::size_t const je = std::min(k, jb + block_columns);
+
+        std::size_t i = 0;
+        for (; i + tile_rows <= n; i += tile_rows)
+          gemm_tile<T, tile_rows>(a, b, c, i, kb, ke, jb, je, m, k);
+        for (; i < n; ++i)
+          gemm_tile<T, 1>(a, b, c, i, kb, ke, jb, je, m, k);
+      }
+    }
+  }
+
+  template <typename T, std::size_t N, std::size_t M, std::size_t K> inline void gemm(T const* a, T const* b, T* c) noexcept
+  {
+    if constexpr ((N <= small_size) && (M <= small_size) && (K <= small_size))
+    {
+      gemm_small<T, N, M, K>(a, b, c);
+    }
+    else
+    {
+      if (!gemm_hook<T>::run(a, b, c, N, M, K))
+        gemm_blocked<T>(a, b, c, N, M, K);
+    }
+  }
+}    // namespace exmath::Internal::kernels
+
+#endif
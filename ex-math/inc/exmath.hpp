@@ -3,9 +3,12 @@
 #define EXMATH_HPP_INCLUDED
 
 #include <exmath-statistics.hpp>
+#include <exmath-statistics_streaming.hpp>
 #include <exmath-intervals.hpp>
 #include <exmath-polynominal.hpp>
 #include <exmath-constants.hpp>
 #include <exmath-blas.hpp>
+#include <exmath-blas_decomposition.hpp>
+#include <exmath-blas_expression.hpp>
 
 #endif
@@ -2,13 +2,86 @@
 #ifndef EXMATH_POLYNOMINAL_HPP_INCLUDED
 #define EXMATH_POLYNOMINAL_HPP_INCLUDED
 
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <span>
 
 namespace exmath::polynominal
 {
+  namespace Internal
+  {
+    // values of a batch evaluated together, independent chains the compiler can vectorize
+    inline constexpr std::size_t batch_size = 8;
+  }    // namespace Internal
+
+  /*
+   * Evaluation of a polynominal with the coefficients para, highest order
+   * first (as TDK datasheets and polynominal_t list them).
+   *
+   * horner: one multiply add per order, each waiting for the previous one
+   * estrin: pairs of coefficients first, then combined with x^2, x^4, ...;
+   *         the multiply adds of one level are independent of each other,
+   *         so the latency is about log2(order) multiply adds
+   */
+  template <typename T, std::size_t Size> constexpr T horner(std::span<T const, Size> para, T const& value) noexcept
+  {
+    T tmp = para[0];
+    for (std::size_t i = 1; i < Size; i++)
+      tmp = tmp * value + para[i];
+    return tmp;
+  }
+
+  template <typename T, std::size_t Size> constexpr T estrin(std::span<T const, Size> para, T const& value) noexcept
+  {
+    // level 0: a[2i] + a[2i+1] * x with a[k] the coefficient of x^k
+    std::array<T, (Size + 1) / 2> tmp = {};
+    for (std::size_t i = 0; i < tmp.size(); i++)
+    {
+      T const low = para[Size - 1 - 2 * i];
+      tmp[i]      = (2 * i + 1 < Size) ? (low + para[Size - 2 - 2 * i] * value) : low;
+    }
+
+    T           power = value * value;
+    std::size_t count = tmp.size();
+    while (count > 1)
+    {
+      for (std::size_t i = 0; i < count / 2; i++)
+        tmp[i] = tmp[2 * i] + tmp[2 * i + 1] * power;
+      if (count % 2 != 0)
+        tmp[count / 2] = tmp[count - 1];
+      count = (count + 1) / 2;
+      power *= power;
+    }
+    return tmp[0];
+  }
+
+  // result[i] = p(values[i]) for min(values.size(), result.size()) values, Horner over a batch of values at once
+  template <typename T, std::size_t Size> void horner(std::span<T const, Size> para, std::span<T const> values, std::span<T> result) noexcept
+  {
+    std::size_t const size = std::min(values.size(), result.size());
+
+    std::size_t i = 0;
+    for (; i + Internal::batch_size <= size; i += Internal::batch_size)
+    {
+      T acc[Internal::batch_size];
+      for (std::size_t k = 0; k < Internal::batch_size; k++)
+        acc[k] = para[0];
+      for (std::size_t c = 1; c < Size; c++)
+      {
+        for (std::size_t k = 0; k < Internal::batch_size; k++)
+          acc[k] = acc[k] * values[i + k] + para[c];
+      }
+      for (std::size_t k = 0; k < Internal::batch_size; k++)
+        result[i + k] = acc[k];
+    }
+    for (; i < size; i++)
+      result[i] = horner(para, values[i]);
+  }
+
   template <typename T, std::size_t Order> class polynominal_t
   {
     using value_type = T;
@@ -22,26 +95,141 @@ namespace exmath::polynominal
     {
     }
 
-    value_type operator()(value_type const& value) const& noexcept
+    constexpr value_type operator()(value_type const& value) const& noexcept { return horner(this->get_parameter(), value); }
+
+    // same value as operator(), shorter dependency chain for higher orders
+    constexpr value_type estrin(value_type const& value) const& noexcept { return polynominal::estrin(this->get_parameter(), value); }
+
+    void operator()(std::span<value_type const> values, std::span<value_type> result) const& noexcept { horner(this->get_parameter(), values, result); }
+
+    constexpr std::span<value_type const, Order + 1> get_parameter() const& noexcept { return this->m_para; }
+
+    constexpr value_type& operator[](uint32_t const& idx) & noexcept { return this->m_para[idx]; }
+    constexpr value_type  operator[](uint32_t const& idx) const& noexcept { return this->m_para[idx]; }
+
+    constexpr bool operator==(polynominal_t<T, Order> const&) const = default;
+
+  private:
+    std::array<value_type, Order + 1> m_para = {};
+  };
+
+  /*
+   * Polynominal in Q format (Fraction_Bits of the int32_t are the
+   * fraction), for targets without a fast FPU path. Products are 64 bit,
+   * rounded back to Q format after every step and saturated to int32_t.
+   * The coefficients are converted (rounded) at construction, e.g. at
+   * compile time from the floating point coefficients.
+   */
+  template <std::size_t Order, uint32_t Fraction_Bits = 16>
+    requires(Fraction_Bits > 0 && Fraction_Bits < 31)
+  class fixed_polynominal_t
+  {
+  public:
+    using value_type = int32_t;
+
+    static constexpr value_type to_fixed(double value) noexcept
     {
-      value_type tmp = this->m_para[0];
+      double const scaled = value * static_cast<double>(int64_t{ 1 } << Fraction_Bits);
+      if (!(scaled < static_cast<double>(std::numeric_limits<value_type>::max())))
+        return std::numeric_limits<value_type>::max();
+      if (!(scaled > static_cast<double>(std::numeric_limits<value_type>::min())))
+        return std::numeric_limits<value_type>::min();
+      return static_cast<value_type>((scaled < 0.0) ? (scaled - 0.5) : (scaled + 0.5));
+    }
+    static constexpr double to_floating(value_type value) noexcept { return static_cast<double>(value) / static_cast<double>(int64_t{ 1 } << Fraction_Bits); }
+
+    constexpr fixed_polynominal_t() = default;
+
+    template <typename T>
+    constexpr explicit fixed_polynominal_t(std::span<T const, Order + 1> para)
+    {
+      for (std::size_t i = 0; i < this->m_para.size(); i++)
+        this->m_para[i] = to_fixed(static_cast<double>(para[i]));
+    }
+    template <typename T>
+    constexpr explicit fixed_polynominal_t(polynominal_t<T, Order> const& poly)
+        : fixed_polynominal_t{ poly.get_parameter() }
+    {
+    }
+
+    constexpr value_type operator()(value_type const& value) const noexcept
+    {
+      constexpr int64_t round = int64_t{ 1 } << (Fraction_Bits - 1);
+
+      int64_t tmp = this->m_para[0];
       for (std::size_t i = 1; i < this->m_para.size(); i++)
       {
-        tmp *= value;
-        tmp += this->m_para[i];
+        tmp = ((tmp * value + round) >> Fraction_Bits) + this->m_para[i];
+        tmp = std::clamp<int64_t>(tmp, std::numeric_limits<value_type>::min(), std::numeric_limits<value_type>::max());
       }
-      return tmp;
+      return static_cast<value_type>(tmp);
+    }
+
+    void operator()(std::span<value_type const> values, std::span<value_type> result) const noexcept
+    {
+      std::size_t const size = std::min(values.size(), result.size());
+      for (std::size_t i = 0; i < size; i++)
+        result[i] = this->operator()(values[i]);
     }
 
-    value_type& operator[](uint32_t const& idx) & noexcept { return this->m_para[idx]; }
-    value_type  operator[](uint32_t const& idx) const& noexcept { return this->m_para[idx]; }
+    constexpr value_type operator[](uint32_t const& idx) const& noexcept { return this->m_para[idx]; }
 
-    constexpr bool operator==(polynominal_t<T, Order> const&) const = default;
+    constexpr bool operator==(fixed_polynominal_t const&) const = default;
 
   private:
     std::array<value_type, Order + 1> m_para = {};
   };
 
+  /*
+   * N values of a function on an equidistant grid in [lower, upper],
+   * linearly interpolated in between and clamped to the range outside.
+   * Filled at construction, so a constexpr table of a polynominal (or of
+   * any constexpr callable) is computed at compile time and placed in
+   * flash.
+   */
+  template <typename T, std::size_t N>
+    requires(N >= 2)
+  class lookup_table_t
+  {
+  public:
+    using value_type = T;
+
+    template <typename functor>
+    constexpr lookup_table_t(functor const& ftor, value_type lower, value_type upper)
+        : m_lower{ lower }
+        , m_upper{ upper }
+        , m_scale{ static_cast<value_type>(N - 1) / (upper - lower) }
+    {
+      for (std::size_t i = 0; i < N; i++)
+        this->m_values[i] = static_cast<value_type>(ftor(lower + (upper - lower) * static_cast<value_type>(i) / static_cast<value_type>(N - 1)));
+    }
+
+    constexpr value_type operator()(value_type const& value) const noexcept
+    {
+      value_type const  pos  = (std::clamp(value, this->m_lower, this->m_upper) - this->m_lower) * this->m_scale;
+      std::size_t const idx  = std::min(N - 2, static_cast<std::size_t>(pos));
+      value_type const  frac = pos - static_cast<value_type>(idx);
+      return this->m_values[idx] + (this->m_values[idx + 1] - this->m_values[idx]) * frac;
+    }
+
+    void operator()(std::span<value_type const> values, std::span<value_type> result) const noexcept
+    {
+      std::size_t const size = std::min(values.size(), result.size());
+      for (std::size_t i = 0; i < size; i++)
+        result[i] = this->operator()(values[i]);
+    }
+
+    constexpr value_type  get_lower_bound() const noexcept { return this->m_lower; }
+    constexpr value_type  get_upper_bound() const noexcept { return this->m_upper; }
+    constexpr std::size_t get_number_of_values() const noexcept { return N; }
+
+  private:
+    value_type                m_lower;
+    value_type                m_upper;
+    value_type                m_scale;
+    std::array<value_type, N> m_values = {};
+  };
+
 }    // namespace exmath::polynominal
 
 #endif
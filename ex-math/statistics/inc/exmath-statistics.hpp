@@ -2,14 +2,97 @@
 #ifndef EXMATH_STATISTICS_HPP_INCLUDED
 #define EXMATH_STATISTICS_HPP_INCLUDED
 
+#include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <limits>
 #include <span>
 
+#if defined(__AVX__) || defined(__SSE2__)
+#  include <immintrin.h>
+#endif
+
 namespace exmath::statistics
 {
+  namespace Internal
+  {
+    /*
+     * lanes of doubles for the bulk path: SSE2 / AVX on the host (as enabled
+     * by the compiler flags), single values otherwise
+     */
+    struct lanes_t
+    {
+#if defined(__AVX__)
+      using reg_t = __m256d;
+
+      static constexpr std::size_t width = 4;
+
+      static reg_t load(double const* src) noexcept { return _mm256_loadu_pd(src); }
+      static reg_t load(float const* src) noexcept { return _mm256_cvtps_pd(_mm_loadu_ps(src)); }
+      static reg_t set1(double val) noexcept { return _mm256_set1_pd(val); }
+      static reg_t add(reg_t a, reg_t b) noexcept { return _mm256_add_pd(a, b); }
+      static reg_t sub(reg_t a, reg_t b) noexcept { return _mm256_sub_pd(a, b); }
+      static reg_t mul(reg_t a, reg_t b) noexcept { return _mm256_mul_pd(a, b); }
+      static reg_t valid(reg_t a) noexcept { return _mm256_cmp_pd(a, a, _CMP_ORD_Q); }
+      static reg_t mask(reg_t m, reg_t a) noexcept { return _mm256_and_pd(m, a); }
+      // a NaN in a keeps b
+      static reg_t min(reg_t a, reg_t b) noexcept { return _mm256_min_pd(a, b); }
+      static reg_t max(reg_t a, reg_t b) noexcept { return _mm256_max_pd(a, b); }
+      static void  store(double* trg, reg_t a) noexcept { _mm256_storeu_pd(trg, a); }
+#elif defined(__SSE2__)
+      using reg_t = __m128d;
+
+      static constexpr std::size_t width = 2;
+
+      static reg_t load(double const* src) noexcept { return _mm_loadu_pd(src); }
+      static reg_t load(float const* src) noexcept { return _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<__m128i const*>(src)))); }
+      static reg_t set1(double val) noexcept { return _mm_set1_pd(val); }
+      static reg_t add(reg_t a, reg_t b) noexcept { return _mm_add_pd(a, b); }
+      static reg_t sub(reg_t a, reg_t b) noexcept { return _mm_sub_pd(a, b); }
+      static reg_t mul(reg_t a, reg_t b) noexcept { return _mm_mul_pd(a, b); }
+      static reg_t valid(reg_t a) noexcept { return _mm_cmpord_pd(a, a); }
+      static reg_t mask(reg_t m, reg_t a) noexcept { return _mm_and_pd(m, a); }
+      // a NaN in a keeps b
+      static reg_t min(reg_t a, reg_t b) noexcept { return _mm_min_pd(a, b); }
+      static reg_t max(reg_t a, reg_t b) noexcept { return _mm_max_pd(a, b); }
+      static void  store(double* trg, reg_t a) noexcept { _mm_storeu_pd(trg, a); }
+#else
+      using reg_t = double;
 
+      static constexpr std::size_t width = 1;
+
+      static reg_t load(double const* src) noexcept { return *src; }
+      static reg_t load(float const* src) noexcept { return static_cast<double>(*src); }
+      static reg_t set1(double val) noexcept { return val; }
+      static reg_t add(reg_t a, reg_t b) noexcept { return a + b; }
+      static reg_t sub(reg_t a, reg_t b) noexcept { return a - b; }
+      static reg_t mul(reg_t a, reg_t b) noexcept { return a * b; }
+      // all ones or zero, as the vector compares
+      static reg_t valid(reg_t a) noexcept { return (a == a) ? 1.0 : 0.0; }
+      static reg_t mask(reg_t m, reg_t a) noexcept { return (m != 0.0) ? a : 0.0; }
+      // a NaN in a keeps b
+      static reg_t min(reg_t a, reg_t b) noexcept { return (a < b) ? a : b; }
+      static reg_t max(reg_t a, reg_t b) noexcept { return (a > b) ? a : b; }
+      static void  store(double* trg, reg_t a) noexcept { *trg = a; }
+#endif
+    };
+  }    // namespace Internal
+
+  /*
+   * Count, min, max, mean and variance of a batch of values, NaNs are
+   * ignored. The variance is kept as the sum of squared deviations (M2),
+   * single values are added by Welford's update and partial results are
+   * merged by the update of Chan et al., so merging the statistics of
+   * parts gives the statistics of the whole without loss of precision.
+   *
+   * Spans and functors are processed in chunks of chunk_size values, in
+   * one pass over the deviations from the first valid value of the chunk
+   * (shifted data), so a large offset does not cancel. Spans run
+   * branchless over two independent vectors of Internal::lanes_t (NaNs
+   * masked). The values of a functor are added one by one without a
+   * buffer, as it is used from interrupts too.
+   */
   class BatchStatistics
   {
   public:
@@ -20,49 +103,19 @@ namespace exmath::statistics
 
     BatchStatistics(value_type const& value) { this->operator()(value); }
 
-    BatchStatistics(std::span<value_type const> const& values)
-    {
-      for (value_type const value : values)
-      {
-        if (std::isnan(value))
-          continue;
-
-        if (this->m_max < value)
-          this->m_max = value;
-        if (this->m_min > value)
-          this->m_min = value;
-
-        this->m_mean += value;
-        this->m_x_sqr += value * value;
-      }
-
-      this->m_count          = values.size();
-      value_type const scale = 1.0 / static_cast<value_type>(this->m_count);
-      this->m_mean *= scale;
-      this->m_x_sqr *= scale;
-    }
+    BatchStatistics(std::span<value_type const> const& values) { this->p_add_bulk(values.data(), values.size()); }
+    BatchStatistics(std::span<float const> const& values) { this->p_add_bulk(values.data(), values.size()); }
 
     template <typename functor> BatchStatistics(functor const& ftor, count_type max_idx)
     {
-      for (count_type i = 0; i < max_idx; i++)
+      for (count_type beg = 0; beg < max_idx; beg += chunk_size)
       {
-        value_type const value = ftor(i);
-        if (std::isnan(value))
-          continue;
-
-        if (this->m_max < value)
-          this->m_max = value;
-        if (this->m_min > value)
-          this->m_min = value;
-
-        this->m_mean += value;
-        this->m_x_sqr += value * value;
+        shifted_sums_t   sums;
+        count_type const end = std::min(max_idx, beg + chunk_size);
+        for (count_type i = beg; i < end; i++)
+          sums.add(ftor(i));
+        this->operator()(sums.get());
       }
-
-      this->m_count          = max_idx;
-      value_type const scale = 1.0 / static_cast<value_type>(this->m_count);
-      this->m_mean *= scale;
-      this->m_x_sqr *= scale;
     }
 
     auto operator()(value_type const& value) noexcept -> BatchStatistics&
@@ -75,12 +128,13 @@ namespace exmath::statistics
       if (this->m_min > value)
         this->m_min = value;
 
-      if (this->m_count < std::numeric_limits<count_type>::max())
-        this->m_count++;
+      if (this->m_count == std::numeric_limits<count_type>::max())
+        return *this;
+      this->m_count++;
 
-      value_type const scale = 1.0 / static_cast<value_type>(this->m_count);
-      this->m_mean += (value - this->m_mean) * scale;
-      this->m_x_sqr += (value * value - this->m_x_sqr) * scale;
+      value_type const delta = value - this->m_mean;
+      this->m_mean += delta / static_cast<value_type>(this->m_count);
+      this->m_m2 += delta * (value - this->m_mean);
 
       return *this;
     }
@@ -89,23 +143,39 @@ namespace exmath::statistics
     {
       return this->operator()(BatchStatistics{ ftor, max_idx });
     }
-    auto operator()(std::span<value_type const> const& values) noexcept -> BatchStatistics& { return this->operator()(BatchStatistics{ values }); }
+    auto operator()(std::span<value_type const> const& values) noexcept -> BatchStatistics&
+    {
+      this->p_add_bulk(values.data(), values.size());
+      return *this;
+    }
+    auto operator()(std::span<float const> const& values) noexcept -> BatchStatistics&
+    {
+      this->p_add_bulk(values.data(), values.size());
+      return *this;
+    }
 
     auto operator()(BatchStatistics const& value) noexcept -> BatchStatistics&
     {
+      if (value.m_count == 0)
+        return *this;
+      if (this->m_count == 0)
+        return *this = value;
+
       if (this->m_max < value.m_max)
         this->m_max = value.m_max;
       if (this->m_min > value.m_min)
         this->m_min = value.m_min;
 
+      count_type const count_a = this->m_count;
       if ((std::numeric_limits<count_type>::max() - this->m_count) > value.m_count)
         this->m_count += value.m_count;
       else
         this->m_count = std::numeric_limits<count_type>::max();
 
+      value_type const delta = value.m_mean - this->m_mean;
       value_type const scale = static_cast<value_type>(value.m_count) / static_cast<value_type>(this->m_count);
-      this->m_mean += (value.m_mean - this->m_mean) * scale;
-      this->m_x_sqr += (value.m_x_sqr - this->m_x_sqr) * scale;
+      this->m_mean += delta * scale;
+      this->m_m2 += value.m_m2 + delta * delta * static_cast<value_type>(count_a) * scale;
       return *this;
     }
 
@@ -122,17 +192,142 @@ namespace exmath::statistics
     {
       if (this->m_count < 2)
         return std::numeric_limits<value_type>::quiet_NaN();
-      value_type const scale = static_cast<value_type>(this->m_count) / static_cast<value_type>(this->m_count - 1);
-      return std::abs(this->m_x_sqr - this->m_mean * this->m_mean) * scale;
+      return this->m_m2 / static_cast<value_type>(this->m_count - 1);
     }
     value_type get_standard_deviation() const noexcept { return std::sqrt(this->get_variance()); }
 
   private:
+    static constexpr count_type chunk_size = 256;
+
+    // sums of the deviations from the first valid value of a chunk
+    struct shifted_sums_t
+    {
+      value_type shift     = 0.0;
+      value_type total     = 0.0;
+      value_type total_sqr = 0.0;
+      value_type count     = 0.0;
+      value_type min       = std::numeric_limits<value_type>::infinity();
+      value_type max       = -std::numeric_limits<value_type>::infinity();
+
+      void add(value_type value) noexcept
+      {
+        if (std::isnan(value))
+          return;
+        if (this->count == 0.0)
+          this->shift = value;
+
+        value_type const delta = value - this->shift;
+        this->total += delta;
+        this->total_sqr += delta * delta;
+        this->count += 1.0;
+        this->min = std::min(this->min, value);
+        this->max = std::max(this->max, value);
+      }
+
+      BatchStatistics get() const noexcept
+      {
+        BatchStatistics ret;
+        if (this->count == 0.0)
+          return ret;
+
+        ret.m_count = static_cast<count_type>(this->count);
+        ret.m_min   = this->min;
+        ret.m_max   = this->max;
+        ret.m_mean  = this->shift + this->total / this->count;
+        ret.m_m2    = std::max(0.0, this->total_sqr - this->total * this->total / this->count);
+        return ret;
+      }
+    };
+
+    template <typename T> void p_add_bulk(T const* values, count_type size) noexcept
+    {
+      for (count_type beg = 0; beg < size; beg += chunk_size)
+        this->operator()(p_chunk(values + beg, std::min(chunk_size, size - beg)));
+    }
+
+    // statistics of at most chunk_size values
+    template <typename T> static BatchStatistics p_chunk(T const* values, count_type size) noexcept
+    {
+      using lanes = Internal::lanes_t;
+
+      shifted_sums_t sums;
+      count_type     first = 0;
+      while ((first < size) && (sums.count == 0.0))
+        sums.add(static_cast<value_type>(values[first++]));
+      if (sums.count == 0.0)
+        return sums.get();
+
+      values += first;
+      size -= first;
+
+      constexpr count_type step = 2 * lanes::width;
+      count_type const     full = size - size % step;
+
+      // two sets of accumulators, so consecutive additions do not wait for each other. Separate
+      // objects and not an array, which gcc keeps in memory unless it unrolls the loop over it
+      struct accumulator_t
+      {
+        lanes::reg_t sum = lanes::set1(0.0);
+        lanes::reg_t sqr = lanes::set1(0.0);
+        lanes::reg_t cnt = lanes::set1(0.0);
+        lanes::reg_t lo;
+        lanes::reg_t hi;
+
+        void add(lanes::reg_t val, lanes::reg_t shift) noexcept
+        {
+          lanes::reg_t const valid = lanes::valid(val);
+          lanes::reg_t const delta = lanes::mask(valid, lanes::sub(val, shift));
+          this->sum                = lanes::add(this->sum, delta);
+          this->sqr                = lanes::add(this->sqr, lanes::mul(delta, delta));
+          this->cnt                = lanes::add(this->cnt, lanes::mask(valid, lanes::set1(1.0)));
+          this->lo                 = lanes::min(val, this->lo);
+          this->hi                 = lanes::max(val, this->hi);
+        }
+
+        void reduce(shifted_sums_t& sums) const noexcept
+        {
+          value_type tmp_sum[lanes::width];
+          value_type tmp_sqr[lanes::width];
+          value_type tmp_cnt[lanes::width];
+          value_type tmp_lo[lanes::width];
+          value_type tmp_hi[lanes::width];
+          lanes::store(tmp_sum, this->sum);
+          lanes::store(tmp_sqr, this->sqr);
+          lanes::store(tmp_cnt, this->cnt);
+          lanes::store(tmp_lo, this->lo);
+          lanes::store(tmp_hi, this->hi);
+          for (count_type l = 0; l < lanes::width; l++)
+          {
+            sums.total += tmp_sum[l];
+            sums.total_sqr += tmp_sqr[l];
+            sums.count += tmp_cnt[l];
+            sums.min = std::min(sums.min, tmp_lo[l]);
+            sums.max = std::max(sums.max, tmp_hi[l]);
+          }
+        }
+      };
+
+      lanes::reg_t const shift = lanes::set1(sums.shift);
+      accumulator_t      acc_a{ .lo = shift, .hi = shift };
+      accumulator_t      acc_b{ .lo = shift, .hi = shift };
+      for (count_type i = 0; i < full; i += step)
+      {
+        acc_a.add(lanes::load(values + i), shift);
+        acc_b.add(lanes::load(values + i + lanes::width), shift);
+      }
+      acc_a.reduce(sums);
+      acc_b.reduce(sums);
+
+      for (count_type i = full; i < size; i++)
+        sums.add(static_cast<value_type>(values[i]));
+      return sums.get();
+    }
+
     count_type m_count = 0;
     value_type m_max   = -std::numeric_limits<value_type>::infinity();
     value_type m_min   = std::numeric_limits<value_type>::infinity();
-    value_type m_mean  = 0.0f;
-    value_type m_x_sqr = 0.0f;
+    value_type m_mean  = 0.0;
+    value_type m_m2    = 0.0;    // sum of the squared deviations from the mean
   };
 
   inline BatchStatistics operator+(BatchStatistics const& lhs, BatchStatistics const& rhs) noexcept
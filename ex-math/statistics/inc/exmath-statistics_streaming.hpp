@@ -0,0 +1,624 @@
+#pragma once
+#ifndef EXMATH_STATISTICS_STREAMING_HPP_INCLUDED
+#define EXMATH_STATISTICS_STREAMING_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <numbers>
+#include <span>
+
+/*
+ * Streaming estimators with constant memory, used like BatchStatistics:
+ * values are added by operator()(value), spans or functors, partial
+ * results are merged by operator()(other) / operator+= and NaNs are
+ * ignored. Where the order matters (ExponentialStatistics,
+ * SlidingWindowStatistics) the right hand side of a merge is the newer
+ * part of the stream.
+ */
+namespace exmath::statistics
+{
+  namespace Internal
+  {
+    inline std::size_t saturated_add(std::size_t a, std::size_t b) noexcept
+    {
+      return ((std::numeric_limits<std::size_t>::max() - a) > b) ? (a + b) : std::numeric_limits<std::size_t>::max();
+    }
+  }    // namespace Internal
+
+  /*
+   * Quantiles by a merging t-digest with at most N centroids.
+   *
+   * New values and merged centroids are collected behind the compressed
+   * ones, when all 2 * N places are used the centroids are sorted and
+   * merged again under the k1 scale function (small centroids at the
+   * tails), so the quantiles near 0 and 1 are the most accurate ones.
+   */
+  template <std::size_t N>
+    requires(N >= 4)
+  class QuantileDigest
+  {
+  public:
+    using count_type = std::size_t;
+    using value_type = double;
+
+    QuantileDigest() = default;
+
+    QuantileDigest(value_type const& value) { this->operator()(value); }
+
+    QuantileDigest(std::span<value_type const> const& values) { this->operator()(values); }
+    QuantileDigest(std::span<float const> const& values) { this->operator()(values); }
+
+    template <typename functor> QuantileDigest(functor const& ftor, count_type max_idx) { this->operator()(ftor, max_idx); }
+
+    auto operator()(value_type const& value) noexcept -> QuantileDigest&
+    {
+      if (std::isnan(value))
+        return *this;
+
+      this->m_min   = std::min(this->m_min, value);
+      this->m_max   = std::max(this->m_max, value);
+      this->m_count = Internal::saturated_add(this->m_count, 1);
+      this->p_insert({ value, 1.0 });
+      return *this;
+    }
+
+    template <typename functor> auto operator()(functor const& ftor, count_type max_idx) noexcept -> QuantileDigest&
+    {
+      for (count_type i = 0; i < max_idx; i++)
+        this->operator()(static_cast<value_type>(ftor(i)));
+      return *this;
+    }
+    auto operator()(std::span<value_type const> const& values) noexcept -> QuantileDigest&
+    {
+      for (value_type const val : values)
+        this->operator()(val);
+      return *this;
+    }
+    auto operator()(std::span<float const> const& values) noexcept -> QuantileDigest&
+    {
+      for (float const val : values)
+        this->operator()(static_cast<value_type>(val));
+      return *this;
+    }
+
+    auto operator()(QuantileDigest const& value) noexcept -> QuantileDigest&
+    {
+      if (value.m_count == 0)
+        return *this;
+
+      this->m_min   = std::min(this->m_min, value.m_min);
+      this->m_max   = std::max(this->m_max, value.m_max);
+      this->m_count = Internal::saturated_add(this->m_count, value.m_count);
+      for (count_type i = 0; i < value.m_used; i++)
+        this->p_insert(value.m_centroids[i]);
+      return *this;
+    }
+
+    count_type get_number_of_values() const noexcept { return this->m_count; }
+    value_type get_max() const noexcept { return this->m_max; }
+    value_type get_min() const noexcept { return this->m_min; }
+
+    // q in [0, 1], interpolated between the centers of the centroids
+    value_type get_quantile(value_type q) const noexcept
+    {
+      if ((this->m_count == 0) || std::isnan(q))
+        return std::numeric_limits<value_type>::quiet_NaN();
+
+      QuantileDigest tmp{ *this };
+      tmp.p_compress();
+      return tmp.p_quantile(std::clamp(q, 0.0, 1.0));
+    }
+    value_type get_median() const noexcept { return this->get_quantile(0.5); }
+
+  private:
+    struct centroid_t
+    {
+      value_type mean   = 0.0;
+      value_type weight = 0.0;
+    };
+
+    static constexpr count_type capacity = 2 * N;
+
+    void p_insert(centroid_t const& val) noexcept
+    {
+      if (this->m_used == capacity)
+        this->p_compress();
+      this->m_centroids[this->m_used++] = val;
+    }
+
+    // k1 scale function for N centroids at most, every centroid spans one unit of k
+    static value_type p_scale(value_type q) noexcept { return static_cast<value_type>(N) / std::numbers::pi * std::asin(2.0 * q - 1.0); }
+    static value_type p_inverse_scale(value_type k) noexcept
+    {
+      value_type const arg = std::clamp(k * std::numbers::pi / static_cast<value_type>(N), -std::numbers::pi / 2.0, std::numbers::pi / 2.0);
+      return (std::sin(arg) + 1.0) / 2.0;
+    }
+
+    void p_compress() noexcept
+    {
+      if (this->m_used < 2)
+        return;
+
+      std::sort(this->m_centroids.begin(), this->m_centroids.begin() + this->m_used, [](centroid_t const& a, centroid_t const& b) { return a.mean < b.mean; });
+
+      value_type total = 0.0;
+      for (count_type i = 0; i < this->m_used; i++)
+        total += this->m_centroids[i].weight;
+
+      count_type cur     = 0;
+      value_type done    = 0.0;    // weight left of the current centroid
+      value_type q_limit = p_inverse_scale(p_scale(0.0) + 1.0);
+      for (count_type i = 1; i < this->m_used; i++)
+      {
+        centroid_t const& next   = this->m_centroids[i];
+        centroid_t&       acc    = this->m_centroids[cur];
+        value_type const  q_next = (done + acc.weight + next.weight) / total;
+        if (q_next <= q_limit)
+        {
+          acc.weight += next.weight;
+          acc.mean += (next.mean - acc.mean) * next.weight / acc.weight;
+        }
+        else
+        {
+          done += acc.weight;
+          q_limit                  = p_inverse_scale(p_scale(done / total) + 1.0);
+          this->m_centroids[++cur] = next;
+        }
+      }
+      this->m_used = cur + 1;
+    }
+
+    value_type p_quantile(value_type q) const noexcept
+    {
+      if (this->m_used == 1)
+        return this->m_centroids[0].mean;
+
+      value_type total = 0.0;
+      for (count_type i = 0; i < this->m_used; i++)
+        total += this->m_centroids[i].weight;
+
+      value_type const target = q * total;
+
+      // left of the center of the first centroid: between the minimum and its mean
+      centroid_t const& first = this->m_centroids[0];
+      if (target < first.weight / 2.0)
+        return this->m_min + (first.mean - this->m_min) * target / (first.weight / 2.0);
+
+      value_type center = first.weight / 2.0;
+      for (count_type i = 1; i < this->m_used; i++)
+      {
+        centroid_t const& prev        = this->m_centroids[i - 1];
+        centroid_t const& cur         = this->m_centroids[i];
+        value_type const  next_center = center + (prev.weight + cur.weight) / 2.0;
+        if (target < next_center)
+          return prev.mean + (cur.mean - prev.mean) * (target - center) / (next_center - center);
+        center = next_center;
+      }
+
+      // right of the center of the last centroid: between its mean and the maximum
+      centroid_t const& last = this->m_centroids[this->m_used - 1];
+      return last.mean + (this->m_max - last.mean) * std::min(1.0, (target - center) / (last.weight / 2.0));
+    }
+
+    std::array<centroid_t, capacity> m_centroids = {};
+    count_type                       m_used      = 0;
+    count_type                       m_count     = 0;
+    value_type                       m_max       = -std::numeric_limits<value_type>::infinity();
+    value_type                       m_min       = std::numeric_limits<value_type>::infinity();
+  };
+
+  /*
+   * Counts of N bins of equal width in [lower, upper), values outside
+   * are counted as under- and overflow. Only histograms with the same
+   * range are merged (exactly), a histogram of a different range is
+   * rejected and leaves this one unchanged. A default constructed
+   * histogram has no range yet and takes the one of the first merge.
+   */
+  template <std::size_t N>
+    requires(N > 0)
+  class Histogram
+  {
+  public:
+    using count_type = std::size_t;
+    using value_type = double;
+
+    Histogram() = default;
+
+    Histogram(value_type lower, value_type upper)
+        : m_lower{ lower }
+        , m_upper{ upper }
+    {
+    }
+
+    Histogram(value_type lower, value_type upper, std::span<value_type const> const& values)
+        : Histogram{ lower, upper }
+    {
+      this->operator()(values);
+    }
+    Histogram(value_type lower, value_type upper, std::span<float const> const& values)
+        : Histogram{ lower, upper }
+    {
+      this->operator()(values);
+    }
+
+    template <typename functor>
+    Histogram(value_type lower, value_type upper, functor const& ftor, count_type max_idx)
+        : Histogram{ lower, upper }
+    {
+      this->operator()(ftor, max_idx);
+    }
+
+    auto operator()(value_type const& value) noexcept -> Histogram&
+    {
+      if (std::isnan(value))
+        return *this;
+      this->p_add(value, 1);
+      return *this;
+    }
+
+    template <typename functor> auto operator()(functor const& ftor, count_type max_idx) noexcept -> Histogram&
+    {
+      for (count_type i = 0; i < max_idx; i++)
+        this->operator()(static_cast<value_type>(ftor(i)));
+      return *this;
+    }
+    auto operator()(std::span<value_type const> const& values) noexcept -> Histogram&
+    {
+      for (value_type const val : values)
+        this->operator()(val);
+      return *this;
+    }
+    auto operator()(std::span<float const> const& values) noexcept -> Histogram&
+    {
+      for (float const val : values)
+        this->operator()(static_cast<value_type>(val));
+      return *this;
+    }
+
+    auto operator()(Histogram const& value) noexcept -> Histogram&
+    {
+      if ((this->m_count == 0) && !this->has_range())
+        return *this = value;
+      if (!this->has_same_range(value))
+        return *this;
+
+      for (count_type i = 0; i < N; i++)
+        this->m_bins[i] = Internal::saturated_add(this->m_bins[i], value.m_bins[i]);
+      this->m_underflow = Internal::saturated_add(this->m_underflow, value.m_underflow);
+      this->m_overflow  = Internal::saturated_add(this->m_overflow, value.m_overflow);
+      this->m_count     = Internal::saturated_add(this->m_count, value.m_count);
+      return *this;
+    }
+
+    // false for a default constructed histogram
+    bool has_range() const noexcept { return this->m_lower != this->m_upper; }
+    // true if value would be merged by operator()(value)
+    bool has_same_range(Histogram const& value) const noexcept { return (this->m_lower == value.m_lower) && (this->m_upper == value.m_upper); }
+
+    count_type get_number_of_values() const noexcept { return this->m_count; }
+    count_type get_number_of_bins() const noexcept { return N; }
+    count_type get_bin(count_type idx) const noexcept { return this->m_bins[idx]; }
+    count_type get_underflow() const noexcept { return this->m_underflow; }
+    count_type get_overflow() const noexcept { return this->m_overflow; }
+    value_type get_lower_bound(count_type idx) const noexcept { return this->m_lower + static_cast<value_type>(idx) * this->p_width(); }
+    value_type get_upper_bound(count_type idx) const noexcept { return this->m_lower + static_cast<value_type>(idx + 1) * this->p_width(); }
+
+    // q in [0, 1], linear within a bin, the bounds of the range if the quantile is in the under- or overflow
+    value_type get_quantile(value_type q) const noexcept
+    {
+      if ((this->m_count == 0) || std::isnan(q))
+        return std::numeric_limits<value_type>::quiet_NaN();
+
+      value_type const target = std::clamp(q, 0.0, 1.0) * static_cast<value_type>(this->m_count);
+      value_type       below  = static_cast<value_type>(this->m_underflow);
+      if (target < below)
+        return this->m_lower;
+      for (count_type i = 0; i < N; i++)
+      {
+        value_type const cnt = static_cast<value_type>(this->m_bins[i]);
+        if ((cnt != 0.0) && (target <= below + cnt))
+          return this->get_lower_bound(i) + this->p_width() * (target - below) / cnt;
+        below += cnt;
+      }
+      return this->m_upper;
+    }
+
+  private:
+    value_type p_width() const noexcept { return (this->m_upper - this->m_lower) / static_cast<value_type>(N); }
+
+    void p_add(value_type value, count_type count) noexcept
+    {
+      if (count == 0)
+        return;
+
+      this->m_count = Internal::saturated_add(this->m_count, count);
+      if (!(value >= this->m_lower))
+        this->m_underflow = Internal::saturated_add(this->m_underflow, count);
+      else if (!(value < this->m_upper))
+        this->m_overflow = Internal::saturated_add(this->m_overflow, count);
+      else
+      {
+        count_type const idx = std::min(N - 1, static_cast<count_type>((value - this->m_lower) / this->p_width()));
+        this->m_bins[idx]    = Internal::saturated_add(this->m_bins[idx], count);
+      }
+    }
+
+    value_type                m_lower     = 0.0;
+    value_type                m_upper     = 0.0;
+    std::array<count_type, N> m_bins      = {};
+    count_type                m_underflow = 0;
+    count_type                m_overflow  = 0;
+    count_type                m_count     = 0;
+  };
+
+  /*
+   * Exponentially weighted mean and variance, every new value weights
+   * all previous ones by (1 - alpha). The state is the sum of the weights,
+   * the weighted mean and the weighted sum of squared deviations, so a
+   * newer part is merged exactly by decaying the older part by the
+   * product of its factors and combining both like BatchStatistics.
+   * Both parts of a merge have to use the same alpha.
+   */
+  class ExponentialStatistics
+  {
+  public:
+    using count_type = std::size_t;
+    using value_type = double;
+
+    explicit ExponentialStatistics(value_type alpha = 0.1)
+        : m_alpha{ alpha }
+    {
+    }
+
+    ExponentialStatistics(std::span<value_type const> const& values, value_type alpha = 0.1)
+        : ExponentialStatistics{ alpha }
+    {
+      this->operator()(values);
+    }
+    ExponentialStatistics(std::span<float const> const& values, value_type alpha = 0.1)
+        : ExponentialStatistics{ alpha }
+    {
+      this->operator()(values);
+    }
+
+    template <typename functor>
+    ExponentialStatistics(functor const& ftor, count_type max_idx, value_type alpha = 0.1)
+        : ExponentialStatistics{ alpha }
+    {
+      this->operator()(ftor, max_idx);
+    }
+
+    auto operator()(value_type const& value) noexcept -> ExponentialStatistics&
+    {
+      if (std::isnan(value))
+        return *this;
+
+      value_type const decay = 1.0 - this->m_alpha;
+      this->m_weight         = this->m_weight * decay + 1.0;
+      this->m_decay *= decay;
+      this->m_count = Internal::saturated_add(this->m_count, 1);
+
+      value_type const delta = value - this->m_mean;
+      this->m_mean += delta / this->m_weight;
+      this->m_m2 = this->m_m2 * decay + delta * (value - this->m_mean);
+      return *this;
+    }
+
+    template <typename functor> auto operator()(functor const& ftor, count_type max_idx) noexcept -> ExponentialStatistics&
+    {
+      for (count_type i = 0; i < max_idx; i++)
+        this->operator()(static_cast<value_type>(ftor(i)));
+      return *this;
+    }
+    auto operator()(std::span<value_type const> const& values) noexcept -> ExponentialStatistics&
+    {
+      for (value_type const val : values)
+        this->operator()(val);
+      return *this;
+    }
+    auto operator()(std::span<float const> const& values) noexcept -> ExponentialStatistics&
+    {
+      for (float const val : values)
+        this->operator()(static_cast<value_type>(val));
+      return *this;
+    }
+
+    // value is the newer part of the stream
+    auto operator()(ExponentialStatistics const& value) noexcept -> ExponentialStatistics&
+    {
+      if (value.m_count == 0)
+        return *this;
+      if (this->m_count == 0)
+        return *this = value;
+
+      value_type const weight_a = this->m_weight * value.m_decay;
+      value_type const weight   = weight_a + value.m_weight;
+      value_type const delta    = value.m_mean - this->m_mean;
+      value_type const scale    = value.m_weight / weight;
+
+      this->m_mean += delta * scale;
+      this->m_m2     = this->m_m2 * value.m_decay + value.m_m2 + delta * delta * weight_a * scale;
+      this->m_weight = weight;
+      this->m_decay *= value.m_decay;
+      this->m_count = Internal::saturated_add(this->m_count, value.m_count);
+      return *this;
+    }
+
+    count_type get_number_of_values() const noexcept { return this->m_count; }
+    value_type get_alpha() const noexcept { return this->m_alpha; }
+    value_type get_mean() const noexcept
+    {
+      if (this->m_count == 0)
+        return std::numeric_limits<value_type>::quiet_NaN();
+      return this->m_mean;
+    }
+    value_type get_variance() const noexcept
+    {
+      if (this->m_count < 2)
+        return std::numeric_limits<value_type>::quiet_NaN();
+      return this->m_m2 / this->m_weight;
+    }
+    value_type get_standard_deviation() const noexcept { return std::sqrt(this->get_variance()); }
+
+  private:
+    value_type m_alpha;
+    value_type m_weight = 0.0;
+    value_type m_decay  = 1.0;    // (1 - alpha) ^ number of values
+    value_type m_mean   = 0.0;
+    value_type m_m2     = 0.0;
+    count_type m_count  = 0;
+  };
+
+  /*
+   * Sum, mean and variance of the last N values. Replacing the oldest
+   * value updates the sums in O(1), every N replacements they are
+   * recalculated from the window so rounding errors do not accumulate.
+   */
+  template <std::size_t N>
+    requires(N > 0)
+  class SlidingWindowStatistics
+  {
+  public:
+    using count_type = std::size_t;
+    using value_type = double;
+
+    SlidingWindowStatistics() = default;
+
+    SlidingWindowStatistics(value_type const& value) { this->operator()(value); }
+
+    SlidingWindowStatistics(std::span<value_type const> const& values) { this->operator()(values); }
+    SlidingWindowStatistics(std::span<float const> const& values) { this->operator()(values); }
+
+    template <typename functor> SlidingWindowStatistics(functor const& ftor, count_type max_idx) { this->operator()(ftor, max_idx); }
+
+    auto operator()(value_type const& value) noexcept -> SlidingWindowStatistics&
+    {
+      if (std::isnan(value))
+        return *this;
+
+      if (this->m_size < N)
+      {
+        this->m_values[(this->m_head + this->m_size) % N] = value;
+        this->m_size++;
+
+        value_type const delta = value - this->m_mean;
+        this->m_mean += delta / static_cast<value_type>(this->m_size);
+        this->m_m2 += delta * (value - this->m_mean);
+        return *this;
+      }
+
+      value_type const old         = this->m_values[this->m_head];
+      this->m_values[this->m_head] = value;
+      this->m_head                 = (this->m_head + 1) % N;
+
+      if (++this->m_replaced == N)
+        return this->p_recalculate();
+
+      value_type const mean = this->m_mean + (value - old) / static_cast<value_type>(N);
+      this->m_m2 += (value - old) * (value - mean + old - this->m_mean);
+      this->m_mean = mean;
+      return *this;
+    }
+
+    template <typename functor> auto operator()(functor const& ftor, count_type max_idx) noexcept -> SlidingWindowStatistics&
+    {
+      for (count_type i = 0; i < max_idx; i++)
+        this->operator()(static_cast<value_type>(ftor(i)));
+      return *this;
+    }
+    auto operator()(std::span<value_type const> const& values) noexcept -> SlidingWindowStatistics&
+    {
+      for (value_type const val : values)
+        this->operator()(val);
+      return *this;
+    }
+    auto operator()(std::span<float const> const& values) noexcept -> SlidingWindowStatistics&
+    {
+      for (float const val : values)
+        this->operator()(static_cast<value_type>(val));
+      return *this;
+    }
+
+    // value is the newer part of the stream, its values are added from the oldest on
+    auto operator()(SlidingWindowStatistics const& value) noexcept -> SlidingWindowStatistics&
+    {
+      for (count_type i = 0; i < value.m_size; i++)
+        this->operator()(value.m_values[(value.m_head + i) % N]);
+      return *this;
+    }
+
+    count_type get_number_of_values() const noexcept { return this->m_size; }
+    count_type get_window_size() const noexcept { return N; }
+    value_type get_sum() const noexcept { return this->m_mean * static_cast<value_type>(this->m_size); }
+    value_type get_mean() const noexcept
+    {
+      if (this->m_size == 0)
+        return std::numeric_limits<value_type>::quiet_NaN();
+      return this->m_mean;
+    }
+    value_type get_variance() const noexcept
+    {
+      if (this->m_size < 2)
+        return std::numeric_limits<value_type>::quiet_NaN();
+      return std::max(0.0, this->m_m2) / static_cast<value_type>(this->m_size - 1);
+    }
+    value_type get_standard_deviation() const noexcept { return std::sqrt(this->get_variance()); }
+
+  private:
+    SlidingWindowStatistics& p_recalculate() noexcept
+    {
+      value_type sum = 0.0;
+      for (value_type const val : this->m_values)
+        sum += val;
+      this->m_mean = sum / static_cast<value_type>(N);
+
+      this->m_m2 = 0.0;
+      for (value_type const val : this->m_values)
+        this->m_m2 += (val - this->m_mean) * (val - this->m_mean);
+
+      this->m_replaced = 0;
+      return *this;
+    }
+
+    std::array<value_type, N> m_values   = {};
+    count_type                m_head     = 0;    // oldest value
+    count_type                m_size     = 0;
+    count_type                m_replaced = 0;
+    value_type                m_mean     = 0.0;
+    value_type                m_m2       = 0.0;
+  };
+
+  template <std::size_t N> QuantileDigest<N> operator+(QuantileDigest<N> const& lhs, QuantileDigest<N> const& rhs) noexcept
+  {
+    QuantileDigest<N> ret{ lhs };
+    return ret(rhs);
+  }
+  template <std::size_t N> QuantileDigest<N>& operator+=(QuantileDigest<N>& lhs, QuantileDigest<N> const& rhs) noexcept { return lhs(rhs); }
+
+  template <std::size_t N> Histogram<N> operator+(Histogram<N> const& lhs, Histogram<N> const& rhs) noexcept
+  {
+    Histogram<N> ret{ lhs };
+    return ret(rhs);
+  }
+  template <std::size_t N> Histogram<N>& operator+=(Histogram<N>& lhs, Histogram<N> const& rhs) noexcept { return lhs(rhs); }
+
+  inline ExponentialStatistics operator+(ExponentialStatistics const& lhs, ExponentialStatistics const& rhs) noexcept
+  {
+    ExponentialStatistics ret{ lhs };
+    return ret(rhs);
+  }
+  inline ExponentialStatistics& operator+=(ExponentialStatistics& lhs, ExponentialStatistics const& rhs) noexcept { return lhs(rhs); }
+
+  template <std::size_t N> SlidingWindowStatistics<N> operator+(SlidingWindowStatistics<N> const& lhs, SlidingWindowStatistics<N> const& rhs) noexcept
+  {
+    SlidingWindowStatistics<N> ret{ lhs };
+    return ret(rhs);
+  }
+  template <std::size_t N> SlidingWindowStatistics<N>& operator+=(SlidingWindowStatistics<N>& lhs, SlidingWindowStatistics<N> const& rhs) noexcept { return lhs(rhs); }
+}    // namespace exmath::statistics
+
+#endif
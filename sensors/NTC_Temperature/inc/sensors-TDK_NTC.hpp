@@ -2,7 +2,14 @@
 #ifndef SENSORS_TDK_NTC_HPP_INCLUDED
 #define SENSORS_TDK_NTC_HPP_INCLUDED
 
+#include <algorithm>
+#include <bit>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <exmath-polynominal.hpp>
+#include <limits>
+#include <span>
 
 namespace sensors
 {
@@ -52,20 +59,122 @@ namespace sensors
     auto operator()(float resistance) const noexcept -> float
     {
       float const v = std::log(resistance / this->m_r_base);
+      return exmath::polynominal::estrin(this->p_parameter(), v);
+    }
 
-      float tmp = this->m_para[0];
-      for (std::size_t i = 1; i < number_of_parameters; i++)
-      {
-        tmp *= v;
-        tmp += this->m_para[i];
-      }
-      return tmp;
+    // temperature[i] of resistance[i], for min(resistance.size(), temperature.size()) values
+    void operator()(std::span<float const> resistance, std::span<float> temperature) const noexcept
+    {
+      std::size_t const size = std::min(resistance.size(), temperature.size());
+      for (std::size_t i = 0; i < size; i++)
+        temperature[i] = std::log(resistance[i] / this->m_r_base);
+      exmath::polynominal::horner(this->p_parameter(), std::span<float const>{ temperature.first(size) }, temperature.first(size));
     }
 
   private:
+    std::span<float const, number_of_parameters> p_parameter() const noexcept { return this->m_para; }
+
     float const (&m_para)[number_of_parameters];
     float const m_r_base;
   };
+
+  /*
+   * TDK_NTC without std::log, for the sample rate of an ADC.
+   *
+   * The temperature is tabulated at compile time over the resistance
+   * ratio r = R / r_base in [2^Min_Octave, 2^Max_Octave]. The axis of the
+   * table is the octave of r plus the linear position in it, r = 2^e * (1 + f)
+   * gives e + f, which is read from the exponent and mantissa of the float.
+   * The grid points lie on the octave bounds, so the interpolation only
+   * spans smooth parts of the curve. Outside of the range the temperature
+   * of the bound is returned.
+   */
+  template <std::size_t Points_Per_Octave = 32, int Min_Octave = -7, int Max_Octave = 7>
+    requires(Points_Per_Octave > 0 && Min_Octave < Max_Octave)
+  class TDK_NTC_table_t
+  {
+    static constexpr std::size_t number_of_parameters = 6;
+    static constexpr std::size_t number_of_values     = static_cast<std::size_t>(Max_Octave - Min_Octave) * Points_Per_Octave + 1;
+
+  public:
+    constexpr TDK_NTC_table_t(float const (&parameter)[number_of_parameters], float r_base)
+        : m_inv_r_base{ 1.0f / r_base }
+        , m_table{ [&parameter](float position) { return p_temperature(parameter, position); }, static_cast<float>(Min_Octave), static_cast<float>(Max_Octave) }
+    {
+    }
+
+    auto operator()(float resistance) const noexcept -> float
+    {
+      float const ratio = resistance * this->m_inv_r_base;
+      if (!(ratio > 0.0f))
+        return std::numeric_limits<float>::quiet_NaN();
+
+      // e + f of ratio = 2^e * (1 + f), for normal floats
+      uint32_t const bits     = std::bit_cast<uint32_t>(ratio);
+      int32_t const  exponent = static_cast<int32_t>(bits >> 23) - 127;
+      float const    fraction = static_cast<float>(bits & 0x007F'FFFFu) * (1.0f / 8388608.0f);
+      return this->m_table(static_cast<float>(exponent) + fraction);
+    }
+
+    // temperature[i] of resistance[i], for min(resistance.size(), temperature.size()) values
+    void operator()(std::span<float const> resistance, std::span<float> temperature) const noexcept
+    {
+      std::size_t const size = std::min(resistance.size(), temperature.size());
+      for (std::size_t i = 0; i < size; i++)
+        temperature[i] = this->operator()(resistance[i]);
+    }
+
+    constexpr float get_min_resistance_ratio() const noexcept { return p_ratio(static_cast<double>(Min_Octave)); }
+    constexpr float get_max_resistance_ratio() const noexcept { return p_ratio(static_cast<double>(Max_Octave)); }
+
+  private:
+    // e of a position e + f, f in [0, 1)
+    static constexpr int p_octave(double position) noexcept
+    {
+      int const ret = static_cast<int>(position);
+      return (ret > position) ? (ret - 1) : ret;
+    }
+
+    static constexpr double p_ratio(double position) noexcept
+    {
+      int const exponent = p_octave(position);
+      double    ret      = 1.0 + (position - exponent);
+      for (int i = 0; i < exponent; i++)
+        ret *= 2.0;
+      for (int i = 0; i > exponent; i--)
+        ret /= 2.0;
+      return ret;
+    }
+
+    // ln(2^e * m) = e * ln(2) + 2 * artanh((m - 1) / (m + 1)), m = 1 + f
+    static constexpr double p_log(double position) noexcept
+    {
+      int const    exponent = p_octave(position);
+      double const mantissa = 1.0 + (position - exponent);
+
+      double const s   = (mantissa - 1.0) / (mantissa + 1.0);
+      double       pow = s;
+      double       sum = 0.0;
+      for (int k = 1; k < 40; k += 2)
+      {
+        sum += pow / k;
+        pow *= s * s;
+      }
+      return exponent * 0.69314718055994530942 + 2.0 * sum;
+    }
+
+    static constexpr float p_temperature(float const (&parameter)[number_of_parameters], float position) noexcept
+    {
+      double const v   = p_log(static_cast<double>(position));
+      double       tmp = parameter[0];
+      for (std::size_t i = 1; i < number_of_parameters; i++)
+        tmp = tmp * v + parameter[i];
+      return static_cast<float>(tmp);
+    }
+
+    float                                                        m_inv_r_base;
+    exmath::polynominal::lookup_table_t<float, number_of_values> m_table;
+  };
 }
 
 #endif
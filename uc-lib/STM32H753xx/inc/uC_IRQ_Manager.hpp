@@ -41,6 +41,10 @@ namespace uC
                       wlib::Callback<void()>&                cb_handle,
                       IRQ_Priority const&                    prio);
     void unregister_irq(uC::HRTIMERs::HW_Unit const& hw_unit);
+
+    // both flash banks share FLASH_IRQn, the callback has to check the bank
+    void register_flash_irq(wlib::Callback<void()>& cb_handle, IRQ_Priority const& prio);
+    void unregister_flash_irq();
   }    // namespace IRQ_Manager
 }    // namespace uC
 
@@ -32,7 +32,8 @@ namespace uC
 
   public:
     using payload_t     = char;
-    using mem_payload_t = bslib::container::mpsc_queue_ex_mem<char>::mem_payload_t;
+    using mem_payload_t    = bslib::container::mpsc_queue_ex_mem<char>::mem_payload_t;
+    using mem_slot_state_t = bslib::container::mpsc_queue_ex_mem<char>::mem_slot_state_t;
 
     static constexpr hw_cfg_t UART_1__TX_A_09__RX__A_10{ uC::USARTs::USART_1, { uC::GPIOs::A_09, 7 }, { uC::GPIOs::A_10, 7 }, 42 };
     static constexpr hw_cfg_t UART_1__TX_A_09__RX__B_07{ uC::USARTs::USART_1, { uC::GPIOs::A_09, 7 }, { uC::GPIOs::B_07, 7 }, 42 };
@@ -46,7 +47,8 @@ namespace uC
     static constexpr hw_cfg_t UART_2__TX_D_05__RX__A_03{ uC::USARTs::USART_2, { uC::GPIOs::D_05, 7 }, { uC::GPIOs::A_03, 7 }, 44 };
     static constexpr hw_cfg_t UART_2__TX_D_05__RX__D_06{ uC::USARTs::USART_2, { uC::GPIOs::D_05, 7 }, { uC::GPIOs::D_06, 7 }, 44 };
 
-    UART__TX_DMA__RX_IRQ(hw_cfg_t const& cfg, uC::DMA_Streams::HW_Unit const& dma_stream_name, std::size_t const& buffer_size)
+    // the slot states are only used by the CPU, they don't need to be in DMA memory
+    UART__TX_DMA__RX_IRQ(hw_cfg_t const& cfg, uC::DMA_Streams::HW_Unit const& dma_stream_name, std::size_t const& buffer_size, std::span<mem_slot_state_t> slot_state)
         : m_uart_handle(cfg.uart_name)
         , m_tx_pin(cfg.tx.pin,
                    uC::HANDLEs::GPIO_Handle_t::Speed::Very_High,
@@ -59,7 +61,7 @@ namespace uC
                    uC::HANDLEs::GPIO_Handle_t::Pull_Mode::No_Pull,
                    cfg.rx.af_val)
         , m_dma_handle(dma_stream_name)
-        , m_buffer(BSP::get_dma_buffer_allocator().allocate<mem_payload_t>(buffer_size))
+        , m_buffer(BSP::get_dma_buffer_allocator().allocate<mem_payload_t>(std::min(buffer_size, slot_state.size())), slot_state)
     {
       USART_TypeDef&          uart_base   = this->m_uart_handle.get_base();
       DMA_Stream_TypeDef&     stream_base = this->m_dma_handle.get_base();
@@ -94,6 +96,9 @@ namespace uC
     bool operator()(char const* c_str, uint32_t len ) override
     {
       bool const  ret = this->m_buffer.push_back(c_str, len);
+
+      // tells a finishing consumer, that there is new data, even if it already found the buffer empty
+      this->m_kick = true;
       this->start_transmission();
       return ret;
     }
@@ -101,11 +106,21 @@ namespace uC
     wlib::CharPuplisher& get_input_publisher() { return this->m_pup; }
 
   private:
+    // the one who gets m_trans_ongoing is the consumer of the buffer, peak_span() collects the committed blocks
     void start_transmission()
     {
-      if (this->m_cur_blk_len != 0)
-        return;
-      this->p_start_transmission();
+      do
+      {
+        if (this->m_trans_ongoing.exchange(true))
+          return;
+
+        this->m_kick = false;
+
+        if (this->p_start_transmission())
+          return;
+
+        this->m_trans_ongoing = false;
+      } while (this->m_kick);
     }
 
     bool p_start_transmission()
@@ -136,7 +151,9 @@ namespace uC
       if (reason.is_transfer_complete())
       {
         this->m_buffer.drop(this->m_cur_blk_len);
-        this->p_start_transmission();
+        this->m_cur_blk_len   = 0;
+        this->m_trans_ongoing = false;
+        this->start_transmission();
       }
       if (reason.is_fifo_error())
       {
@@ -155,6 +172,7 @@ namespace uC
     }
 
     std::atomic<bool>                                                m_trans_ongoing = false;
+    std::atomic<bool>                                                m_kick          = false;
     std::atomic<uint32_t>                                            m_cur_blk_len   = 0;
     wlib::Memberfunction_Callback<this_t, void(irq_reason_t const&)> m_transfer_complete_cb{ *this, &this_t::p_finish_transmission };
     wlib::Memberfunction_Callback<this_t, void()>                    m_rx_irq_cb{ *this, &this_t::rx_irq_handler };
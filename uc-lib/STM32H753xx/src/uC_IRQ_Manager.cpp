@@ -14,6 +14,7 @@ namespace
   wlib::Callback<void(uC::HANDLEs::DMA_Stream_Handle_t::irq_reason_t const&)>* irq_handler_dma_stream[2][8]                                      = {};
   wlib::Callback<void()>*                                                      irq_handler_hrtimer[1][7]                                         = {};
   wlib::Callback<void()>*                                                      irq_handler_basic_timer[uC::TIMERs::HW_Unit::max_number_of_units] = {};
+  wlib::Callback<void()>*                                                      irq_handler_flash                                                 = nullptr;
 
   constexpr std::tuple<IRQn_Type, wlib::Callback<void()>*&> get_entry(uC::USARTs::HW_Unit const& hw_unit)
   {
@@ -137,6 +138,18 @@ namespace uC::IRQ_Manager
     disable_irq(irq_idx);
     handler = nullptr;
   }
+
+  void register_flash_irq(wlib::Callback<void()>& cb_handle, IRQ_Priority const& prio)
+  {
+    irq_handler_flash = &cb_handle;
+    enable_irq(FLASH_IRQn, prio);
+  }
+
+  void unregister_flash_irq()
+  {
+    disable_irq(FLASH_IRQn);
+    irq_handler_flash = nullptr;
+  }
 }    // namespace uC::IRQ_Manager
 
 uC::HANDLEs::DMA_Stream_Handle_t::irq_reason_t get_and_clear_reason(uC::register_t sr, uC::register_t clear, uint32_t sht)
@@ -187,6 +200,8 @@ extern "C" void SPI1_IRQHandler() { irq_handler_spi[0]->operator()(); }
 extern "C" void SPI2_IRQHandler() { irq_handler_spi[1]->operator()(); }
 extern "C" void SPI3_IRQHandler() { irq_handler_spi[2]->operator()(); }
 
+extern "C" void FLASH_IRQHandler() { irq_handler_flash->operator()(); }
+
 // extern "C" void NMI_Handler()
 //{
 //   __asm("bkpt 255");
@@ -259,12 +274,6 @@ extern "C" void SPI3_IRQHandler() { irq_handler_spi[2]->operator()(); }
 //   __asm("bkpt 255");
 //   __asm("bx lr");
 // }
-// extern "C" void FLASH_IRQHandler()
-//{
-//   //	extern "C" void FLASH_IRQHandler();
-//   __asm("bkpt 255");
-//   __asm("bx lr");
-// }
 // extern "C" void RCC_IRQHandler()
 //{
 //   //	extern "C" void RCC_IRQHandler();
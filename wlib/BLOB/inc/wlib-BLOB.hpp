@@ -6,50 +6,150 @@
 #include <bit>
 #include <concepts>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <limits>
 #include <span>
+#include <type_traits>
+#include <utility>
 
 namespace wlib::blob
 {
   namespace internal
   {
-    inline std::size_t data_shift_right(std::span<std::byte> data, std::size_t offset, std::size_t shift)
+#if defined(__cpp_lib_byteswap)
+    using std::byteswap;
+#else
+    template <std::integral T> [[nodiscard]] constexpr T byteswap(T value) noexcept
     {
-      for (std::size_t i = data.size(); offset < i;)
+      auto bytes = std::bit_cast<std::array<std::byte, sizeof(T)>>(value);
+      for (std::size_t i = 0; i < sizeof(T) / 2; i++)
+        std::swap(bytes[i], bytes[sizeof(T) - 1 - i]);
+      return std::bit_cast<T>(bytes);
+    }
+#endif
+
+    /*
+     * the kernels below are plain byte loops during constant evaluation and
+     * memmove / memcpy / memset or word wide byte swaps at runtime
+     */
+    constexpr std::size_t data_shift_right(std::span<std::byte> data, std::size_t offset, std::size_t shift)
+    {
+      if (data.size() <= offset)
+        return shift;
+
+      if (std::is_constant_evaluated())
       {
-        --i;
-        data.data()[i + shift] = data[i];
+        for (std::size_t i = data.size(); offset < i;)
+        {
+          --i;
+          data.data()[i + shift] = data[i];
+        }
+      }
+      else
+      {
+        std::memmove(data.data() + offset + shift, data.data() + offset, data.size() - offset);
       }
       return shift;
     }
-    inline std::size_t data_shift_left(std::span<std::byte> data, std::size_t offset, std::size_t shift)
+    constexpr std::size_t data_shift_left(std::span<std::byte> data, std::size_t offset, std::size_t shift)
     {
-      for (std::size_t i = offset; i < (data.size() - shift); i++)
+      if (data.size() <= offset + shift)
+        return shift;
+
+      if (std::is_constant_evaluated())
       {
-        data[i] = data[i + shift];
+        for (std::size_t i = offset; i < (data.size() - shift); i++)
+        {
+          data[i] = data[i + shift];
+        }
+      }
+      else
+      {
+        std::memmove(data.data() + offset, data.data() + offset + shift, data.size() - shift - offset);
       }
       return shift;
     }
 
-    inline std::size_t byte_copy(std::span<std::byte> trg, std::byte const* src)
+    constexpr std::size_t byte_copy(std::span<std::byte> trg, std::byte const* src)
     {
-      for (std::byte& ent : trg)
-        ent = *src++;
+      if (std::is_constant_evaluated())
+      {
+        for (std::byte& ent : trg)
+          ent = *src++;
+      }
+      else if (!trg.empty())
+      {
+        std::memcpy(trg.data(), src, trg.size());
+      }
       return trg.size();
     }
 
-    inline std::size_t byte_copy_reverse(std::span<std::byte> trg, std::byte const* src)
+    template <std::unsigned_integral T> inline void word_copy_reverse(std::byte* trg, std::byte const* src) noexcept
     {
-      src += trg.size();
-      for (std::byte& ent : trg)
-        ent = *--src;
+      T tmp;
+      std::memcpy(&tmp, src, sizeof(T));
+      tmp = byteswap(tmp);
+      std::memcpy(trg, &tmp, sizeof(T));
+    }
+
+    inline void byte_copy_reverse_bulk(std::byte* trg, std::byte const* src, std::size_t len) noexcept
+    {
+      for (; len >= sizeof(uint64_t); len -= sizeof(uint64_t), trg += sizeof(uint64_t))
+        word_copy_reverse<uint64_t>(trg, src + len - sizeof(uint64_t));
+      for (; len > 0; len--)
+        *trg++ = src[len - 1];
+    }
+
+    constexpr std::size_t byte_copy_reverse(std::span<std::byte> trg, std::byte const* src)
+    {
+      if (std::is_constant_evaluated())
+      {
+        src += trg.size();
+        for (std::byte& ent : trg)
+          ent = *--src;
+      }
+      // the sizes of the arithmetic types are a single byte swap
+      else if (trg.size() == sizeof(uint16_t))
+        word_copy_reverse<uint16_t>(trg.data(), src);
+      else if (trg.size() == sizeof(uint32_t))
+        word_copy_reverse<uint32_t>(trg.data(), src);
+      else if (trg.size() == sizeof(uint64_t))
+        word_copy_reverse<uint64_t>(trg.data(), src);
+      else
+        byte_copy_reverse_bulk(trg.data(), src, trg.size());
       return trg.size();
     }
 
-    inline std::size_t byte_fill(std::span<std::byte> trg, std::byte src)
+    /*
+     * copies a single value of N bytes, byte order reversed if requested
+     * N is known at compile time, so the reversal is a single byte swap
+     */
+    template <std::size_t N> constexpr void value_copy(std::byte* trg, std::byte const* src, bool reverse) noexcept
+    {
+      if (!reverse)
+        byte_copy(std::span<std::byte>(trg, N), src);
+      else if (std::is_constant_evaluated() || (N != 2 && N != 4 && N != 8))
+        byte_copy_reverse(std::span<std::byte>(trg, N), src);
+      else if constexpr (N == 2)
+        word_copy_reverse<uint16_t>(trg, src);
+      else if constexpr (N == 4)
+        word_copy_reverse<uint32_t>(trg, src);
+      else if constexpr (N == 8)
+        word_copy_reverse<uint64_t>(trg, src);
+    }
+
+    constexpr std::size_t byte_fill(std::span<std::byte> trg, std::byte src)
     {
-      for (std::byte& ent : trg)
-        ent = src;
+      if (std::is_constant_evaluated())
+      {
+        for (std::byte& ent : trg)
+          ent = src;
+      }
+      else if (!trg.empty())
+      {
+        std::memset(trg.data(), std::to_integer<int>(src), trg.size());
+      }
       return trg.size();
     }
 
@@ -127,25 +227,19 @@ namespace wlib::blob
 
     template <ArithmeticOrByte T> bool try_read(std::size_t offset, T& value, std::endian endian = std::endian::native) const noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_read(offset, std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-      else
-        return this->try_read_reverse(offset, std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
+      if (!this->range_check_read(offset, sizeof(T)))
+        return false;
+
+      internal::value_copy<sizeof(T)>(reinterpret_cast<std::byte*>(&value), &this->m_data[this->m_idx_front + offset], endian != std::endian::native);
+      return true;
     }
     template <ArithmeticOrByte T> bool try_read_back(T& value, std::endian endian = std::endian::native) const noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_read_back(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-      else
-        return this->try_read_back_reverse(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-    }
-    template <ArithmeticOrByte T> bool try_read_front(T& value, std::endian endian = std::endian::native) const noexcept
-    {
-      if (endian == std::endian::native)
-        return this->try_read_front(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-      else
-        return this->try_read_front_reverse(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
+      if (this->get_number_of_remaining_bytes() < sizeof(T))
+        return false;
+      return this->try_read(this->get_number_of_remaining_bytes() - sizeof(T), value, endian);
     }
+    template <ArithmeticOrByte T> bool try_read_front(T& value, std::endian endian = std::endian::native) const noexcept { return this->try_read(0, value, endian); }
 
     template <ArithmeticOrByte T> [[nodiscard]] T read(std::size_t offset, std::endian endian = std::endian::native) const
     {
@@ -243,8 +337,12 @@ namespace wlib::blob
     std::size_t                m_idx_back;
   };
 
+  class AppendWriter;
+
   class MemoryBlob
   {
+    friend class AppendWriter;
+
   public:
     constexpr MemoryBlob(std::span<std::byte> data, std::size_t position_idx = 0) noexcept
         : m_data(data)
@@ -263,6 +361,7 @@ namespace wlib::blob
     [[nodiscard]] constexpr std::size_t                get_number_of_used_bytes() const noexcept { return this->m_pos_idx; }
     [[nodiscard]] constexpr std::span<std::byte const> get_span() const noexcept { return std::span<std::byte const>(this->m_data.data(), this->m_pos_idx); }
     [[nodiscard]] constexpr std::span<std::byte>       get_span() noexcept { return std::span<std::byte>(this->m_data.data(), this->m_pos_idx); }
+    [[nodiscard]] constexpr std::span<std::byte>       get_free_span() noexcept { return this->m_data.subspan(this->m_pos_idx); }
     constexpr void                                     clear() noexcept { this->m_pos_idx = 0; }
     constexpr bool                                     try_adjust_position(std::ptrdiff_t offset) noexcept
     {
@@ -326,25 +425,19 @@ namespace wlib::blob
 
     template <ArithmeticOrByte T> bool try_read(std::size_t offset, T& value, std::endian endian = std::endian::native) const noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_read(offset, std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-      else
-        return this->try_read_reverse(offset, std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
+      if (!this->range_check_read(offset, sizeof(T)))
+        return false;
+
+      internal::value_copy<sizeof(T)>(reinterpret_cast<std::byte*>(&value), &this->m_data[offset], endian != std::endian::native);
+      return true;
     }
     template <ArithmeticOrByte T> bool try_read_back(T& value, std::endian endian = std::endian::native) const noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_read_back(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-      else
-        return this->try_read_back_reverse(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-    }
-    template <ArithmeticOrByte T> bool try_read_front(T& value, std::endian endian = std::endian::native) const noexcept
-    {
-      if (endian == std::endian::native)
-        return this->try_read_front(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
-      else
-        return this->try_read_front_reverse(std::span<std::byte>(reinterpret_cast<std::byte*>(&value), sizeof(T)));
+      if (this->get_number_of_used_bytes() < sizeof(T))
+        return false;
+      return this->try_read(this->get_number_of_used_bytes() - sizeof(T), value, endian);
     }
+    template <ArithmeticOrByte T> bool try_read_front(T& value, std::endian endian = std::endian::native) const noexcept { return this->try_read(0, value, endian); }
 
     template <ArithmeticOrByte T> [[nodiscard]] T read(std::size_t offset, std::endian endian = std::endian::native) const
     {
@@ -392,24 +485,21 @@ namespace wlib::blob
 
     template <ArithmeticOrByte T> bool try_overwrite(std::size_t offset, T const& value, std::endian endian = std::endian::native) noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_overwrite(offset, { reinterpret_cast<std::byte const*>(&value), sizeof(T) });
-      else
-        return this->try_overwrite_reverse(offset, { reinterpret_cast<std::byte const*>(&value), sizeof(T) });
+      if (!this->range_check_read(offset, sizeof(T)))
+        return false;
+
+      internal::value_copy<sizeof(T)>(&this->m_data[offset], reinterpret_cast<std::byte const*>(&value), endian != std::endian::native);
+      return true;
     }
     template <ArithmeticOrByte T> bool try_overwrite_back(T const& value, std::endian endian = std::endian::native) noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_overwrite_back({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
-      else
-        return this->try_overwrite_back_reverse({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
+      if (this->m_pos_idx < sizeof(T))
+        return false;
+      return this->try_overwrite(this->m_pos_idx - sizeof(T), value, endian);
     }
     template <ArithmeticOrByte T> bool try_overwrite_front(T const& value, std::endian endian = std::endian::native) noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_overwrite_front({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
-      else
-        return this->try_overwrite_front_reverse({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
+      return this->try_overwrite(0, value, endian);
     }
 
     template <ArithmeticOrByte T> void overwrite(std::size_t offset, T const& value, std::endian endian = std::endian::native)
@@ -469,24 +559,21 @@ namespace wlib::blob
 
     template <ArithmeticOrByte T> bool try_insert(std::size_t offset, T const& value, std::endian endian = std::endian::native) noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_insert(offset, { reinterpret_cast<std::byte const*>(&value), sizeof(T) });
-      else
-        return this->try_insert_reverse(offset, { reinterpret_cast<std::byte const*>(&value), sizeof(T) });
+      if (!this->range_check_insert(offset, sizeof(T)))
+        return false;
+
+      internal::data_shift_right(this->get_span(), offset, sizeof(T));
+      internal::value_copy<sizeof(T)>(&this->m_data[offset], reinterpret_cast<std::byte const*>(&value), endian != std::endian::native);
+      this->m_pos_idx += sizeof(T);
+      return true;
     }
     template <ArithmeticOrByte T> bool try_insert_back(T const& value, std::endian endian = std::endian::native) noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_insert_back({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
-      else
-        return this->try_insert_back_reverse({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
+      return this->try_insert(this->m_pos_idx, value, endian);
     }
     template <ArithmeticOrByte T> bool try_insert_front(T const& value, std::endian endian = std::endian::native) noexcept
     {
-      if (endian == std::endian::native)
-        return this->try_insert_front({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
-      else
-        return this->try_insert_front_reverse({ reinterpret_cast<std::byte const*>(&value), sizeof(T) });
+      return this->try_insert(0, value, endian);
     }
 
 
@@ -651,6 +738,103 @@ namespace wlib::blob
     std::size_t          m_pos_idx = 0;
   };
 
+  /*
+   * Append only writer for serializing a record into a MemoryBlob.
+   *
+   * The room for the record is reserved and range checked once on
+   * construction. The appends only compare against the remaining reserved
+   * bytes and never shift data. The written bytes become part of the blob
+   * with commit() or when the writer is destroyed. The blob must not be
+   * modified while a writer is active on it.
+   */
+  class AppendWriter
+  {
+  public:
+    // reserves all free bytes of the blob
+    explicit AppendWriter(MemoryBlob& blob) noexcept
+        : m_blob(blob)
+        , m_reserved(blob.m_data.subspan(blob.m_pos_idx))
+    {
+    }
+
+    AppendWriter(MemoryBlob& blob, std::size_t number_of_bytes)
+        : m_blob(blob)
+    {
+      if (blob.get_number_of_free_bytes() < number_of_bytes)
+        internal::handle_insert_exception();
+      else
+        this->m_reserved = blob.m_data.subspan(blob.m_pos_idx, number_of_bytes);
+    }
+
+    AppendWriter(AppendWriter const&)            = delete;
+    AppendWriter(AppendWriter&&)                 = delete;
+    AppendWriter& operator=(AppendWriter const&) = delete;
+    AppendWriter& operator=(AppendWriter&&)      = delete;
+    ~AppendWriter() noexcept { this->commit(); }
+
+    [[nodiscard]] std::size_t get_number_of_free_bytes() const noexcept { return this->m_reserved.size() - this->m_idx; }
+    [[nodiscard]] std::size_t get_number_of_written_bytes() const noexcept { return this->m_idx; }
+
+    bool try_append(std::span<std::byte const> data) noexcept
+    {
+      if (this->get_number_of_free_bytes() < data.size())
+        return false;
+      this->m_idx += internal::byte_copy(this->m_reserved.subspan(this->m_idx, data.size()), data.data());
+      return true;
+    }
+    bool try_append_reverse(std::span<std::byte const> data) noexcept
+    {
+      if (this->get_number_of_free_bytes() < data.size())
+        return false;
+      this->m_idx += internal::byte_copy_reverse(this->m_reserved.subspan(this->m_idx, data.size()), data.data());
+      return true;
+    }
+    bool try_append(std::byte data, std::size_t count) noexcept
+    {
+      if (this->get_number_of_free_bytes() < count)
+        return false;
+      this->m_idx += internal::byte_fill(this->m_reserved.subspan(this->m_idx, count), data);
+      return true;
+    }
+    template <ArithmeticOrByte T> bool try_append(T const& value, std::endian endian = std::endian::native) noexcept
+    {
+      if (this->get_number_of_free_bytes() < sizeof(T))
+        return false;
+      internal::value_copy<sizeof(T)>(&this->m_reserved[this->m_idx], reinterpret_cast<std::byte const*>(&value), endian != std::endian::native);
+      this->m_idx += sizeof(T);
+      return true;
+    }
+
+    void append(std::span<std::byte const> data)
+    {
+      if (!this->try_append(data))
+        internal::handle_insert_exception();
+    }
+    void append(std::byte data, std::size_t count)
+    {
+      if (!this->try_append(data, count))
+        internal::handle_insert_exception();
+    }
+    template <ArithmeticOrByte T> void append(T const& value, std::endian endian = std::endian::native)
+    {
+      if (!this->try_append(value, endian))
+        internal::handle_insert_exception();
+    }
+
+    // makes the bytes written so far part of the blob, the remaining reservation stays usable
+    void commit() noexcept
+    {
+      this->m_blob.m_pos_idx += this->m_idx;
+      this->m_reserved = this->m_reserved.subspan(this->m_idx);
+      this->m_idx      = 0;
+    }
+
+  private:
+    MemoryBlob&          m_blob;
+    std::span<std::byte> m_reserved = {};
+    std::size_t          m_idx      = 0;
+  };
+
   template <std::size_t N> class StaticBlob final: public MemoryBlob
   {
   public:
@@ -662,15 +846,16 @@ namespace wlib::blob
     StaticBlob(StaticBlob const& other)
         : StaticBlob()
     {
-      for (std::byte val : other.get_span())
-        this->insert_back(val);
+      this->insert_back(other.get_span());
     }
 
     StaticBlob& operator=(StaticBlob const& other)
     {
-      this->clear();
-      for (std::byte val : other.get_span())
-        this->insert_back(val);
+      if (this != &other)
+      {
+        this->clear();
+        this->insert_back(other.get_span());
+      }
       return *this;
     }
 
@@ -691,6 +876,21 @@ namespace wlib::blob
   }
   template <typename T, std::size_t N> MemoryBlob& operator<<(MemoryBlob& blob, std::array<T, N> const& obj_arr) { return blob << std::span<T const>(obj_arr); }
 
+  template <ArithmeticOrByte T> AppendWriter& operator<<(AppendWriter& writer, T const& obj)
+  {
+    writer.append(obj);
+    return writer;
+  }
+  template <ArithmeticOrByte T> AppendWriter& operator<<(AppendWriter& writer, std::span<T const> obj_span)
+  {
+    writer.append(std::as_bytes(obj_span));
+    return writer;
+  }
+  template <ArithmeticOrByte T, std::size_t N> AppendWriter& operator<<(AppendWriter& writer, std::array<T, N> const& obj_arr)
+  {
+    return writer << std::span<T const>(obj_arr);
+  }
+
   template <ArithmeticOrByte T> MemoryBlob& operator>>(MemoryBlob& blob, T& obj)
   {
     obj = blob.extract_front<T>();
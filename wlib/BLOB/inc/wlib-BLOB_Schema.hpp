@@ -0,0 +1,273 @@
+#pragma once
+#ifndef WLIB_BLOB_SCHEMA_HPP_INCLUDED
+#define WLIB_BLOB_SCHEMA_HPP_INCLUDED
+
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <wlib-BLOB.hpp>
+
+namespace wlib::blob
+{
+  namespace internal
+  {
+    template <typename T> struct member_pointer_traits;
+    template <typename C, typename M> struct member_pointer_traits<M C::*>
+    {
+      using class_type  = C;
+      using member_type = M;
+    };
+
+    // a packed field: arithmetic, std::byte, enum or a std::array of those
+    template <typename T> struct field_traits;
+
+    template <typename T>
+      requires(ArithmeticOrByte<T> || std::is_enum_v<T>)
+    struct field_traits<T>
+    {
+      static constexpr std::size_t size = sizeof(T);
+
+      template <bool Reverse> static void store(std::byte* trg, T const& value) noexcept
+      {
+        value_copy<size>(trg, reinterpret_cast<std::byte const*>(&value), Reverse);
+      }
+      template <bool Reverse> static void load(std::byte const* src, T& value) noexcept
+      {
+        value_copy<size>(reinterpret_cast<std::byte*>(&value), src, Reverse);
+      }
+    };
+
+    template <typename T, std::size_t N> struct field_traits<std::array<T, N>>
+    {
+      using element_traits = field_traits<T>;
+
+      static constexpr std::size_t size = element_traits::size * N;
+
+      template <bool Reverse> static void store(std::byte* trg, std::array<T, N> const& value) noexcept
+      {
+        for (std::size_t i = 0; i < N; i++)
+          element_traits::template store<Reverse>(trg + i * element_traits::size, value[i]);
+      }
+      template <bool Reverse> static void load(std::byte const* src, std::array<T, N>& value) noexcept
+      {
+        for (std::size_t i = 0; i < N; i++)
+          element_traits::template load<Reverse>(src + i * element_traits::size, value[i]);
+      }
+    };
+
+    template <auto Member> using member_type_t = typename member_pointer_traits<decltype(Member)>::member_type;
+    template <auto Member> using class_type_t  = typename member_pointer_traits<decltype(Member)>::class_type;
+
+    template <auto First, auto... Rest> struct first_member
+    {
+      static constexpr auto value = First;
+    };
+
+    template <auto Lhs, auto Rhs> constexpr bool is_same_member() noexcept
+    {
+      if constexpr (std::is_same_v<decltype(Lhs), decltype(Rhs)>)
+        return Lhs == Rhs;
+      else
+        return false;
+    }
+  }    // namespace internal
+
+  /*
+   * Serializer for a fixed list of data members, packed without padding in
+   * the order of the list, every field in the byte order Endian.
+   *
+   * Size and offsets are calculated at compile time, a record is range
+   * checked once and the fields are stored with fixed offsets and fixed
+   * byte order (no per field checks and no endian branch at runtime).
+   *
+   *   using settings_schema = wlib::blob::schema<&settings_t::gain, &settings_t::offset>;
+   *
+   * view / mutable_view access single fields of an encoded record in place.
+   */
+  template <std::endian Endian, auto... Members>
+    requires(sizeof...(Members) > 0 && (std::is_member_object_pointer_v<decltype(Members)> && ...))
+  class basic_schema
+  {
+    using first_class_t = internal::class_type_t<internal::first_member<Members...>::value>;
+    static_assert((std::is_same_v<internal::class_type_t<Members>, first_class_t> && ...), "all members have to belong to the same class");
+
+    static constexpr bool reverse = (Endian != std::endian::native);
+
+  public:
+    using value_type = first_class_t;
+
+    static constexpr std::endian endian           = Endian;
+    static constexpr std::size_t number_of_fields = sizeof...(Members);
+    static constexpr std::size_t size             = (internal::field_traits<internal::member_type_t<Members>>::size + ...);
+    static constexpr std::array<std::size_t, number_of_fields> field_sizes = { internal::field_traits<internal::member_type_t<Members>>::size... };
+    static constexpr std::array<std::size_t, number_of_fields> offsets     = []() {
+      std::array<std::size_t, number_of_fields> ret{};
+      for (std::size_t i = 1; i < number_of_fields; i++)
+        ret[i] = ret[i - 1] + field_sizes[i - 1];
+      return ret;
+    }();
+
+    template <auto Member> static constexpr std::size_t index_of = []() {
+      std::size_t ret = number_of_fields;
+      std::size_t idx = 0;
+      ((internal::is_same_member<Member, Members>() ? (ret = idx, ++idx) : ++idx), ...);
+      return ret;
+    }();
+    template <auto Member>
+      requires(index_of<Member> < number_of_fields)
+    static constexpr std::size_t offset_of = offsets[index_of<Member>];
+
+    // unchecked, the size is part of the type
+    static void encode(value_type const& value, std::span<std::byte, size> trg) noexcept
+    {
+      encode_fields(value, trg.data(), std::make_index_sequence<number_of_fields>{});
+    }
+    static void decode(std::span<std::byte const, size> src, value_type& value) noexcept
+    {
+      decode_fields(src.data(), value, std::make_index_sequence<number_of_fields>{});
+    }
+
+    static bool try_encode(value_type const& value, std::span<std::byte> trg) noexcept
+    {
+      if (trg.size() < size)
+        return false;
+      encode(value, trg.template first<size>());
+      return true;
+    }
+    static bool try_decode(std::span<std::byte const> src, value_type& value) noexcept
+    {
+      if (src.size() < size)
+        return false;
+      decode(src.template first<size>(), value);
+      return true;
+    }
+
+    static bool try_insert_back(MemoryBlob& blob, value_type const& value) noexcept
+    {
+      return try_encode(value, blob.get_free_span()) && blob.try_adjust_position(size);
+    }
+    static bool try_extract_front(ConstMemoryBlob& blob, value_type& value) noexcept
+    {
+      return try_decode(blob.get_span(), value) && blob.try_remove_front(size);
+    }
+    static bool try_extract_front(MemoryBlob& blob, value_type& value) noexcept
+    {
+      return try_decode(blob.get_span(), value) && blob.try_remove_front(size);
+    }
+
+    static void insert_back(MemoryBlob& blob, value_type const& value)
+    {
+      if (!try_insert_back(blob, value))
+        internal::handle_insert_exception();
+    }
+    template <typename blob_t> static void extract_front(blob_t& blob, value_type& value)
+    {
+      if (!try_extract_front(blob, value))
+        internal::handle_read_exception();
+    }
+
+    /*
+     * access to the fields of an encoded record without decoding the whole record
+     */
+    template <typename byte_t>
+      requires(std::is_same_v<std::remove_const_t<byte_t>, std::byte>)
+    class basic_view
+    {
+    public:
+      explicit basic_view(std::span<byte_t, size> data) noexcept
+          : m_data(data)
+      {
+      }
+
+      template <auto Member>
+        requires(index_of<Member> < number_of_fields)
+      [[nodiscard]] internal::member_type_t<Member> get() const noexcept
+      {
+        internal::member_type_t<Member> ret;
+        internal::field_traits<internal::member_type_t<Member>>::template load<reverse>(this->m_data.data() + offset_of<Member>, ret);
+        return ret;
+      }
+
+      template <auto Member>
+        requires(index_of<Member> < number_of_fields && !std::is_const_v<byte_t>)
+      void set(internal::member_type_t<Member> const& value) noexcept
+      {
+        internal::field_traits<internal::member_type_t<Member>>::template store<reverse>(this->m_data.data() + offset_of<Member>, value);
+      }
+
+      [[nodiscard]] value_type get() const noexcept
+      {
+        value_type ret{};
+        decode(this->m_data, ret);
+        return ret;
+      }
+
+      [[nodiscard]] std::span<byte_t, size> get_span() const noexcept { return this->m_data; }
+
+    private:
+      std::span<byte_t, size> m_data;
+    };
+
+    using view         = basic_view<std::byte const>;
+    using mutable_view = basic_view<std::byte>;
+
+    static std::optional<view> try_view(std::span<std::byte const> data) noexcept
+    {
+      if (data.size() < size)
+        return std::nullopt;
+      return view{ data.template first<size>() };
+    }
+    static std::optional<mutable_view> try_view(std::span<std::byte> data) noexcept
+    {
+      if (data.size() < size)
+        return std::nullopt;
+      return mutable_view{ data.template first<size>() };
+    }
+
+  private:
+    template <std::size_t... I> static void encode_fields(value_type const& value, std::byte* trg, std::index_sequence<I...>) noexcept
+    {
+      (internal::field_traits<internal::member_type_t<Members>>::template store<reverse>(trg + offsets[I], value.*Members), ...);
+    }
+    template <std::size_t... I> static void decode_fields(std::byte const* src, value_type& value, std::index_sequence<I...>) noexcept
+    {
+      (internal::field_traits<internal::member_type_t<Members>>::template load<reverse>(src + offsets[I], value.*Members), ...);
+    }
+  };
+
+  template <auto... Members> using schema = basic_schema<std::endian::little, Members...>;
+
+  /*
+   * specialize schema_of<T> with a member type alias "type" to serialize T by
+   * its schema with the stream operators, e.g. in wlib::storage::strategy::mirrow_storage_t
+   */
+  template <typename T> struct schema_of
+  {
+  };
+
+  template <typename T>
+  concept HasSchema = requires { typename schema_of<T>::type; } && std::is_same_v<typename schema_of<T>::type::value_type, T>;
+
+  template <HasSchema T> MemoryBlob& operator<<(MemoryBlob& blob, T const& obj)
+  {
+    schema_of<T>::type::insert_back(blob, obj);
+    return blob;
+  }
+  template <HasSchema T> MemoryBlob& operator>>(MemoryBlob& blob, T& obj)
+  {
+    schema_of<T>::type::extract_front(blob, obj);
+    return blob;
+  }
+  template <HasSchema T> ConstMemoryBlob& operator>>(ConstMemoryBlob& blob, T& obj)
+  {
+    schema_of<T>::type::extract_front(blob, obj);
+    return blob;
+  }
+}    // namespace wlib::blob
+
+#endif
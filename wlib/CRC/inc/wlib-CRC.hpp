@@ -3,6 +3,7 @@
 #define WLIB_CRC_HPP_INCLUDED
 
 #include <wlib-CRC_Interface.hpp>
+#include <wlib-CRC_Generic.hpp>
 #include <wlib-CRC_8.hpp>
 #include <wlib-CRC_16_ccitt.hpp>
 #include <wlib-CRC_32.hpp>
@@ -2,29 +2,23 @@
 #ifndef WLIB_CRC_32_HPP_INCLUDED
 #define WLIB_CRC_32_HPP_INCLUDED
 
-#include <wlib-CRC_Interface.hpp>
+#include <wlib-CRC_Generic.hpp>
 #include <cstddef>
 #include <cstdint>
 
 namespace wlib::crc
 {
-  class CRC_32 final: public CRC_Interface<uint32_t>
-  {
-  public:
-    using base_t = CRC_Interface<uint32_t>;
-
-    virtual used_type get_inital_value() const noexcept override { return CRC_32::init_value ^ CRC_32::output_msk; }
-    virtual void      reset() noexcept override { this->m_crc = CRC_32::init_value; }
-    virtual used_type get() const noexcept override { return this->m_crc ^ CRC_32::output_msk; }
+  // CRC-32/ISO-HDLC
+  using CRC_32 = crc_t<32, 0x04C1'1DB7, 0xFFFF'FFFF, true, true, 0xFFFF'FFFF>;
 
-    using base_t::operator();
+  // carry-less multiplication folding, falls back to slicing by 16 if the CPU does not support PCLMULQDQ
+  CRC_32::used_type crc_32_engine_pclmul(CRC_32::used_type crc, std::byte const* data, std::size_t len) noexcept;
+  bool              is_crc_32_pclmul_supported() noexcept;
 
-    virtual used_type operator()(std::byte const* beg, std::byte const* end) noexcept override;
-
-  private:
-    static constexpr used_type output_msk = 0xFFFF'FFFF;
-    static constexpr used_type init_value = 0xFFFF'FFFF;
-    used_type                  m_crc      = init_value;
+  // PCLMULQDQ if supported, slicing by 8 otherwise
+  template <> struct default_engine<CRC_32>
+  {
+    static CRC_32::engine_t get() noexcept;
   };
 }    // namespace wlib::crc
 #endif
@@ -0,0 +1,202 @@
+#pragma once
+#ifndef WLIB_CRC_GENERIC_HPP_INCLUDED
+#define WLIB_CRC_GENERIC_HPP_INCLUDED
+
+#include <wlib-CRC_Interface.hpp>
+#include <wlib-CRC_Slicing.hpp>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <type_traits>
+
+namespace wlib::crc
+{
+  namespace internal
+  {
+    template <std::size_t Width> struct uint_for
+    {
+      using type = std::conditional_t<(Width <= 8), uint8_t, std::conditional_t<(Width <= 16), uint16_t, std::conditional_t<(Width <= 32), uint32_t, uint64_t>>>;
+    };
+  }    // namespace internal
+
+  template <std::size_t Width> using uint_for_t = typename internal::uint_for<Width>::type;
+
+  template <typename crc_type> struct default_engine;
+
+  /*
+   * CRC described by the Rocksoft parameter model (Width, Poly, Init, RefIn,
+   * RefOut, XorOut), as used by the CRC catalogue. Poly and Init are given
+   * in normal (not reflected) notation. Width has to be a multiple of 8.
+   *
+   * The tables are generated at compile time and everything is constexpr,
+   * so e.g. the CRC of a constant string can be calculated by the compiler.
+   * At runtime the data is processed by a selectable engine (slicing by 8
+   * by default, see default_engine<>).
+   */
+  template <std::size_t Width, uint_for_t<Width> Poly, uint_for_t<Width> Init, bool RefIn, bool RefOut, uint_for_t<Width> XorOut>
+    requires(Width >= 8 && Width <= 64 && Width % 8 == 0)
+  class crc_t final: public CRC_Interface<uint_for_t<Width>>
+  {
+  public:
+    using base_t    = CRC_Interface<uint_for_t<Width>>;
+    using used_type = typename base_t::used_type;
+
+    static constexpr std::size_t width   = Width;
+    static constexpr used_type   poly    = Poly;
+    static constexpr used_type   init    = Init;
+    static constexpr bool        ref_in  = RefIn;
+    static constexpr bool        ref_out = RefOut;
+    static constexpr used_type   xor_out = XorOut;
+
+    /*
+     * continues the raw crc register (reflected for RefIn, before RefOut and XorOut) over len bytes
+     */
+    using engine_t = used_type (*)(used_type crc, std::byte const* data, std::size_t len) noexcept;
+
+    static used_type engine_bytewise(used_type crc, std::byte const* data, std::size_t len) noexcept
+    {
+      return slicing::update_bytewise<used_type, Width, RefIn>(crc, data, len, byte_table());
+    }
+    static used_type engine_slicing_by_4(used_type crc, std::byte const* data, std::size_t len) noexcept { return update_slicing<4>(crc, data, len); }
+    static used_type engine_slicing_by_8(used_type crc, std::byte const* data, std::size_t len) noexcept { return update_slicing<8>(crc, data, len); }
+    static used_type engine_slicing_by_16(used_type crc, std::byte const* data, std::size_t len) noexcept { return update_slicing<16>(crc, data, len); }
+
+    // selects the engine used by all objects of this CRC, nullptr selects the default one
+    static void     set_engine(engine_t engine) noexcept { s_engine.store(engine, std::memory_order_relaxed); }
+    static engine_t get_default_engine() noexcept { return default_engine<crc_t>::get(); }
+    static engine_t get_engine() noexcept
+    {
+      engine_t const ret = s_engine.load(std::memory_order_relaxed);
+      return (ret != nullptr) ? ret : get_default_engine();
+    }
+
+    constexpr crc_t() noexcept = default;
+
+    virtual constexpr used_type get_inital_value() const noexcept override { return finalize(init_state); }
+    virtual constexpr void      reset() noexcept override { this->m_crc = init_state; }
+    virtual constexpr used_type get() const noexcept override { return finalize(this->m_crc); }
+
+    using base_t::operator();
+
+    virtual constexpr used_type operator()(std::byte const* beg, std::byte const* end) noexcept override
+    {
+      if (beg < end)
+      {
+        this->m_crc = update(this->m_crc, beg, static_cast<std::size_t>(end - beg));
+      }
+      return this->get();
+    }
+
+    static constexpr used_type calculate(std::span<std::byte const> data) noexcept { return finalize(update(init_state, data.data(), data.size())); }
+
+    static constexpr used_type calculate(std::string_view str) noexcept
+    {
+      used_type crc = init_state;
+      for (char const c : str)
+      {
+        std::byte const b = static_cast<std::byte>(c);
+        crc               = slicing::update_bytewise<used_type, Width, RefIn>(crc, &b, 1, byte_table());
+      }
+      return finalize(crc);
+    }
+
+    /*
+     * crc of the concatenation A|B from crc_a = crc(A), crc_b = crc(B) and len_b = size of B
+     * e.g. to merge the crcs of chunks which were processed in parallel
+     */
+    static constexpr used_type combine(used_type crc_a, used_type crc_b, std::size_t len_b) noexcept
+    {
+      // crc registers are linear: R(A|B) = (R(A) ^ R_init) * x^(8 * len_b) ^ R(B)
+      used_type const reg_a = unfinalize(crc_a);
+      used_type const reg_b = unfinalize(crc_b);
+      return finalize(static_cast<used_type>(shift_by_zero_bytes(static_cast<used_type>(reg_a ^ init_state), len_b) ^ reg_b));
+    }
+
+  private:
+    static constexpr used_type mask       = slicing::mask_v<used_type, Width>;
+    static constexpr used_type init_state = RefIn ? slicing::reflect<used_type>(Init, Width) : Init;
+
+    static constexpr auto const& byte_table() noexcept { return slicing::tables_t<used_type, Width, Poly, RefIn, 1>::table[0]; }
+
+    template <std::size_t Slices> static used_type update_slicing(used_type crc, std::byte const* data, std::size_t len) noexcept
+    {
+      return slicing::update<used_type, Width, Poly, RefIn, Slices>(crc, data, len);
+    }
+
+    static constexpr used_type update(used_type crc, std::byte const* data, std::size_t len) noexcept
+    {
+      if (std::is_constant_evaluated())
+        return slicing::update_bytewise<used_type, Width, RefIn>(crc, data, len, byte_table());
+      return get_engine()(crc, data, len);
+    }
+
+    static constexpr used_type finalize(used_type reg) noexcept
+    {
+      if constexpr (RefIn != RefOut)
+        reg = slicing::reflect<used_type>(reg, Width);
+      return static_cast<used_type>((reg ^ XorOut) & mask);
+    }
+
+    static constexpr used_type unfinalize(used_type value) noexcept
+    {
+      value = static_cast<used_type>((value ^ XorOut) & mask);
+      if constexpr (RefIn != RefOut)
+        value = slicing::reflect<used_type>(value, Width);
+      return value;
+    }
+
+    // a * b mod Poly, both in normal notation
+    static constexpr used_type multiply_mod(used_type a, used_type b) noexcept
+    {
+      used_type ret = 0;
+      for (std::size_t i = Width; i-- > 0;)
+      {
+        bool const carry = ((ret >> (Width - 1)) & 1) != 0;
+        ret              = static_cast<used_type>((ret << 1) & mask);
+        if (carry)
+          ret = static_cast<used_type>(ret ^ Poly);
+        if ((b >> i) & 1)
+          ret = static_cast<used_type>(ret ^ a);
+      }
+      return ret;
+    }
+
+    // the register after feeding len zero bytes: reg * x^(8 * len) mod Poly
+    static constexpr used_type shift_by_zero_bytes(used_type reg, std::size_t len) noexcept
+    {
+      if constexpr (RefIn)
+        reg = slicing::reflect<used_type>(reg, Width);
+
+      // x^8 mod Poly
+      used_type x_pow = 1;
+      for (std::size_t i = 0; i < 8; i++)
+      {
+        x_pow = multiply_mod(x_pow, 2);
+      }
+
+      for (; len != 0; len >>= 1)
+      {
+        if (len & 1)
+          reg = multiply_mod(reg, x_pow);
+        x_pow = multiply_mod(x_pow, x_pow);
+      }
+
+      if constexpr (RefIn)
+        reg = slicing::reflect<used_type>(reg, Width);
+      return reg;
+    }
+
+    static inline std::atomic<engine_t> s_engine = nullptr;
+
+    used_type m_crc = init_state;
+  };
+
+  template <typename crc_type> struct default_engine
+  {
+    static typename crc_type::engine_t get() noexcept { return &crc_type::engine_slicing_by_8; }
+  };
+}    // namespace wlib::crc
+
+#endif
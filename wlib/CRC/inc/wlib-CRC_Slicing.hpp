@@ -0,0 +1,135 @@
+#pragma once
+#ifndef WLIB_CRC_SLICING_HPP_INCLUDED
+#define WLIB_CRC_SLICING_HPP_INCLUDED
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+
+namespace wlib::crc::slicing
+{
+  /*
+   * Table driven CRC which consumes Slices bytes per step (slicing-by-N).
+   *
+   * table[0] is the classic byte wise table, table[k] advances the
+   * contribution of a byte by k further bytes of zeros. One step xors
+   * Slices table lookups, which are independent of each other, so the
+   * loop is not limited by the latency of the previous lookup.
+   *
+   * The state is the raw CRC register: reflected for RefIn, without the
+   * final xor. Poly is given in normal (not reflected) notation.
+   */
+  template <std::unsigned_integral T, std::size_t Width> inline constexpr T mask_v = (Width >= sizeof(T) * 8) ? static_cast<T>(~T{ 0 }) : static_cast<T>((T{ 1 } << Width) - 1);
+
+  template <std::unsigned_integral T> constexpr T reflect(T value, std::size_t const& width) noexcept
+  {
+    T ret = 0;
+    for (std::size_t i = 0; i < width; i++)
+    {
+      ret   = static_cast<T>((ret << 1) | (value & 1));
+      value = static_cast<T>(value >> 1);
+    }
+    return ret;
+  }
+
+  template <std::unsigned_integral T, std::size_t Width, T Poly, bool RefIn, std::size_t Slices>
+    requires(Width >= 8 && Width <= sizeof(T) * 8 && Slices > 0)
+  struct tables_t
+  {
+    using table_t = std::array<T, 256>;
+
+    static constexpr T mask = mask_v<T, Width>;
+
+    static constexpr table_t make_byte_table() noexcept
+    {
+      table_t ret{};
+      for (std::size_t n = 0; n < 256; n++)
+      {
+        if constexpr (RefIn)
+        {
+          T const poly_ref = reflect<T>(Poly, Width);
+          T       crc      = static_cast<T>(n);
+          for (std::size_t bit = 0; bit < 8; bit++)
+            crc = static_cast<T>((crc & 1) ? (crc >> 1) ^ poly_ref : (crc >> 1));
+          ret[n] = crc;
+        }
+        else
+        {
+          T crc = static_cast<T>(static_cast<T>(n) << (Width - 8));
+          for (std::size_t bit = 0; bit < 8; bit++)
+            crc = static_cast<T>(((crc >> (Width - 1)) & 1) ? (crc << 1) ^ Poly : (crc << 1));
+          ret[n] = static_cast<T>(crc & mask);
+        }
+      }
+      return ret;
+    }
+
+    static constexpr std::array<table_t, Slices> make() noexcept
+    {
+      std::array<table_t, Slices> ret{};
+      ret[0] = make_byte_table();
+      for (std::size_t k = 1; k < Slices; k++)
+      {
+        for (std::size_t n = 0; n < 256; n++)
+        {
+          T const prev = ret[k - 1][n];
+          if constexpr (RefIn)
+          {
+            ret[k][n] = static_cast<T>((Width > 8 ? (prev >> 8) : T{ 0 }) ^ ret[0][prev & 0xFF]);
+          }
+          else
+          {
+            ret[k][n] = static_cast<T>(((Width > 8 ? (prev << 8) : T{ 0 }) ^ ret[0][(prev >> (Width - 8)) & 0xFF]) & mask);
+          }
+        }
+      }
+      return ret;
+    }
+
+    static constexpr std::array<table_t, Slices> table = make();
+  };
+
+  template <std::unsigned_integral T, std::size_t Width, bool RefIn>
+  constexpr T update_bytewise(T crc, std::byte const* data, std::size_t len, std::array<T, 256> const& tbl) noexcept
+  {
+    for (std::size_t i = 0; i < len; i++)
+    {
+      std::uint8_t const b = static_cast<std::uint8_t>(data[i]);
+      if constexpr (RefIn)
+        crc = static_cast<T>((Width > 8 ? (crc >> 8) : T{ 0 }) ^ tbl[(crc ^ b) & 0xFF]);
+      else
+        crc = static_cast<T>(((Width > 8 ? (crc << 8) : T{ 0 }) ^ tbl[((crc >> (Width - 8)) ^ b) & 0xFF]) & mask_v<T, Width>);
+    }
+    return crc;
+  }
+
+  template <std::unsigned_integral T, std::size_t Width, T Poly, bool RefIn, std::size_t Slices>
+    requires(Width % 8 == 0 && Slices >= Width / 8)
+  constexpr T update(T crc, std::byte const* data, std::size_t len) noexcept
+  {
+    constexpr std::size_t width_bytes = Width / 8;
+    auto const&           tbl         = tables_t<T, Width, Poly, RefIn, Slices>::table;
+
+    for (; len >= Slices; len -= Slices, data += Slices)
+    {
+      // the first width_bytes bytes are combined with the register, the others are looked up directly
+      T next = 0;
+      for (std::size_t i = 0; i < width_bytes; i++)
+      {
+        std::size_t const shift = RefIn ? 8 * i : Width - 8 - 8 * i;
+        std::uint8_t const b     = static_cast<std::uint8_t>(static_cast<std::uint8_t>(crc >> shift) ^ static_cast<std::uint8_t>(data[i]));
+        next                     = static_cast<T>(next ^ tbl[Slices - 1 - i][b]);
+      }
+      for (std::size_t i = width_bytes; i < Slices; i++)
+      {
+        next = static_cast<T>(next ^ tbl[Slices - 1 - i][static_cast<std::uint8_t>(data[i])]);
+      }
+      crc = next;
+    }
+
+    return update_bytewise<T, Width, RefIn>(crc, data, len, tbl[0]);
+  }
+}    // namespace wlib::crc::slicing
+
+#endif
@@ -1 +1,42 @@
 #include <wlib-CRC.hpp>
+
+namespace wlib::crc
+{
+  namespace
+  {
+    // check values of the CRC catalogue: crc of "123456789"
+    constexpr std::string_view check_str = "123456789";
+
+    static_assert(CRC_8::calculate(check_str) == 0xF4);
+    static_assert(CRC_16_ccitt_false::calculate(check_str) == 0x29B1);
+    static_assert(CRC_16_ccitt_zero::calculate(check_str) == 0x31C3);
+    static_assert(CRC_32::calculate(check_str) == 0xCBF4'3926);
+    static_assert(CRC_64_go_iso::calculate(check_str) == 0xB909'56C7'75A4'1001);
+
+    // CRC-8/MAXIM-DOW, CRC-16/ARC, CRC-16/KERMIT, CRC-16/MODBUS
+    static_assert(crc_t<8, 0x31, 0x00, true, true, 0x00>::calculate(check_str) == 0xA1);
+    static_assert(crc_t<16, 0x8005, 0x0000, true, true, 0x0000>::calculate(check_str) == 0xBB3D);
+    static_assert(crc_t<16, 0x1021, 0x0000, true, true, 0x0000>::calculate(check_str) == 0x2189);
+    static_assert(crc_t<16, 0x8005, 0xFFFF, true, true, 0x0000>::calculate(check_str) == 0x4B37);
+    // CRC-24/OPENPGP
+    static_assert(crc_t<24, 0x86'4CFB, 0xB7'04CE, false, false, 0x00'0000>::calculate(check_str) == 0x21'CF02);
+    // CRC-32/BZIP2, CRC-32/MPEG-2, CRC-32/ISCSI
+    static_assert(crc_t<32, 0x04C1'1DB7, 0xFFFF'FFFF, false, false, 0xFFFF'FFFF>::calculate(check_str) == 0xFC89'1918);
+    static_assert(crc_t<32, 0x04C1'1DB7, 0xFFFF'FFFF, false, false, 0x0000'0000>::calculate(check_str) == 0x0376'E6E7);
+    static_assert(crc_t<32, 0x1EDC'6F41, 0xFFFF'FFFF, true, true, 0xFFFF'FFFF>::calculate(check_str) == 0xE306'9283);
+    // CRC-64/ECMA-182, CRC-64/XZ
+    static_assert(crc_t<64, 0x42F0'E1EB'A9EA'3693, 0, false, false, 0>::calculate(check_str) == 0x6C40'DF5F'0B49'7347);
+    static_assert(crc_t<64, 0x42F0'E1EB'A9EA'3693, ~uint64_t{ 0 }, true, true, ~uint64_t{ 0 }>::calculate(check_str) == 0x995D'C9BB'DF19'39FA);
+
+    // combine() of "1234" and "56789"
+    template <typename crc_type> constexpr bool check_combine() noexcept
+    {
+      return crc_type::combine(crc_type::calculate(check_str.substr(0, 4)), crc_type::calculate(check_str.substr(4)), 5) == crc_type::calculate(check_str);
+    }
+    static_assert(check_combine<CRC_8>());
+    static_assert(check_combine<CRC_16_ccitt_false>());
+    static_assert(check_combine<CRC_32>());
+    static_assert(check_combine<CRC_64_go_iso>());
+    static_assert(check_combine<crc_t<24, 0x86'4CFB, 0xB7'04CE, false, false, 0x00'0000>>());
+  }    // namespace
+}    // namespace wlib::crc
@@ -3,7 +3,9 @@
 #define WLIB_HASH_HPP_INCLUDED
 
 #include <array>
+#include <atomic>
 #include <bit>
+#include <cstddef>
 #include <cstdint>
 #include <span>
 
@@ -27,6 +29,7 @@ namespace wlib::hash
       internal_state_t&              operator+=(internal_state_t const& rhs) noexcept;
       [[nodiscard]] internal_state_t operator+(internal_state_t const& rhs) const noexcept;
       [[nodiscard]] hash_t           to_hash() const noexcept;
+      [[nodiscard]] uint32_t*        data() noexcept { return this->m_value.data(); }
 
     private:
       std::array<uint32_t, 8> m_value{ 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
@@ -39,8 +42,27 @@ namespace wlib::hash
 
     [[nodiscard]] hash_t get() const noexcept;
 
+    /*
+     * hashes data[i] into hashes[i] for all i < min(data.size(), hashes.size())
+     * without SHA instructions, 4 messages are compressed in lockstep
+     */
+    static void calculate(std::span<std::span<std::byte const> const> data, std::span<hash_t> hashes) noexcept;
+
+    // true if the x86 SHA extensions are used
+    [[nodiscard]] static bool is_sha_ni_supported() noexcept;
+
+    // false forces the portable code even if the SHA extensions are there, e.g. to compare both
+    static void set_sha_ni_enabled(bool enable) noexcept { s_sha_ni_enabled.store(enable, std::memory_order_relaxed); }
+
   private:
-    [[nodiscard]] static internal_state_t process_blk(internal_state_t state, chunk_t const& blk) noexcept;
+    static constexpr std::size_t lanes = 4;
+
+    // compresses number_of_blks consecutive 64 byte blocks into state
+    static void process_blks(internal_state_t& state, std::byte const* data, std::size_t number_of_blks) noexcept;
+    static void process_blks_portable(internal_state_t& state, std::byte const* data, std::size_t number_of_blks) noexcept;
+    static void process_blks_lockstep(internal_state_t (&state)[lanes], std::byte const* const (&data)[lanes], std::size_t number_of_blks) noexcept;
+
+    static inline std::atomic<bool> s_sha_ni_enabled = true;
 
     uint64_t         m_len = 0;
     uint32_t         m_idx = 0;
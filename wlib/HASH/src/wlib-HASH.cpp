@@ -1,7 +1,107 @@
 #include <wlib-HASH.hpp>
+#include <algorithm>
+#include <cstring>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#  define WLIB_HASH_HAS_SHA_NI 1
+#  include <cpuid.h>
+#  include <immintrin.h>
+#else
+#  define WLIB_HASH_HAS_SHA_NI 0
+#endif
 
 namespace wlib::hash
 {
+  namespace
+  {
+    constexpr uint32_t k[64] = { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
+                                 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
+                                 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+                                 0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                                 0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
+                                 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+                                 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
+
+    inline uint32_t load_be32(std::byte const* p) noexcept
+    {
+      return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) | (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+    }
+
+#if WLIB_HASH_HAS_SHA_NI
+    bool detect_sha_ni() noexcept
+    {
+      unsigned int eax = 0, ebx = 0, ecx = 0, edx = 0;
+      if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return false;
+      bool const has_sse41 = (ecx & bit_SSE4_1) != 0;
+      bool const has_ssse3 = (ecx & bit_SSSE3) != 0;
+      if (!__get_cpuid_count(7, 0, &eax, &ebx, &ecx, &edx))
+        return false;
+      return has_sse41 && has_ssse3 && (ebx & bit_SHA) != 0;
+    }
+
+    /*
+     * compression with the x86 SHA extensions, the state is kept as ABEF / CDGH
+     * as required by sha256rnds2
+     */
+    __attribute__((target("sha,sse4.1,ssse3"))) void process_blks_sha_ni(uint32_t* state, std::byte const* data, std::size_t number_of_blks) noexcept
+    {
+      __m128i const shuffle_msk = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+      __m128i tmp    = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[0])), 0xB1);    // CDAB
+      __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128(reinterpret_cast<__m128i const*>(&state[4])), 0x1B);    // EFGH
+      __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                                          // ABEF
+      state1         = _mm_blend_epi16(state1, tmp, 0xF0);                                                       // CDGH
+
+      for (; number_of_blks > 0; number_of_blks--, data += 64)
+      {
+        __m128i const abef_save = state0;
+        __m128i const cdgh_save = state1;
+        __m128i       msg[4];
+
+#  pragma GCC unroll 16
+        for (std::size_t g = 0; g < 16; g++)
+        {
+          __m128i& cur = msg[g % 4];
+          if (g < 4)
+            cur = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + 16 * g)), shuffle_msk);
+
+          __m128i rnd = _mm_add_epi32(cur, _mm_loadu_si128(reinterpret_cast<__m128i const*>(&k[4 * g])));
+          state1      = _mm_sha256rnds2_epu32(state1, state0, rnd);
+
+          // message schedule for the group after the next one
+          if (g >= 3 && g <= 14)
+          {
+            __m128i& next = msg[(g + 1) % 4];
+            next          = _mm_add_epi32(next, _mm_alignr_epi8(cur, msg[(g + 3) % 4], 4));
+            next          = _mm_sha256msg2_epu32(next, cur);
+          }
+
+          rnd    = _mm_shuffle_epi32(rnd, 0x0E);
+          state0 = _mm_sha256rnds2_epu32(state0, state1, rnd);
+
+          if (g >= 1 && g <= 12)
+          {
+            __m128i& prev = msg[(g + 3) % 4];
+            prev          = _mm_sha256msg1_epu32(prev, cur);
+          }
+        }
+
+        state0 = _mm_add_epi32(state0, abef_save);
+        state1 = _mm_add_epi32(state1, cdgh_save);
+      }
+
+      tmp    = _mm_shuffle_epi32(state0, 0x1B);    // FEBA
+      state1 = _mm_shuffle_epi32(state1, 0xB1);    // DCHG
+      state0 = _mm_blend_epi16(tmp, state1, 0xF0); // DCBA
+      state1 = _mm_alignr_epi8(state1, tmp, 8);    // HGFE
+
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[0]), state0);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(&state[4]), state1);
+    }
+#endif
+  }    // namespace
+
 
   uint32_t&       sha_256::internal_state_t::operator[](uint32_t idx) noexcept { return this->m_value[idx]; }
   
@@ -36,18 +136,51 @@ namespace wlib::hash
     return ret;
   }
 
+  bool sha_256::is_sha_ni_supported() noexcept
+  {
+#if WLIB_HASH_HAS_SHA_NI
+    static bool const supported = detect_sha_ni();
+    return supported && s_sha_ni_enabled.load(std::memory_order_relaxed);
+#else
+    return false;
+#endif
+  }
+
   sha_256& sha_256::operator()(std::span<std::byte const> const& data) noexcept
   {
-    for (std::byte const& cur : data)
+    // data() of an empty span may be nullptr, which memcpy must not get, even with length 0
+    if (data.empty())
+      return *this;
+
+    std::byte const* cur = data.data();
+    std::size_t      len = data.size();
+
+    this->m_len += static_cast<uint64_t>(len) * 8;
+
+    // complete a block started by a previous call
+    if (this->m_idx != 0)
     {
-      this->m_blk[this->m_idx++] = cur;
-      this->m_len += 8;
-      if (this->m_idx < 64)
-        continue;
+      std::size_t const cpy_len = std::min<std::size_t>(len, this->m_blk.size() - this->m_idx);
+      std::memcpy(this->m_blk.data() + this->m_idx, cur, cpy_len);
+      this->m_idx += static_cast<uint32_t>(cpy_len);
+      cur += cpy_len;
+      len -= cpy_len;
+
+      if (this->m_idx < this->m_blk.size())
+        return *this;
 
-      this->m_idx            = 0;
-      this->m_internal_state = this->process_blk(this->m_internal_state, this->m_blk);
+      this->process_blks(this->m_internal_state, this->m_blk.data(), 1);
+      this->m_idx = 0;
     }
+
+    // whole blocks are compressed directly from the callers memory
+    std::size_t const number_of_blks = len / this->m_blk.size();
+    this->process_blks(this->m_internal_state, cur, number_of_blks);
+    cur += number_of_blks * this->m_blk.size();
+    len -= number_of_blks * this->m_blk.size();
+
+    std::memcpy(this->m_blk.data(), cur, len);
+    this->m_idx = static_cast<uint32_t>(len);
     return *this;
   }
 
@@ -71,8 +204,8 @@ namespace wlib::hash
       tmp_blk[tmp_idx++] = std::byte(0x80);
       for (; tmp_idx < 64; tmp_idx++)
         tmp_blk[tmp_idx] = std::byte(0);
-      tmp_idx        = 0;
-      internal_state = this->process_blk(internal_state, tmp_blk);
+      tmp_idx = 0;
+      process_blks(internal_state, tmp_blk.data(), 1);
     }
     else
     {
@@ -82,63 +215,166 @@ namespace wlib::hash
     for (; tmp_idx < 56; tmp_idx++)
       tmp_blk[tmp_idx] = std::byte(0);
 
-    tmp_blk[56]    = std::byte((this->m_len >> 56) & 0xFF);
-    tmp_blk[57]    = std::byte((this->m_len >> 48) & 0xFF);
-    tmp_blk[58]    = std::byte((this->m_len >> 40) & 0xFF);
-    tmp_blk[59]    = std::byte((this->m_len >> 32) & 0xFF);
-    tmp_blk[60]    = std::byte((this->m_len >> 24) & 0xFF);
-    tmp_blk[61]    = std::byte((this->m_len >> 16) & 0xFF);
-    tmp_blk[62]    = std::byte((this->m_len >> 8) & 0xFF);
-    tmp_blk[63]    = std::byte((this->m_len >> 0) & 0xFF);
-    internal_state = this->process_blk(internal_state, tmp_blk);
+    tmp_blk[56] = std::byte((this->m_len >> 56) & 0xFF);
+    tmp_blk[57] = std::byte((this->m_len >> 48) & 0xFF);
+    tmp_blk[58] = std::byte((this->m_len >> 40) & 0xFF);
+    tmp_blk[59] = std::byte((this->m_len >> 32) & 0xFF);
+    tmp_blk[60] = std::byte((this->m_len >> 24) & 0xFF);
+    tmp_blk[61] = std::byte((this->m_len >> 16) & 0xFF);
+    tmp_blk[62] = std::byte((this->m_len >> 8) & 0xFF);
+    tmp_blk[63] = std::byte((this->m_len >> 0) & 0xFF);
+    process_blks(internal_state, tmp_blk.data(), 1);
 
     return internal_state.to_hash();
   }
 
-  sha_256::internal_state_t sha_256::process_blk(internal_state_t state, chunk_t const& blk) noexcept
+  void sha_256::calculate(std::span<std::span<std::byte const> const> data, std::span<hash_t> hashes) noexcept
   {
-    static constexpr uint32_t k[64] = { 0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01,
-                                        0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc,
-                                        0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da, 0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
-                                        0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
-                                        0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070, 0x19a4c116, 0x1e376c08,
-                                        0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
-                                        0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2 };
-
-    uint32_t w[64];
-    for (int i = 0; i < 16; ++i)
+    std::size_t const number_of_msgs = std::min(data.size(), hashes.size());
+
+    for (std::size_t first = 0; first < number_of_msgs; first += lanes)
     {
-      w[i] = (static_cast<uint32_t>(blk[i * 4 + 0]) << 24) | (static_cast<uint32_t>(blk[i * 4 + 1]) << 16) | (static_cast<uint32_t>(blk[i * 4 + 2]) << 8) |
-             static_cast<uint32_t>(blk[i * 4 + 3]);
+      std::size_t const used_lanes = std::min(lanes, number_of_msgs - first);
+
+      // blocks which all messages of this group have in common are compressed in lockstep
+      std::size_t common_blks = data[first].size() / 64;
+      for (std::size_t l = 1; l < used_lanes; l++)
+        common_blks = std::min(common_blks, data[first + l].size() / 64);
+
+      sha_256 ctx[lanes];
+      if (is_sha_ni_supported() || used_lanes == 1)
+      {
+        for (std::size_t l = 0; l < used_lanes; l++)
+          process_blks(ctx[l].m_internal_state, data[first + l].data(), common_blks);
+      }
+      else
+      {
+        internal_state_t state[lanes];
+        std::byte const* ptrs[lanes];
+        for (std::size_t l = 0; l < lanes; l++)
+          ptrs[l] = data[first + std::min(l, used_lanes - 1)].data();
+
+        process_blks_lockstep(state, ptrs, common_blks);
+        for (std::size_t l = 0; l < used_lanes; l++)
+          ctx[l].m_internal_state = state[l];
+      }
+
+      for (std::size_t l = 0; l < used_lanes; l++)
+      {
+        ctx[l].m_len = static_cast<uint64_t>(common_blks) * 64 * 8;
+        ctx[l](data[first + l].subspan(common_blks * 64));
+        hashes[first + l] = ctx[l].get();
+      }
     }
-    for (int i = 16; i < 64; ++i)
+  }
+
+  void sha_256::process_blks(internal_state_t& state, std::byte const* data, std::size_t number_of_blks) noexcept
+  {
+    if (number_of_blks == 0)
+      return;
+
+#if WLIB_HASH_HAS_SHA_NI
+    if (is_sha_ni_supported())
+      return process_blks_sha_ni(state.data(), data, number_of_blks);
+#endif
+    return process_blks_portable(state, data, number_of_blks);
+  }
+
+  void sha_256::process_blks_portable(internal_state_t& state, std::byte const* data, std::size_t number_of_blks) noexcept
+  {
+    for (; number_of_blks > 0; number_of_blks--, data += 64)
     {
-      uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
-      uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
-      w[i]        = w[i - 16] + s0 + w[i - 7] + s1;
+      uint32_t w[64];
+      for (int i = 0; i < 16; ++i)
+      {
+        w[i] = load_be32(data + i * 4);
+      }
+      for (int i = 16; i < 64; ++i)
+      {
+        uint32_t s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        uint32_t s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i]        = w[i - 16] + s0 + w[i - 7] + s1;
+      }
+
+      internal_state_t tmp = state;
+      for (uint64_t i = 0; i < 64; ++i)
+      {
+        uint32_t S1    = std::rotr(tmp[4], 6) ^ std::rotr(tmp[4], 11) ^ std::rotr(tmp[4], 25);
+        uint32_t ch    = (tmp[4] & tmp[5]) ^ (~tmp[4] & tmp[6]);
+        uint32_t temp1 = tmp[7] + S1 + ch + k[i] + w[i];
+        uint32_t S0    = std::rotr(tmp[0], 2) ^ std::rotr(tmp[0], 13) ^ std::rotr(tmp[0], 22);
+        uint32_t maj   = (tmp[0] & tmp[1]) ^ (tmp[0] & tmp[2]) ^ (tmp[1] & tmp[2]);
+        uint32_t temp2 = S0 + maj;
+
+        tmp[7] = tmp[6];
+        tmp[6] = tmp[5];
+        tmp[5] = tmp[4];
+        tmp[4] = tmp[3] + temp1;
+        tmp[3] = tmp[2];
+        tmp[2] = tmp[1];
+        tmp[1] = tmp[0];
+        tmp[0] = temp1 + temp2;
+      }
+
+      state += tmp;
     }
+  }
 
-    internal_state_t tmp = state;
-    for (uint64_t i = 0; i < 64; ++i)
+  void sha_256::process_blks_lockstep(internal_state_t (&state)[lanes], std::byte const* const (&data)[lanes], std::size_t number_of_blks) noexcept
+  {
+    // lane index innermost, so the compiler can map the lanes onto vector registers
+    for (std::size_t blk = 0; blk < number_of_blks; blk++)
     {
-      uint32_t S1    = std::rotr(tmp[4], 6) ^ std::rotr(tmp[4], 11) ^ std::rotr(tmp[4], 25);
-      uint32_t ch    = (tmp[4] & tmp[5]) ^ (~tmp[4] & tmp[6]);
-      uint32_t temp1 = tmp[7] + S1 + ch + k[i] + w[i];
-      uint32_t S0    = std::rotr(tmp[0], 2) ^ std::rotr(tmp[0], 13) ^ std::rotr(tmp[0], 22);
-      uint32_t maj   = (tmp[0] & tmp[1]) ^ (tmp[0] & tmp[2]) ^ (tmp[1] & tmp[2]);
-      uint32_t temp2 = S0 + maj;
-
-      tmp[7] = tmp[6];
-      tmp[6] = tmp[5];
-      tmp[5] = tmp[4];
-      tmp[4] = tmp[3] + temp1;
-      tmp[3] = tmp[2];
-      tmp[2] = tmp[1];
-      tmp[1] = tmp[0];
-      tmp[0] = temp1 + temp2;
-    }
+      uint32_t w[64][lanes];
+      for (int i = 0; i < 16; ++i)
+      {
+        for (std::size_t l = 0; l < lanes; l++)
+          w[i][l] = load_be32(data[l] + blk * 64 + i * 4);
+      }
+      for (int i = 16; i < 64; ++i)
+      {
+        for (std::size_t l = 0; l < lanes; l++)
+        {
+          uint32_t s0 = std::rotr(w[i - 15][l], 7) ^ std::rotr(w[i - 15][l], 18) ^ (w[i - 15][l] >> 3);
+          uint32_t s1 = std::rotr(w[i - 2][l], 17) ^ std::rotr(w[i - 2][l], 19) ^ (w[i - 2][l] >> 10);
+          w[i][l]     = w[i - 16][l] + s0 + w[i - 7][l] + s1;
+        }
+      }
+
+      uint32_t v[8][lanes];
+      for (std::size_t j = 0; j < 8; j++)
+      {
+        for (std::size_t l = 0; l < lanes; l++)
+          v[j][l] = state[l][static_cast<uint32_t>(j)];
+      }
 
-    state += tmp;
-    return state;
+      for (uint64_t i = 0; i < 64; ++i)
+      {
+        for (std::size_t l = 0; l < lanes; l++)
+        {
+          uint32_t S1    = std::rotr(v[4][l], 6) ^ std::rotr(v[4][l], 11) ^ std::rotr(v[4][l], 25);
+          uint32_t ch    = (v[4][l] & v[5][l]) ^ (~v[4][l] & v[6][l]);
+          uint32_t temp1 = v[7][l] + S1 + ch + k[i] + w[i][l];
+          uint32_t S0    = std::rotr(v[0][l], 2) ^ std::rotr(v[0][l], 13) ^ std::rotr(v[0][l], 22);
+          uint32_t maj   = (v[0][l] & v[1][l]) ^ (v[0][l] & v[2][l]) ^ (v[1][l] & v[2][l]);
+          uint32_t temp2 = S0 + maj;
+
+          v[7][l] = v[6][l];
+          v[6][l] = v[5][l];
+          v[5][l] = v[4][l];
+          v[4][l] = v[3][l] + temp1;
+          v[3][l] = v[2][l];
+          v[2][l] = v[1][l];
+          v[1][l] = v[0][l];
+          v[0][l] = temp1 + temp2;
+        }
+      }
+
+      for (std::size_t l = 0; l < lanes; l++)
+      {
+        for (std::size_t j = 0; j < 8; j++)
+          state[l][static_cast<uint32_t>(j)] += v[j][l];
+      }
+    }
   }
 }    // namespace wlib::hash
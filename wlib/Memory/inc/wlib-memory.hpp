@@ -2,6 +2,7 @@
 #ifndef WLIB_MEMORY_INTERFACE_HPP_INCLUDED
 #define WLIB_MEMORY_INTERFACE_HPP_INCLUDED
 
+#include <cstddef>
 #include <cstdint>
 #include <span>
 
@@ -18,6 +19,24 @@ namespace wlib
       virtual void flush()                                                 = 0;
       virtual void read(std::size_t add, std::span<std::byte> data)        = 0;
     };
+
+    /*
+     * Memory which has to be erased in sectors before it can be programmed.
+     * write() only programs, it never erases: programming an erased unit
+     * is the only write which is guaranteed to work. Addresses and sizes
+     * of write() are multiples of get_program_size().
+     */
+    class Flash_Memory_Interface: public Non_Volatile_Memory_Interface
+    {
+    public:
+      virtual std::size_t get_size() const         = 0;
+      virtual std::size_t get_sector_size() const  = 0;
+      virtual std::size_t get_program_size() const = 0;
+      virtual std::byte   get_erased_value() const { return std::byte{ 0xFF }; }
+
+      // add and size are multiples of get_sector_size()
+      virtual void erase(std::size_t add, std::size_t size) = 0;
+    };
   }    // namespace memory
 }    // namespace wlib
 
@@ -0,0 +1,268 @@
+#pragma once
+#ifndef WLIB_MEMORY_COALESCING_HPP_INCLUDED
+#define WLIB_MEMORY_COALESCING_HPP_INCLUDED
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <wlib-memory.hpp>
+
+namespace wlib::memory::internal
+{
+  void handle_config_exception();
+}    // namespace wlib::memory::internal
+
+namespace wlib::memory
+{
+  /*
+   * Decorator which buffers writes in RAM and writes them back coalesced.
+   *
+   * The buffer is split into up to N frames of unit_size bytes (e.g. the
+   * flash word), each frame holds one aligned unit of the target. Writes
+   * to a unit which is already buffered are merged in RAM; a partially
+   * written unit is completed from the target first, so only whole
+   * aligned units are written back. On write back the frames are sorted
+   * by address and every run of consecutive units within one page is
+   * passed to the target with a single write().
+   *
+   * Write back happens when the buffer is full, when policy.threshold
+   * bytes are dirty, when the oldest dirty byte is older than
+   * policy.max_age (checked on every access and by poll()) and on
+   * barrier(). By default flush() is a barrier. With policy.defer_flush a
+   * flush() only writes back if one of the limits is reached, so callers
+   * which flush after every write (e.g. mirrow_storage_t) do not force a
+   * program cycle each time; this is data which is lost on a reset, so it
+   * takes effect only together with a threshold or a max_age.
+   *
+   * read() returns the buffered data (read your writes). Not thread safe.
+   */
+  template <std::size_t N>
+    requires(N > 0)
+  class Write_Coalescing_Memory final: public Non_Volatile_Memory_Interface
+  {
+  public:
+    using clock_t = std::chrono::steady_clock;
+
+    struct policy_t
+    {
+      std::size_t               threshold   = 0;     // dirty bytes which trigger a write back, 0: only when the buffer is full
+      std::chrono::milliseconds max_age     = {};    // age of the oldest dirty byte which triggers a write back, 0: none
+      bool                      defer_flush = false; // flush() only writes back if threshold or max_age (one of them is required) is reached
+    };
+
+    struct statistics_t
+    {
+      std::size_t bytes_written         = 0;    // passed to write()
+      std::size_t bytes_coalesced       = 0;    // written into a unit which was dirty already
+      std::size_t page_writes_requested = 0;    // pages touched by the write() calls, one program operation each without buffering
+      std::size_t program_operations    = 0;    // write() calls passed to the target
+      std::size_t write_backs           = 0;
+
+      std::size_t get_number_of_saved_program_operations() const noexcept
+      {
+        return (page_writes_requested > program_operations) ? (page_writes_requested - program_operations) : 0;
+      }
+    };
+
+    /*
+     * buffer:    RAM for the frames, N * unit_size bytes are used at most
+     * unit_size: alignment and size of a written back unit, e.g. the flash word
+     * page_size: a write to the target never crosses a page, multiple of unit_size
+     *
+     * throws std::invalid_argument if unit_size or page_size is 0 or
+     * page_size is no multiple of unit_size
+     */
+    Write_Coalescing_Memory(Non_Volatile_Memory_Interface& target, std::span<std::byte> buffer, std::size_t unit_size, std::size_t page_size, policy_t const& policy = {})
+        : m_target(target)
+        , m_buffer(buffer)
+        , m_unit_sz(unit_size)
+        , m_page_sz(page_size)
+        , m_number_of_frames((unit_size == 0) ? 0 : std::min(N, buffer.size() / unit_size))
+        , m_policy(policy)
+    {
+      if ((this->m_unit_sz == 0) || (this->m_page_sz == 0) || (this->m_page_sz % this->m_unit_sz != 0))
+      {
+        internal::handle_config_exception();
+        return;
+      }
+    }
+
+    Write_Coalescing_Memory(Write_Coalescing_Memory const&)            = delete;
+    Write_Coalescing_Memory(Write_Coalescing_Memory&&)                 = delete;
+    Write_Coalescing_Memory& operator=(Write_Coalescing_Memory const&) = delete;
+    Write_Coalescing_Memory& operator=(Write_Coalescing_Memory&&)      = delete;
+    ~Write_Coalescing_Memory() override
+    {
+      try
+      {
+        this->barrier();
+      }
+      catch (...)
+      {
+      }
+    }
+
+    void write(std::size_t add, std::span<std::byte const> data) override
+    {
+      if (data.empty())
+        return;
+
+      this->m_stat.bytes_written += data.size();
+      this->m_stat.page_writes_requested += (add + data.size() - 1) / this->m_page_sz - add / this->m_page_sz + 1;
+
+      if (this->m_number_of_frames == 0)
+      {
+        this->m_target.write(add, data);
+        this->m_stat.program_operations++;
+        return;
+      }
+
+      while (!data.empty())
+      {
+        std::size_t const unit_add = add - add % this->m_unit_sz;
+        std::size_t const offset   = add - unit_add;
+        std::size_t const len      = std::min(data.size(), this->m_unit_sz - offset);
+
+        std::size_t frame = this->p_find(unit_add);
+        if (frame < this->m_used)
+        {
+          this->m_stat.bytes_coalesced += len;
+        }
+        else
+        {
+          if (this->m_used == this->m_number_of_frames)
+            this->p_write_back();
+
+          frame              = this->m_used++;
+          this->m_add[frame] = unit_add;
+          if (frame == 0)
+            this->m_first_dirty = clock_t::now();
+
+          // complete a partially written unit from the target
+          if (len != this->m_unit_sz)
+            this->m_target.read(unit_add, this->p_frame(frame));
+        }
+
+        std::memcpy(this->p_frame(frame).data() + offset, data.data(), len);
+        data = data.subspan(len);
+        add += len;
+      }
+
+      this->poll();
+    }
+
+    // deferred or a barrier, see policy_t::defer_flush
+    void flush() override
+    {
+      // without a limit the data would stay in RAM until the buffer is full
+      if (this->m_policy.defer_flush && (this->m_policy.threshold != 0 || this->m_policy.max_age.count() != 0))
+        return this->poll();
+      this->barrier();
+    }
+
+    void read(std::size_t add, std::span<std::byte> data) override
+    {
+      this->m_target.read(add, data);
+
+      for (std::size_t i = 0; i < this->m_used; i++)
+      {
+        std::size_t const beg = std::max(add, this->m_add[i]);
+        std::size_t const end = std::min(add + data.size(), this->m_add[i] + this->m_unit_sz);
+        if (beg < end)
+          std::memcpy(data.data() + (beg - add), this->p_frame(i).data() + (beg - this->m_add[i]), end - beg);
+      }
+    }
+
+    // writes everything back and flushes the target
+    void barrier()
+    {
+      this->p_write_back();
+      this->m_target.flush();
+    }
+
+    // writes back if the threshold or the max age is reached, e.g. to be called periodically
+    void poll()
+    {
+      if (this->m_used == 0)
+        return;
+
+      bool const threshold_reached = (this->m_policy.threshold != 0) && (this->get_number_of_dirty_bytes() >= this->m_policy.threshold);
+      bool const age_reached       = (this->m_policy.max_age.count() != 0) && ((clock_t::now() - this->m_first_dirty) >= this->m_policy.max_age);
+      if (threshold_reached || age_reached)
+        this->barrier();
+    }
+
+    std::size_t         get_number_of_dirty_bytes() const noexcept { return this->m_used * this->m_unit_sz; }
+    statistics_t const& get_statistics() const noexcept { return this->m_stat; }
+    void                reset_statistics() noexcept { this->m_stat = {}; }
+
+  private:
+    std::span<std::byte> p_frame(std::size_t idx) noexcept { return this->m_buffer.subspan(idx * this->m_unit_sz, this->m_unit_sz); }
+
+    std::size_t p_find(std::size_t unit_add) const noexcept
+    {
+      for (std::size_t i = 0; i < this->m_used; i++)
+      {
+        if (this->m_add[i] == unit_add)
+          return i;
+      }
+      return this->m_used;
+    }
+
+    void p_write_back()
+    {
+      if (this->m_used == 0)
+        return;
+
+      // sort the frames by address, so consecutive units are consecutive in the buffer
+      for (std::size_t i = 0; i < this->m_used; i++)
+      {
+        std::size_t min = i;
+        for (std::size_t j = i + 1; j < this->m_used; j++)
+        {
+          if (this->m_add[j] < this->m_add[min])
+            min = j;
+        }
+        if (min != i)
+        {
+          std::swap(this->m_add[i], this->m_add[min]);
+          std::swap_ranges(this->p_frame(i).begin(), this->p_frame(i).end(), this->p_frame(min).begin());
+        }
+      }
+
+      std::size_t run_beg = 0;
+      for (std::size_t i = 1; i <= this->m_used; i++)
+      {
+        bool const run_ends = (i == this->m_used) || (this->m_add[i] != this->m_add[i - 1] + this->m_unit_sz)
+                              || (this->m_add[i] / this->m_page_sz != this->m_add[run_beg] / this->m_page_sz);
+        if (!run_ends)
+          continue;
+
+        this->m_target.write(this->m_add[run_beg], this->m_buffer.subspan(run_beg * this->m_unit_sz, (i - run_beg) * this->m_unit_sz));
+        this->m_stat.program_operations++;
+        run_beg = i;
+      }
+
+      this->m_stat.write_backs++;
+      this->m_used = 0;
+    }
+
+    Non_Volatile_Memory_Interface& m_target;
+    std::span<std::byte>           m_buffer;
+    std::size_t const              m_unit_sz;
+    std::size_t const              m_page_sz;
+    std::size_t const              m_number_of_frames;
+    policy_t                       m_policy;
+
+    std::array<std::size_t, N> m_add   = {};
+    std::size_t                m_used  = 0;
+    clock_t::time_point        m_first_dirty;
+    statistics_t               m_stat  = {};
+  };
+}    // namespace wlib::memory
+
+#endif    // WLIB_MEMORY_COALESCING_HPP_INCLUDED
@@ -1,4 +1,10 @@
 #include <wlib-memory.hpp>
+#include <wlib-memory_coalescing.hpp>
 
+//
+#include <stdexcept>
 
-
+namespace wlib::memory
+{
+  void internal::handle_config_exception() { throw std::invalid_argument("invalid memory configuration"); }
+}    // namespace wlib::memory
@@ -0,0 +1,330 @@
+#pragma once
+#ifndef WLIB_STORAGE_LOG_HPP_INCLUDED
+#define WLIB_STORAGE_LOG_HPP_INCLUDED
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <wlib-BLOB.hpp>
+#include <wlib-CRC.hpp>
+#include <wlib-Provider_Interface.hpp>
+#include <wlib-memory.hpp>
+#include <wlib-storage.hpp>
+
+namespace wlib::storage::internal
+{
+  void handle_config_exception();
+}    // namespace wlib::storage::internal
+
+namespace wlib::storage::strategy
+{
+  /*
+   * Append only storage in a ring of flash sectors.
+   *
+   * Every save() programs one record into the next free slot, a sector is
+   * erased only when the write position enters it, i.e. once per
+   * slots-per-sector saves instead of on every save. A record is
+   *
+   *   | magic u32 | sequence u32 | value (blob << value) | 0 padding | crc64 |
+   *
+   * with a fixed size (rounded up to the program size of the flash). At
+   * startup the sector currently written is found by the sequence numbers
+   * of the first valid slots of all sectors, the written part of it by a
+   * binary search; the newest record with a valid crc is loaded. A record
+   * torn by a power loss is skipped, the previous one stays valid.
+   *
+   * The written slots of a sector always are a prefix: a slot counts as
+   * written if any byte of it is programmed. If a write fails, a partly
+   * programmed slot is skipped (its crc is wrong), an erased one is used
+   * again; the record is retried once.
+   *
+   * At least two sectors are required, so the newest record is never in
+   * the sector which is erased.
+   */
+  template <typename T> class log_storage_t: public wlib::storage::Non_Volatile_Storage_Interface<T>
+  {
+    using crc_t      = wlib::crc::CRC_64_go_iso;
+    using value_type = typename wlib::storage::Non_Volatile_Storage_Interface<T>::value_type;
+    using seq_t      = uint32_t;
+
+    static constexpr uint32_t    magic       = 0x574C'4F47;
+    static constexpr std::size_t header_size = sizeof(magic) + sizeof(seq_t);
+
+  public:
+    /*
+     * rec_size:          bytes per record including header and crc
+     * add:               address of the first sector of the ring
+     * number_of_sectors: sectors of the ring, at least 2
+     */
+    log_storage_t(wlib::memory::Flash_Memory_Interface& mem,
+                  std::size_t                           rec_size,
+                  std::size_t                           add,
+                  std::size_t                           number_of_sectors,
+                  Shared_Memory_Provider_Interface&     memory_provider)
+        : m_mem{ mem }
+        , m_rec_sz{ round_up(rec_size, mem.get_program_size()) }
+        , m_add{ add }
+        , m_sec_sz{ mem.get_sector_size() }
+        , m_number_of_sectors{ number_of_sectors }
+        , m_slots_per_sector{ divide_or_zero(mem.get_sector_size(), m_rec_sz) }
+        , m_buffer_pro(memory_provider)
+    {
+      // the sector size is checked first, the alignment check divides by it
+      if ((this->m_sec_sz == 0) || (this->m_number_of_sectors < 2) || (this->m_slots_per_sector == 0)
+          || (this->m_rec_sz < header_size + sizeof(crc_t::used_type)) || (this->m_add % this->m_sec_sz != 0))
+      {
+        internal::handle_config_exception();
+        return;
+      }
+
+      try
+      {
+        this->p_mount();
+      }
+      catch (...)
+      {
+      }
+    }
+
+    value_type load() const override { return this->m_val; }
+    void       save(value_type const& value) override
+    {
+      if (this->m_val == value)
+        return;
+
+      value_type const old = this->m_val;
+      this->m_val          = value;
+
+      for (std::size_t attempt = 0;; attempt++)
+      {
+        try
+        {
+          this->p_append();
+          this->m_number_of_records++;
+          return;
+        }
+        catch (...)
+        {
+          this->m_number_of_failed_writes++;
+          if (attempt > 0)
+          {
+            // load() returns what is stored, the next save() of the value tries again
+            this->m_val = old;
+            throw;
+          }
+        }
+      }
+    }
+
+    // erases and records issued by this object, e.g. to compare the wear with mirrow_storage_t
+    std::size_t get_number_of_erases() const noexcept { return this->m_number_of_erases; }
+    std::size_t get_number_of_written_records() const noexcept { return this->m_number_of_records; }
+    std::size_t get_number_of_failed_writes() const noexcept { return this->m_number_of_failed_writes; }
+    std::size_t get_record_size() const noexcept { return this->m_rec_sz; }
+    std::size_t get_number_of_slots() const noexcept { return this->p_number_of_slots(); }
+
+  private:
+    static constexpr std::size_t round_up(std::size_t value, std::size_t multiple) noexcept
+    {
+      return (multiple == 0) ? value : ((value + multiple - 1) / multiple) * multiple;
+    }
+
+    // a zero record size is a configuration error, which is reported after the initialization
+    static constexpr std::size_t divide_or_zero(std::size_t value, std::size_t divisor) noexcept { return (divisor == 0) ? 0 : value / divisor; }
+
+    std::size_t p_number_of_slots() const noexcept { return this->m_slots_per_sector * this->m_number_of_sectors; }
+    std::size_t p_slot_address(std::size_t slot) const noexcept
+    {
+      return this->m_add + (slot / this->m_slots_per_sector) * this->m_sec_sz + (slot % this->m_slots_per_sector) * this->m_rec_sz;
+    }
+    std::size_t get_begin_of_crc() const noexcept { return this->m_rec_sz - sizeof(crc_t::used_type); }
+
+    void p_append()
+    {
+      if (this->m_head % this->m_slots_per_sector == 0)
+      {
+        this->m_mem.erase(this->m_add + (this->m_head / this->m_slots_per_sector) * this->m_sec_sz, this->m_sec_sz);
+        this->m_number_of_erases++;
+      }
+
+      std::size_t const slot = this->m_head;
+
+      auto                 obj = this->m_buffer_pro.request();
+      std::span<std::byte> tmp = this->p_serialize(obj.get(), this->m_seq + 1);
+      try
+      {
+        this->m_mem.write(this->p_slot_address(slot), tmp);
+        this->m_mem.flush();
+      }
+      catch (...)
+      {
+        // a slot which cannot be programmed again is used up
+        if (this->p_is_written(slot, tmp))
+          this->p_consume(slot);
+        throw;
+      }
+      this->p_consume(slot);
+    }
+
+    void p_consume(std::size_t slot) noexcept
+    {
+      this->m_head = (slot + 1) % this->p_number_of_slots();
+      this->m_seq++;
+    }
+
+    // any byte of the record programmed, a slot which cannot be read counts as written
+    bool p_is_written(std::size_t slot, std::span<std::byte> buffer) noexcept
+    {
+      try
+      {
+        std::span<std::byte> const tmp = buffer.subspan(0, this->m_rec_sz);
+        this->m_mem.read(this->p_slot_address(slot), tmp);
+        for (std::byte b : tmp)
+        {
+          if (b != this->m_mem.get_erased_value())
+            return true;
+        }
+        return false;
+      }
+      catch (...)
+      {
+        return true;
+      }
+    }
+
+    struct header_t
+    {
+      bool  valid = false;
+      seq_t seq   = 0;
+    };
+
+    header_t p_read_header(std::size_t slot)
+    {
+      std::array<std::byte, header_size> raw;
+      this->m_mem.read(this->p_slot_address(slot), raw);
+
+      wlib::blob::ConstMemoryBlob blob{ raw };
+      header_t                    ret;
+      ret.valid = (blob.read<uint32_t>(0) == magic);
+      ret.seq   = blob.read<seq_t>(sizeof(magic));
+      return ret;
+    }
+
+    void p_mount()
+    {
+      auto                 obj = this->m_buffer_pro.request();
+      std::span<std::byte> tmp = obj.get().subspan(0, this->m_rec_sz);
+
+      // sector with the newest first record is the one written currently, torn slots
+      // at the begin of a sector are skipped, the sequence counts every used slot
+      std::optional<std::size_t> cur_sector;
+      std::size_t                cur_first_valid = 0;
+      seq_t                      cur_seq         = 0;
+      for (std::size_t sec = 0; sec < this->m_number_of_sectors; sec++)
+      {
+        std::size_t const first = sec * this->m_slots_per_sector;
+        for (std::size_t k = 0; k < this->m_slots_per_sector && this->p_is_written(first + k, tmp); k++)
+        {
+          header_t const hdr = this->p_read_header(first + k);
+          if (!hdr.valid)
+            continue;
+
+          seq_t const seq = hdr.seq - static_cast<seq_t>(k);
+          if (!cur_sector.has_value() || static_cast<int32_t>(seq - cur_seq) > 0)
+          {
+            cur_sector      = sec;
+            cur_first_valid = k;
+            cur_seq         = seq;
+          }
+          break;
+        }
+      }
+      if (!cur_sector.has_value())
+        return;
+
+      // the written slots of a sector are a prefix: binary search for the first erased one
+      std::size_t const first = cur_sector.value() * this->m_slots_per_sector;
+      std::size_t       lo    = cur_first_valid + 1;
+      std::size_t       hi    = this->m_slots_per_sector;
+      while (lo < hi)
+      {
+        std::size_t const mid = lo + (hi - lo) / 2;
+        if (this->p_is_written(first + mid, tmp))
+          lo = mid + 1;
+        else
+          hi = mid;
+      }
+      std::size_t const last_written = first + lo - 1;
+      this->m_head                   = (last_written + 1) % this->p_number_of_slots();
+      this->m_seq                    = cur_seq + static_cast<seq_t>(lo - 1);
+
+      // newest record which is complete
+      for (std::size_t i = 0; i < this->p_number_of_slots(); i++)
+      {
+        std::size_t const slot = (last_written + this->p_number_of_slots() - i) % this->p_number_of_slots();
+        this->m_mem.read(this->p_slot_address(slot), tmp);
+
+        auto const val = this->p_check(tmp);
+        if (val.has_value())
+        {
+          this->m_val = val.value();
+          return;
+        }
+      }
+    }
+
+    std::optional<value_type> p_check(std::span<std::byte const> buffer)
+    {
+      try
+      {
+        wlib::blob::ConstMemoryBlob blob{ buffer };
+        crc_t::used_type            crc_in   = blob.read<crc_t::used_type>(this->get_begin_of_crc());
+        crc_t::used_type            crc_calc = crc_t::calculate(buffer.first(this->get_begin_of_crc()));
+        if ((crc_in != crc_calc) || (blob.read<uint32_t>(0) != magic))
+          return std::nullopt;
+
+        blob.remove_front(header_size);
+        value_type ret = {};
+        blob >> ret;
+        return ret;
+      }
+      catch (...)
+      {
+        return std::nullopt;
+      }
+    }
+
+    std::span<std::byte> p_serialize(std::span<std::byte> tmp, seq_t seq)
+    {
+      wlib::blob::MemoryBlob blob{ tmp.subspan(0, this->m_rec_sz) };
+      blob.insert_back(magic);
+      blob.insert_back(seq);
+      blob << this->m_val;
+
+      blob.insert_back(std::byte(0x00), this->get_begin_of_crc() - blob.get_number_of_used_bytes());
+      blob.insert_back(crc_t::calculate(blob.get_span()));
+
+      return blob.get_span();
+    }
+
+    wlib::memory::Flash_Memory_Interface& m_mem;
+    std::size_t const                     m_rec_sz;
+    std::size_t const                     m_add;
+    std::size_t const                     m_sec_sz;
+    std::size_t const                     m_number_of_sectors;
+    std::size_t const                     m_slots_per_sector;
+    Shared_Memory_Provider_Interface&     m_buffer_pro;
+
+    std::size_t m_head                    = 0;
+    seq_t       m_seq                     = 0;
+    std::size_t m_number_of_erases        = 0;
+    std::size_t m_number_of_records       = 0;
+    std::size_t m_number_of_failed_writes = 0;
+
+    value_type m_val = {};
+  };
+}    // namespace wlib::storage::strategy
+
+#endif    // WLIB_STORAGE_LOG_HPP_INCLUDED
@@ -1,2 +1,10 @@
 #include <wlib-storage.hpp>
+#include <wlib-storage_log.hpp>
 
+//
+#include <stdexcept>
+
+namespace wlib::storage
+{
+  void internal::handle_config_exception() { throw std::invalid_argument("invalid storage configuration"); }
+}    // namespace wlib::storage
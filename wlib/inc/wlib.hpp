@@ -5,6 +5,7 @@
 #include <wlib-CRC.hpp>
 #include <wlib-HASH.hpp>
 #include <wlib-BLOB.hpp>
+#include <wlib-BLOB_Schema.hpp>
 #include <wlib-Callback.hpp>
 #include <wlib-Publisher.hpp>
 #include <wlib-Container.hpp>
@@ -12,7 +13,9 @@
 #include <wlib-io.hpp>
 #include <wlib-StringSink.hpp>
 #include <wlib-memory.hpp>
+#include <wlib-memory_coalescing.hpp>
 #include <wlib-storage.hpp>
+#include <wlib-storage_log.hpp>
 #include <wlib-Provider_Interface.hpp>
 
 //#include <wlib_LED_abstraction.hpp>